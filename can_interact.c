@@ -1,4 +1,4 @@
-#define _DEFAULT_SOURCE
+#define _GNU_SOURCE /* recvmmsg */
 
 #include <unistd.h> /* syscalls */
 #include <stddef.h>
@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <endian.h>
 #include <math.h>
+#include <time.h>
 
 #include <errno.h>
 #include <linux/if.h>
@@ -34,6 +35,9 @@ int can_interact_init(int *s, const char *net_device)
 	struct ifreq ifr; /* used to configure net device */
 	struct sockaddr_can addr; /* assigns address connections */
 
+	if (strcmp(net_device, "any") == 0) {
+		return can_interact_init_any(s);
+	}
 	*s = socket(PF_CAN, SOCK_RAW, CAN_RAW); /* creates communication endpoint to a given data source. request for raw network protocol access */
 	if(*s == -1) {
 		return (int)errno;
@@ -50,12 +54,35 @@ int can_interact_init(int *s, const char *net_device)
 	return 0;
 }
 
+int can_interact_init_any(int *s)
+{
+	struct sockaddr_can addr;
+
+	*s = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+	if (*s == -1) {
+		return (int)errno;
+	}
+	memset(&addr, '\0', sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = 0; /* all CAN interfaces, the source of each frame is reported via recvmsg */
+	if (bind(*s, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+		return (int)errno;
+	}
+
+	return 0;
+}
+
 int can_interact_filter(const uint32_t *filter_ids, const size_t filter_id_len, const int *socket)
 {
 	struct can_filter *filters;
 	size_t i;
 	int res;
 
+	if (filter_id_len == 0) { /* an empty filter list disables reception */
+		res = setsockopt(*socket, SOL_CAN_RAW, CAN_RAW_FILTER, NULL, 0);
+		return res == 0 ? 0 : (int)errno;
+	}
+
 	filters = (struct can_filter*)malloc(sizeof(struct can_filter) * filter_id_len);
 	
 	if (filters == NULL) {
@@ -67,7 +94,7 @@ int can_interact_filter(const uint32_t *filter_ids, const size_t filter_id_len,
 		filters[i].can_mask = 0x1FFFFFFF; /* every bit must match filter (see https://www.cnblogs.com/shangdawei/p/4716860.html) */
 	}
 	
-	res = setsockopt(*socket, SOL_CAN_RAW, CAN_RAW_FILTER, &filters, sizeof(filters));
+	res = setsockopt(*socket, SOL_CAN_RAW, CAN_RAW_FILTER, filters, (socklen_t)(sizeof(struct can_filter) * filter_id_len));
 	free(filters);
 	return res == 0 ? 0 : (int)errno ;
 }
@@ -78,6 +105,189 @@ int can_interact_get_frame(struct can_frame* can_frame, const int *socket)
 	return nbytes <= 0 ? (int)errno : 0; /* 0 = success, 1 = no data reading from CAN */
 }
 
+int can_interact_timestamps(const int *socket)
+{
+	const int enable = 1;
+	return setsockopt(*socket, SOL_SOCKET, SO_TIMESTAMPNS, &enable, sizeof(enable)) == 0 ? 0 : (int)errno;
+}
+
+/**
+ * @brief _p_can_interact_timestamp - INTERNAL METHOD. extracts SO_TIMESTAMPNS timestamp from received message's control data
+ * @param struct msghdr* - received message header
+ * @return uint64_t - timestamp in nanoseconds, 0 if not present
+ */
+static uint64_t _p_can_interact_timestamp(struct msghdr *msg)
+{
+	struct cmsghdr *cmsg;
+	struct timespec ts;
+
+	for (cmsg = CMSG_FIRSTHDR(msg); cmsg != NULL; cmsg = CMSG_NXTHDR(msg, cmsg)) {
+		if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPNS) {
+			memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+			return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+		}
+	}
+	return 0;
+}
+
+int can_interact_get_frames(struct can_interact_timed_frame *frames, const size_t len, size_t *received, const int *socket)
+{
+	struct mmsghdr msgs[CAN_INTERACT_MAX_BATCH];
+	struct iovec iovs[CAN_INTERACT_MAX_BATCH];
+	uint64_t control[CAN_INTERACT_MAX_BATCH][CMSG_SPACE(sizeof(struct timespec)) / sizeof(uint64_t) + 1]; /* aligned cmsg buffers */
+	const size_t n = len < CAN_INTERACT_MAX_BATCH ? len : CAN_INTERACT_MAX_BATCH;
+	size_t i;
+	int res;
+
+	*received = 0;
+	memset(msgs, 0, sizeof(struct mmsghdr) * n);
+	for (i = 0; i < n; ++i) {
+		iovs[i].iov_base = &frames[i].frame;
+		iovs[i].iov_len = sizeof(struct can_frame);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_control = control[i];
+		msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+	}
+
+	res = recvmmsg(*socket, msgs, (unsigned int)n, MSG_WAITFORONE, NULL); /* block for first, then take what is queued */
+	if (res <= 0) {
+		return res == 0 ? EAGAIN : (int)errno;
+	}
+	for (i = 0; i < (size_t)res; ++i) {
+		frames[i].timestamp_ns = _p_can_interact_timestamp(&msgs[i].msg_hdr);
+	}
+	*received = (size_t)res;
+	return 0;
+}
+
+int can_interact_get_if_frames(struct can_interact_if_frame *frames, const size_t len, size_t *received, const int *socket)
+{
+	struct mmsghdr msgs[CAN_INTERACT_MAX_BATCH];
+	struct iovec iovs[CAN_INTERACT_MAX_BATCH];
+	struct sockaddr_can addrs[CAN_INTERACT_MAX_BATCH]; /* carry the source interface */
+	uint64_t control[CAN_INTERACT_MAX_BATCH][CMSG_SPACE(sizeof(struct timespec)) / sizeof(uint64_t) + 1]; /* aligned cmsg buffers */
+	const size_t n = len < CAN_INTERACT_MAX_BATCH ? len : CAN_INTERACT_MAX_BATCH;
+	size_t i;
+	int res;
+
+	*received = 0;
+	memset(msgs, 0, sizeof(struct mmsghdr) * n);
+	for (i = 0; i < n; ++i) {
+		iovs[i].iov_base = &frames[i].frame;
+		iovs[i].iov_len = sizeof(struct can_frame);
+		msgs[i].msg_hdr.msg_name = &addrs[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_can);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_control = control[i];
+		msgs[i].msg_hdr.msg_controllen = sizeof(control[i]);
+	}
+
+	res = recvmmsg(*socket, msgs, (unsigned int)n, MSG_WAITFORONE, NULL); /* block for first, then take what is queued */
+	if (res <= 0) {
+		return res == 0 ? EAGAIN : (int)errno;
+	}
+	for (i = 0; i < (size_t)res; ++i) {
+		frames[i].timestamp_ns = _p_can_interact_timestamp(&msgs[i].msg_hdr);
+		frames[i].ifindex = msgs[i].msg_hdr.msg_namelen >= sizeof(struct sockaddr_can) ? addrs[i].can_ifindex : 0;
+	}
+	*received = (size_t)res;
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_if_store - INTERNAL METHOD. remembers interface in cache, replacing the oldest entry once full
+ * @param struct can_interact_if_cache* - cache
+ * @param const int - interface index
+ * @param const char* - interface name
+ * @return size_t - slot of entry
+ */
+static size_t _p_can_interact_if_store(struct can_interact_if_cache *cache, const int ifindex, const char *name)
+{
+	size_t slot;
+
+	if (cache->len < CAN_INTERACT_IF_CACHE) {
+		slot = cache->len++;
+	} else {
+		slot = cache->next;
+		cache->next = (cache->next + 1) % CAN_INTERACT_IF_CACHE;
+	}
+	cache->ifindex[slot] = ifindex;
+	strncpy(cache->name[slot], name, IFNAMSIZ - 1);
+	cache->name[slot][IFNAMSIZ - 1] = '\0';
+	return slot;
+}
+
+/**
+ * @brief _p_can_interact_if_ioctl - INTERNAL METHOD. resolves interface index or name with the kernel
+ * @param struct ifreq* - request holding index (SIOCGIFNAME) or name (SIOCGIFINDEX)
+ * @param const unsigned long - request
+ * @return int - error code, 0 on success
+ */
+static int _p_can_interact_if_ioctl(struct ifreq *ifr, const unsigned long request)
+{
+	int s, res = 0;
+
+	s = socket(AF_UNIX, SOCK_DGRAM, 0); /* any socket serves interface ioctls */
+	if (s == -1) {
+		return (int)errno;
+	}
+	if (ioctl(s, request, ifr) == -1) {
+		res = (int)errno;
+	}
+	close(s);
+	return res;
+}
+
+int can_interact_if_name(struct can_interact_if_cache *cache, const int ifindex, const char **name)
+{
+	struct ifreq ifr;
+	size_t i;
+	int res;
+
+	for (i = 0; i < cache->len; ++i) {
+		if (cache->ifindex[i] == ifindex) {
+			*name = cache->name[i];
+			return 0;
+		}
+	}
+	memset(&ifr, 0, sizeof(ifr));
+	ifr.ifr_ifindex = ifindex;
+	res = _p_can_interact_if_ioctl(&ifr, SIOCGIFNAME);
+	if (res != 0) {
+		return res;
+	}
+	*name = cache->name[_p_can_interact_if_store(cache, ifindex, ifr.ifr_name)];
+	return 0;
+}
+
+int can_interact_if_index(struct can_interact_if_cache *cache, const char *device_name, int *ifindex)
+{
+	struct ifreq ifr;
+	size_t i;
+	int res;
+
+	for (i = 0; i < cache->len; ++i) {
+		if (strncmp(cache->name[i], device_name, IFNAMSIZ) == 0) {
+			*ifindex = cache->ifindex[i];
+			return 0;
+		}
+	}
+	if (strlen(device_name) >= IFNAMSIZ) {
+		return ENODEV;
+	}
+	memset(&ifr, 0, sizeof(ifr));
+	strcpy(ifr.ifr_name, device_name);
+	res = _p_can_interact_if_ioctl(&ifr, SIOCGIFINDEX);
+	if (res != 0) {
+		return res;
+	}
+	*ifindex = ifr.ifr_ifindex;
+	_p_can_interact_if_store(cache, ifr.ifr_ifindex, device_name);
+	return 0;
+}
+
 /**
  * @brief _p_can_interact_decode_float - INTERNAL METHOD. purely converts array of length x containing bytes into double type
  * @param const uint8_t* - const array of bytes
@@ -319,6 +529,44 @@ int can_interact_send_frame(const struct can_frame* can_frame, const int* socket
 	return res == 0 ? 0 : (int)errno;
 }
 
+int can_interact_send_frames(const struct can_frame *frames, const size_t len, size_t *sent, const int *socket)
+{
+	struct mmsghdr msgs[CAN_INTERACT_MAX_BATCH];
+	struct iovec iovs[CAN_INTERACT_MAX_BATCH];
+	const size_t n = len < CAN_INTERACT_MAX_BATCH ? len : CAN_INTERACT_MAX_BATCH;
+	size_t i;
+	int res;
+
+	*sent = 0;
+	if (n == 0) {
+		return 0;
+	}
+	memset(msgs, 0, sizeof(struct mmsghdr) * n);
+	for (i = 0; i < n; ++i) {
+		iovs[i].iov_base = (void*)&frames[i];
+		iovs[i].iov_len = sizeof(struct can_frame);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	res = sendmmsg(*socket, msgs, (unsigned int)n, 0); /* stops at first failing frame, reporting those before it */
+	if (res <= 0) {
+		return (int)errno;
+	}
+	*sent = (size_t)res;
+	return 0;
+}
+
+int can_interact_send_if_frame(const struct can_frame *frame, const int ifindex, const int *socket)
+{
+	struct sockaddr_can addr;
+
+	memset(&addr, '\0', sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = ifindex;
+	return sendto(*socket, frame, sizeof(struct can_frame), 0, (struct sockaddr*)&addr, sizeof(addr)) == (ssize_t)sizeof(struct can_frame) ? 0 : (int)errno;
+}
+
 int can_interact_fini(const int* socket)
 {
 	close(*socket);
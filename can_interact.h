@@ -44,6 +44,37 @@ enum can_interact_data_type {
     DATA_TYPE_FLOAT /* ieee 754 double float */
 };
 
+#define CAN_INTERACT_MAX_BATCH 64 /* max frames received per can_interact_get_frames call */
+
+struct can_interact_timed_frame {
+    /**
+     * @brief struct can_interact_timed_frame - received frame paired with its kernel receive timestamp
+     */
+    struct can_frame frame;
+    uint64_t timestamp_ns; /* CLOCK_REALTIME nanoseconds, 0 if timestamps have not been enabled via can_interact_timestamps */
+};
+
+#define CAN_INTERACT_IF_CACHE 16 /* interfaces remembered by struct can_interact_if_cache */
+
+struct can_interact_if_frame {
+    /**
+     * @brief struct can_interact_if_frame - received frame paired with its kernel receive timestamp and source interface, see can_interact_init_any
+     */
+    struct can_frame frame;
+    uint64_t timestamp_ns; /* CLOCK_REALTIME nanoseconds, 0 if timestamps have not been enabled via can_interact_timestamps */
+    int ifindex; /* interface the frame was received on */
+};
+
+struct can_interact_if_cache {
+    /**
+     * @brief struct can_interact_if_cache - interface index to name table, filled on lookup (zero initialise before first use)
+     */
+    int ifindex[CAN_INTERACT_IF_CACHE];
+    char name[CAN_INTERACT_IF_CACHE][IFNAMSIZ];
+    size_t len;
+    size_t next; /* slot to replace once full */
+};
+
 /**
  * @brief can_interact_init - initialises CAN connection to specific network device via low level syscalls
  *
@@ -56,6 +87,17 @@ enum can_interact_data_type {
  */
 int can_interact_init(int *socket, const char *device_name);
 
+/**
+ * @brief can_interact_init_any - initialises CAN connection receiving from (and able to send to) all CAN devices, by binding to interface index 0
+ * can_interact_init does the same for device name "any" (as candump does)
+ *
+ * @param int* - pointer to varibale to initialise as socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes for other writing errors
+ */
+int can_interact_init_any(int *socket);
+
 /**
  * @brief can_interact_filter - function applies kernel level filtering to socket to relevant CAN frames
  *
@@ -84,6 +126,33 @@ int can_interact_filter(const uint32_t *filter_ids, const size_t len_ids, const
  */
 int can_interact_get_frame(struct can_frame *frame, const int *socket);
 
+/**
+ * @brief can_interact_timestamps - enables kernel receive timestamps (SO_TIMESTAMPNS) on socket, used by can_interact_get_frames
+ *
+ * @param const int* - socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes for other writing errors
+ */
+int can_interact_timestamps(const int *socket);
+
+/**
+ * @brief can_interact_get_frames - function gets batch of timestamped can frames from stream associated to descriptor in a single syscall
+ * Blocks until at least one frame is available, then returns all frames already queued (up to limit)
+ *
+ * @param struct can_interact_timed_frame* - array of frames to write to
+ *
+ * @param const size_t - capacity of array (at most CAN_INTERACT_MAX_BATCH frames are received per call)
+ *
+ * @param size_t* - pointer to write number of received frames to
+ *
+ * @param const int* - socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes for other reading errors (e.g. EAGAIN if a receive timeout expired)
+ */
+int can_interact_get_frames(struct can_interact_timed_frame *frames, const size_t len, size_t *received, const int *socket);
+
 /**
  * @brief can_interact_decode - converts array of length x containing bytes into value
  *
@@ -126,6 +195,51 @@ int can_interact_decode(const struct can_frame *frame, const enum can_interact_d
  */
 int can_interact_encode(const canid_t id, const void *value, const uint8_t len, const enum can_interact_data_type type, const enum can_interact_endianness endianness, struct can_frame *frame);
 
+/**
+ * @brief can_interact_get_if_frames - function gets batch of timestamped can frames together with the interfaces they were received on
+ * Blocks until at least one frame is available, then returns all frames already queued (up to limit)
+ *
+ * @param struct can_interact_if_frame* - array of frames to write to
+ *
+ * @param const size_t - capacity of array (at most CAN_INTERACT_MAX_BATCH frames are received per call)
+ *
+ * @param size_t* - pointer to write number of received frames to
+ *
+ * @param const int* - socket descriptor (typically from can_interact_init_any)
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes for other reading errors (e.g. EAGAIN if a receive timeout expired)
+ */
+int can_interact_get_if_frames(struct can_interact_if_frame *frames, const size_t len, size_t *received, const int *socket);
+
+/**
+ * @brief can_interact_if_name - looks up name of interface, asking the kernel only on cache misses
+ *
+ * @param struct can_interact_if_cache* - cache
+ *
+ * @param const int - interface index
+ *
+ * @param const char** - pointer to write name to (points into cache, valid until it is replaced)
+ *
+ * @return int - error code
+ * Note: 0 on success, ENODEV if there is no such interface, for other non-zero values refer to errno codes
+ */
+int can_interact_if_name(struct can_interact_if_cache *cache, const int ifindex, const char **name);
+
+/**
+ * @brief can_interact_if_index - looks up index of interface, asking the kernel only on cache misses
+ *
+ * @param struct can_interact_if_cache* - cache
+ *
+ * @param const char* - c-string (null terminated) to CAN device name
+ *
+ * @param int* - pointer to write interface index to
+ *
+ * @return int - error code
+ * Note: 0 on success, ENODEV if there is no such interface, for other non-zero values refer to errno codes
+ */
+int can_interact_if_index(struct can_interact_if_cache *cache, const char *device_name, int *ifindex);
+
 /**
  * @brief can_interact_send_frame - function sends can frame to stream associated to provided descriptor
  *
@@ -139,6 +253,36 @@ int can_interact_encode(const canid_t id, const void *value, const uint8_t len,
  */
 int can_interact_send_frame(const struct can_frame *frame, const int *socket);
 
+/**
+ * @brief can_interact_send_frames - function sends batch of can frames to stream associated to descriptor in a single syscall
+ *
+ * @param const struct can_frame* - array of LINUX can frames to send
+ *
+ * @param const size_t - number of frames (at most CAN_INTERACT_MAX_BATCH frames are sent per call)
+ *
+ * @param size_t* - pointer to write number of sent frames to (frames after it were not sent, e.g. as the transmit queue is full)
+ *
+ * @param const int* - socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 if at least one frame was sent (or none were given), for non-zero values refer to errno codes for other writing errors
+ */
+int can_interact_send_frames(const struct can_frame *frames, const size_t len, size_t *sent, const int *socket);
+
+/**
+ * @brief can_interact_send_if_frame - function sends can frame to specific interface via socket bound to all interfaces (see can_interact_init_any)
+ *
+ * @param const struct can_frame* - pointer to LINUX can frame to send
+ *
+ * @param const int - index of interface to send frame on
+ *
+ * @param const int* - socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes for other writing errors
+ */
+int can_interact_send_if_frame(const struct can_frame *frame, const int ifindex, const int *socket);
+
 /**
  * @brief can_interact_fini - frees CAN connection
  *
@@ -13,6 +13,7 @@
 #include <stdexcept>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include <unistd.h>
 #include <errno.h>
@@ -127,6 +128,41 @@ namespace can_interact {
 			  */
 			can_frame frame() const noexcept(false) ;
 
+			/**
+			  * @brief timestamps - enables kernel receive timestamps, reported by the batched frames method
+			  * @throws std::runtime_exception - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void timestamps() const noexcept(false) ;
+
+			/**
+			  * @brief frames (overload) - receives batch of timestamped frames from CAN in a single syscall, blocking until at least one is available
+			  * @param can_interact_timed_frame* - array to write frames to
+			  * @param const std::size_t - capacity of array (at most CAN_INTERACT_MAX_BATCH frames are received per call)
+			  * @return std::size_t - number of frames received
+			  * @throws std::runtime_exception - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::size_t frames(can_interact_timed_frame*, const std::size_t) const noexcept(false) ;
+
+			/**
+			  * @brief frames (overload) - receives batch of timestamped frames from CAN in a single syscall, blocking until at least one is available
+			  * @tparam std::size_t SIZE - length of array
+			  * @param std::array<can_interact_timed_frame, SIZE>& - array to write frames to
+			  * @return std::size_t - number of frames received
+			  * @throws std::runtime_exception - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			template<std::size_t SIZE>
+			std::size_t frames(std::array<can_interact_timed_frame, SIZE>&) const noexcept(false) ;
+
+			/**
+			  * @brief frames (overload) - receives batch of timestamped frames and their source interfaces in a single syscall, blocking until at least one is available
+			  * Meant for connections to all interfaces, i.e. CAN("any")
+			  * @param can_interact_if_frame* - array to write frames to
+			  * @param const std::size_t - capacity of array (at most CAN_INTERACT_MAX_BATCH frames are received per call)
+			  * @return std::size_t - number of frames received
+			  * @throws std::runtime_exception - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::size_t frames(can_interact_if_frame*, const std::size_t) const noexcept(false) ;
+
 			/**
 			  * @brief frame (overload) - sends frame from CAN
 			  * This method expects a LINUX can_frame struct
@@ -138,6 +174,23 @@ namespace can_interact {
 			  */
 			void frame(const can_frame&) const noexcept(false) ;
 
+			/**
+			  * @brief frame (overload) - sends frame on specific interface, for connections to all interfaces (i.e. CAN("any"))
+			  * @param const can_frame& - LINUX CAN frame struct
+			  * @param const int - interface index (see InterfaceCache)
+			  * @throws std::runtime_exception - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void frame(const can_frame&, const int) const noexcept(false) ;
+
+			/**
+			  * @brief frames (overload) - sends batch of frames from CAN in a single syscall
+			  * @param const can_frame* - array of LINUX CAN frame structs
+			  * @param const std::size_t - number of frames (at most CAN_INTERACT_MAX_BATCH frames are sent per call)
+			  * @return std::size_t - number of frames sent, frames after it were not sent (e.g. as the transmit queue is full)
+			  * @throws std::runtime_exception - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::size_t frames(const can_frame*, const std::size_t) const noexcept(false) ;
+
 			/**
 			  * @brief ~CAN (destructor) - frees CAN socket connections
 			  * TODO closing COULD fail but this method has no way of throwing exception
@@ -149,6 +202,36 @@ namespace can_interact {
 			CAN() noexcept = delete ;
 	} ;
 
+	class InterfaceCache {
+		/**
+		  * @brief InterfaceCache (class) - remembers interface names and indices, e.g. to name the source of frames received via CAN("any")
+		  */
+		private:
+			can_interact_if_cache _cache ;
+
+		public:
+			/**
+			  * @brief InterfaceCache (constructor) - creates empty cache
+			  */
+			InterfaceCache() noexcept ;
+
+			/**
+			  * @brief name - looks up name of interface
+			  * @param const int - interface index
+			  * @return std::string - interface name
+			  * @throws std::runtime_exception - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::string name(const int) noexcept(false) ;
+
+			/**
+			  * @brief index - looks up index of interface
+			  * @param const std::string& - interface name
+			  * @return int - interface index
+			  * @throws std::runtime_exception - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			int index(const std::string&) noexcept(false) ;
+	} ;
+
 	// delete general cases, we only want 3 cases: long unsigned, long int, double, implemented below
 	template<typename T>
 	T decode(const can_frame&, const can_interact_endianness) noexcept(false) = delete ;
@@ -354,6 +437,43 @@ can_frame can_interact::CAN::frame() const noexcept(false)
 	return frame ;
 }
 
+void can_interact::CAN::timestamps() const noexcept(false)
+{
+	const int res = can_interact_timestamps(&this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+std::size_t can_interact::CAN::frames(can_interact_timed_frame* frames, const std::size_t len) const noexcept(false)
+{
+	std::size_t received ;
+	const int res = can_interact_get_frames(frames, len, &received, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return received ;
+}
+
+template<std::size_t SIZE>
+std::size_t can_interact::CAN::frames(std::array<can_interact_timed_frame, SIZE>& frames) const noexcept(false)
+{
+	return this->frames(frames.data(), frames.size()) ;
+}
+
+std::size_t can_interact::CAN::frames(can_interact_if_frame* frames, const std::size_t len) const noexcept(false)
+{
+	std::size_t received ;
+	const int res = can_interact_get_if_frames(frames, len, &received, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return received ;
+}
+
 void can_interact::CAN::frame(const can_frame& frame) const noexcept(false)
 {
 	const int res = can_interact_send_frame(&frame, &this->_socket) ;
@@ -363,6 +483,26 @@ void can_interact::CAN::frame(const can_frame& frame) const noexcept(false)
 	}
 }
 
+void can_interact::CAN::frame(const can_frame& frame, const int ifindex) const noexcept(false)
+{
+	const int res = can_interact_send_if_frame(&frame, ifindex, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+std::size_t can_interact::CAN::frames(const can_frame* frames, const std::size_t len) const noexcept(false)
+{
+	std::size_t sent ;
+	const int res = can_interact_send_frames(frames, len, &sent, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return sent ;
+}
+
 can_interact::CAN::~CAN() noexcept
 {
 	errno = 0 ; // TODO find better way to report (and not report) potential errors
@@ -372,6 +512,33 @@ can_interact::CAN::~CAN() noexcept
 	}
 }
 
+can_interact::InterfaceCache::InterfaceCache() noexcept
+{
+	std::memset(&this->_cache, 0, sizeof(this->_cache)) ;
+}
+
+std::string can_interact::InterfaceCache::name(const int ifindex) noexcept(false)
+{
+	const char* name ;
+	const int res = can_interact_if_name(&this->_cache, ifindex, &name) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return std::string{name} ;
+}
+
+int can_interact::InterfaceCache::index(const std::string& name) noexcept(false)
+{
+	int ifindex ;
+	const int res = can_interact_if_index(&this->_cache, name.c_str(), &ifindex) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return ifindex ;
+}
+
 template<>
 std::uint64_t can_interact::decode<std::uint64_t>(const can_frame& frame, const can_interact_endianness byte_order) noexcept(false)
 {
@@ -414,7 +581,7 @@ double can_interact::decode<double>(const can_frame& frame, const can_interact_e
 	return val ;
 }
 
-template<typename F, typename std::enable_if<std::is_floating_point<F>::value, bool>::type = true>
+template<typename F, typename std::enable_if<std::is_floating_point<F>::value, bool>::type>
 can_frame can_interact::encode(const canid_t id, const F val, const can_interact_endianness endianness) noexcept(false)
 {
 	can_frame frame ;
@@ -427,7 +594,7 @@ can_frame can_interact::encode(const canid_t id, const F val, const can_interact
 	return frame ;
 }
 
-template<typename S, typename std::enable_if<std::is_integral<S>::value && std::is_signed<S>::value, bool>::type = true>
+template<typename S, typename std::enable_if<std::is_integral<S>::value && std::is_signed<S>::value, bool>::type>
 can_frame can_interact::encode(const canid_t id, const S val, const can_interact_endianness endianness) noexcept(false)
 {
 	can_frame frame ;
@@ -440,7 +607,7 @@ can_frame can_interact::encode(const canid_t id, const S val, const can_interact
 	return frame ;
 }
 
-template<typename U, typename std::enable_if<std::is_integral<U>::value && !std::is_signed<U>::value, bool>::type = true>
+template<typename U, typename std::enable_if<std::is_integral<U>::value && !std::is_signed<U>::value, bool>::type>
 can_frame can_interact::encode(const canid_t id, const U val, const can_interact_endianness endianness) noexcept(false)
 {
 	can_frame frame ;
@@ -0,0 +1,877 @@
+#ifndef CAN_INTERACT_ASYNC_HH
+#define CAN_INTERACT_ASYNC_HH
+#pragma once
+
+#if __cplusplus < 202002L
+#error "can_interact_async.hh requires C++20 (coroutines), can_interact.hh itself stays usable with C++11"
+#endif
+
+#include <coroutine>
+#include <optional>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <exception>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include "can_interact.hh"
+
+/**
+ * @brief CXX API (C++20) of awaitable receive / send operations on CAN connections, driven by a bundled epoll executor
+ * A Task coroutine is spawned on an Executor and awaits operations of an AsyncCAN, e.g. `can_frame frame = co_await can.frame() ;`.
+ * Every operation first tries its non-blocking system call and only suspends if the socket is not ready, then the executor resumes it
+ * once epoll reports readiness (or its timeout expires). Operations keep their frames and message headers inside the awaiter, which lives
+ * in the coroutine frame, so no operation allocates: the only allocation is the coroutine frame of each Task
+ * Sockets stay in blocking mode (operations pass MSG_DONTWAIT), so the same CAN object remains usable with the blocking API
+ * All coroutines of an executor run on the thread calling Executor::run
+ */
+
+namespace can_interact {
+
+	class Executor ;
+	class AsyncCAN ;
+
+	class Task {
+		/**
+		  * @brief Task (class) - fire-and-forget coroutine, started by Executor::spawn and destroyed when it finishes
+		  */
+		public:
+			struct promise_type {
+				/**
+				  * @brief promise_type - coroutine promise of Task, forwards escaping exceptions to Executor::run
+				  */
+				Executor* executor = nullptr ;
+
+				Task get_return_object() noexcept ;
+				std::suspend_always initial_suspend() noexcept ;
+				std::suspend_never final_suspend() noexcept ;
+				void return_void() noexcept ;
+				void unhandled_exception() noexcept ;
+			} ;
+
+		private:
+			std::coroutine_handle<promise_type> _handle ;
+
+			friend class Executor ;
+
+			/**
+			  * @brief Task (constructor) - INTERNAL METHOD. takes not yet started coroutine
+			  * @param std::coroutine_handle<promise_type> - coroutine
+			  */
+			explicit Task(std::coroutine_handle<promise_type>) noexcept ;
+
+		public:
+			Task(Task&&) noexcept ;
+			Task& operator=(Task&&) noexcept ;
+
+			/**
+			  * @brief ~Task (destructor) - destroys coroutine if it was never spawned
+			  */
+			~Task() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			Task(const Task&) = delete ;
+			Task& operator=(const Task&) = delete ;
+	} ;
+
+	class Executor {
+		/**
+		  * @brief Executor (class) - epoll and timer loop resuming coroutines waiting on AsyncCAN operations or sleeps
+		  */
+		public:
+			struct waiter_t {
+				/**
+				  * @brief waiter_t - INTERNAL. suspended operation, embedded in its awaiter (and thus in the coroutine frame)
+				  */
+				std::coroutine_handle<> handle ;
+				bool (*attempt)(waiter_t*) ; // retries operation, true once it completed (or failed), nullptr for sleeps
+				void* context ; // awaiter owning the waiter
+				int error ;
+				bool timed_out ;
+			} ;
+
+		private:
+			struct _slot {
+				/**
+				  * @brief _slot - INTERNAL. registered connection and its waiting reader and writer
+				  */
+				AsyncCAN* can ; // nullptr once unregistered
+				waiter_t* reader ;
+				waiter_t* writer ;
+				std::uint64_t reader_generation ;
+				std::uint64_t writer_generation ;
+			} ;
+
+			struct _timer {
+				/**
+				  * @brief _timer - INTERNAL. deadline of a sleep or of an operation's timeout
+				  */
+				std::uint64_t deadline_ns ;
+				std::size_t slot ; // SIZE_MAX for sleeps
+				bool write ;
+				std::uint64_t generation ; // of the waiting operation, stale timers are skipped
+				waiter_t* sleeper ;
+				bool retry ; // retries the operation instead of timing it out
+
+				bool operator>(const _timer& other) const noexcept { return this->deadline_ns > other.deadline_ns ; }
+			} ;
+
+			int _epoll ;
+			std::vector<_slot> _slots ;
+			std::vector<_timer> _timers ; // min heap on deadline
+			std::size_t _tasks ; // spawned and not yet finished
+			std::exception_ptr _error ;
+			bool _stopped ;
+
+			friend class AsyncCAN ;
+			friend struct Task::promise_type ;
+
+			/**
+			  * @brief _register - INTERNAL METHOD. adds connection to epoll set
+			  * @param AsyncCAN* - connection
+			  * @param const int - socket
+			  * @return std::size_t - slot
+			  * @throws std::runtime_error - on errors reported by errno
+			  */
+			std::size_t _register(AsyncCAN*, const int) noexcept(false) ;
+
+			/**
+			  * @brief _unregister - INTERNAL METHOD. removes connection from epoll set
+			  * @param const std::size_t - slot
+			  * @param const int - socket
+			  */
+			void _unregister(const std::size_t, const int) noexcept ;
+
+			/**
+			  * @brief _wait - INTERNAL METHOD. parks operation of a connection, with optional timeout
+			  * @param const std::size_t - slot
+			  * @param const bool - write (else read) operation
+			  * @param waiter_t* - operation
+			  * @param const std::int64_t - timeout in nanoseconds, negative for none
+			  * @throws std::logic_error - if another coroutine already waits for the same direction of the connection
+			  */
+			void _wait(const std::size_t, const bool, waiter_t*, const std::int64_t) noexcept(false) ;
+
+			/**
+			  * @brief _retry - INTERNAL METHOD. retries operation of a connection after a delay, for failures without a readiness edge
+			  * @param const std::size_t - slot
+			  * @param const bool - write (else read) operation
+			  * @param const std::int64_t - delay in nanoseconds
+			  */
+			void _retry(const std::size_t, const bool, const std::int64_t) ;
+
+			/**
+			  * @brief _ready - INTERNAL METHOD. retries parked operation after epoll reported readiness, resuming it once complete
+			  * @param const std::size_t - slot
+			  * @param const bool - write (else read) direction
+			  */
+			void _ready(const std::size_t, const bool) ;
+
+			/**
+			  * @brief _expire - INTERNAL METHOD. resumes operations and sleeps whose deadline passed
+			  * @return int - milliseconds until next deadline, -1 if none
+			  */
+			int _expire() ;
+
+			/**
+			  * @brief _now - INTERNAL METHOD. current time
+			  * @return std::uint64_t - CLOCK_MONOTONIC nanoseconds
+			  */
+			static std::uint64_t _now() noexcept ;
+
+		public:
+			class sleep_t {
+				/**
+				  * @brief sleep_t - awaitable returned by sleep
+				  */
+				private:
+					Executor& _executor ;
+					std::int64_t _ns ;
+					waiter_t _waiter ;
+
+				public:
+					sleep_t(Executor&, const std::int64_t) noexcept ;
+					bool await_ready() const noexcept ;
+					void await_suspend(std::coroutine_handle<>) ;
+					void await_resume() const noexcept ;
+			} ;
+
+			/**
+			  * @brief Executor (constructor) - creates epoll instance
+			  * @throws std::runtime_error - on errors reported by errno
+			  */
+			Executor() noexcept(false) ;
+
+			/**
+			  * @brief spawn - starts coroutine, running it until its first suspension
+			  * @param Task - coroutine
+			  */
+			void spawn(Task) ;
+
+			/**
+			  * @brief run - resumes coroutines as their operations complete, until all spawned tasks finished or stop was called
+			  * @throws std::runtime_error - on errors reported by errno
+			  * @throws - exceptions escaping a task
+			  */
+			void run() noexcept(false) ;
+
+			/**
+			  * @brief stop - makes run return after the current iteration (callable from within tasks)
+			  */
+			void stop() noexcept ;
+
+			/**
+			  * @brief sleep - awaitable suspending the coroutine for some time
+			  * @param const std::chrono::nanoseconds - duration
+			  * @return sleep_t - awaitable
+			  */
+			sleep_t sleep(const std::chrono::nanoseconds) noexcept ;
+
+			/**
+			  * @brief tasks - number of spawned tasks not finished yet
+			  * @return std::size_t - count
+			  */
+			std::size_t tasks() const noexcept ;
+
+			/**
+			  * @brief ~Executor (destructor) - closes epoll instance (suspended tasks are leaked, finish them before)
+			  */
+			~Executor() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			Executor(const Executor&) = delete ;
+			Executor(Executor&&) = delete ;
+			Executor& operator=(const Executor&) = delete ;
+			Executor& operator=(Executor&&) = delete ;
+	} ;
+
+	class AsyncCAN {
+		/**
+		  * @brief AsyncCAN (class) - awaitable operations on a CAN connection, registered with an executor
+		  */
+		private:
+			Executor& _executor ;
+			const CAN& _can ;
+			std::size_t _slot ;
+
+		public:
+			class frame_t {
+				/**
+				  * @brief frame_t - awaitable returned by frame (without timeout), resumes with the received frame
+				  */
+				protected:
+					AsyncCAN& _owner ;
+					std::int64_t _timeout_ns ;
+					Executor::waiter_t _waiter ;
+					can_frame _frame ;
+
+					static bool _attempt(Executor::waiter_t*) ;
+
+				public:
+					frame_t(AsyncCAN&, const std::int64_t) noexcept ;
+					bool await_ready() ;
+					void await_suspend(std::coroutine_handle<>) ;
+					can_frame await_resume() const noexcept(false) ;
+			} ;
+
+			class timed_frame_t : public frame_t {
+				/**
+				  * @brief timed_frame_t - awaitable returned by frame (with timeout), resumes with the frame or nothing on timeout
+				  */
+				public:
+					using frame_t::frame_t ;
+					std::optional<can_frame> await_resume() const noexcept(false) ;
+			} ;
+
+			class frames_t {
+				/**
+				  * @brief frames_t - awaitable returned by frames, resumes with the number of frames received (0 on timeout)
+				  */
+				private:
+					AsyncCAN& _owner ;
+					std::int64_t _timeout_ns ;
+					Executor::waiter_t _waiter ;
+					can_interact_timed_frame* _frames ;
+					std::size_t _len ;
+					std::size_t _received ;
+					mmsghdr _msgs[CAN_INTERACT_MAX_BATCH] ;
+					iovec _iovs[CAN_INTERACT_MAX_BATCH] ;
+					std::uint64_t _control[CAN_INTERACT_MAX_BATCH][CMSG_SPACE(sizeof(timespec)) / sizeof(std::uint64_t) + 1] ; // aligned cmsg buffers
+
+					static bool _attempt(Executor::waiter_t*) ;
+
+				public:
+					frames_t(AsyncCAN&, can_interact_timed_frame*, const std::size_t, const std::int64_t) noexcept ;
+					bool await_ready() ;
+					void await_suspend(std::coroutine_handle<>) ;
+					std::size_t await_resume() const noexcept(false) ;
+			} ;
+
+			class send_t {
+				/**
+				  * @brief send_t - awaitable returned by send, resumes once all frames were handed to the kernel
+				  */
+				private:
+					AsyncCAN& _owner ;
+					Executor::waiter_t _waiter ;
+					const can_frame* _frames ;
+					std::size_t _len ;
+					std::size_t _sent ;
+
+					static constexpr std::int64_t _backoff_ns = 1000000 ; // retry interval while the device queue is full, about one frame at 125 kbit/s
+
+					static bool _attempt(Executor::waiter_t*) ;
+
+				public:
+					send_t(AsyncCAN&, const can_frame*, const std::size_t) noexcept ;
+					bool await_ready() ;
+					void await_suspend(std::coroutine_handle<>) ;
+					std::size_t await_resume() const noexcept(false) ;
+			} ;
+
+			/**
+			  * @brief AsyncCAN (constructor) - registers connection with executor
+			  * @param Executor& - executor (must outlive this object)
+			  * @param const CAN& - connection (must outlive this object)
+			  * @throws std::runtime_error - on errors reported by errno
+			  */
+			AsyncCAN(Executor&, const CAN&) noexcept(false) ;
+
+			/**
+			  * @brief frame (overload) - awaitable receive of one frame
+			  * @return frame_t - resumes with can_frame
+			  */
+			frame_t frame() noexcept ;
+
+			/**
+			  * @brief frame (overload) - awaitable receive of one frame with timeout
+			  * @param const std::chrono::nanoseconds - timeout
+			  * @return timed_frame_t - resumes with std::optional<can_frame>, empty on timeout
+			  */
+			timed_frame_t frame(const std::chrono::nanoseconds) noexcept ;
+
+			/**
+			  * @brief frames - awaitable receive of all queued frames (at least one, at most CAN_INTERACT_MAX_BATCH) with receive timestamps if enabled
+			  * @param can_interact_timed_frame* - array to write to (must stay valid until resumed)
+			  * @param const std::size_t - capacity of array
+			  * @param const std::chrono::nanoseconds - timeout, negative for none
+			  * @return frames_t - resumes with number of frames, 0 on timeout
+			  */
+			frames_t frames(can_interact_timed_frame*, const std::size_t, const std::chrono::nanoseconds = std::chrono::nanoseconds{-1}) noexcept ;
+
+			/**
+			  * @brief send (overload) - awaitable send of one frame
+			  * @param const can_frame& - frame (must stay valid until resumed)
+			  * @return send_t - resumes with 1
+			  */
+			send_t send(const can_frame&) noexcept ;
+
+			/**
+			  * @brief send (overload) - awaitable send of many frames, batched into sendmmsg calls
+			  * @param const can_frame* - frames (must stay valid until resumed)
+			  * @param const std::size_t - number of frames
+			  * @return send_t - resumes with number of frames sent
+			  */
+			send_t send(const can_frame*, const std::size_t) noexcept ;
+
+			/**
+			  * @brief ~AsyncCAN (destructor) - unregisters connection (no operation may be waiting)
+			  */
+			~AsyncCAN() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			AsyncCAN(const AsyncCAN&) = delete ;
+			AsyncCAN(AsyncCAN&&) = delete ;
+			AsyncCAN& operator=(const AsyncCAN&) = delete ;
+			AsyncCAN& operator=(AsyncCAN&&) = delete ;
+			AsyncCAN() = delete ;
+	} ;
+
+}
+
+can_interact::Task can_interact::Task::promise_type::get_return_object() noexcept
+{
+	return Task{std::coroutine_handle<promise_type>::from_promise(*this)} ;
+}
+
+std::suspend_always can_interact::Task::promise_type::initial_suspend() noexcept
+{
+	return {} ;
+}
+
+std::suspend_never can_interact::Task::promise_type::final_suspend() noexcept
+{
+	if(this->executor != nullptr)
+	{
+		--this->executor->_tasks ;
+	}
+	return {} ;
+}
+
+void can_interact::Task::promise_type::return_void() noexcept {}
+
+void can_interact::Task::promise_type::unhandled_exception() noexcept
+{
+	if(this->executor != nullptr && !this->executor->_error)
+	{
+		this->executor->_error = std::current_exception() ;
+	}
+}
+
+can_interact::Task::Task(std::coroutine_handle<promise_type> handle) noexcept : _handle{handle} {}
+
+can_interact::Task::Task(Task&& task) noexcept : _handle{task._handle}
+{
+	task._handle = nullptr ;
+}
+
+can_interact::Task& can_interact::Task::operator=(Task&& task) noexcept
+{
+	if(this->_handle)
+	{
+		this->_handle.destroy() ;
+	}
+	this->_handle = task._handle ;
+	task._handle = nullptr ;
+	return *this ;
+}
+
+can_interact::Task::~Task() noexcept
+{
+	if(this->_handle)
+	{
+		this->_handle.destroy() ;
+	}
+}
+
+can_interact::Executor::Executor() noexcept(false) : _epoll{epoll_create1(EPOLL_CLOEXEC)}, _slots{}, _timers{}, _tasks{0}, _error{}, _stopped{false}
+{
+	if(this->_epoll == -1)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(errno)) ;
+	}
+}
+
+std::uint64_t can_interact::Executor::_now() noexcept
+{
+	timespec now ;
+	clock_gettime(CLOCK_MONOTONIC, &now) ;
+	return static_cast<std::uint64_t>(now.tv_sec) * 1000000000u + static_cast<std::uint64_t>(now.tv_nsec) ;
+}
+
+std::size_t can_interact::Executor::_register(AsyncCAN* can, const int socket) noexcept(false)
+{
+	std::size_t slot = 0 ;
+	while(slot < this->_slots.size() && this->_slots[slot].can != nullptr)
+	{
+		++slot ;
+	}
+	if(slot == this->_slots.size())
+	{
+		this->_slots.push_back(_slot{nullptr, nullptr, nullptr, 0, 0}) ;
+	}
+	// edge triggered: every arriving frame (and every freed send buffer) is an edge, operations always try their call before waiting
+	epoll_event event{} ;
+	event.events = EPOLLIN | EPOLLOUT | EPOLLET ;
+	event.data.u64 = slot ;
+	if(epoll_ctl(this->_epoll, EPOLL_CTL_ADD, socket, &event) == -1)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(errno)) ;
+	}
+	this->_slots[slot].can = can ;
+	return slot ;
+}
+
+void can_interact::Executor::_unregister(const std::size_t slot, const int socket) noexcept
+{
+	epoll_ctl(this->_epoll, EPOLL_CTL_DEL, socket, nullptr) ;
+	_slot& entry = this->_slots[slot] ;
+	entry.can = nullptr ;
+	entry.reader = nullptr ;
+	entry.writer = nullptr ;
+	++entry.reader_generation ; // invalidates pending timers
+	++entry.writer_generation ;
+}
+
+void can_interact::Executor::_wait(const std::size_t slot, const bool write, waiter_t* waiter, const std::int64_t timeout_ns) noexcept(false)
+{
+	_slot& entry = this->_slots[slot] ;
+	waiter_t*& parked = write ? entry.writer : entry.reader ;
+	if(parked != nullptr)
+	{
+		throw std::logic_error(write ? "Another coroutine is already sending on this connection" : "Another coroutine is already receiving on this connection") ;
+	}
+	parked = waiter ;
+	if(timeout_ns >= 0)
+	{
+		this->_timers.push_back(_timer{Executor::_now() + static_cast<std::uint64_t>(timeout_ns), slot, write, write ? entry.writer_generation : entry.reader_generation, nullptr, false}) ;
+		std::push_heap(this->_timers.begin(), this->_timers.end(), std::greater<_timer>{}) ;
+	}
+}
+
+void can_interact::Executor::_retry(const std::size_t slot, const bool write, const std::int64_t delay_ns)
+{
+	_slot& entry = this->_slots[slot] ;
+	this->_timers.push_back(_timer{Executor::_now() + static_cast<std::uint64_t>(delay_ns), slot, write, write ? entry.writer_generation : entry.reader_generation, nullptr, true}) ;
+	std::push_heap(this->_timers.begin(), this->_timers.end(), std::greater<_timer>{}) ;
+}
+
+void can_interact::Executor::_ready(const std::size_t slot, const bool write)
+{
+	_slot& entry = this->_slots[slot] ;
+	waiter_t*& parked = write ? entry.writer : entry.reader ;
+	waiter_t* waiter = parked ;
+	if(waiter == nullptr || !waiter->attempt(waiter))
+	{
+		return ;
+	}
+	parked = nullptr ;
+	++(write ? entry.writer_generation : entry.reader_generation) ;
+	waiter->handle.resume() ;
+}
+
+int can_interact::Executor::_expire()
+{
+	while(!this->_timers.empty())
+	{
+		const _timer timer = this->_timers.front() ;
+		const std::uint64_t now = Executor::_now() ;
+		if(timer.deadline_ns > now)
+		{
+			return static_cast<int>(std::min<std::uint64_t>((timer.deadline_ns - now + 999999u) / 1000000u, 60000u)) ;
+		}
+		std::pop_heap(this->_timers.begin(), this->_timers.end(), std::greater<_timer>{}) ;
+		this->_timers.pop_back() ;
+		if(timer.sleeper != nullptr)
+		{
+			timer.sleeper->handle.resume() ;
+			continue ;
+		}
+		_slot& entry = this->_slots[timer.slot] ;
+		waiter_t*& parked = timer.write ? entry.writer : entry.reader ;
+		std::uint64_t& generation = timer.write ? entry.writer_generation : entry.reader_generation ;
+		if(parked == nullptr || generation != timer.generation)
+		{
+			continue ; // operation completed before its timeout
+		}
+		if(timer.retry)
+		{
+			this->_ready(timer.slot, timer.write) ;
+			continue ;
+		}
+		waiter_t* waiter = parked ;
+		parked = nullptr ;
+		++generation ;
+		waiter->timed_out = true ;
+		waiter->handle.resume() ;
+	}
+	return -1 ;
+}
+
+void can_interact::Executor::spawn(Task task)
+{
+	std::coroutine_handle<Task::promise_type> handle = task._handle ;
+	task._handle = nullptr ;
+	handle.promise().executor = this ;
+	++this->_tasks ;
+	handle.resume() ;
+}
+
+void can_interact::Executor::run() noexcept(false)
+{
+	epoll_event events[64] ;
+	this->_stopped = false ;
+	while(!this->_stopped && this->_tasks > 0 && !this->_error)
+	{
+		const int timeout_ms = this->_expire() ;
+		if(this->_stopped || this->_tasks == 0 || this->_error)
+		{
+			break ;
+		}
+		const int ready = epoll_wait(this->_epoll, events, 64, timeout_ms) ;
+		if(ready < 0 && errno != EINTR)
+		{
+			throw std::runtime_error(std::string{"Errno "} + std::to_string(errno)) ;
+		}
+		for(int i = 0 ; i < ready ; ++i)
+		{
+			const std::size_t slot = static_cast<std::size_t>(events[i].data.u64) ;
+			if(events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))
+			{
+				this->_ready(slot, false) ;
+			}
+			if(events[i].events & (EPOLLOUT | EPOLLERR | EPOLLHUP))
+			{
+				this->_ready(slot, true) ;
+			}
+		}
+	}
+	if(this->_error)
+	{
+		std::exception_ptr error = this->_error ;
+		this->_error = nullptr ;
+		std::rethrow_exception(error) ;
+	}
+}
+
+void can_interact::Executor::stop() noexcept
+{
+	this->_stopped = true ;
+}
+
+std::size_t can_interact::Executor::tasks() const noexcept
+{
+	return this->_tasks ;
+}
+
+can_interact::Executor::sleep_t can_interact::Executor::sleep(const std::chrono::nanoseconds duration) noexcept
+{
+	return sleep_t{*this, duration.count()} ;
+}
+
+can_interact::Executor::sleep_t::sleep_t(Executor& executor, const std::int64_t ns) noexcept : _executor(executor), _ns{ns}, _waiter{nullptr, nullptr, nullptr, 0, false} {}
+
+bool can_interact::Executor::sleep_t::await_ready() const noexcept
+{
+	return this->_ns <= 0 ;
+}
+
+void can_interact::Executor::sleep_t::await_suspend(std::coroutine_handle<> handle)
+{
+	this->_waiter.handle = handle ;
+	this->_executor._timers.push_back(_timer{Executor::_now() + static_cast<std::uint64_t>(this->_ns), SIZE_MAX, false, 0, &this->_waiter, false}) ;
+	std::push_heap(this->_executor._timers.begin(), this->_executor._timers.end(), std::greater<_timer>{}) ;
+}
+
+void can_interact::Executor::sleep_t::await_resume() const noexcept {}
+
+can_interact::Executor::~Executor() noexcept
+{
+	close(this->_epoll) ;
+}
+
+can_interact::AsyncCAN::AsyncCAN(Executor& executor, const CAN& can) noexcept(false) : _executor(executor), _can(can), _slot{0}
+{
+	this->_slot = executor._register(this, can.socket()) ;
+}
+
+can_interact::AsyncCAN::frame_t can_interact::AsyncCAN::frame() noexcept
+{
+	return frame_t{*this, -1} ;
+}
+
+can_interact::AsyncCAN::timed_frame_t can_interact::AsyncCAN::frame(const std::chrono::nanoseconds timeout) noexcept
+{
+	return timed_frame_t{*this, std::max<std::int64_t>(timeout.count(), 0)} ;
+}
+
+can_interact::AsyncCAN::frames_t can_interact::AsyncCAN::frames(can_interact_timed_frame* frames, const std::size_t len, const std::chrono::nanoseconds timeout) noexcept
+{
+	return frames_t{*this, frames, len, timeout.count()} ;
+}
+
+can_interact::AsyncCAN::send_t can_interact::AsyncCAN::send(const can_frame& frame) noexcept
+{
+	return send_t{*this, &frame, 1} ;
+}
+
+can_interact::AsyncCAN::send_t can_interact::AsyncCAN::send(const can_frame* frames, const std::size_t len) noexcept
+{
+	return send_t{*this, frames, len} ;
+}
+
+can_interact::AsyncCAN::~AsyncCAN() noexcept
+{
+	this->_executor._unregister(this->_slot, this->_can.socket()) ;
+}
+
+can_interact::AsyncCAN::frame_t::frame_t(AsyncCAN& owner, const std::int64_t timeout_ns) noexcept
+	: _owner(owner), _timeout_ns{timeout_ns}, _waiter{nullptr, &frame_t::_attempt, nullptr, 0, false}, _frame{}
+{
+}
+
+bool can_interact::AsyncCAN::frame_t::_attempt(Executor::waiter_t* waiter)
+{
+	frame_t* self = static_cast<frame_t*>(waiter->context) ;
+	const ssize_t res = recv(self->_owner._can.socket(), &self->_frame, sizeof(can_frame), MSG_DONTWAIT) ;
+	if(res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+	{
+		return false ;
+	}
+	waiter->error = res < 0 ? errno : (res == static_cast<ssize_t>(sizeof(can_frame)) ? 0 : EIO) ;
+	return true ;
+}
+
+bool can_interact::AsyncCAN::frame_t::await_ready()
+{
+	this->_waiter.context = this ; // the awaiter has reached its final place in the coroutine frame
+	return frame_t::_attempt(&this->_waiter) ;
+}
+
+void can_interact::AsyncCAN::frame_t::await_suspend(std::coroutine_handle<> handle)
+{
+	this->_waiter.handle = handle ;
+	this->_owner._executor._wait(this->_owner._slot, false, &this->_waiter, this->_timeout_ns) ;
+}
+
+can_frame can_interact::AsyncCAN::frame_t::await_resume() const noexcept(false)
+{
+	if(this->_waiter.error != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(this->_waiter.error)) ;
+	}
+	return this->_frame ;
+}
+
+std::optional<can_frame> can_interact::AsyncCAN::timed_frame_t::await_resume() const noexcept(false)
+{
+	if(this->_waiter.timed_out)
+	{
+		return std::nullopt ;
+	}
+	return frame_t::await_resume() ;
+}
+
+can_interact::AsyncCAN::frames_t::frames_t(AsyncCAN& owner, can_interact_timed_frame* frames, const std::size_t len, const std::int64_t timeout_ns) noexcept
+	: _owner(owner), _timeout_ns{timeout_ns}, _waiter{nullptr, &frames_t::_attempt, nullptr, 0, false}, _frames{frames},
+	_len{std::min<std::size_t>(len, CAN_INTERACT_MAX_BATCH)}, _received{0}
+{
+}
+
+bool can_interact::AsyncCAN::frames_t::_attempt(Executor::waiter_t* waiter)
+{
+	frames_t* self = static_cast<frames_t*>(waiter->context) ;
+	std::memset(self->_msgs, 0, sizeof(mmsghdr) * self->_len) ;
+	for(std::size_t i = 0 ; i < self->_len ; ++i)
+	{
+		self->_iovs[i].iov_base = &self->_frames[i].frame ;
+		self->_iovs[i].iov_len = sizeof(can_frame) ;
+		self->_msgs[i].msg_hdr.msg_iov = &self->_iovs[i] ;
+		self->_msgs[i].msg_hdr.msg_iovlen = 1 ;
+		self->_msgs[i].msg_hdr.msg_control = self->_control[i] ;
+		self->_msgs[i].msg_hdr.msg_controllen = sizeof(self->_control[i]) ;
+	}
+	const int res = recvmmsg(self->_owner._can.socket(), self->_msgs, static_cast<unsigned int>(self->_len), MSG_DONTWAIT, nullptr) ;
+	if(res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+	{
+		return false ;
+	}
+	waiter->error = res < 0 ? errno : 0 ;
+	for(int i = 0 ; i < res ; ++i)
+	{
+		can_interact_timed_frame& frame = self->_frames[i] ;
+		frame.timestamp_ns = 0 ;
+		for(cmsghdr* cmsg = CMSG_FIRSTHDR(&self->_msgs[i].msg_hdr) ; cmsg != nullptr ; cmsg = CMSG_NXTHDR(&self->_msgs[i].msg_hdr, cmsg))
+		{
+			if(cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SO_TIMESTAMPNS)
+			{
+				timespec ts ;
+				std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts)) ;
+				frame.timestamp_ns = static_cast<std::uint64_t>(ts.tv_sec) * 1000000000u + static_cast<std::uint64_t>(ts.tv_nsec) ;
+			}
+		}
+	}
+	self->_received = res > 0 ? static_cast<std::size_t>(res) : 0 ;
+	return true ;
+}
+
+bool can_interact::AsyncCAN::frames_t::await_ready()
+{
+	this->_waiter.context = this ;
+	return this->_len == 0 || frames_t::_attempt(&this->_waiter) ;
+}
+
+void can_interact::AsyncCAN::frames_t::await_suspend(std::coroutine_handle<> handle)
+{
+	this->_waiter.handle = handle ;
+	this->_owner._executor._wait(this->_owner._slot, false, &this->_waiter, this->_timeout_ns) ;
+}
+
+std::size_t can_interact::AsyncCAN::frames_t::await_resume() const noexcept(false)
+{
+	if(this->_waiter.error != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(this->_waiter.error)) ;
+	}
+	return this->_received ;
+}
+
+can_interact::AsyncCAN::send_t::send_t(AsyncCAN& owner, const can_frame* frames, const std::size_t len) noexcept
+	: _owner(owner), _waiter{nullptr, &send_t::_attempt, nullptr, 0, false}, _frames{frames}, _len{len}, _sent{0}
+{
+}
+
+bool can_interact::AsyncCAN::send_t::_attempt(Executor::waiter_t* waiter)
+{
+	send_t* self = static_cast<send_t*>(waiter->context) ;
+	mmsghdr msgs[CAN_INTERACT_MAX_BATCH] ;
+	iovec iovs[CAN_INTERACT_MAX_BATCH] ;
+
+	while(self->_sent < self->_len)
+	{
+		const std::size_t n = std::min<std::size_t>(self->_len - self->_sent, CAN_INTERACT_MAX_BATCH) ;
+		std::memset(msgs, 0, sizeof(mmsghdr) * n) ;
+		for(std::size_t i = 0 ; i < n ; ++i)
+		{
+			iovs[i].iov_base = const_cast<can_frame*>(&self->_frames[self->_sent + i]) ;
+			iovs[i].iov_len = sizeof(can_frame) ;
+			msgs[i].msg_hdr.msg_iov = &iovs[i] ;
+			msgs[i].msg_hdr.msg_iovlen = 1 ;
+		}
+		const int res = sendmmsg(self->_owner._can.socket(), msgs, static_cast<unsigned int>(n), MSG_DONTWAIT) ;
+		if(res < 0)
+		{
+			if(errno == EINTR)
+			{
+				continue ;
+			}
+			if(errno == EAGAIN || errno == EWOULDBLOCK)
+			{
+				return false ; // wait for send buffer space
+			}
+			if(errno == ENOBUFS)
+			{
+				// the device queue is full while the socket buffer is not, so no EPOLLOUT edge may follow: poll on the timer instead
+				self->_owner._executor._retry(self->_owner._slot, true, send_t::_backoff_ns) ;
+				return false ;
+			}
+			waiter->error = errno ;
+			return true ;
+		}
+		self->_sent += static_cast<std::size_t>(res) ;
+	}
+	return true ;
+}
+
+bool can_interact::AsyncCAN::send_t::await_ready()
+{
+	this->_waiter.context = this ;
+	return send_t::_attempt(&this->_waiter) ;
+}
+
+void can_interact::AsyncCAN::send_t::await_suspend(std::coroutine_handle<> handle)
+{
+	this->_waiter.handle = handle ;
+	this->_owner._executor._wait(this->_owner._slot, true, &this->_waiter, -1) ;
+}
+
+std::size_t can_interact::AsyncCAN::send_t::await_resume() const noexcept(false)
+{
+	if(this->_waiter.error != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(this->_waiter.error)) ;
+	}
+	return this->_sent ;
+}
+
+#endif // CAN_INTERACT_ASYNC_HH
@@ -0,0 +1,186 @@
+#define _DEFAULT_SOURCE
+
+#include <unistd.h> /* syscalls */
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <errno.h>
+#include <linux/if.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/ioctl.h>
+#include <linux/can.h>
+#include <linux/can/bcm.h>
+
+#include "can_interact_bcm.h"
+
+/**
+ * @brief C-style definitions of broadcast manager functionality (cyclic transmission, change & timeout detection)
+ * For definitions for the CXX API, see can_interact_bcm.hh
+ */
+
+#define BCM_MSG_MAX_LEN (sizeof(struct bcm_msg_head) + sizeof(struct can_frame) * CAN_INTERACT_BCM_MAX_FRAMES)
+
+/**
+ * @brief _p_can_interact_bcm_write - INTERNAL METHOD. writes message head plus frames to broadcast manager in one syscall
+ * bcm_msg_head ends in a zero length array of frames, so the message is assembled in a suitably aligned buffer
+ * @param const struct bcm_msg_head* - message head (nframes dictates how many frames are appended)
+ * @param const struct can_frame* - frames to append (may be NULL when nframes is 0)
+ * @param const int* - socket descriptor
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_bcm_write(const struct bcm_msg_head *head, const struct can_frame *frames, const int *socket)
+{
+	uint64_t buf[BCM_MSG_MAX_LEN / sizeof(uint64_t) + 1];
+	const size_t len = sizeof(struct bcm_msg_head) + sizeof(struct can_frame) * head->nframes;
+
+	memcpy(buf, head, sizeof(struct bcm_msg_head));
+	if (head->nframes != 0) {
+		memcpy((uint8_t*)buf + sizeof(struct bcm_msg_head), frames, sizeof(struct can_frame) * head->nframes);
+	}
+	return write(*socket, buf, len) == (ssize_t)len ? 0 : (int)errno;
+}
+
+int can_interact_bcm_init(int *s, const char *net_device)
+{
+	struct ifreq ifr; /* used to configure net device */
+	struct sockaddr_can addr; /* assigns address connections */
+
+	*s = socket(PF_CAN, SOCK_DGRAM, CAN_BCM); /* broadcast manager uses datagram sockets */
+	if (*s == -1) {
+		return (int)errno;
+	}
+	memset(&ifr, '\0', sizeof(ifr));
+	strncpy(ifr.ifr_name, net_device, IFNAMSIZ - 1);
+	if (ioctl(*s, SIOCGIFINDEX, &ifr) == -1) {
+		return (int)errno;
+	}
+	memset(&addr, '\0', sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = ifr.ifr_ifindex;
+	if (connect(*s, (struct sockaddr*)&addr, sizeof(addr)) == -1) { /* BCM sockets are connected rather than bound */
+		return (int)errno;
+	}
+
+	return 0;
+}
+
+int can_interact_bcm_tx_setup(const struct can_frame *frames, const uint32_t nframes, const uint32_t interval_us, const int *socket)
+{
+	struct bcm_msg_head head;
+
+	if (nframes == 0 || nframes > CAN_INTERACT_BCM_MAX_FRAMES) {
+		return EINVAL;
+	}
+	memset(&head, 0, sizeof(head));
+	head.opcode = TX_SETUP;
+	head.flags = SETTIMER | STARTTIMER;
+	head.count = 0; /* only use ival2 - repeat forever */
+	head.ival2.tv_sec = (long)(interval_us / 1000000u);
+	head.ival2.tv_usec = (long)(interval_us % 1000000u);
+	head.can_id = frames[0].can_id;
+	head.nframes = nframes;
+	return _p_can_interact_bcm_write(&head, frames, socket);
+}
+
+int can_interact_bcm_tx_update(const struct can_frame *frames, const uint32_t nframes, const int announce, const int *socket)
+{
+	struct bcm_msg_head head;
+
+	if (nframes == 0 || nframes > CAN_INTERACT_BCM_MAX_FRAMES) {
+		return EINVAL;
+	}
+	memset(&head, 0, sizeof(head));
+	head.opcode = TX_SETUP;
+	head.flags = announce ? TX_ANNOUNCE : 0; /* no SETTIMER / STARTTIMER - existing timer keeps running */
+	head.can_id = frames[0].can_id;
+	head.nframes = nframes;
+	return _p_can_interact_bcm_write(&head, frames, socket);
+}
+
+int can_interact_bcm_tx_delete(const canid_t id, const int *socket)
+{
+	struct bcm_msg_head head;
+
+	memset(&head, 0, sizeof(head));
+	head.opcode = TX_DELETE;
+	head.can_id = id;
+	head.nframes = 0;
+	return _p_can_interact_bcm_write(&head, NULL, socket);
+}
+
+int can_interact_bcm_rx_setup(const canid_t id, const uint8_t *mask, const uint32_t timeout_us, const uint32_t throttle_us, const int *socket)
+{
+	struct bcm_msg_head head;
+	struct can_frame filter;
+
+	memset(&head, 0, sizeof(head));
+	memset(&filter, 0, sizeof(filter));
+	head.opcode = RX_SETUP;
+	head.flags = SETTIMER | RX_CHECK_DLC;
+	if (timeout_us != 0) {
+		head.flags |= RX_ANNOUNCE_RESUME; /* report first frame after a timeout even if unchanged */
+	}
+	head.ival1.tv_sec = (long)(timeout_us / 1000000u);
+	head.ival1.tv_usec = (long)(timeout_us % 1000000u);
+	head.ival2.tv_sec = (long)(throttle_us / 1000000u);
+	head.ival2.tv_usec = (long)(throttle_us % 1000000u);
+	head.can_id = id;
+	if (mask == NULL) {
+		head.flags |= RX_FILTER_ID;
+		head.nframes = 0;
+	} else {
+		filter.can_id = id;
+		filter.can_dlc = 8;
+		memcpy(filter.data, mask, 8);
+		head.nframes = 1;
+	}
+	return _p_can_interact_bcm_write(&head, &filter, socket);
+}
+
+int can_interact_bcm_rx_delete(const canid_t id, const int *socket)
+{
+	struct bcm_msg_head head;
+
+	memset(&head, 0, sizeof(head));
+	head.opcode = RX_DELETE;
+	head.can_id = id;
+	head.nframes = 0;
+	return _p_can_interact_bcm_write(&head, NULL, socket);
+}
+
+int can_interact_bcm_get_event(struct can_interact_bcm_event *event, const int *socket)
+{
+	uint64_t buf[(sizeof(struct bcm_msg_head) + sizeof(struct can_frame)) / sizeof(uint64_t) + 1];
+	struct bcm_msg_head head;
+	ssize_t nbytes;
+
+	for (;;) {
+		nbytes = read(*socket, buf, sizeof(buf));
+		if (nbytes < (ssize_t)sizeof(struct bcm_msg_head)) {
+			return nbytes < 0 ? (int)errno : EIO;
+		}
+		memcpy(&head, buf, sizeof(head));
+		if (head.opcode != RX_CHANGED && head.opcode != RX_TIMEOUT) {
+			continue; /* e.g. TX_EXPIRED notifications - not of interest */
+		}
+		event->id = head.can_id;
+		memset(&event->frame, 0, sizeof(event->frame));
+		if (head.opcode == RX_CHANGED) {
+			if (head.nframes == 0 || nbytes < (ssize_t)(sizeof(struct bcm_msg_head) + sizeof(struct can_frame))) {
+				return EIO;
+			}
+			event->type = BCM_EVENT_CHANGED;
+			memcpy(&event->frame, (uint8_t*)buf + sizeof(struct bcm_msg_head), sizeof(struct can_frame));
+		} else {
+			event->type = BCM_EVENT_TIMEOUT;
+		}
+		return 0;
+	}
+}
+
+int can_interact_bcm_fini(const int *socket)
+{
+	return close(*socket) == 0 ? 0 : (int)errno;
+}
@@ -0,0 +1,155 @@
+#ifndef CAN_INTERACT_BCM_H
+#define CAN_INTERACT_BCM_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_interact.h"
+
+#include <linux/can/bcm.h>
+
+/**
+ * @brief C-style functionality to offload cyclic transmission and change / timeout detection of CAN frames to the kernel's broadcast manager (CAN_BCM)
+ * Once set up, the kernel emits frames on schedule and only delivers received frames whose (masked) payload changed - the process only needs to act when data changes
+ * For the CXX API, see can_interact_bcm.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CAN_INTERACT_BCM_MAX_FRAMES 256 /* kernel limit of frames per job (MAX_NFRAMES) */
+
+enum can_interact_bcm_event_type {
+    /**
+     * @brief enum can_interact_bcm_event_type - kind of notification received from broadcast manager
+     */
+    BCM_EVENT_CHANGED = 0, /* masked payload (or DLC) of watched frame changed, or first reception / reception after timeout */
+    BCM_EVENT_TIMEOUT /* watched cyclic frame was not received within its timeout */
+};
+
+struct can_interact_bcm_event {
+	/**
+	 * @brief struct can_interact_bcm_event - notification received from broadcast manager
+	 */
+	enum can_interact_bcm_event_type type;
+	canid_t id; /* can_id of watched frame */
+	struct can_frame frame; /* received frame (BCM_EVENT_CHANGED only, zeroed otherwise) */
+};
+
+/**
+ * @brief can_interact_bcm_init - initialises broadcast manager connection to specific network device
+ *
+ * @param int* - pointer to variable to initialise as socket descriptor
+ *
+ * @param const char* - c-string (null terminated) to CAN device name
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes for other writing errors
+ */
+int can_interact_bcm_init(int *socket, const char *device_name);
+
+/**
+ * @brief can_interact_bcm_tx_setup - creates (or replaces) cyclic transmission of frame(s), sent by the kernel every interval
+ * Multiple frames are sent in turn, one per interval (e.g. for multiplexed messages). The job is identified by the can_id of the first frame
+ *
+ * @param const struct can_frame* - array of frames to transmit
+ *
+ * @param const uint32_t - number of frames (1 - CAN_INTERACT_BCM_MAX_FRAMES)
+ *
+ * @param const uint32_t - cycle time in microseconds
+ *
+ * @param const int* - pointer to broadcast manager socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if number of frames is invalid, for other non-zero values refer to errno codes
+ */
+int can_interact_bcm_tx_setup(const struct can_frame *frames, const uint32_t nframes, const uint32_t interval_us, const int *socket);
+
+/**
+ * @brief can_interact_bcm_tx_update - replaces payload of existing cyclic transmission without disturbing its timer
+ *
+ * @param const struct can_frame* - array of frames (first can_id identifies job)
+ *
+ * @param const uint32_t - number of frames (1 - CAN_INTERACT_BCM_MAX_FRAMES)
+ *
+ * @param const int - non-zero to additionally send the new (first) frame immediately rather than at the next cycle
+ *
+ * @param const int* - pointer to broadcast manager socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if number of frames is invalid, for other non-zero values refer to errno codes
+ */
+int can_interact_bcm_tx_update(const struct can_frame *frames, const uint32_t nframes, const int announce, const int *socket);
+
+/**
+ * @brief can_interact_bcm_tx_delete - cancels cyclic transmission
+ *
+ * @param const canid_t - can_id identifying job
+ *
+ * @param const int* - pointer to broadcast manager socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes (ENOENT / EINVAL if no such job exists)
+ */
+int can_interact_bcm_tx_delete(const canid_t id, const int *socket);
+
+/**
+ * @brief can_interact_bcm_rx_setup - creates (or replaces) kernel side watch of received frame id
+ * The kernel only forwards a frame when the payload bits selected by the mask change, its DLC changes, or it reappears after a timeout
+ *
+ * @param const canid_t - can_id to watch (including CAN_EFF_FLAG for 29-bit ids)
+ *
+ * @param const uint8_t* - 8 byte content mask, set bits are compared against the previous frame. NULL forwards every frame (id filtering only)
+ *
+ * @param const uint32_t - timeout in microseconds after which BCM_EVENT_TIMEOUT is raised if no frame arrived, 0 disables monitoring
+ *
+ * @param const uint32_t - minimum interval in microseconds between change notifications (throttling), 0 disables throttling
+ *
+ * @param const int* - pointer to broadcast manager socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_bcm_rx_setup(const canid_t id, const uint8_t *mask, const uint32_t timeout_us, const uint32_t throttle_us, const int *socket);
+
+/**
+ * @brief can_interact_bcm_rx_delete - removes kernel side watch of received frame id
+ *
+ * @param const canid_t - can_id being watched
+ *
+ * @param const int* - pointer to broadcast manager socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes (ENOENT / EINVAL if no such watch exists)
+ */
+int can_interact_bcm_rx_delete(const canid_t id, const int *socket);
+
+/**
+ * @brief can_interact_bcm_get_event - blocks until next change / timeout notification of any watch
+ *
+ * @param struct can_interact_bcm_event* - pointer to event to write to
+ *
+ * @param const int* - pointer to broadcast manager socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_bcm_get_event(struct can_interact_bcm_event *event, const int *socket);
+
+/**
+ * @brief can_interact_bcm_fini - frees broadcast manager connection, cancelling all of its jobs
+ *
+ * @param const int* - pointer to socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_bcm_fini(const int *socket);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_BCM_H */
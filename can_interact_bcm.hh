@@ -0,0 +1,309 @@
+#ifndef CAN_INTERACT_BCM_HH
+#define CAN_INTERACT_BCM_HH
+#pragma once
+
+#include <vector>
+#include <array>
+#include <chrono>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include "can_interact.hh"
+#include "can_interact_bcm.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact broadcast manager functionality
+ * For declarations for the native C library, see can_interact_bcm.h
+ */
+
+namespace can_interact {
+
+	class BCM {
+		/**
+		  * @brief BCM (class) - manages broadcast manager connection and the cyclic transmissions & receive watches (jobs) created through it
+		  * Closing the connection (i.e. destruction) cancels all of its jobs
+		  */
+		private:
+			int _socket ;
+
+			/**
+			  * @brief _us - INTERNAL METHOD. converts duration to the microseconds of the BCM timers
+			  * @param const std::chrono::microseconds - duration
+			  * @return std::uint32_t - microseconds
+			  * @throws std::invalid_argument - if duration is negative or longer than std::uint32_t microseconds (about 71 minutes)
+			  */
+			static std::uint32_t _us(const std::chrono::microseconds) noexcept(false) ;
+
+		public:
+			/**
+			  * @brief BCM (constructor) (overload) - initialises broadcast manager connection
+			  * @param const std::string& - name of device
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error
+			  */
+			BCM(const std::string&) noexcept(false) ;
+
+			/**
+			  * @brief BCM (constructor) (overload) - adopts and works with existing broadcast manager socket
+			  * @param const int - existing, initialised socket
+			  */
+			BCM(const int) noexcept ;
+
+			/**
+			  * @brief BCM (move constructor) - copies over internal socket ID and nullifies previous
+			  * @param BCM&& - rvalue reference to BCM class object
+			  */
+			BCM(BCM&&) noexcept ;
+
+			/**
+			  * @brief operator= (move assignment) - copies over internal socket ID and nullifies previous
+			  * @param BCM&& - rvalue reference to BCM class object
+			  * @return BCM& - reference to assigned BCM object
+			  */
+			BCM& operator=(BCM&&) noexcept ;
+
+			/**
+			  * @brief socket - getter to return socket being internally maintained
+			  * @return int - socket
+			  */
+			int socket() const noexcept ;
+
+			/**
+			  * @brief cyclic (overload) - creates (or replaces) cyclic transmission of a single frame
+			  * @param const can_frame& - LINUX CAN frame struct to transmit
+			  * @param const std::chrono::microseconds - cycle time
+			  * @throws std::invalid_argument - if cycle time is negative or above UINT32_MAX microseconds
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void cyclic(const can_frame&, const std::chrono::microseconds) const noexcept(false) ;
+
+			/**
+			  * @brief cyclic (overload) - creates (or replaces) cyclic transmission of a sequence of frames, one sent per cycle
+			  * @param const std::vector<can_frame>& - frames to transmit (first can_id identifies job)
+			  * @param const std::chrono::microseconds - cycle time
+			  * @throws std::invalid_argument - if the number of frames is 0 or above CAN_INTERACT_BCM_MAX_FRAMES, or cycle time is out of range
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void cyclic(const std::vector<can_frame>&, const std::chrono::microseconds) const noexcept(false) ;
+
+			/**
+			  * @brief update (overload) - replaces payload of existing cyclic transmission, keeping its timer
+			  * @param const can_frame& - LINUX CAN frame struct
+			  * @param const bool - whether to also send the new frame immediately
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void update(const can_frame&, const bool = false) const noexcept(false) ;
+
+			/**
+			  * @brief update (overload) - replaces payload sequence of existing cyclic transmission, keeping its timer
+			  * @param const std::vector<can_frame>& - frames (first can_id identifies job)
+			  * @param const bool - whether to also send the first frame immediately
+			  * @throws std::invalid_argument - if the number of frames is 0 or above CAN_INTERACT_BCM_MAX_FRAMES
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void update(const std::vector<can_frame>&, const bool = false) const noexcept(false) ;
+
+			/**
+			  * @brief cancel - cancels cyclic transmission
+			  * @param const canid_t - can_id identifying job
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void cancel(const canid_t) const noexcept(false) ;
+
+			/**
+			  * @brief watch (overload) - creates (or replaces) kernel side watch, forwarding frames only when masked payload bits change
+			  * @param const canid_t - can_id to watch
+			  * @param const std::array<std::uint8_t, 8>& - content mask, set bits are compared against previous frame
+			  * @param const std::chrono::microseconds - timeout after which a BCM_EVENT_TIMEOUT event is raised, 0 disables monitoring
+			  * @param const std::chrono::microseconds - minimum interval between change notifications, 0 disables throttling
+			  * @throws std::invalid_argument - if timeout or throttle is negative or above UINT32_MAX microseconds
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void watch(const canid_t, const std::array<std::uint8_t, 8>&, const std::chrono::microseconds = std::chrono::microseconds{0}, const std::chrono::microseconds = std::chrono::microseconds{0}) const noexcept(false) ;
+
+			/**
+			  * @brief watch (overload) - creates (or replaces) kernel side watch forwarding every frame of id, used for timeout monitoring
+			  * @param const canid_t - can_id to watch
+			  * @param const std::chrono::microseconds - timeout after which a BCM_EVENT_TIMEOUT event is raised, 0 disables monitoring
+			  * @throws std::invalid_argument - if timeout is negative or above UINT32_MAX microseconds
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void watch(const canid_t, const std::chrono::microseconds = std::chrono::microseconds{0}) const noexcept(false) ;
+
+			/**
+			  * @brief unwatch - removes kernel side watch
+			  * @param const canid_t - can_id being watched
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void unwatch(const canid_t) const noexcept(false) ;
+
+			/**
+			  * @brief event - blocks until next change / timeout notification of any watch
+			  * @return can_interact_bcm_event - notification
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			can_interact_bcm_event event() const noexcept(false) ;
+
+			/**
+			  * @brief ~BCM (destructor) - frees broadcast manager socket, cancelling all jobs
+			  */
+			~BCM() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			BCM() noexcept = delete ;
+			BCM(const BCM&) = delete ;
+			BCM& operator=(const BCM&) = delete ;
+	} ;
+
+}
+
+can_interact::BCM::BCM(const std::string& device_name) noexcept(false)
+{
+	const int res = can_interact_bcm_init(&this->_socket, device_name.c_str()) ;
+	if(res != 0)
+	{
+		if(this->_socket != -1)
+		{
+			can_interact_bcm_fini(&this->_socket) ;
+		}
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+can_interact::BCM::BCM(const int socket) noexcept : _socket(socket) {}
+
+std::uint32_t can_interact::BCM::_us(const std::chrono::microseconds duration) noexcept(false)
+{
+	if(duration.count() < 0 || duration.count() > static_cast<std::chrono::microseconds::rep>(UINT32_MAX))
+	{
+		throw std::invalid_argument(std::string{"BCM timer of "} + std::to_string(duration.count()) + "us out of range 0-" + std::to_string(UINT32_MAX) + "us") ;
+	}
+	return static_cast<std::uint32_t>(duration.count()) ;
+}
+
+can_interact::BCM::BCM(can_interact::BCM&& bcm) noexcept
+{
+	this->_socket = bcm._socket ;
+	bcm._socket = -1 ;
+}
+
+can_interact::BCM& can_interact::BCM::operator=(can_interact::BCM&& bcm) noexcept
+{
+	if(this != &bcm)
+	{
+		if(this->_socket != -1)
+		{
+			can_interact_bcm_fini(&this->_socket) ;
+		}
+		this->_socket = bcm._socket ;
+		bcm._socket = -1 ;
+	}
+	return *this ;
+}
+
+int can_interact::BCM::socket() const noexcept
+{
+	return this->_socket ;
+}
+
+void can_interact::BCM::cyclic(const can_frame& frame, const std::chrono::microseconds interval) const noexcept(false)
+{
+	const int res = can_interact_bcm_tx_setup(&frame, 1, BCM::_us(interval), &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::BCM::cyclic(const std::vector<can_frame>& frames, const std::chrono::microseconds interval) const noexcept(false)
+{
+	if(frames.empty() || frames.size() > CAN_INTERACT_BCM_MAX_FRAMES)
+	{
+		throw std::invalid_argument(std::string{"Number of frames must be 1-"} + std::to_string(CAN_INTERACT_BCM_MAX_FRAMES)) ;
+	}
+	const int res = can_interact_bcm_tx_setup(frames.data(), static_cast<std::uint32_t>(frames.size()), BCM::_us(interval), &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::BCM::update(const can_frame& frame, const bool announce) const noexcept(false)
+{
+	const int res = can_interact_bcm_tx_update(&frame, 1, announce ? 1 : 0, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::BCM::update(const std::vector<can_frame>& frames, const bool announce) const noexcept(false)
+{
+	if(frames.empty() || frames.size() > CAN_INTERACT_BCM_MAX_FRAMES)
+	{
+		throw std::invalid_argument(std::string{"Number of frames must be 1-"} + std::to_string(CAN_INTERACT_BCM_MAX_FRAMES)) ;
+	}
+	const int res = can_interact_bcm_tx_update(frames.data(), static_cast<std::uint32_t>(frames.size()), announce ? 1 : 0, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::BCM::cancel(const canid_t id) const noexcept(false)
+{
+	const int res = can_interact_bcm_tx_delete(id, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::BCM::watch(const canid_t id, const std::array<std::uint8_t, 8>& mask, const std::chrono::microseconds timeout, const std::chrono::microseconds throttle) const noexcept(false)
+{
+	const int res = can_interact_bcm_rx_setup(id, mask.data(), BCM::_us(timeout), BCM::_us(throttle), &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::BCM::watch(const canid_t id, const std::chrono::microseconds timeout) const noexcept(false)
+{
+	const int res = can_interact_bcm_rx_setup(id, nullptr, BCM::_us(timeout), 0, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::BCM::unwatch(const canid_t id) const noexcept(false)
+{
+	const int res = can_interact_bcm_rx_delete(id, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+can_interact_bcm_event can_interact::BCM::event() const noexcept(false)
+{
+	can_interact_bcm_event event ;
+	const int res = can_interact_bcm_get_event(&event, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return event ;
+}
+
+can_interact::BCM::~BCM() noexcept
+{
+	if(this->_socket != -1)
+	{
+		can_interact_bcm_fini(&this->_socket) ;
+	}
+}
+
+#endif // CAN_INTERACT_BCM_HH
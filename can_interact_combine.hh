@@ -0,0 +1,284 @@
+#ifndef CAN_INTERACT_COMBINE_HH
+#define CAN_INTERACT_COMBINE_HH
+#pragma once
+
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <errno.h>
+
+#include "can_interact.hh"
+
+/**
+ * @brief CXX API (C++11) flat-combining transmit front-end, letting many threads share one CAN connection with batched sends
+ * Each sending thread owns a slot (see TxCombiner::Sender) and publishes its frame there. Whichever caller takes the combiner lock sends
+ * every published frame in one can_interact_send_frames call and hands each slot its own result, while the other callers wait for theirs
+ * A sender has at most one frame in flight, so each thread's frames go out in call order
+ * Requires linking with -pthread
+ */
+
+namespace can_interact {
+
+	class TxCombiner {
+		/**
+		  * @brief TxCombiner (class) - combines concurrent sends on one connection into batched syscalls
+		  */
+		private:
+			struct _slot {
+				/**
+				  * @brief _slot - INTERNAL. publication record of one sender, padded against false sharing with its neighbours
+				  */
+				std::atomic<std::uint32_t> state ; // _IDLE, _PENDING or _DONE
+				std::atomic<bool> claimed ;
+				can_frame frame ;
+				int result ;
+				char _pad[64] ;
+			} ;
+
+			static const std::uint32_t _IDLE = 0 ;
+			static const std::uint32_t _PENDING = 1 ;
+			static const std::uint32_t _DONE = 2 ;
+
+			int _socket ;
+			std::size_t _capacity ;
+			std::unique_ptr<_slot[]> _slots ;
+			std::mutex _lock ;
+			std::size_t _start ; // first slot scanned by next pass, rotated for fairness
+			std::atomic<std::uint64_t> _frames ;
+			std::atomic<std::uint64_t> _syscalls ;
+
+			/**
+			  * @brief _combine - INTERNAL METHOD. sends all published frames, called with lock held
+			  * @return std::size_t - number of frames handled
+			  */
+			std::size_t _combine() noexcept ;
+
+			/**
+			  * @brief _send - INTERNAL METHOD. publishes frame in slot and waits until it was sent, combining if the lock is free
+			  * @param const std::size_t - slot
+			  * @param const can_frame& - frame
+			  * @return int - error code of send, 0 on success
+			  */
+			int _send(const std::size_t, const can_frame&) noexcept ;
+
+		public:
+			class Sender {
+				/**
+				  * @brief Sender (class) - handle to a slot of a TxCombiner, to be used by a single thread at a time
+				  */
+				friend class TxCombiner ;
+
+				private:
+					TxCombiner* _owner ;
+					std::size_t _slot ;
+
+					/**
+					  * @brief Sender (constructor) - INTERNAL. adopts claimed slot
+					  * @param TxCombiner* - owning combiner
+					  * @param const std::size_t - slot
+					  */
+					Sender(TxCombiner*, const std::size_t) noexcept ;
+
+				public:
+					Sender(Sender&&) noexcept ;
+					Sender& operator=(Sender&&) noexcept ;
+
+					/**
+					  * @brief frame - sends frame, returning once it was handed to the kernel (possibly by another thread's syscall)
+					  * @param const can_frame& - LINUX CAN frame struct
+					  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+					  */
+					void frame(const can_frame&) noexcept(false) ;
+
+					/**
+					  * @brief ~Sender (destructor) - returns slot to combiner
+					  */
+					~Sender() noexcept ;
+
+					/* Below are defaulted and deleted methods */
+					Sender() = delete ;
+					Sender(const Sender&) = delete ;
+					Sender& operator=(const Sender&) = delete ;
+			} ;
+
+			struct stats_t {
+				/**
+				  * @brief stats_t - transmit counters
+				  */
+				std::uint64_t frames ; // frames handed to the kernel or failed
+				std::uint64_t syscalls ; // sendmmsg calls, frames / syscalls is the achieved batch size
+			} ;
+
+			/**
+			  * @brief TxCombiner (constructor) - sets up slots
+			  * @param const CAN& - connection (must outlive combiner)
+			  * @param const std::size_t - maximum number of concurrent senders
+			  */
+			TxCombiner(const CAN&, const std::size_t = 64) noexcept(false) ;
+
+			/**
+			  * @brief sender - claims slot for calling thread
+			  * @return Sender - handle, must not outlive combiner
+			  * @throws std::runtime_error - if all slots are taken
+			  */
+			Sender sender() noexcept(false) ;
+
+			/**
+			  * @brief stats - getter for transmit counters
+			  * @return stats_t - counters
+			  */
+			stats_t stats() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			TxCombiner() = delete ;
+			TxCombiner(const TxCombiner&) = delete ;
+			TxCombiner& operator=(const TxCombiner&) = delete ;
+	} ;
+
+}
+
+can_interact::TxCombiner::TxCombiner(const CAN& can, const std::size_t capacity) noexcept(false)
+	: _socket{can.socket()}, _capacity{capacity == 0 ? 1 : capacity}, _slots{}, _lock{}, _start{0}, _frames{0}, _syscalls{0}
+{
+	this->_slots.reset(new _slot[this->_capacity]) ;
+	for(std::size_t i = 0 ; i < this->_capacity ; ++i)
+	{
+		this->_slots[i].state.store(_IDLE, std::memory_order_relaxed) ;
+		this->_slots[i].claimed.store(false, std::memory_order_relaxed) ;
+	}
+}
+
+can_interact::TxCombiner::Sender can_interact::TxCombiner::sender() noexcept(false)
+{
+	for(std::size_t i = 0 ; i < this->_capacity ; ++i)
+	{
+		if(!this->_slots[i].claimed.exchange(true, std::memory_order_acquire))
+		{
+			return Sender{this, i} ;
+		}
+	}
+	throw std::runtime_error(std::string{"All "} + std::to_string(this->_capacity) + " sender slots are taken") ;
+}
+
+std::size_t can_interact::TxCombiner::_combine() noexcept
+{
+	can_frame frames[CAN_INTERACT_MAX_BATCH] ;
+	std::size_t owners[CAN_INTERACT_MAX_BATCH] ;
+	std::size_t count = 0 ;
+
+	for(std::size_t n = 0 ; n < this->_capacity && count < CAN_INTERACT_MAX_BATCH ; ++n)
+	{
+		const std::size_t i = (this->_start + n) % this->_capacity ;
+		if(this->_slots[i].state.load(std::memory_order_acquire) == _PENDING)
+		{
+			frames[count] = this->_slots[i].frame ;
+			owners[count++] = i ;
+		}
+	}
+	this->_start = (this->_start + 1) % this->_capacity ;
+
+	// a partial send leaves the rest queued behind the first failing frame, which alone gets the error
+	std::size_t done = 0 ;
+	while(done < count)
+	{
+		std::size_t sent ;
+		const int res = can_interact_send_frames(frames + done, count - done, &sent, &this->_socket) ;
+		this->_syscalls.fetch_add(1, std::memory_order_relaxed) ;
+		for(std::size_t i = done ; i < done + sent ; ++i)
+		{
+			this->_slots[owners[i]].result = 0 ;
+			this->_slots[owners[i]].state.store(_DONE, std::memory_order_release) ;
+		}
+		done += sent ;
+		if(res != 0 || sent == 0)
+		{
+			this->_slots[owners[done]].result = res != 0 ? res : EAGAIN ;
+			this->_slots[owners[done]].state.store(_DONE, std::memory_order_release) ;
+			++done ;
+		}
+	}
+	this->_frames.fetch_add(count, std::memory_order_relaxed) ;
+	return count ;
+}
+
+int can_interact::TxCombiner::_send(const std::size_t idx, const can_frame& frame) noexcept
+{
+	_slot& slot = this->_slots[idx] ;
+	slot.frame = frame ;
+	slot.state.store(_PENDING, std::memory_order_release) ;
+
+	while(slot.state.load(std::memory_order_acquire) != _DONE)
+	{
+		if(this->_lock.try_lock())
+		{
+			// combine until our own frame is out, picking up whatever others publish meanwhile
+			while(this->_combine() > 0 && slot.state.load(std::memory_order_acquire) != _DONE)
+			{
+			}
+			this->_lock.unlock() ;
+		}
+		else
+		{
+			std::this_thread::yield() ;
+		}
+	}
+	const int res = slot.result ;
+	slot.state.store(_IDLE, std::memory_order_relaxed) ;
+	return res ;
+}
+
+can_interact::TxCombiner::stats_t can_interact::TxCombiner::stats() const noexcept
+{
+	return stats_t{this->_frames.load(std::memory_order_relaxed), this->_syscalls.load(std::memory_order_relaxed)} ;
+}
+
+can_interact::TxCombiner::Sender::Sender(TxCombiner* owner, const std::size_t slot) noexcept : _owner{owner}, _slot{slot} {}
+
+can_interact::TxCombiner::Sender::Sender(Sender&& sender) noexcept : _owner{sender._owner}, _slot{sender._slot}
+{
+	sender._owner = nullptr ;
+}
+
+can_interact::TxCombiner::Sender& can_interact::TxCombiner::Sender::operator=(Sender&& sender) noexcept
+{
+	if(this != &sender)
+	{
+		if(this->_owner != nullptr)
+		{
+			this->_owner->_slots[this->_slot].claimed.store(false, std::memory_order_release) ;
+		}
+		this->_owner = sender._owner ;
+		this->_slot = sender._slot ;
+		sender._owner = nullptr ;
+	}
+	return *this ;
+}
+
+void can_interact::TxCombiner::Sender::frame(const can_frame& frame) noexcept(false)
+{
+	if(this->_owner == nullptr)
+	{
+		throw std::invalid_argument("Sender was moved from") ;
+	}
+	const int res = this->_owner->_send(this->_slot, frame) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+can_interact::TxCombiner::Sender::~Sender() noexcept
+{
+	if(this->_owner != nullptr)
+	{
+		this->_owner->_slots[this->_slot].claimed.store(false, std::memory_order_release) ;
+	}
+}
+
+#endif // CAN_INTERACT_COMBINE_HH
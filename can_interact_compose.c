@@ -0,0 +1,272 @@
+#define _DEFAULT_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <errno.h>
+#include <linux/can.h>
+
+#include "can_interact_compose.h"
+
+/**
+ * @brief C-style definitions of the multi-signal frame composer
+ * For definitions for the CXX API, see can_interact_compose.hh
+ */
+
+/**
+ * @brief _p_can_interact_compose_mask - INTERNAL METHOD. bits of byte between two bit positions
+ * @param const unsigned int - lowest bit (0-7)
+ * @param const unsigned int - highest bit (0-7)
+ * @return uint8_t - mask
+ */
+static uint8_t _p_can_interact_compose_mask(const unsigned int lo, const unsigned int hi)
+{
+	return (uint8_t)(((1u << (hi - lo + 1)) - 1u) << lo);
+}
+
+/**
+ * @brief _p_can_interact_compose_compile - INTERNAL METHOD. splits signal into per-byte spans
+ * Both byte orders share one representation: byte b receives the raw value shifted right by (lowest raw bit landing in b) - (its bit in b)
+ * @param const struct can_interact_compose_signal* - signal
+ * @param const uint8_t - payload length in bytes
+ * @param struct can_interact_compose_entry* - entry to fill
+ * @return int - 0 on success, EINVAL if signal leaves payload
+ */
+static int _p_can_interact_compose_compile(const struct can_interact_compose_signal *signal, const uint8_t len, struct can_interact_compose_entry *entry)
+{
+	unsigned int first, last, b, lo, hi, msb, lsb;
+
+	entry->span_count = 0;
+	if (signal->byte_order == ENDIAN_LITTLE) { /* Intel: bits ascend from start bit, continuing into following bytes */
+		first = signal->start_bit;
+		last = first + signal->length - 1u;
+		if (last / 8u >= len) {
+			return EINVAL;
+		}
+		for (b = first / 8u; b <= last / 8u; ++b) {
+			lo = first > b * 8u ? first - b * 8u : 0u;
+			hi = last < b * 8u + 7u ? last - b * 8u : 7u;
+			entry->spans[entry->span_count].byte = (uint8_t)b;
+			entry->spans[entry->span_count].shift = (int8_t)((int)(b * 8u) - (int)first);
+			entry->spans[entry->span_count].mask = _p_can_interact_compose_mask(lo, hi);
+			++entry->span_count;
+		}
+	} else { /* Motorola: start bit is the msb, less significant bits continue into following bytes from their bit 7 */
+		msb = (signal->start_bit / 8u) * 8u + (7u - signal->start_bit % 8u); /* as position counted from bit 7 of byte 0 */
+		lsb = msb + signal->length - 1u;
+		if (lsb / 8u >= len) {
+			return EINVAL;
+		}
+		for (b = msb / 8u; b <= lsb / 8u; ++b) {
+			first = msb > b * 8u ? msb - b * 8u : 0u; /* positions within byte, 0 being bit 7 */
+			last = lsb < b * 8u + 7u ? lsb - b * 8u : 7u;
+			entry->spans[entry->span_count].byte = (uint8_t)b;
+			entry->spans[entry->span_count].shift = (int8_t)((int)lsb - (int)(b * 8u + 7u));
+			entry->spans[entry->span_count].mask = _p_can_interact_compose_mask(7u - last, 7u - first);
+			++entry->span_count;
+		}
+	}
+	return 0;
+}
+
+int can_interact_compose_init(struct can_interact_compose_layout *layout, const canid_t id, const uint8_t len, const struct can_interact_compose_signal *signals, const size_t count)
+{
+	uint8_t used[64];
+	struct can_interact_compose_entry *entry;
+	uint64_t half;
+	size_t i, s;
+
+	if (count > CAN_INTERACT_COMPOSE_MAX_SIGNALS) {
+		return E2BIG;
+	}
+	if (len > 64) {
+		return EINVAL;
+	}
+	memset(used, 0, sizeof(used));
+	layout->id = id;
+	layout->len = len;
+	layout->count = count;
+	for (i = 0; i < count; ++i) {
+		entry = &layout->signals[i];
+		if (signals[i].length == 0 || signals[i].length > 64
+				|| (signals[i].type == DATA_TYPE_FLOAT && signals[i].length != 32 && signals[i].length != 64)) {
+			return EINVAL;
+		}
+		if (_p_can_interact_compose_compile(&signals[i], len, entry) != 0) {
+			return EINVAL;
+		}
+		for (s = 0; s < entry->span_count; ++s) {
+			if (used[entry->spans[s].byte] & entry->spans[s].mask) {
+				return EINVAL;
+			}
+			used[entry->spans[s].byte] |= entry->spans[s].mask;
+		}
+
+		entry->length = signals[i].length;
+		entry->type = signals[i].type;
+		entry->scale = signals[i].scale == 0.0 ? 1.0 : signals[i].scale;
+		entry->offset = signals[i].offset;
+		half = (uint64_t)1 << (entry->length - 1u);
+		if (entry->type == DATA_TYPE_SIGNED) {
+			entry->min_raw = ~(half - 1u); /* sign extended, masked when packing */
+			entry->max_raw = half - 1u;
+			entry->min = -(double)half;
+			entry->max = (double)(half - 1u);
+		} else {
+			entry->min_raw = 0;
+			entry->max_raw = half - 1u + half;
+			entry->min = 0.0;
+			entry->max = (double)entry->max_raw;
+		}
+	}
+	return 0;
+}
+
+void can_interact_compose_raw(const struct can_interact_compose_layout *layout, const size_t signal, const uint64_t raw, uint8_t *data)
+{
+	const struct can_interact_compose_entry *entry = &layout->signals[signal];
+	const struct can_interact_compose_span *span;
+	uint64_t part;
+	uint8_t s;
+
+	for (s = 0; s < entry->span_count; ++s) {
+		span = &entry->spans[s];
+		part = span->shift >= 0 ? raw >> span->shift : raw << -span->shift;
+		data[span->byte] = (uint8_t)((data[span->byte] & ~span->mask) | ((uint8_t)part & span->mask));
+	}
+}
+
+/**
+ * @brief _p_can_interact_compose_to_raw - INTERNAL METHOD. converts physical value to raw value of signal
+ * @param const struct can_interact_compose_entry* - signal
+ * @param const double - physical value
+ * @return uint64_t - raw value, rounded to nearest and saturated to signal's range
+ */
+static uint64_t _p_can_interact_compose_to_raw(const struct can_interact_compose_entry *entry, const double value)
+{
+	double scaled = (value - entry->offset) / entry->scale;
+	uint32_t bits32;
+	uint64_t bits64;
+	float single;
+
+	if (entry->type == DATA_TYPE_FLOAT) {
+		if (entry->length == 32) {
+			single = (float)scaled;
+			memcpy(&bits32, &single, sizeof(bits32));
+			return bits32;
+		}
+		memcpy(&bits64, &scaled, sizeof(bits64));
+		return bits64;
+	}
+	if (!(scaled > entry->min)) { /* also catches NaN */
+		return entry->min_raw;
+	}
+	if (scaled >= entry->max) {
+		return entry->max_raw;
+	}
+	scaled = scaled < 0.0 ? scaled - 0.5 : scaled + 0.5; /* round half away from zero, the cast truncates */
+	return entry->type == DATA_TYPE_SIGNED ? (uint64_t)(int64_t)scaled : (uint64_t)scaled;
+}
+
+void can_interact_compose_value(const struct can_interact_compose_layout *layout, const size_t signal, const double value, uint8_t *data)
+{
+	can_interact_compose_raw(layout, signal, _p_can_interact_compose_to_raw(&layout->signals[signal], value), data);
+}
+
+uint64_t can_interact_compose_get_raw(const struct can_interact_compose_layout *layout, const size_t signal, const uint8_t *data)
+{
+	const struct can_interact_compose_entry *entry = &layout->signals[signal];
+	const struct can_interact_compose_span *span;
+	uint64_t raw = 0, part;
+	uint8_t s;
+
+	for (s = 0; s < entry->span_count; ++s) {
+		span = &entry->spans[s];
+		part = (uint64_t)(data[span->byte] & span->mask);
+		raw |= span->shift >= 0 ? part << span->shift : part >> -span->shift;
+	}
+	if (entry->type == DATA_TYPE_SIGNED && entry->length < 64 && (raw >> (entry->length - 1u)) & 1u) {
+		raw |= ~(((uint64_t)1 << entry->length) - 1u);
+	}
+	return raw;
+}
+
+double can_interact_compose_get_value(const struct can_interact_compose_layout *layout, const size_t signal, const uint8_t *data)
+{
+	const struct can_interact_compose_entry *entry = &layout->signals[signal];
+	const uint64_t raw = can_interact_compose_get_raw(layout, signal, data);
+	uint32_t bits32;
+	float single;
+	double value;
+
+	if (entry->type == DATA_TYPE_FLOAT) {
+		if (entry->length == 32) {
+			bits32 = (uint32_t)raw;
+			memcpy(&single, &bits32, sizeof(single));
+			value = (double)single;
+		} else {
+			memcpy(&value, &raw, sizeof(value));
+		}
+	} else {
+		value = entry->type == DATA_TYPE_SIGNED ? (double)(int64_t)raw : (double)raw;
+	}
+	return value * entry->scale + entry->offset;
+}
+
+int can_interact_compose_frame(const struct can_interact_compose_layout *layout, const double *values, struct can_frame *frame)
+{
+	size_t i;
+
+	if (layout->len > CAN_MAX_DLEN) {
+		return EINVAL;
+	}
+	memset(frame, 0, sizeof(struct can_frame));
+	frame->can_id = layout->id;
+	frame->can_dlc = layout->len;
+	for (i = 0; i < layout->count; ++i) {
+		can_interact_compose_raw(layout, i, _p_can_interact_compose_to_raw(&layout->signals[i], values[i]), frame->data);
+	}
+	return 0;
+}
+
+int can_interact_compose_frame_raw(const struct can_interact_compose_layout *layout, const uint64_t *raws, struct can_frame *frame)
+{
+	size_t i;
+
+	if (layout->len > CAN_MAX_DLEN) {
+		return EINVAL;
+	}
+	memset(frame, 0, sizeof(struct can_frame));
+	frame->can_id = layout->id;
+	frame->can_dlc = layout->len;
+	for (i = 0; i < layout->count; ++i) {
+		can_interact_compose_raw(layout, i, raws[i], frame->data);
+	}
+	return 0;
+}
+
+void can_interact_compose_fd_frame(const struct can_interact_compose_layout *layout, const double *values, struct canfd_frame *frame)
+{
+	size_t i;
+
+	memset(frame, 0, sizeof(struct canfd_frame));
+	frame->can_id = layout->id;
+	frame->len = layout->len;
+	for (i = 0; i < layout->count; ++i) {
+		can_interact_compose_raw(layout, i, _p_can_interact_compose_to_raw(&layout->signals[i], values[i]), frame->data);
+	}
+}
+
+int can_interact_compose_frames(const struct can_interact_compose_layout *layout, const double *values, const size_t len, struct can_frame *frames)
+{
+	size_t i;
+
+	if (layout->len > CAN_MAX_DLEN) {
+		return EINVAL;
+	}
+	for (i = 0; i < len; ++i) {
+		can_interact_compose_frame(layout, values + i * layout->count, &frames[i]);
+	}
+	return 0;
+}
@@ -0,0 +1,208 @@
+#ifndef CAN_INTERACT_COMPOSE_H
+#define CAN_INTERACT_COMPOSE_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+#include "can_interact.h"
+
+/**
+ * @brief C-style composer packing many signals at arbitrary bit positions into one frame (classical or CAN FD)
+ * A message layout is compiled once into per-byte masks and shifts of each signal, so packing a value touches only the bytes it spans
+ * Signals follow DBC conventions: ENDIAN_LITTLE (Intel) start bit is the least significant bit, ENDIAN_BIG (Motorola) start bit is the most
+ * significant bit, both counted as byte * 8 + bit within byte. Physical values are converted as raw = (physical - offset) / scale, rounded and
+ * saturated to the signal's range; DATA_TYPE_FLOAT signals (32 or 64 bits) hold IEEE 754 values
+ * The same layout reads signals back from received payloads (can_interact_compose_get_raw / can_interact_compose_get_value)
+ * For the CXX API, see can_interact_compose.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifndef CAN_INTERACT_COMPOSE_MAX_SIGNALS
+#define CAN_INTERACT_COMPOSE_MAX_SIGNALS 64 /* signals per layout */
+#endif /* CAN_INTERACT_COMPOSE_MAX_SIGNALS */
+
+#define CAN_INTERACT_COMPOSE_MAX_SPANS 9 /* bytes a signal of up to 64 bits may touch */
+
+struct can_interact_compose_signal {
+	/**
+	 * @brief struct can_interact_compose_signal - position and encoding of a signal within a message
+	 */
+	uint16_t start_bit;
+	uint8_t length; /* bits, 1-64 (32 or 64 for DATA_TYPE_FLOAT) */
+	enum can_interact_endianness byte_order;
+	enum can_interact_data_type type;
+	double scale; /* 0 is treated as 1 */
+	double offset;
+};
+
+struct can_interact_compose_span {
+	/**
+	 * @brief struct can_interact_compose_span - INTERNAL. part of a signal within one payload byte
+	 */
+	uint8_t byte;
+	int8_t shift; /* raw value is shifted right by this (left if negative) to line up with byte */
+	uint8_t mask;
+};
+
+struct can_interact_compose_entry {
+	/**
+	 * @brief struct can_interact_compose_entry - INTERNAL. compiled signal
+	 */
+	struct can_interact_compose_span spans[CAN_INTERACT_COMPOSE_MAX_SPANS];
+	uint8_t span_count;
+	uint8_t length;
+	enum can_interact_data_type type;
+	double scale;
+	double offset;
+	double min; /* raw range as doubles, for saturation */
+	double max;
+	uint64_t min_raw;
+	uint64_t max_raw;
+};
+
+struct can_interact_compose_layout {
+	/**
+	 * @brief struct can_interact_compose_layout - compiled message layout, see can_interact_compose_init
+	 */
+	canid_t id;
+	uint8_t len; /* payload bytes */
+	size_t count;
+	struct can_interact_compose_entry signals[CAN_INTERACT_COMPOSE_MAX_SIGNALS];
+};
+
+/**
+ * @brief can_interact_compose_init - compiles message layout
+ *
+ * @param struct can_interact_compose_layout* - layout to initialise
+ *
+ * @param const canid_t - identifier of message (including CAN_EFF_FLAG for extended identifiers)
+ *
+ * @param const uint8_t - payload length in bytes (at most 8 for classical frames, 64 for CAN FD)
+ *
+ * @param const struct can_interact_compose_signal* - signals, indexed in this order by the other functions
+ *
+ * @param const size_t - number of signals
+ *
+ * @return int - error code
+ * Note: 0 on success, E2BIG if there are more than CAN_INTERACT_COMPOSE_MAX_SIGNALS signals,
+ * EINVAL if a signal has an invalid length, lies outside the payload or overlaps another signal
+ */
+int can_interact_compose_init(struct can_interact_compose_layout *layout, const canid_t id, const uint8_t len, const struct can_interact_compose_signal *signals, const size_t count);
+
+/**
+ * @brief can_interact_compose_raw - packs raw value of one signal into payload, leaving the other signals untouched
+ *
+ * @param const struct can_interact_compose_layout* - layout
+ *
+ * @param const size_t - index of signal
+ *
+ * @param const uint64_t - raw value (two's complement for signed signals, bits beyond the signal's length are ignored)
+ *
+ * @param uint8_t* - payload to update
+ */
+void can_interact_compose_raw(const struct can_interact_compose_layout *layout, const size_t signal, const uint64_t raw, uint8_t *data);
+
+/**
+ * @brief can_interact_compose_value - packs physical value of one signal into payload, leaving the other signals untouched
+ *
+ * @param const struct can_interact_compose_layout* - layout
+ *
+ * @param const size_t - index of signal
+ *
+ * @param const double - physical value
+ *
+ * @param uint8_t* - payload to update
+ */
+void can_interact_compose_value(const struct can_interact_compose_layout *layout, const size_t signal, const double value, uint8_t *data);
+
+/**
+ * @brief can_interact_compose_get_raw - reads raw value of one signal from payload
+ *
+ * @param const struct can_interact_compose_layout* - layout
+ *
+ * @param const size_t - index of signal
+ *
+ * @param const uint8_t* - payload (at least the layout's length)
+ *
+ * @return uint64_t - raw value, sign extended for signed signals
+ */
+uint64_t can_interact_compose_get_raw(const struct can_interact_compose_layout *layout, const size_t signal, const uint8_t *data);
+
+/**
+ * @brief can_interact_compose_get_value - reads physical value of one signal from payload
+ *
+ * @param const struct can_interact_compose_layout* - layout
+ *
+ * @param const size_t - index of signal
+ *
+ * @param const uint8_t* - payload (at least the layout's length)
+ *
+ * @return double - physical value, raw * scale + offset
+ */
+double can_interact_compose_get_value(const struct can_interact_compose_layout *layout, const size_t signal, const uint8_t *data);
+
+/**
+ * @brief can_interact_compose_frame - builds classical frame from physical values of all signals
+ *
+ * @param const struct can_interact_compose_layout* - layout (with payload of at most 8 bytes)
+ *
+ * @param const double* - physical values, one per signal
+ *
+ * @param struct can_frame* - frame to write to
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if the layout's payload exceeds 8 bytes (see can_interact_compose_fd_frame)
+ */
+int can_interact_compose_frame(const struct can_interact_compose_layout *layout, const double *values, struct can_frame *frame);
+
+/**
+ * @brief can_interact_compose_frame_raw - builds classical frame from raw values of all signals
+ *
+ * @param const struct can_interact_compose_layout* - layout (with payload of at most 8 bytes)
+ *
+ * @param const uint64_t* - raw values, one per signal
+ *
+ * @param struct can_frame* - frame to write to
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if the layout's payload exceeds 8 bytes (see can_interact_compose_fd_frame)
+ */
+int can_interact_compose_frame_raw(const struct can_interact_compose_layout *layout, const uint64_t *raws, struct can_frame *frame);
+
+/**
+ * @brief can_interact_compose_fd_frame - builds CAN FD frame from physical values of all signals
+ *
+ * @param const struct can_interact_compose_layout* - layout
+ *
+ * @param const double* - physical values, one per signal
+ *
+ * @param struct canfd_frame* - frame to write to
+ */
+void can_interact_compose_fd_frame(const struct can_interact_compose_layout *layout, const double *values, struct canfd_frame *frame);
+
+/**
+ * @brief can_interact_compose_frames - builds many classical frames from physical values
+ *
+ * @param const struct can_interact_compose_layout* - layout (with payload of at most 8 bytes)
+ *
+ * @param const double* - physical values, one row of all signals per frame
+ *
+ * @param const size_t - number of frames
+ *
+ * @param struct can_frame* - frames to write to
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if the layout's payload exceeds 8 bytes (see can_interact_compose_fd_frame)
+ */
+int can_interact_compose_frames(const struct can_interact_compose_layout *layout, const double *values, const size_t len, struct can_frame *frames);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_COMPOSE_H */
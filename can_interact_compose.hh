@@ -0,0 +1,257 @@
+#ifndef CAN_INTERACT_COMPOSE_HH
+#define CAN_INTERACT_COMPOSE_HH
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <errno.h>
+
+#include "can_interact.hh"
+#include "can_interact_compose.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact multi-signal frame composer
+ * For declarations for the native C library, see can_interact_compose.h
+ */
+
+namespace can_interact {
+
+	class Composer {
+		/**
+		  * @brief Composer (class) - compiled message layout packing signal values into frames
+		  */
+		private:
+			std::unique_ptr<can_interact_compose_layout> _layout ;
+
+			/**
+			  * @brief _check - INTERNAL METHOD. validates number of values against number of signals
+			  * @param const std::size_t - number of values
+			  * @param const bool - whether values may hold several rows of all signals
+			  * @throws std::invalid_argument - if it does not match the number of signals (or a multiple of it)
+			  */
+			void _check(const std::size_t, const bool = false) const noexcept(false) ;
+
+			/**
+			  * @brief _classic - INTERNAL METHOD. validates that the payload fits a classical frame
+			  * @throws std::invalid_argument - if the layout's payload exceeds 8 bytes
+			  */
+			void _classic() const noexcept(false) ;
+
+		public:
+			/**
+			  * @brief Composer (constructor) - compiles message layout
+			  * @param const canid_t - identifier of message (including CAN_EFF_FLAG for extended identifiers)
+			  * @param const std::uint8_t - payload length in bytes (at most 8 for classical frames, 64 for CAN FD)
+			  * @param const std::vector<can_interact_compose_signal>& - signals, indexed in this order
+			  * @throws std::invalid_argument - if a signal is invalid, leaves the payload or overlaps another one, or there are too many signals
+			  */
+			Composer(const canid_t, const std::uint8_t, const std::vector<can_interact_compose_signal>&) noexcept(false) ;
+
+			Composer(Composer&&) noexcept = default ;
+			Composer& operator=(Composer&&) noexcept = default ;
+
+			/**
+			  * @brief frame - builds classical frame from physical values
+			  * @param const std::vector<double>& - physical values, one per signal
+			  * @return can_frame - LINUX CAN frame struct ready to be sent
+			  * @throws std::invalid_argument - if the number of values does not match the layout
+			  * @throws std::invalid_argument - if the payload exceeds 8 bytes (see fd_frame)
+			  */
+			can_frame frame(const std::vector<double>&) const noexcept(false) ;
+
+			/**
+			  * @brief frame_raw - builds classical frame from raw values
+			  * @param const std::vector<std::uint64_t>& - raw values, one per signal
+			  * @return can_frame - LINUX CAN frame struct ready to be sent
+			  * @throws std::invalid_argument - if the number of values does not match the layout
+			  * @throws std::invalid_argument - if the payload exceeds 8 bytes (see fd_frame)
+			  */
+			can_frame frame_raw(const std::vector<std::uint64_t>&) const noexcept(false) ;
+
+			/**
+			  * @brief fd_frame - builds CAN FD frame from physical values
+			  * @param const std::vector<double>& - physical values, one per signal
+			  * @return canfd_frame - LINUX CAN FD frame struct ready to be sent
+			  * @throws std::invalid_argument - if the number of values does not match the layout
+			  */
+			canfd_frame fd_frame(const std::vector<double>&) const noexcept(false) ;
+
+			/**
+			  * @brief frames - builds many classical frames from physical values
+			  * @param const std::vector<double>& - physical values, one row of all signals per frame
+			  * @return std::vector<can_frame> - frames
+			  * @throws std::invalid_argument - if the number of values is not a multiple of the number of signals
+			  * @throws std::invalid_argument - if the payload exceeds 8 bytes (see fd_frame)
+			  */
+			std::vector<can_frame> frames(const std::vector<double>&) const noexcept(false) ;
+
+			/**
+			  * @brief set - updates one signal of existing frame with physical value
+			  * @param can_frame& - frame built by this composer
+			  * @param const std::size_t - index of signal
+			  * @param const double - physical value
+			  * @throws std::out_of_range - if there is no such signal
+			  * @throws std::invalid_argument - if the payload exceeds 8 bytes (see fd_frame)
+			  */
+			void set(can_frame&, const std::size_t, const double) const noexcept(false) ;
+
+			/**
+			  * @brief set_raw - updates one signal of existing frame with raw value
+			  * @param can_frame& - frame built by this composer
+			  * @param const std::size_t - index of signal
+			  * @param const std::uint64_t - raw value
+			  * @throws std::out_of_range - if there is no such signal
+			  * @throws std::invalid_argument - if the payload exceeds 8 bytes (see fd_frame)
+			  */
+			void set_raw(can_frame&, const std::size_t, const std::uint64_t) const noexcept(false) ;
+
+			/**
+			  * @brief get - reads physical value of one signal from received frame
+			  * @param const can_frame& - frame of this layout's message
+			  * @param const std::size_t - index of signal
+			  * @return double - physical value
+			  * @throws std::out_of_range - if there is no such signal
+			  * @throws std::invalid_argument - if the payload exceeds 8 bytes (see fd_frame)
+			  */
+			double get(const can_frame&, const std::size_t) const noexcept(false) ;
+
+			/**
+			  * @brief get_raw - reads raw value of one signal from received frame
+			  * @param const can_frame& - frame of this layout's message
+			  * @param const std::size_t - index of signal
+			  * @return std::uint64_t - raw value, sign extended for signed signals
+			  * @throws std::out_of_range - if there is no such signal
+			  * @throws std::invalid_argument - if the payload exceeds 8 bytes (see fd_frame)
+			  */
+			std::uint64_t get_raw(const can_frame&, const std::size_t) const noexcept(false) ;
+
+			/**
+			  * @brief layout - getter for compiled layout, e.g. to name its signals in a Trigger
+			  * @return const can_interact_compose_layout& - layout, valid while the composer lives
+			  */
+			const can_interact_compose_layout& layout() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			Composer() = delete ;
+			Composer(const Composer&) = delete ;
+			Composer& operator=(const Composer&) = delete ;
+	} ;
+
+}
+
+can_interact::Composer::Composer(const canid_t id, const std::uint8_t len, const std::vector<can_interact_compose_signal>& signals) noexcept(false)
+	: _layout{new can_interact_compose_layout}
+{
+	const int res = can_interact_compose_init(this->_layout.get(), id, len, signals.data(), signals.size()) ;
+	if(res == E2BIG)
+	{
+		throw std::invalid_argument(std::string{"At most "} + std::to_string(CAN_INTERACT_COMPOSE_MAX_SIGNALS) + " signals per message") ;
+	}
+	else if(res != 0)
+	{
+		throw std::invalid_argument(std::string{"Invalid or overlapping signal layout for id "} + std::to_string(id)) ;
+	}
+}
+
+void can_interact::Composer::_check(const std::size_t len, const bool rows) const noexcept(false)
+{
+	if(rows ? (this->_layout->count == 0 ? len != 0 : len % this->_layout->count != 0) : len != this->_layout->count)
+	{
+		throw std::invalid_argument(std::string{"Expected values for "} + std::to_string(this->_layout->count) + " signals, got " + std::to_string(len)) ;
+	}
+}
+
+void can_interact::Composer::_classic() const noexcept(false)
+{
+	if(this->_layout->len > CAN_MAX_DLEN)
+	{
+		throw std::invalid_argument(std::string{"Payload of "} + std::to_string(this->_layout->len) + " bytes does not fit a classical frame") ;
+	}
+}
+
+can_frame can_interact::Composer::frame(const std::vector<double>& values) const noexcept(false)
+{
+	this->_check(values.size()) ;
+	this->_classic() ;
+	can_frame frame ;
+	can_interact_compose_frame(this->_layout.get(), values.data(), &frame) ;
+	return frame ;
+}
+
+can_frame can_interact::Composer::frame_raw(const std::vector<std::uint64_t>& raws) const noexcept(false)
+{
+	this->_check(raws.size()) ;
+	this->_classic() ;
+	can_frame frame ;
+	can_interact_compose_frame_raw(this->_layout.get(), raws.data(), &frame) ;
+	return frame ;
+}
+
+canfd_frame can_interact::Composer::fd_frame(const std::vector<double>& values) const noexcept(false)
+{
+	this->_check(values.size()) ;
+	canfd_frame frame ;
+	can_interact_compose_fd_frame(this->_layout.get(), values.data(), &frame) ;
+	return frame ;
+}
+
+std::vector<can_frame> can_interact::Composer::frames(const std::vector<double>& values) const noexcept(false)
+{
+	this->_check(values.size(), true) ;
+	this->_classic() ;
+	std::vector<can_frame> frames(this->_layout->count == 0 ? 0 : values.size() / this->_layout->count) ;
+	can_interact_compose_frames(this->_layout.get(), values.data(), frames.size(), frames.data()) ;
+	return frames ;
+}
+
+void can_interact::Composer::set(can_frame& frame, const std::size_t signal, const double value) const noexcept(false)
+{
+	if(signal >= this->_layout->count)
+	{
+		throw std::out_of_range(std::string{"No signal "} + std::to_string(signal)) ;
+	}
+	this->_classic() ;
+	can_interact_compose_value(this->_layout.get(), signal, value, frame.data) ;
+}
+
+void can_interact::Composer::set_raw(can_frame& frame, const std::size_t signal, const std::uint64_t raw) const noexcept(false)
+{
+	if(signal >= this->_layout->count)
+	{
+		throw std::out_of_range(std::string{"No signal "} + std::to_string(signal)) ;
+	}
+	this->_classic() ;
+	can_interact_compose_raw(this->_layout.get(), signal, raw, frame.data) ;
+}
+
+double can_interact::Composer::get(const can_frame& frame, const std::size_t signal) const noexcept(false)
+{
+	if(signal >= this->_layout->count)
+	{
+		throw std::out_of_range(std::string{"No signal "} + std::to_string(signal)) ;
+	}
+	this->_classic() ;
+	return can_interact_compose_get_value(this->_layout.get(), signal, frame.data) ;
+}
+
+std::uint64_t can_interact::Composer::get_raw(const can_frame& frame, const std::size_t signal) const noexcept(false)
+{
+	if(signal >= this->_layout->count)
+	{
+		throw std::out_of_range(std::string{"No signal "} + std::to_string(signal)) ;
+	}
+	this->_classic() ;
+	return can_interact_compose_get_raw(this->_layout.get(), signal, frame.data) ;
+}
+
+const can_interact_compose_layout& can_interact::Composer::layout() const noexcept
+{
+	return *this->_layout ;
+}
+
+#endif // CAN_INTERACT_COMPOSE_HH
@@ -0,0 +1,488 @@
+#define _DEFAULT_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <errno.h>
+#include <linux/can.h>
+
+#include "can_interact_e2e.h"
+
+/**
+ * @brief C-style definitions of end-to-end protection
+ * For definitions for the CXX API, see can_interact_e2e.hh
+ */
+
+#define _P_CAN_INTERACT_E2E_USED 1
+#define _P_CAN_INTERACT_E2E_REMOVED 2
+
+/**
+ * @brief _p_can_interact_e2e_crc8_tables - INTERNAL METHOD. builds sliced tables of non-reflected CRC8
+ * @param const uint8_t - polynomial
+ * @param uint8_t[4][256] - tables to fill
+ */
+static void _p_can_interact_e2e_crc8_tables(const uint8_t polynomial, uint8_t tables[4][256])
+{
+	unsigned int i, bit, k;
+	uint8_t crc;
+
+	for (i = 0; i < 256; ++i) {
+		crc = (uint8_t)i;
+		for (bit = 0; bit < 8; ++bit) {
+			crc = (uint8_t)(crc & 0x80u ? (crc << 1) ^ polynomial : crc << 1);
+		}
+		tables[0][i] = crc;
+	}
+	for (k = 1; k < 4; ++k) { /* one more zero byte through the register */
+		for (i = 0; i < 256; ++i) {
+			tables[k][i] = tables[0][tables[k - 1][i]];
+		}
+	}
+}
+
+/**
+ * @brief _p_can_interact_e2e_crc8 - INTERNAL METHOD. feeds bytes into non-reflected CRC8 register, 4 bytes per step
+ * @param const uint8_t[4][256] - tables of polynomial
+ * @param uint8_t - register
+ * @param const uint8_t* - data
+ * @param size_t - length of data
+ * @return uint8_t - register
+ */
+static uint8_t _p_can_interact_e2e_crc8(const uint8_t tables[4][256], uint8_t crc, const uint8_t *data, size_t len)
+{
+	for (; len >= 4; data += 4, len -= 4) {
+		crc = (uint8_t)(tables[3][crc ^ data[0]] ^ tables[2][data[1]] ^ tables[1][data[2]] ^ tables[0][data[3]]);
+	}
+	for (; len > 0; ++data, --len) {
+		crc = tables[0][crc ^ *data];
+	}
+	return crc;
+}
+
+/**
+ * @brief _p_can_interact_e2e_crc16 - INTERNAL METHOD. feeds bytes into CRC16 (CCITT) register, 2 bytes per step
+ * @param const uint16_t[2][256] - tables
+ * @param uint16_t - register
+ * @param const uint8_t* - data
+ * @param size_t - length of data
+ * @return uint16_t - register
+ */
+static uint16_t _p_can_interact_e2e_crc16(const uint16_t tables[2][256], uint16_t crc, const uint8_t *data, size_t len)
+{
+	for (; len >= 2; data += 2, len -= 2) {
+		crc = (uint16_t)(tables[1][(crc >> 8) ^ data[0]] ^ tables[0][(crc & 0xFFu) ^ data[1]]);
+	}
+	if (len > 0) {
+		crc = (uint16_t)((crc << 8) ^ tables[0][(crc >> 8) ^ *data]);
+	}
+	return crc;
+}
+
+/**
+ * @brief _p_can_interact_e2e_crc32 - INTERNAL METHOD. feeds bytes into reflected CRC32 register, 8 bytes per step
+ * @param const uint32_t[8][256] - tables of reflected polynomial
+ * @param uint32_t - register
+ * @param const uint8_t* - data
+ * @param size_t - length of data
+ * @return uint32_t - register
+ */
+static uint32_t _p_can_interact_e2e_crc32(const uint32_t tables[8][256], uint32_t crc, const uint8_t *data, size_t len)
+{
+	uint32_t low, high;
+
+	for (; len >= 8; data += 8, len -= 8) {
+		low = crc ^ ((uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24);
+		high = (uint32_t)data[4] | (uint32_t)data[5] << 8 | (uint32_t)data[6] << 16 | (uint32_t)data[7] << 24;
+		crc = tables[7][low & 0xFFu] ^ tables[6][(low >> 8) & 0xFFu] ^ tables[5][(low >> 16) & 0xFFu] ^ tables[4][low >> 24]
+			^ tables[3][high & 0xFFu] ^ tables[2][(high >> 8) & 0xFFu] ^ tables[1][(high >> 16) & 0xFFu] ^ tables[0][high >> 24];
+	}
+	for (; len > 0; ++data, --len) {
+		crc = (crc >> 8) ^ tables[0][(crc ^ *data) & 0xFFu];
+	}
+	return crc;
+}
+
+void can_interact_e2e_init(struct can_interact_e2e *e2e)
+{
+	unsigned int i, bit, k;
+	uint16_t crc16;
+	uint32_t crc32;
+
+	memset(e2e->entries, 0, sizeof(e2e->entries));
+	e2e->count = 0;
+
+	_p_can_interact_e2e_crc8_tables(0x1D, e2e->crc8);
+	_p_can_interact_e2e_crc8_tables(0x2F, e2e->crc8h2f);
+	for (i = 0; i < 256; ++i) {
+		crc16 = (uint16_t)(i << 8);
+		crc32 = i;
+		for (bit = 0; bit < 8; ++bit) {
+			crc16 = (uint16_t)(crc16 & 0x8000u ? (crc16 << 1) ^ 0x1021 : crc16 << 1);
+			crc32 = crc32 & 1u ? (crc32 >> 1) ^ 0xC8DF352Fu : crc32 >> 1; /* 0xF4ACFB13 bit reversed */
+		}
+		e2e->crc16[0][i] = crc16;
+		e2e->crc32p4[0][i] = crc32;
+	}
+	for (i = 0; i < 256; ++i) {
+		e2e->crc16[1][i] = (uint16_t)((e2e->crc16[0][i] << 8) ^ e2e->crc16[0][e2e->crc16[0][i] >> 8]);
+		for (k = 1; k < 8; ++k) {
+			e2e->crc32p4[k][i] = (e2e->crc32p4[k - 1][i] >> 8) ^ e2e->crc32p4[0][e2e->crc32p4[k - 1][i] & 0xFFu];
+		}
+	}
+}
+
+/**
+ * @brief _p_can_interact_e2e_update - INTERNAL METHOD. feeds bytes into register of any kind of CRC
+ * @param const struct can_interact_e2e* - state with tables
+ * @param const enum can_interact_e2e_crc_type - kind of CRC
+ * @param const uint32_t - register
+ * @param const uint8_t* - data
+ * @param const size_t - length of data
+ * @return uint32_t - register
+ */
+static uint32_t _p_can_interact_e2e_update(const struct can_interact_e2e *e2e, const enum can_interact_e2e_crc_type crc, const uint32_t reg, const uint8_t *data, const size_t len)
+{
+	switch (crc) {
+	case E2E_CRC8_SAE_J1850:
+		return _p_can_interact_e2e_crc8(e2e->crc8, (uint8_t)reg, data, len);
+	case E2E_CRC8H2F:
+		return _p_can_interact_e2e_crc8(e2e->crc8h2f, (uint8_t)reg, data, len);
+	case E2E_CRC16:
+		return _p_can_interact_e2e_crc16(e2e->crc16, (uint16_t)reg, data, len);
+	default:
+		return _p_can_interact_e2e_crc32(e2e->crc32p4, reg, data, len);
+	}
+}
+
+/**
+ * @brief _p_can_interact_e2e_width - INTERNAL METHOD. size of CRC field
+ * @param const enum can_interact_e2e_crc_type - kind of CRC
+ * @return unsigned int - bytes
+ */
+static unsigned int _p_can_interact_e2e_width(const enum can_interact_e2e_crc_type crc)
+{
+	return crc == E2E_CRC32P4 ? 4u : crc == E2E_CRC16 ? 2u : 1u;
+}
+
+/**
+ * @brief _p_can_interact_e2e_init_value - INTERNAL METHOD. initial register of CRC
+ * @param const enum can_interact_e2e_crc_type - kind of CRC
+ * @return uint32_t - register
+ */
+static uint32_t _p_can_interact_e2e_init_value(const enum can_interact_e2e_crc_type crc)
+{
+	return crc == E2E_CRC32P4 ? 0xFFFFFFFFu : crc == E2E_CRC16 ? 0xFFFFu : 0xFFu;
+}
+
+/**
+ * @brief _p_can_interact_e2e_xor_out - INTERNAL METHOD. final xor of CRC
+ * @param const enum can_interact_e2e_crc_type - kind of CRC
+ * @return uint32_t - value xored into register
+ */
+static uint32_t _p_can_interact_e2e_xor_out(const enum can_interact_e2e_crc_type crc)
+{
+	return crc == E2E_CRC32P4 ? 0xFFFFFFFFu : crc == E2E_CRC16 ? 0u : 0xFFu;
+}
+
+uint32_t can_interact_e2e_crc(const struct can_interact_e2e *e2e, const enum can_interact_e2e_crc_type crc, const uint8_t *data, const size_t len)
+{
+	return _p_can_interact_e2e_update(e2e, crc, _p_can_interact_e2e_init_value(crc), data, len) ^ _p_can_interact_e2e_xor_out(crc);
+}
+
+/**
+ * @brief _p_can_interact_e2e_slot - INTERNAL METHOD. first probe position of identifier
+ * @param const canid_t - identifier
+ * @return size_t - slot
+ */
+static size_t _p_can_interact_e2e_slot(const canid_t id)
+{
+	return (size_t)((id * 2654435761u) & (CAN_INTERACT_E2E_MAX_IDS - 1));
+}
+
+/**
+ * @brief _p_can_interact_e2e_find - INTERNAL METHOD. looks up slot of protected identifier
+ * @param const struct can_interact_e2e* - state
+ * @param const canid_t - identifier
+ * @return size_t - slot, CAN_INTERACT_E2E_MAX_IDS if not protected
+ */
+static size_t _p_can_interact_e2e_find(const struct can_interact_e2e *e2e, const canid_t id)
+{
+	size_t i = _p_can_interact_e2e_slot(id), probe;
+
+	for (probe = 0; probe < CAN_INTERACT_E2E_MAX_IDS && e2e->entries[i].state != 0; ++probe, i = (i + 1) & (CAN_INTERACT_E2E_MAX_IDS - 1)) {
+		if (e2e->entries[i].state == _P_CAN_INTERACT_E2E_USED && e2e->entries[i].config.id == id) {
+			return i;
+		}
+	}
+	return CAN_INTERACT_E2E_MAX_IDS;
+}
+
+/**
+ * @brief _p_can_interact_e2e_modulus - INTERNAL METHOD. number of distinct counter values
+ * @param const struct can_interact_e2e_config* - configuration
+ * @return uint32_t - counter_max + 1
+ */
+static uint32_t _p_can_interact_e2e_modulus(const struct can_interact_e2e_config *config)
+{
+	return config->counter_max != 0 ? (uint32_t)config->counter_max + 1u : (uint32_t)1 << config->counter_length;
+}
+
+int can_interact_e2e_protect(struct can_interact_e2e *e2e, const struct can_interact_e2e_config *config)
+{
+	const unsigned int crc_end = config->crc_offset + _p_can_interact_e2e_width(config->crc);
+	unsigned int counter_first = config->counter_offset, counter_end = config->counter_offset + 1u;
+	size_t i;
+
+	if (crc_end > 8) {
+		return EINVAL;
+	}
+	if (config->counter_length == 16) {
+		if (config->counter_shift != 0) {
+			return EINVAL;
+		}
+		++counter_end;
+	} else if (config->counter_length > 8 || config->counter_shift + config->counter_length > 8) {
+		return EINVAL;
+	}
+	if (config->counter_length != 0) {
+		if (counter_end > 8 || (counter_first < crc_end && config->crc_offset < counter_end)
+				|| (config->counter_length != 16 && config->counter_max >> config->counter_length != 0)) {
+			return EINVAL;
+		}
+	}
+
+	i = _p_can_interact_e2e_find(e2e, config->id);
+	if (i == CAN_INTERACT_E2E_MAX_IDS) {
+		if (e2e->count == CAN_INTERACT_E2E_MAX_IDS) {
+			return ENOSPC;
+		}
+		i = _p_can_interact_e2e_slot(config->id);
+		while (e2e->entries[i].state == _P_CAN_INTERACT_E2E_USED) {
+			i = (i + 1) & (CAN_INTERACT_E2E_MAX_IDS - 1);
+		}
+		++e2e->count;
+	}
+	memset(&e2e->entries[i], 0, sizeof(struct can_interact_e2e_entry));
+	e2e->entries[i].config = *config;
+	e2e->entries[i].state = _P_CAN_INTERACT_E2E_USED;
+	return 0;
+}
+
+int can_interact_e2e_unprotect(struct can_interact_e2e *e2e, const canid_t id)
+{
+	const size_t i = _p_can_interact_e2e_find(e2e, id);
+
+	if (i == CAN_INTERACT_E2E_MAX_IDS) {
+		return ENOENT;
+	}
+	e2e->entries[i].state = _P_CAN_INTERACT_E2E_REMOVED;
+	--e2e->count;
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_e2e_fits - INTERNAL METHOD. checks that payload holds CRC and counter fields
+ * @param const struct can_interact_e2e_config* - configuration
+ * @param const uint8_t - payload length
+ * @return int - 1 if it does, else 0
+ */
+static int _p_can_interact_e2e_fits(const struct can_interact_e2e_config *config, const uint8_t len)
+{
+	if (config->crc_offset + _p_can_interact_e2e_width(config->crc) > len) {
+		return 0;
+	}
+	return config->counter_length == 0 || config->counter_offset + (config->counter_length == 16 ? 2u : 1u) <= len;
+}
+
+/**
+ * @brief _p_can_interact_e2e_compute - INTERNAL METHOD. computes CRC of payload (without CRC field) and data id
+ * @param const struct can_interact_e2e* - state with tables
+ * @param const struct can_interact_e2e_config* - configuration
+ * @param const uint8_t* - payload
+ * @param const uint8_t - payload length
+ * @return uint32_t - CRC
+ */
+static uint32_t _p_can_interact_e2e_compute(const struct can_interact_e2e *e2e, const struct can_interact_e2e_config *config, const uint8_t *data, const uint8_t len)
+{
+	const unsigned int crc_end = config->crc_offset + _p_can_interact_e2e_width(config->crc);
+	uint8_t data_id[2];
+	uint32_t reg = _p_can_interact_e2e_init_value(config->crc);
+
+	data_id[0] = (uint8_t)(config->data_id & 0xFFu);
+	data_id[1] = (uint8_t)(config->data_id >> 8);
+	if (config->data_id_mode == E2E_DATA_ID_PREFIX) {
+		reg = _p_can_interact_e2e_update(e2e, config->crc, reg, data_id, 2);
+	}
+	reg = _p_can_interact_e2e_update(e2e, config->crc, reg, data, config->crc_offset);
+	reg = _p_can_interact_e2e_update(e2e, config->crc, reg, data + crc_end, len - crc_end);
+	if (config->data_id_mode == E2E_DATA_ID_SUFFIX) {
+		reg = _p_can_interact_e2e_update(e2e, config->crc, reg, data_id, 2);
+	}
+	return reg ^ _p_can_interact_e2e_xor_out(config->crc);
+}
+
+/**
+ * @brief _p_can_interact_e2e_read - INTERNAL METHOD. reads multi-byte field
+ * @param const uint8_t* - first byte of field
+ * @param const unsigned int - width in bytes
+ * @param const enum can_interact_endianness - byte order
+ * @return uint32_t - value
+ */
+static uint32_t _p_can_interact_e2e_read(const uint8_t *field, const unsigned int width, const enum can_interact_endianness byte_order)
+{
+	uint32_t value = 0;
+	unsigned int b;
+
+	for (b = 0; b < width; ++b) {
+		value = value << 8 | field[byte_order == ENDIAN_BIG ? b : width - 1u - b];
+	}
+	return value;
+}
+
+/**
+ * @brief _p_can_interact_e2e_write - INTERNAL METHOD. writes multi-byte field
+ * @param uint8_t* - first byte of field
+ * @param const unsigned int - width in bytes
+ * @param const enum can_interact_endianness - byte order
+ * @param uint32_t - value
+ */
+static void _p_can_interact_e2e_write(uint8_t *field, const unsigned int width, const enum can_interact_endianness byte_order, uint32_t value)
+{
+	unsigned int b;
+
+	for (b = width; b > 0; --b, value >>= 8) {
+		field[byte_order == ENDIAN_BIG ? b - 1u : width - b] = (uint8_t)(value & 0xFFu);
+	}
+}
+
+/**
+ * @brief _p_can_interact_e2e_fill - INTERNAL METHOD. stamps counter and CRC into payload
+ * @param struct can_interact_e2e* - state
+ * @param struct can_interact_e2e_entry* - entry of frame's identifier
+ * @param struct can_frame* - frame
+ * @return int - 0 on success, EINVAL if payload is too short
+ */
+static int _p_can_interact_e2e_fill(struct can_interact_e2e *e2e, struct can_interact_e2e_entry *entry, struct can_frame *frame)
+{
+	const struct can_interact_e2e_config *config = &entry->config;
+	uint8_t mask;
+
+	if (!_p_can_interact_e2e_fits(config, frame->can_dlc)) {
+		return EINVAL;
+	}
+	if (config->counter_length == 16) {
+		_p_can_interact_e2e_write(frame->data + config->counter_offset, 2, config->byte_order, entry->tx_counter);
+	} else if (config->counter_length != 0) {
+		mask = (uint8_t)(((1u << config->counter_length) - 1u) << config->counter_shift);
+		frame->data[config->counter_offset] = (uint8_t)((frame->data[config->counter_offset] & ~mask) | ((entry->tx_counter << config->counter_shift) & mask));
+	}
+	entry->tx_counter = (uint16_t)(((uint32_t)entry->tx_counter + 1u) % _p_can_interact_e2e_modulus(config));
+	_p_can_interact_e2e_write(frame->data + config->crc_offset, _p_can_interact_e2e_width(config->crc), config->byte_order,
+		_p_can_interact_e2e_compute(e2e, config, frame->data, frame->can_dlc));
+	return 0;
+}
+
+int can_interact_e2e_fill(struct can_interact_e2e *e2e, struct can_frame *frame)
+{
+	const size_t i = _p_can_interact_e2e_find(e2e, frame->can_id);
+
+	if (i == CAN_INTERACT_E2E_MAX_IDS) {
+		return ENOENT;
+	}
+	return _p_can_interact_e2e_fill(e2e, &e2e->entries[i], frame);
+}
+
+int can_interact_e2e_fill_frames(struct can_interact_e2e *e2e, struct can_frame *frames, const size_t len)
+{
+	size_t n, i;
+
+	for (n = 0; n < len; ++n) {
+		i = _p_can_interact_e2e_find(e2e, frames[n].can_id);
+		if (i != CAN_INTERACT_E2E_MAX_IDS && _p_can_interact_e2e_fill(e2e, &e2e->entries[i], &frames[n]) != 0) {
+			return EINVAL;
+		}
+	}
+	return 0;
+}
+
+enum can_interact_e2e_status can_interact_e2e_check(struct can_interact_e2e *e2e, const struct can_frame *frame)
+{
+	const size_t i = _p_can_interact_e2e_find(e2e, frame->can_id);
+	struct can_interact_e2e_entry *entry;
+	const struct can_interact_e2e_config *config;
+	uint32_t counter, delta, max_delta;
+
+	if (i == CAN_INTERACT_E2E_MAX_IDS) {
+		return E2E_UNPROTECTED;
+	}
+	entry = &e2e->entries[i];
+	config = &entry->config;
+	if (!_p_can_interact_e2e_fits(config, frame->can_dlc)
+			|| _p_can_interact_e2e_read(frame->data + config->crc_offset, _p_can_interact_e2e_width(config->crc), config->byte_order)
+				!= _p_can_interact_e2e_compute(e2e, config, frame->data, frame->can_dlc)) {
+		++entry->stats.errors;
+		return E2E_ERROR;
+	}
+	if (config->counter_length == 0) {
+		++entry->stats.ok;
+		return E2E_OK;
+	}
+
+	if (config->counter_length == 16) {
+		counter = _p_can_interact_e2e_read(frame->data + config->counter_offset, 2, config->byte_order);
+	} else {
+		counter = (uint32_t)(frame->data[config->counter_offset] >> config->counter_shift) & ((1u << config->counter_length) - 1u);
+	}
+	if (!entry->rx_valid) {
+		entry->rx_counter = (uint16_t)counter;
+		entry->rx_valid = 1;
+		++entry->stats.ok;
+		return E2E_INITIAL;
+	}
+	delta = (counter + _p_can_interact_e2e_modulus(config) - entry->rx_counter) % _p_can_interact_e2e_modulus(config);
+	max_delta = config->max_delta != 0 ? config->max_delta : 1u;
+	if (delta == 0) {
+		++entry->stats.repeated;
+		return E2E_REPEATED;
+	}
+	entry->rx_counter = (uint16_t)counter;
+	if (delta > max_delta) {
+		++entry->stats.wrong_sequence;
+		return E2E_WRONG_SEQUENCE;
+	}
+	++entry->stats.ok;
+	if (delta > 1) {
+		entry->stats.lost += delta - 1u;
+		return E2E_OK_SOME_LOST;
+	}
+	return E2E_OK;
+}
+
+size_t can_interact_e2e_check_frames(struct can_interact_e2e *e2e, const struct can_interact_timed_frame *frames, const size_t len, enum can_interact_e2e_status *results)
+{
+	enum can_interact_e2e_status status;
+	size_t n, failed = 0;
+
+	for (n = 0; n < len; ++n) {
+		status = can_interact_e2e_check(e2e, &frames[n].frame);
+		if (status == E2E_REPEATED || status == E2E_WRONG_SEQUENCE || status == E2E_ERROR) {
+			++failed;
+		}
+		if (results != NULL) {
+			results[n] = status;
+		}
+	}
+	return failed;
+}
+
+int can_interact_e2e_get_stats(const struct can_interact_e2e *e2e, const canid_t id, struct can_interact_e2e_stats *stats)
+{
+	const size_t i = _p_can_interact_e2e_find(e2e, id);
+
+	if (i == CAN_INTERACT_E2E_MAX_IDS) {
+		return ENOENT;
+	}
+	*stats = e2e->entries[i].stats;
+	return 0;
+}
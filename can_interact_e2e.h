@@ -0,0 +1,220 @@
+#ifndef CAN_INTERACT_E2E_H
+#define CAN_INTERACT_E2E_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+#include "can_interact.h"
+
+/**
+ * @brief C-style end-to-end protection (AUTOSAR E2E style CRCs and alive counters) of classical frames
+ * Each protected identifier gets a configuration naming its CRC, the position of the CRC and counter fields and an optional data id mixed
+ * into the CRC. can_interact_e2e_fill stamps the next counter value and CRC into an outgoing frame (after composing its signals), while
+ * can_interact_e2e_check verifies CRC and counter sequence of a received frame and keeps per identifier statistics
+ * The CRC covers the whole payload except the CRC field itself. CRCs are computed through lookup tables built once by can_interact_e2e_init,
+ * sliced so that 2 (CRC16), 4 (CRC8) or 8 (CRC32P4) bytes are folded per step
+ * For the CXX API, see can_interact_e2e.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifndef CAN_INTERACT_E2E_MAX_IDS
+#define CAN_INTERACT_E2E_MAX_IDS 64 /* protected identifiers, power of two */
+#endif /* CAN_INTERACT_E2E_MAX_IDS */
+
+enum can_interact_e2e_crc_type {
+    E2E_CRC8_SAE_J1850 = 0, /* poly 0x1D, init 0xFF, xor out 0xFF (profiles 1, 11) */
+    E2E_CRC8H2F, /* poly 0x2F, init 0xFF, xor out 0xFF (profiles 2, 22) */
+    E2E_CRC16, /* CCITT-FALSE, poly 0x1021, init 0xFFFF, no xor out (profiles 5, 6) */
+    E2E_CRC32P4 /* poly 0xF4ACFB13 reflected, init 0xFFFFFFFF, xor out 0xFFFFFFFF (profile 4) */
+};
+
+enum can_interact_e2e_data_id {
+    E2E_DATA_ID_NONE = 0,
+    E2E_DATA_ID_PREFIX, /* low byte then high byte of data id fed into CRC before payload */
+    E2E_DATA_ID_SUFFIX /* low byte then high byte of data id fed into CRC after payload */
+};
+
+enum can_interact_e2e_status {
+    E2E_OK = 0, /* CRC correct, counter incremented by one */
+    E2E_OK_SOME_LOST, /* CRC correct, counter incremented by more than one but at most max_delta */
+    E2E_INITIAL, /* CRC correct, first frame (or first after a wrong sequence), counter taken as reference */
+    E2E_REPEATED, /* CRC correct, counter unchanged */
+    E2E_WRONG_SEQUENCE, /* CRC correct, counter jumped by more than max_delta, resynchronised on it */
+    E2E_ERROR, /* CRC mismatch or payload too short for the configured fields */
+    E2E_UNPROTECTED /* no configuration for identifier */
+};
+
+struct can_interact_e2e_config {
+	/**
+	 * @brief struct can_interact_e2e_config - protection of one identifier
+	 */
+	canid_t id; /* including CAN_EFF_FLAG for extended identifiers */
+	enum can_interact_e2e_crc_type crc;
+	uint8_t crc_offset; /* first payload byte of CRC field */
+	enum can_interact_endianness byte_order; /* of CRC16 / CRC32P4 field and 16 bit counter */
+	uint8_t counter_offset; /* payload byte of counter */
+	uint8_t counter_shift; /* lowest bit of counter within its byte (0 for 16 bit counters) */
+	uint8_t counter_length; /* bits, 1-8 or 16, 0 for no counter */
+	uint16_t counter_max; /* last value before counter wraps to 0 (e.g. 14 for profile 1), 0 for all ones */
+	uint16_t max_delta; /* largest increment accepted as E2E_OK_SOME_LOST, 0 for 1 */
+	uint16_t data_id;
+	enum can_interact_e2e_data_id data_id_mode;
+};
+
+struct can_interact_e2e_stats {
+	/**
+	 * @brief struct can_interact_e2e_stats - receive counters of one identifier
+	 */
+	uint64_t ok; /* E2E_OK, E2E_OK_SOME_LOST and E2E_INITIAL */
+	uint64_t lost; /* counter values skipped by E2E_OK_SOME_LOST */
+	uint64_t repeated;
+	uint64_t wrong_sequence;
+	uint64_t errors;
+};
+
+struct can_interact_e2e_entry {
+	/**
+	 * @brief struct can_interact_e2e_entry - INTERNAL. configuration and counter state of one identifier
+	 */
+	struct can_interact_e2e_config config;
+	struct can_interact_e2e_stats stats;
+	uint16_t tx_counter; /* next counter value to send */
+	uint16_t rx_counter; /* last counter value received */
+	uint8_t rx_valid;
+	uint8_t state; /* 0 never used, 1 used, 2 removed (keeps probing chains intact) */
+};
+
+struct can_interact_e2e {
+	/**
+	 * @brief struct can_interact_e2e - CRC tables and protected identifiers, see can_interact_e2e_init
+	 */
+	uint8_t crc8[4][256]; /* [k][i] is CRC register after byte i followed by k zero bytes */
+	uint8_t crc8h2f[4][256];
+	uint16_t crc16[2][256];
+	uint32_t crc32p4[8][256];
+	struct can_interact_e2e_entry entries[CAN_INTERACT_E2E_MAX_IDS];
+	size_t count;
+};
+
+/**
+ * @brief can_interact_e2e_init - builds CRC tables and clears protected identifiers
+ *
+ * @param struct can_interact_e2e* - state to initialise
+ */
+void can_interact_e2e_init(struct can_interact_e2e *e2e);
+
+/**
+ * @brief can_interact_e2e_crc - computes CRC of buffer with the standard parameters of its kind
+ *
+ * @param const struct can_interact_e2e* - initialised state
+ *
+ * @param const enum can_interact_e2e_crc_type - kind of CRC
+ *
+ * @param const uint8_t* - data
+ *
+ * @param const size_t - length of data in bytes
+ *
+ * @return uint32_t - CRC (in the low 8 or 16 bits for the narrower kinds)
+ */
+uint32_t can_interact_e2e_crc(const struct can_interact_e2e *e2e, const enum can_interact_e2e_crc_type crc, const uint8_t *data, const size_t len);
+
+/**
+ * @brief can_interact_e2e_protect - adds or replaces protection of an identifier, resetting its counters and statistics
+ *
+ * @param struct can_interact_e2e* - initialised state
+ *
+ * @param const struct can_interact_e2e_config* - configuration
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if a field lies outside 8 bytes or counter and CRC overlap, ENOSPC if CAN_INTERACT_E2E_MAX_IDS identifiers are protected
+ */
+int can_interact_e2e_protect(struct can_interact_e2e *e2e, const struct can_interact_e2e_config *config);
+
+/**
+ * @brief can_interact_e2e_unprotect - removes protection of an identifier
+ *
+ * @param struct can_interact_e2e* - initialised state
+ *
+ * @param const canid_t - identifier
+ *
+ * @return int - error code
+ * Note: 0 on success, ENOENT if identifier is not protected
+ */
+int can_interact_e2e_unprotect(struct can_interact_e2e *e2e, const canid_t id);
+
+/**
+ * @brief can_interact_e2e_fill - writes next counter value and CRC into frame of a protected identifier
+ *
+ * @param struct can_interact_e2e* - initialised state
+ *
+ * @param struct can_frame* - frame with final payload (other than counter and CRC) to update
+ *
+ * @return int - error code
+ * Note: 0 on success, ENOENT if identifier is not protected, EINVAL if can_dlc is too short for the configured fields
+ */
+int can_interact_e2e_fill(struct can_interact_e2e *e2e, struct can_frame *frame);
+
+/**
+ * @brief can_interact_e2e_fill_frames - writes counter values and CRCs into many frames, leaving frames of unprotected identifiers untouched
+ *
+ * @param struct can_interact_e2e* - initialised state
+ *
+ * @param struct can_frame* - frames to update
+ *
+ * @param const size_t - number of frames
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if a protected frame is too short for its fields (frames before it have been filled)
+ */
+int can_interact_e2e_fill_frames(struct can_interact_e2e *e2e, struct can_frame *frames, const size_t len);
+
+/**
+ * @brief can_interact_e2e_check - verifies CRC and counter of received frame and updates statistics of its identifier
+ *
+ * @param struct can_interact_e2e* - initialised state
+ *
+ * @param const struct can_frame* - received frame
+ *
+ * @return enum can_interact_e2e_status - outcome, E2E_UNPROTECTED for identifiers without configuration
+ */
+enum can_interact_e2e_status can_interact_e2e_check(struct can_interact_e2e *e2e, const struct can_frame *frame);
+
+/**
+ * @brief can_interact_e2e_check_frames - verifies many frames in order, e.g. a batch received by can_interact_get_frames or read from a log
+ *
+ * @param struct can_interact_e2e* - initialised state
+ *
+ * @param const struct can_interact_timed_frame* - frames
+ *
+ * @param const size_t - number of frames
+ *
+ * @param enum can_interact_e2e_status* - array to write outcome of each frame to, may be NULL
+ *
+ * @return size_t - number of frames which were E2E_REPEATED, E2E_WRONG_SEQUENCE or E2E_ERROR
+ */
+size_t can_interact_e2e_check_frames(struct can_interact_e2e *e2e, const struct can_interact_timed_frame *frames, const size_t len, enum can_interact_e2e_status *results);
+
+/**
+ * @brief can_interact_e2e_get_stats - getter for receive counters of an identifier
+ *
+ * @param const struct can_interact_e2e* - initialised state
+ *
+ * @param const canid_t - identifier
+ *
+ * @param struct can_interact_e2e_stats* - counters to write to
+ *
+ * @return int - error code
+ * Note: 0 on success, ENOENT if identifier is not protected
+ */
+int can_interact_e2e_get_stats(const struct can_interact_e2e *e2e, const canid_t id, struct can_interact_e2e_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_E2E_H */
@@ -0,0 +1,204 @@
+#ifndef CAN_INTERACT_E2E_HH
+#define CAN_INTERACT_E2E_HH
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <errno.h>
+
+#include "can_interact.hh"
+#include "can_interact_e2e.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact end-to-end protection
+ * For declarations for the native C library, see can_interact_e2e.h
+ */
+
+namespace can_interact {
+
+	class E2E {
+		/**
+		  * @brief E2E (class) - CRC and alive counter protection of identifiers, filling outgoing and verifying received frames
+		  */
+		private:
+			std::unique_ptr<can_interact_e2e> _e2e ;
+
+		public:
+			/**
+			  * @brief E2E (constructor) - builds CRC tables, no identifier is protected yet
+			  */
+			E2E() noexcept(false) ;
+
+			E2E(E2E&&) noexcept = default ;
+			E2E& operator=(E2E&&) noexcept = default ;
+
+			/**
+			  * @brief protect - adds or replaces protection of an identifier, resetting its counters and statistics
+			  * @param const can_interact_e2e_config& - configuration
+			  * @throws std::invalid_argument - if a field lies outside 8 bytes or counter and CRC overlap
+			  * @throws std::runtime_error - if CAN_INTERACT_E2E_MAX_IDS identifiers are protected
+			  */
+			void protect(const can_interact_e2e_config&) noexcept(false) ;
+
+			/**
+			  * @brief unprotect - removes protection of an identifier
+			  * @param const canid_t - identifier
+			  * @throws std::out_of_range - if identifier is not protected
+			  */
+			void unprotect(const canid_t) noexcept(false) ;
+
+			/**
+			  * @brief crc - computes CRC of buffer with the standard parameters of its kind
+			  * @param const can_interact_e2e_crc_type - kind of CRC
+			  * @param const std::uint8_t* - data
+			  * @param const std::size_t - length of data in bytes
+			  * @return std::uint32_t - CRC
+			  */
+			std::uint32_t crc(const can_interact_e2e_crc_type, const std::uint8_t*, const std::size_t) const noexcept ;
+
+			/**
+			  * @brief fill (overload) - writes next counter value and CRC into frame of a protected identifier
+			  * @param can_frame& - frame with final payload (other than counter and CRC)
+			  * @throws std::out_of_range - if identifier is not protected
+			  * @throws std::invalid_argument - if payload is too short for the configured fields
+			  */
+			void fill(can_frame&) noexcept(false) ;
+
+			/**
+			  * @brief fill (overload) - writes counter values and CRCs into many frames, leaving frames of unprotected identifiers untouched
+			  * @param std::vector<can_frame>& - frames
+			  * @throws std::invalid_argument - if a protected frame is too short for its fields
+			  */
+			void fill(std::vector<can_frame>&) noexcept(false) ;
+
+			/**
+			  * @brief check (overload) - verifies CRC and counter of received frame
+			  * @param const can_frame& - received frame
+			  * @return can_interact_e2e_status - outcome, E2E_UNPROTECTED for identifiers without configuration
+			  */
+			can_interact_e2e_status check(const can_frame&) noexcept ;
+
+			/**
+			  * @brief check (overload) - verifies many frames in order, e.g. read from a log
+			  * @param const std::vector<can_interact_timed_frame>& - frames
+			  * @return std::vector<can_interact_e2e_status> - outcome of each frame
+			  */
+			std::vector<can_interact_e2e_status> check(const std::vector<can_interact_timed_frame>&) noexcept(false) ;
+
+			/**
+			  * @brief verify - verifies batch received by CAN::frames in place, dropping frames which are repeated, out of sequence or corrupt
+			  * @param can_interact_timed_frame* - frames, compacted to the kept ones in their order
+			  * @param const std::size_t - number of frames
+			  * @return std::size_t - number of kept frames
+			  */
+			std::size_t verify(can_interact_timed_frame*, const std::size_t) noexcept ;
+
+			/**
+			  * @brief stats - getter for receive counters of an identifier
+			  * @param const canid_t - identifier
+			  * @return can_interact_e2e_stats - counters
+			  * @throws std::out_of_range - if identifier is not protected
+			  */
+			can_interact_e2e_stats stats(const canid_t) const noexcept(false) ;
+
+			/* Below are defaulted and deleted methods */
+			E2E(const E2E&) = delete ;
+			E2E& operator=(const E2E&) = delete ;
+	} ;
+
+}
+
+can_interact::E2E::E2E() noexcept(false) : _e2e{new can_interact_e2e}
+{
+	can_interact_e2e_init(this->_e2e.get()) ;
+}
+
+void can_interact::E2E::protect(const can_interact_e2e_config& config) noexcept(false)
+{
+	const int res = can_interact_e2e_protect(this->_e2e.get(), &config) ;
+	if(res == ENOSPC)
+	{
+		throw std::runtime_error(std::string{"At most "} + std::to_string(CAN_INTERACT_E2E_MAX_IDS) + " protected identifiers") ;
+	}
+	else if(res != 0)
+	{
+		throw std::invalid_argument(std::string{"Invalid field layout for id "} + std::to_string(config.id)) ;
+	}
+}
+
+void can_interact::E2E::unprotect(const canid_t id) noexcept(false)
+{
+	if(can_interact_e2e_unprotect(this->_e2e.get(), id) != 0)
+	{
+		throw std::out_of_range(std::string{"Id "} + std::to_string(id) + " is not protected") ;
+	}
+}
+
+std::uint32_t can_interact::E2E::crc(const can_interact_e2e_crc_type kind, const std::uint8_t* data, const std::size_t len) const noexcept
+{
+	return can_interact_e2e_crc(this->_e2e.get(), kind, data, len) ;
+}
+
+void can_interact::E2E::fill(can_frame& frame) noexcept(false)
+{
+	const int res = can_interact_e2e_fill(this->_e2e.get(), &frame) ;
+	if(res == ENOENT)
+	{
+		throw std::out_of_range(std::string{"Id "} + std::to_string(frame.can_id) + " is not protected") ;
+	}
+	else if(res != 0)
+	{
+		throw std::invalid_argument(std::string{"Payload of id "} + std::to_string(frame.can_id) + " too short for its E2E fields") ;
+	}
+}
+
+void can_interact::E2E::fill(std::vector<can_frame>& frames) noexcept(false)
+{
+	if(can_interact_e2e_fill_frames(this->_e2e.get(), frames.data(), frames.size()) != 0)
+	{
+		throw std::invalid_argument("Payload too short for its E2E fields") ;
+	}
+}
+
+can_interact_e2e_status can_interact::E2E::check(const can_frame& frame) noexcept
+{
+	return can_interact_e2e_check(this->_e2e.get(), &frame) ;
+}
+
+std::vector<can_interact_e2e_status> can_interact::E2E::check(const std::vector<can_interact_timed_frame>& frames) noexcept(false)
+{
+	std::vector<can_interact_e2e_status> results(frames.size()) ;
+	can_interact_e2e_check_frames(this->_e2e.get(), frames.data(), frames.size(), results.data()) ;
+	return results ;
+}
+
+std::size_t can_interact::E2E::verify(can_interact_timed_frame* frames, const std::size_t len) noexcept
+{
+	std::size_t kept = 0 ;
+	for(std::size_t i = 0 ; i < len ; ++i)
+	{
+		const can_interact_e2e_status status = can_interact_e2e_check(this->_e2e.get(), &frames[i].frame) ;
+		if(status != E2E_REPEATED && status != E2E_WRONG_SEQUENCE && status != E2E_ERROR)
+		{
+			frames[kept++] = frames[i] ;
+		}
+	}
+	return kept ;
+}
+
+can_interact_e2e_stats can_interact::E2E::stats(const canid_t id) const noexcept(false)
+{
+	can_interact_e2e_stats stats ;
+	if(can_interact_e2e_get_stats(this->_e2e.get(), id, &stats) != 0)
+	{
+		throw std::out_of_range(std::string{"Id "} + std::to_string(id) + " is not protected") ;
+	}
+	return stats ;
+}
+
+#endif // CAN_INTERACT_E2E_HH
@@ -0,0 +1,334 @@
+#define _GNU_SOURCE
+
+#include <unistd.h> /* syscalls */
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <errno.h>
+#include <net/if.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <linux/can.h>
+#include <linux/can/gw.h>
+
+#include "can_interact_gw.h"
+
+/**
+ * @brief C-style definitions of gateway routing functionality (can-gw rules over rtnetlink, userspace forwarding)
+ * For definitions for the CXX API, see can_interact_gw.hh
+ */
+
+#define GW_MSG_MAX_LEN 1024u /* request: header, rtcanmsg and every attribute of a rule fit comfortably */
+#define GW_RECV_MAX_LEN 32768u /* dump replies carry several rules per datagram */
+
+static const int _p_can_interact_gw_mod_attrs[CGW_MOD_FUNCS] = { CGW_MOD_AND, CGW_MOD_OR, CGW_MOD_XOR, CGW_MOD_SET };
+
+/**
+ * @brief _p_can_interact_gw_put - INTERNAL METHOD. appends attribute to netlink message
+ * @param struct nlmsghdr* - message (nlmsg_len is advanced)
+ * @param const unsigned short - attribute type
+ * @param const void* - payload
+ * @param const size_t - length of payload
+ */
+static void _p_can_interact_gw_put(struct nlmsghdr *msg, const unsigned short type, const void *data, const size_t len)
+{
+	struct rtattr *attr = (struct rtattr*)((uint8_t*)msg + NLMSG_ALIGN(msg->nlmsg_len));
+
+	attr->rta_type = type;
+	attr->rta_len = (unsigned short)RTA_LENGTH(len);
+	memcpy(RTA_DATA(attr), data, len);
+	msg->nlmsg_len = NLMSG_ALIGN(msg->nlmsg_len) + (uint32_t)RTA_ALIGN(attr->rta_len);
+}
+
+/**
+ * @brief _p_can_interact_gw_start - INTERNAL METHOD. writes netlink and can-gw headers of request
+ * @param struct nlmsghdr* - message buffer (at least GW_MSG_MAX_LEN bytes)
+ * @param const uint16_t - message type (RTM_NEWROUTE, RTM_DELROUTE, RTM_GETROUTE)
+ * @param const uint16_t - netlink flags
+ * @param const uint16_t - can-gw flags (CGW_FLAGS_CAN_*)
+ */
+static void _p_can_interact_gw_start(struct nlmsghdr *msg, const uint16_t type, const uint16_t nl_flags, const uint16_t gw_flags)
+{
+	struct rtcanmsg *rtcan;
+
+	memset(msg, 0, GW_MSG_MAX_LEN);
+	msg->nlmsg_len = NLMSG_LENGTH(sizeof(struct rtcanmsg));
+	msg->nlmsg_type = type;
+	msg->nlmsg_flags = nl_flags;
+	rtcan = (struct rtcanmsg*)NLMSG_DATA(msg);
+	rtcan->can_family = AF_CAN;
+	rtcan->gwtype = CGW_TYPE_CAN_CAN;
+	rtcan->flags = gw_flags;
+}
+
+/**
+ * @brief _p_can_interact_gw_put_rule - INTERNAL METHOD. appends every attribute describing rule
+ * @param struct nlmsghdr* - message
+ * @param const struct can_interact_gw_rule* - rule
+ */
+static void _p_can_interact_gw_put_rule(struct nlmsghdr *msg, const struct can_interact_gw_rule *rule)
+{
+	size_t i;
+
+	for (i = 0; i < CGW_MOD_FUNCS; ++i) {
+		if (rule->mods[i].modtype != 0) {
+			_p_can_interact_gw_put(msg, (unsigned short)_p_can_interact_gw_mod_attrs[i], &rule->mods[i], CGW_MODATTR_LEN);
+		}
+	}
+	if (rule->checksums & CAN_INTERACT_GW_CS_XOR) {
+		_p_can_interact_gw_put(msg, CGW_CS_XOR, &rule->csum_xor, CGW_CS_XOR_LEN);
+	}
+	if (rule->checksums & CAN_INTERACT_GW_CS_CRC8) {
+		_p_can_interact_gw_put(msg, CGW_CS_CRC8, &rule->csum_crc8, CGW_CS_CRC8_LEN);
+	}
+	if (rule->mod_uid != 0) {
+		_p_can_interact_gw_put(msg, CGW_MOD_UID, &rule->mod_uid, sizeof(uint32_t));
+	}
+	if (rule->limit_hops != 0) {
+		_p_can_interact_gw_put(msg, CGW_LIM_HOPS, &rule->limit_hops, sizeof(uint8_t));
+	}
+	_p_can_interact_gw_put(msg, CGW_FILTER, &rule->filter, sizeof(struct can_filter));
+	_p_can_interact_gw_put(msg, CGW_SRC_IF, &rule->src_ifindex, sizeof(uint32_t));
+	_p_can_interact_gw_put(msg, CGW_DST_IF, &rule->dst_ifindex, sizeof(uint32_t));
+}
+
+/**
+ * @brief _p_can_interact_gw_request - INTERNAL METHOD. sends request and waits for kernel's acknowledgement
+ * @param struct nlmsghdr* - message (NLM_F_ACK is added)
+ * @param const int* - rtnetlink socket descriptor
+ * @return int - error code, 0 on success, errno value otherwise (as reported by kernel)
+ */
+static int _p_can_interact_gw_request(struct nlmsghdr *msg, const int *socket)
+{
+	uint64_t buf[GW_MSG_MAX_LEN / sizeof(uint64_t)];
+	struct nlmsghdr *reply;
+	ssize_t len;
+
+	msg->nlmsg_flags |= NLM_F_REQUEST | NLM_F_ACK;
+	if (send(*socket, msg, msg->nlmsg_len, 0) != (ssize_t)msg->nlmsg_len) {
+		return (int)errno;
+	}
+	for (;;) {
+		len = recv(*socket, buf, sizeof(buf), 0);
+		if (len < 0) {
+			return (int)errno;
+		}
+		for (reply = (struct nlmsghdr*)buf; NLMSG_OK(reply, (unsigned int)len); reply = NLMSG_NEXT(reply, len)) {
+			if (reply->nlmsg_type == NLMSG_ERROR) {
+				return -((struct nlmsgerr*)NLMSG_DATA(reply))->error; /* 0 is the acknowledgement */
+			}
+		}
+	}
+}
+
+/**
+ * @brief _p_can_interact_gw_parse - INTERNAL METHOD. converts dumped route message back into rule
+ * @param const struct nlmsghdr* - RTM_NEWROUTE message
+ * @param struct can_interact_gw_rule* - rule to write to
+ */
+static void _p_can_interact_gw_parse(const struct nlmsghdr *msg, struct can_interact_gw_rule *rule)
+{
+	const struct rtcanmsg *rtcan = (const struct rtcanmsg*)NLMSG_DATA(msg);
+	const struct rtattr *attr;
+	int len = (int)msg->nlmsg_len - (int)NLMSG_LENGTH(sizeof(struct rtcanmsg));
+	size_t i;
+
+	memset(rule, 0, sizeof(struct can_interact_gw_rule));
+	rule->flags = rtcan->flags;
+	for (attr = (const struct rtattr*)((const uint8_t*)rtcan + NLMSG_ALIGN(sizeof(struct rtcanmsg))); RTA_OK(attr, len); len -= (int)RTA_ALIGN(attr->rta_len), attr = (const struct rtattr*)((const uint8_t*)attr + RTA_ALIGN(attr->rta_len))) {
+		const void *data = RTA_DATA(attr);
+		switch (attr->rta_type) {
+			case CGW_MOD_AND:
+			case CGW_MOD_OR:
+			case CGW_MOD_XOR:
+			case CGW_MOD_SET:
+				for (i = 0; i < CGW_MOD_FUNCS; ++i) {
+					if (_p_can_interact_gw_mod_attrs[i] == attr->rta_type) {
+						memcpy(&rule->mods[i], data, CGW_MODATTR_LEN);
+					}
+				}
+				break;
+			case CGW_CS_XOR:
+				memcpy(&rule->csum_xor, data, CGW_CS_XOR_LEN);
+				rule->checksums |= CAN_INTERACT_GW_CS_XOR;
+				break;
+			case CGW_CS_CRC8:
+				memcpy(&rule->csum_crc8, data, CGW_CS_CRC8_LEN);
+				rule->checksums |= CAN_INTERACT_GW_CS_CRC8;
+				break;
+			case CGW_HANDLED:
+				memcpy(&rule->handled, data, sizeof(uint32_t));
+				break;
+			case CGW_DROPPED:
+				memcpy(&rule->dropped, data, sizeof(uint32_t));
+				break;
+			case CGW_DELETED:
+				memcpy(&rule->deleted, data, sizeof(uint32_t));
+				break;
+			case CGW_SRC_IF:
+				memcpy(&rule->src_ifindex, data, sizeof(uint32_t));
+				break;
+			case CGW_DST_IF:
+				memcpy(&rule->dst_ifindex, data, sizeof(uint32_t));
+				break;
+			case CGW_FILTER:
+				memcpy(&rule->filter, data, sizeof(struct can_filter));
+				break;
+			case CGW_LIM_HOPS:
+				memcpy(&rule->limit_hops, data, sizeof(uint8_t));
+				break;
+			case CGW_MOD_UID:
+				memcpy(&rule->mod_uid, data, sizeof(uint32_t));
+				break;
+			default: /* CAN FD modifications are not represented */
+				break;
+		}
+	}
+}
+
+int can_interact_gw_rule_init(struct can_interact_gw_rule *rule, const char *src_device, const char *dst_device)
+{
+	memset(rule, 0, sizeof(struct can_interact_gw_rule));
+	rule->src_ifindex = if_nametoindex(src_device);
+	rule->dst_ifindex = if_nametoindex(dst_device);
+	return rule->src_ifindex == 0 || rule->dst_ifindex == 0 ? ENODEV : 0;
+}
+
+void can_interact_gw_crc8_table(const uint8_t polynomial, uint8_t *table)
+{
+	unsigned int i, bit;
+	uint8_t crc;
+
+	for (i = 0; i < 256u; ++i) {
+		crc = (uint8_t)i;
+		for (bit = 0; bit < 8u; ++bit) {
+			crc = (uint8_t)((crc & 0x80u) ? (crc << 1) ^ polynomial : crc << 1);
+		}
+		table[i] = crc;
+	}
+}
+
+int can_interact_gw_init(int *s)
+{
+	struct sockaddr_nl addr;
+
+	*s = socket(AF_NETLINK, SOCK_RAW, NETLINK_ROUTE);
+	if (*s == -1) {
+		return (int)errno;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.nl_family = AF_NETLINK; /* kernel assigns port id */
+	if (bind(*s, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+		return (int)errno;
+	}
+	return 0;
+}
+
+int can_interact_gw_add(const struct can_interact_gw_rule *rule, const int *socket)
+{
+	uint64_t buf[GW_MSG_MAX_LEN / sizeof(uint64_t)];
+	struct nlmsghdr *msg = (struct nlmsghdr*)buf;
+
+	_p_can_interact_gw_start(msg, RTM_NEWROUTE, NLM_F_CREATE | NLM_F_EXCL, rule->flags);
+	_p_can_interact_gw_put_rule(msg, rule);
+	return _p_can_interact_gw_request(msg, socket);
+}
+
+int can_interact_gw_remove(const struct can_interact_gw_rule *rule, const int *socket)
+{
+	uint64_t buf[GW_MSG_MAX_LEN / sizeof(uint64_t)];
+	struct nlmsghdr *msg = (struct nlmsghdr*)buf;
+
+	if (rule->src_ifindex == 0 || rule->dst_ifindex == 0) { /* the kernel reads two zero indices as flush */
+		return ENODEV;
+	}
+	_p_can_interact_gw_start(msg, RTM_DELROUTE, 0, rule->flags);
+	_p_can_interact_gw_put_rule(msg, rule);
+	return _p_can_interact_gw_request(msg, socket);
+}
+
+int can_interact_gw_flush(const int *socket)
+{
+	uint64_t buf[GW_MSG_MAX_LEN / sizeof(uint64_t)];
+	struct nlmsghdr *msg = (struct nlmsghdr*)buf;
+	const uint32_t any = 0;
+
+	_p_can_interact_gw_start(msg, RTM_DELROUTE, 0, 0);
+	_p_can_interact_gw_put(msg, CGW_SRC_IF, &any, sizeof(uint32_t));
+	_p_can_interact_gw_put(msg, CGW_DST_IF, &any, sizeof(uint32_t));
+	return _p_can_interact_gw_request(msg, socket);
+}
+
+int can_interact_gw_list(struct can_interact_gw_rule *rules, const size_t len, size_t *count, const int *socket)
+{
+	uint64_t req[GW_MSG_MAX_LEN / sizeof(uint64_t)];
+	uint64_t buf[GW_RECV_MAX_LEN / sizeof(uint64_t)];
+	struct nlmsghdr *msg = (struct nlmsghdr*)req;
+	struct nlmsghdr *reply;
+	ssize_t received;
+
+	*count = 0;
+	_p_can_interact_gw_start(msg, RTM_GETROUTE, NLM_F_REQUEST | NLM_F_DUMP, 0);
+	if (send(*socket, msg, msg->nlmsg_len, 0) != (ssize_t)msg->nlmsg_len) {
+		return (int)errno;
+	}
+	for (;;) {
+		received = recv(*socket, buf, sizeof(buf), 0);
+		if (received < 0) {
+			return (int)errno;
+		}
+		for (reply = (struct nlmsghdr*)buf; NLMSG_OK(reply, (unsigned int)received); reply = NLMSG_NEXT(reply, received)) {
+			if (reply->nlmsg_type == NLMSG_DONE) {
+				return 0;
+			} else if (reply->nlmsg_type == NLMSG_ERROR) {
+				return -((struct nlmsgerr*)NLMSG_DATA(reply))->error;
+			} else if (reply->nlmsg_type == RTM_NEWROUTE && reply->nlmsg_len >= NLMSG_LENGTH(sizeof(struct rtcanmsg))
+					&& ((struct rtcanmsg*)NLMSG_DATA(reply))->can_family == AF_CAN) { /* without can-gw loaded, the kernel dumps other families' routes instead */
+				if (*count < len) {
+					_p_can_interact_gw_parse(reply, &rules[*count]);
+				}
+				++*count;
+			}
+		}
+	}
+}
+
+int can_interact_gw_forward(const int *src_socket, const int *dst_socket, const can_interact_gw_handler handler, void *context, size_t *forwarded)
+{
+	struct can_interact_timed_frame received[CAN_INTERACT_MAX_BATCH];
+	struct can_frame kept[CAN_INTERACT_MAX_BATCH];
+	size_t n, i, len, done, sent;
+	int res;
+
+	if (forwarded != NULL) {
+		*forwarded = 0;
+	}
+	res = can_interact_get_frames(received, CAN_INTERACT_MAX_BATCH, &n, src_socket);
+	if (res != 0) {
+		return res;
+	}
+	len = 0;
+	for (i = 0; i < n; ++i) {
+		if (handler == NULL || handler(&received[i].frame, context) != 0) {
+			kept[len++] = received[i].frame;
+		}
+	}
+	for (done = 0; done < len; done += sent) { /* a full transmit queue may accept only part of the batch */
+		res = can_interact_send_frames(kept + done, len - done, &sent, dst_socket);
+		if (res != 0) {
+			break;
+		}
+	}
+	if (forwarded != NULL) {
+		*forwarded = done;
+	}
+	return res;
+}
+
+int can_interact_gw_fini(const int *socket)
+{
+	return close(*socket) == 0 ? 0 : (int)errno;
+}
@@ -0,0 +1,181 @@
+#ifndef CAN_INTERACT_GW_H
+#define CAN_INTERACT_GW_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/can.h>
+#include <linux/can/gw.h>
+
+#include "can_interact.h"
+
+/**
+ * @brief C-style CAN gateway routing, both in-kernel (can-gw rules over rtnetlink) and as a userspace fallback
+ * Kernel rules copy (and optionally modify) frames between two interfaces without any userspace involvement
+ * The fallback forwarder moves frames in batches for routing the kernel cannot express (e.g. rewrites depending on payload)
+ * Kernel rules require the can-gw module and CAP_NET_ADMIN
+ * For the CXX API, see can_interact_gw.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+enum can_interact_gw_op {
+	/**
+	 * @brief enum can_interact_gw_op - modification functions of a rule, applied in this order
+	 * GW_MOD_AND clears bits, GW_MOD_OR sets bits, GW_MOD_XOR toggles bits, GW_MOD_SET replaces values
+	 */
+    GW_MOD_AND,
+    GW_MOD_OR,
+    GW_MOD_XOR,
+    GW_MOD_SET
+};
+
+#define CAN_INTERACT_GW_CS_XOR 0x01u /* rule carries XOR checksum update */
+#define CAN_INTERACT_GW_CS_CRC8 0x02u /* rule carries CRC8 checksum update */
+
+struct can_interact_gw_rule {
+	/**
+	 * @brief struct can_interact_gw_rule - kernel routing rule from one interface to another
+	 * mods are indexed by can_interact_gw_op, their modtype (CGW_MOD_ID / CGW_MOD_DLC / CGW_MOD_DATA) selects the fields affected, 0 leaves the function unused
+	 * Checksums are calculated after modifications, negative indices count from the end of the payload
+	 */
+	uint32_t src_ifindex;
+	uint32_t dst_ifindex;
+	struct can_filter filter; /* applied on source interface, can_mask 0 passes everything */
+	uint16_t flags; /* CGW_FLAGS_CAN_* */
+	uint8_t limit_hops; /* 0 uses module's max_hops */
+	uint8_t checksums; /* CAN_INTERACT_GW_CS_* */
+	uint32_t mod_uid; /* non-zero identifies rule for updating its modifications in place */
+	struct cgw_frame_mod mods[CGW_MOD_FUNCS];
+	struct cgw_csum_xor csum_xor;
+	struct cgw_csum_crc8 csum_crc8;
+	uint32_t handled; /* reported by can_interact_gw_list: frames routed */
+	uint32_t dropped; /* reported by can_interact_gw_list: frames failed to send */
+	uint32_t deleted; /* reported by can_interact_gw_list: frames discarded by hop limit */
+};
+
+/**
+ * @brief can_interact_gw_handler - userspace forwarding handler, may modify frame in place
+ * @return int - non-zero to forward frame, 0 to drop it
+ */
+typedef int (*can_interact_gw_handler)(struct can_frame *frame, void *context);
+
+/**
+ * @brief can_interact_gw_rule_init - clears rule and sets its interfaces
+ *
+ * @param struct can_interact_gw_rule* - rule to initialise
+ *
+ * @param const char* - name of source interface
+ *
+ * @param const char* - name of destination interface
+ *
+ * @return int - error code
+ * Note: 0 on success, ENODEV if an interface does not exist
+ */
+int can_interact_gw_rule_init(struct can_interact_gw_rule *rule, const char *src_device, const char *dst_device);
+
+/**
+ * @brief can_interact_gw_crc8_table - fills lookup table of CRC8 checksum for polynomial (MSB first), as required by csum_crc8.crctab
+ *
+ * @param const uint8_t - generator polynomial (e.g. 0x1D for SAE J1850)
+ *
+ * @param uint8_t* - table of 256 entries to fill
+ */
+void can_interact_gw_crc8_table(const uint8_t polynomial, uint8_t *table);
+
+/**
+ * @brief can_interact_gw_init - opens rtnetlink socket to manage kernel rules on
+ *
+ * @param int* - pointer to variable to initialise as socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_gw_init(int *socket);
+
+/**
+ * @brief can_interact_gw_add - installs rule in kernel (or, given a rule with a known mod_uid, updates its modifications)
+ *
+ * @param const struct can_interact_gw_rule* - rule
+ *
+ * @param const int* - rtnetlink socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes (e.g. EPERM without CAP_NET_ADMIN, EOPNOTSUPP without can-gw module)
+ */
+int can_interact_gw_add(const struct can_interact_gw_rule *rule, const int *socket);
+
+/**
+ * @brief can_interact_gw_remove - removes kernel rule matching interfaces, filter, flags, modifications and checksums of given rule
+ *
+ * @param const struct can_interact_gw_rule* - rule (as added or as listed)
+ *
+ * @param const int* - rtnetlink socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if no rule matched, for other non-zero values refer to errno codes
+ */
+int can_interact_gw_remove(const struct can_interact_gw_rule *rule, const int *socket);
+
+/**
+ * @brief can_interact_gw_flush - removes all kernel rules
+ *
+ * @param const int* - rtnetlink socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_gw_flush(const int *socket);
+
+/**
+ * @brief can_interact_gw_list - lists kernel rules including their counters
+ *
+ * @param struct can_interact_gw_rule* - array to write rules to (may be NULL if len is 0)
+ *
+ * @param const size_t - capacity of array
+ *
+ * @param size_t* - pointer to write total number of rules to (may exceed len, in which case only len rules were written)
+ *
+ * @param const int* - rtnetlink socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_gw_list(struct can_interact_gw_rule *rules, const size_t len, size_t *count, const int *socket);
+
+/**
+ * @brief can_interact_gw_forward - forwards one batch of frames from source to destination socket (run in a loop on one thread)
+ * Receives everything queued with one syscall, passes each frame through handler and sends those kept with one syscall
+ *
+ * @param const int* - CAN socket descriptor to receive from (see can_interact_init, can_interact_filter)
+ *
+ * @param const int* - CAN socket descriptor to send to
+ *
+ * @param const can_interact_gw_handler - handler deciding on and modifying frames, NULL forwards all frames unchanged
+ *
+ * @param void* - context passed to handler
+ *
+ * @param size_t* - pointer to write number of forwarded frames to, may be NULL
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes of receiving or sending (frames not yet sent are dropped)
+ */
+int can_interact_gw_forward(const int *src_socket, const int *dst_socket, const can_interact_gw_handler handler, void *context, size_t *forwarded);
+
+/**
+ * @brief can_interact_gw_fini - closes rtnetlink socket (installed rules remain in place)
+ *
+ * @param const int* - rtnetlink socket descriptor
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_gw_fini(const int *socket);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_GW_H */
@@ -0,0 +1,195 @@
+#ifndef CAN_INTERACT_GW_HH
+#define CAN_INTERACT_GW_HH
+#pragma once
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <stdexcept>
+#include <cstddef>
+
+#include <unistd.h>
+
+#include "can_interact.hh"
+#include "can_interact_gw.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact gateway routing functionality
+ * For declarations for the native C library, see can_interact_gw.h
+ */
+
+namespace can_interact {
+
+	class Gateway {
+		/**
+		  * @brief Gateway (class) - manages kernel can-gw rules through an rtnetlink connection
+		  * Rules outlive the connection, remove or flush them explicitly
+		  */
+		private:
+			int _socket ;
+
+		public:
+			/**
+			  * @brief Gateway (constructor) - opens rtnetlink connection
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			Gateway() noexcept(false) ;
+
+			/**
+			  * @brief add - installs rule in kernel
+			  * @param const can_interact_gw_rule& - rule (see can_interact::gw_rule)
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void add(const can_interact_gw_rule&) const noexcept(false) ;
+
+			/**
+			  * @brief remove - removes kernel rule equal to given one
+			  * @param const can_interact_gw_rule& - rule (as added or as listed)
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void remove(const can_interact_gw_rule&) const noexcept(false) ;
+
+			/**
+			  * @brief flush - removes all kernel rules
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void flush() const noexcept(false) ;
+
+			/**
+			  * @brief rules - lists kernel rules including their handled / dropped / deleted counters
+			  * @return std::vector<can_interact_gw_rule> - rules
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::vector<can_interact_gw_rule> rules() const noexcept(false) ;
+
+			/**
+			  * @brief ~Gateway (destructor) - closes rtnetlink connection
+			  */
+			~Gateway() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			Gateway(const Gateway&) = delete ;
+			Gateway& operator=(const Gateway&) = delete ;
+	} ;
+
+	/**
+	  * @brief gw_rule - creates empty rule (copying everything) between two interfaces
+	  * @param const std::string& - name of source interface
+	  * @param const std::string& - name of destination interface
+	  * @return can_interact_gw_rule - rule, set filter / mods / csum_* fields before adding
+	  * @throws std::invalid_argument - if an interface does not exist
+	  */
+	can_interact_gw_rule gw_rule(const std::string&, const std::string&) noexcept(false) ;
+
+	/**
+	  * @brief forward - forwards one batch of frames between CAN connections in userspace, for routing kernel rules cannot express
+	  * @param const CAN& - connection to receive from
+	  * @param const CAN& - connection to send to
+	  * @param const std::function<bool(can_frame&)>& - handler, may modify frame, returns whether to forward it
+	  * @return std::size_t - number of frames forwarded
+	  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+	  */
+	std::size_t forward(const CAN&, const CAN&, const std::function<bool(can_frame&)>&) noexcept(false) ;
+
+	/**
+	  * @brief _gw_trampoline - INTERNAL METHOD. forwards C forwarding handler calls to std::function handler
+	  */
+	int _gw_trampoline(can_frame*, void*) ;
+
+}
+
+can_interact::Gateway::Gateway() noexcept(false)
+{
+	const int res = can_interact_gw_init(&this->_socket) ;
+	if(res != 0)
+	{
+		if(this->_socket != -1)
+		{
+			close(this->_socket) ;
+		}
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::Gateway::add(const can_interact_gw_rule& rule) const noexcept(false)
+{
+	const int res = can_interact_gw_add(&rule, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::Gateway::remove(const can_interact_gw_rule& rule) const noexcept(false)
+{
+	const int res = can_interact_gw_remove(&rule, &this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::Gateway::flush() const noexcept(false)
+{
+	const int res = can_interact_gw_flush(&this->_socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+std::vector<can_interact_gw_rule> can_interact::Gateway::rules() const noexcept(false)
+{
+	std::vector<can_interact_gw_rule> rules(8) ;
+	std::size_t count ;
+	for(;;)
+	{
+		const int res = can_interact_gw_list(rules.data(), rules.size(), &count, &this->_socket) ;
+		if(res != 0)
+		{
+			throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+		}
+		if(count <= rules.size())
+		{
+			break ;
+		}
+		rules.resize(count) ; // rules were added in the meantime if this repeats
+	}
+	rules.resize(count) ;
+	return rules ;
+}
+
+can_interact::Gateway::~Gateway() noexcept
+{
+	can_interact_gw_fini(&this->_socket) ;
+}
+
+can_interact_gw_rule can_interact::gw_rule(const std::string& src, const std::string& dst) noexcept(false)
+{
+	can_interact_gw_rule rule ;
+	if(can_interact_gw_rule_init(&rule, src.c_str(), dst.c_str()) != 0)
+	{
+		throw std::invalid_argument(std::string{"No such interface: "} + src + " or " + dst) ;
+	}
+	return rule ;
+}
+
+int can_interact::_gw_trampoline(can_frame* frame, void* context)
+{
+	return (*static_cast<const std::function<bool(can_frame&)>*>(context))(*frame) ? 1 : 0 ;
+}
+
+std::size_t can_interact::forward(const CAN& src, const CAN& dst, const std::function<bool(can_frame&)>& handler) noexcept(false)
+{
+	const int src_socket = src.socket() ;
+	const int dst_socket = dst.socket() ;
+	std::size_t forwarded ;
+	const int res = can_interact_gw_forward(&src_socket, &dst_socket, handler ? &can_interact::_gw_trampoline : nullptr, const_cast<std::function<bool(can_frame&)>*>(&handler), &forwarded) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return forwarded ;
+}
+
+#endif // CAN_INTERACT_GW_HH
@@ -0,0 +1,135 @@
+#define _DEFAULT_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "can_interact_hist.h"
+
+/**
+ * @brief C-style definitions of the latency histogram
+ * For definitions for the CXX API, see can_interact_hist.hh
+ */
+
+#define CAN_INTERACT_HIST_HALF (CAN_INTERACT_HIST_SUB_BUCKETS / 2)
+
+/**
+ * @brief _p_can_interact_hist_index - INTERNAL METHOD. bucket of value
+ * A value of bit length CAN_INTERACT_HIST_SUB_BITS + e (e > 0) is shifted right by e into [HALF, SUB_BUCKETS), giving bucket HALF * e + (value >> e)
+ * @param const uint64_t - value
+ * @return size_t - bucket index
+ */
+static size_t _p_can_interact_hist_index(const uint64_t value)
+{
+	uint64_t rest = value >> CAN_INTERACT_HIST_SUB_BITS;
+	unsigned int shift = 0;
+
+	if (rest >> 32) {
+		shift += 32;
+		rest >>= 32;
+	}
+	if (rest >> 16) {
+		shift += 16;
+		rest >>= 16;
+	}
+	if (rest >> 8) {
+		shift += 8;
+		rest >>= 8;
+	}
+	if (rest >> 4) {
+		shift += 4;
+		rest >>= 4;
+	}
+	if (rest >> 2) {
+		shift += 2;
+		rest >>= 2;
+	}
+	if (rest >> 1) {
+		shift += 1;
+		rest >>= 1;
+	}
+	shift += (unsigned int)rest; /* bit length of value beyond CAN_INTERACT_HIST_SUB_BITS */
+	return (size_t)CAN_INTERACT_HIST_HALF * shift + (size_t)(value >> shift);
+}
+
+/**
+ * @brief _p_can_interact_hist_highest - INTERNAL METHOD. largest value falling into bucket
+ * @param const size_t - bucket index
+ * @return uint64_t - value
+ */
+static uint64_t _p_can_interact_hist_highest(const size_t index)
+{
+	size_t shift;
+
+	if (index < CAN_INTERACT_HIST_SUB_BUCKETS) {
+		return (uint64_t)index;
+	}
+	shift = index / CAN_INTERACT_HIST_HALF - 1;
+	return (((uint64_t)(index % CAN_INTERACT_HIST_HALF + CAN_INTERACT_HIST_HALF) + 1) << shift) - 1; /* wraps to UINT64_MAX in the last bucket */
+}
+
+void can_interact_hist_init(struct can_interact_hist *hist)
+{
+	memset(hist, 0, sizeof(struct can_interact_hist));
+	hist->min = ~(uint64_t)0;
+}
+
+void can_interact_hist_record(struct can_interact_hist *hist, const uint64_t value)
+{
+	++hist->counts[_p_can_interact_hist_index(value)];
+	++hist->total;
+	hist->sum += value;
+	if (value < hist->min) {
+		hist->min = value;
+	}
+	if (value > hist->max) {
+		hist->max = value;
+	}
+}
+
+void can_interact_hist_merge(struct can_interact_hist *hist, const struct can_interact_hist *other)
+{
+	size_t i;
+
+	for (i = 0; i < CAN_INTERACT_HIST_LEN; ++i) {
+		hist->counts[i] += other->counts[i];
+	}
+	hist->total += other->total;
+	hist->sum += other->sum;
+	if (other->min < hist->min) {
+		hist->min = other->min;
+	}
+	if (other->max > hist->max) {
+		hist->max = other->max;
+	}
+}
+
+uint64_t can_interact_hist_percentile(const struct can_interact_hist *hist, const double percentile)
+{
+	uint64_t rank, seen = 0, value;
+	size_t i;
+
+	if (hist->total == 0) {
+		return 0;
+	}
+	if (percentile >= 100.0) {
+		return hist->max;
+	}
+	rank = percentile <= 0.0 ? 1 : (uint64_t)(percentile / 100.0 * (double)hist->total + 0.999999);
+	if (rank == 0) {
+		rank = 1;
+	}
+	for (i = 0; i < CAN_INTERACT_HIST_LEN; ++i) {
+		seen += hist->counts[i];
+		if (seen >= rank) {
+			value = _p_can_interact_hist_highest(i);
+			return value < hist->max ? value : hist->max;
+		}
+	}
+	return hist->max;
+}
+
+double can_interact_hist_mean(const struct can_interact_hist *hist)
+{
+	return hist->total == 0 ? 0.0 : (double)hist->sum / (double)hist->total;
+}
@@ -0,0 +1,84 @@
+#ifndef CAN_INTERACT_HIST_H
+#define CAN_INTERACT_HIST_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief C-style latency histogram in the manner of HdrHistogram, for latency percentiles without storing samples
+ * Values below CAN_INTERACT_HIST_SUB_BUCKETS are counted exactly. Larger values fall into log-linear buckets: every power of two range is split
+ * into CAN_INTERACT_HIST_SUB_BUCKETS / 2 equal sub-buckets, so a reported value is at most 1 / 64 (about 1.6%) above the recorded one
+ * over the whole uint64_t range, at a fixed size of about 30 KiB. Recording is a few shifts and an increment, with no allocation
+ * For the CXX API, see can_interact_hist.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CAN_INTERACT_HIST_SUB_BITS 7
+#define CAN_INTERACT_HIST_SUB_BUCKETS (1u << CAN_INTERACT_HIST_SUB_BITS)
+#define CAN_INTERACT_HIST_LEN (CAN_INTERACT_HIST_SUB_BUCKETS + (64 - CAN_INTERACT_HIST_SUB_BITS) * (CAN_INTERACT_HIST_SUB_BUCKETS / 2))
+
+struct can_interact_hist {
+	/**
+	 * @brief struct can_interact_hist - bucket counts and exact summary values, see can_interact_hist_init
+	 */
+	uint64_t counts[CAN_INTERACT_HIST_LEN];
+	uint64_t total; /* recorded values */
+	uint64_t min;
+	uint64_t max;
+	uint64_t sum;
+};
+
+/**
+ * @brief can_interact_hist_init - clears histogram
+ *
+ * @param struct can_interact_hist* - histogram to initialise
+ */
+void can_interact_hist_init(struct can_interact_hist *hist);
+
+/**
+ * @brief can_interact_hist_record - counts value
+ *
+ * @param struct can_interact_hist* - histogram
+ *
+ * @param const uint64_t - value, e.g. latency in nanoseconds
+ */
+void can_interact_hist_record(struct can_interact_hist *hist, const uint64_t value);
+
+/**
+ * @brief can_interact_hist_merge - adds counts of one histogram to another, e.g. of per-thread histograms
+ *
+ * @param struct can_interact_hist* - histogram to add to
+ *
+ * @param const struct can_interact_hist* - histogram to add
+ */
+void can_interact_hist_merge(struct can_interact_hist *hist, const struct can_interact_hist *other);
+
+/**
+ * @brief can_interact_hist_percentile - value below or at which the given share of recorded values lies
+ *
+ * @param const struct can_interact_hist* - histogram
+ *
+ * @param const double - percentile from 0 to 100, e.g. 99.9
+ *
+ * @return uint64_t - highest value equivalent to the bucket holding the percentile (capped at the maximum), 0 if the histogram is empty
+ */
+uint64_t can_interact_hist_percentile(const struct can_interact_hist *hist, const double percentile);
+
+/**
+ * @brief can_interact_hist_mean - exact mean of recorded values
+ *
+ * @param const struct can_interact_hist* - histogram
+ *
+ * @return double - mean, 0 if the histogram is empty
+ */
+double can_interact_hist_mean(const struct can_interact_hist *hist);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_HIST_H */
@@ -0,0 +1,122 @@
+#ifndef CAN_INTERACT_HIST_HH
+#define CAN_INTERACT_HIST_HH
+#pragma once
+
+#include <memory>
+#include <cstdint>
+
+#include "can_interact_hist.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact latency histogram
+ * For declarations for the native C library, see can_interact_hist.h
+ */
+
+namespace can_interact {
+
+	class Histogram {
+		/**
+		  * @brief Histogram (class) - log-linear histogram reporting percentiles within about 1.6%
+		  */
+		private:
+			std::unique_ptr<can_interact_hist> _state ;
+
+		public:
+			/**
+			  * @brief Histogram (constructor) - creates empty histogram
+			  */
+			Histogram() noexcept(false) ;
+
+			Histogram(Histogram&&) noexcept = default ;
+			Histogram& operator=(Histogram&&) noexcept = default ;
+
+			/**
+			  * @brief record - counts value
+			  * @param const std::uint64_t - value, e.g. latency in nanoseconds
+			  */
+			void record(const std::uint64_t) noexcept ;
+
+			/**
+			  * @brief merge - adds counts of other histogram
+			  * @param const Histogram& - histogram to add
+			  */
+			void merge(const Histogram&) noexcept ;
+
+			/**
+			  * @brief reset - clears counts
+			  */
+			void reset() noexcept ;
+
+			/**
+			  * @brief percentile - value below or at which the given share of recorded values lies
+			  * @param const double - percentile from 0 to 100
+			  * @return std::uint64_t - value, 0 if empty
+			  */
+			std::uint64_t percentile(const double) const noexcept ;
+
+			/**
+			  * @brief mean - exact mean of recorded values
+			  * @return double - mean, 0 if empty
+			  */
+			double mean() const noexcept ;
+
+			/**
+			  * @brief count - number of recorded values
+			  * @return std::uint64_t - count
+			  */
+			std::uint64_t count() const noexcept ;
+
+			/**
+			  * @brief max - largest recorded value
+			  * @return std::uint64_t - value, 0 if empty
+			  */
+			std::uint64_t max() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			Histogram(const Histogram&) = delete ;
+			Histogram& operator=(const Histogram&) = delete ;
+	} ;
+
+}
+
+can_interact::Histogram::Histogram() noexcept(false) : _state{new can_interact_hist}
+{
+	can_interact_hist_init(this->_state.get()) ;
+}
+
+void can_interact::Histogram::record(const std::uint64_t value) noexcept
+{
+	can_interact_hist_record(this->_state.get(), value) ;
+}
+
+void can_interact::Histogram::merge(const Histogram& other) noexcept
+{
+	can_interact_hist_merge(this->_state.get(), other._state.get()) ;
+}
+
+void can_interact::Histogram::reset() noexcept
+{
+	can_interact_hist_init(this->_state.get()) ;
+}
+
+std::uint64_t can_interact::Histogram::percentile(const double percentile) const noexcept
+{
+	return can_interact_hist_percentile(this->_state.get(), percentile) ;
+}
+
+double can_interact::Histogram::mean() const noexcept
+{
+	return can_interact_hist_mean(this->_state.get()) ;
+}
+
+std::uint64_t can_interact::Histogram::count() const noexcept
+{
+	return this->_state->total ;
+}
+
+std::uint64_t can_interact::Histogram::max() const noexcept
+{
+	return this->_state->max ;
+}
+
+#endif // CAN_INTERACT_HIST_HH
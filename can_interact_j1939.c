@@ -0,0 +1,599 @@
+#define _DEFAULT_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <linux/can.h>
+
+#include "can_interact.h"
+#include "can_interact_j1939.h"
+
+/**
+ * @brief C-style definitions of SAE J1939 layer
+ * For definitions for the CXX API, see can_interact_j1939.hh
+ */
+
+#define J1939_TP_RTS 16
+#define J1939_TP_CTS 17
+#define J1939_TP_EOMA 19
+#define J1939_TP_BAM 32
+#define J1939_TP_ABORT 255
+
+#define J1939_ABORT_BUSY 1 /* already in one or more connection managed sessions and cannot support another */
+#define J1939_ABORT_TIMEOUT 3
+#define J1939_ABORT_BAD_SEQUENCE 7
+
+#define J1939_T1_MS 750 /* max gap between data packets */
+#define J1939_T2_MS 1250 /* max wait for data after a CTS / RTS */
+#define J1939_CLAIM_MS 250 /* contention period of an address claim */
+
+#define J1939_SESSION_FREE 0
+#define J1939_SESSION_LISTEN 1
+#define J1939_SESSION_OURS 2
+
+#define J1939_EMPTY_PGN 0xFFFFFFFFu
+
+int can_interact_j1939_decode_id(const canid_t id, struct can_interact_j1939_id *dest)
+{
+	if ((id & CAN_EFF_FLAG) == 0 || (id & (CAN_RTR_FLAG | CAN_ERR_FLAG)) != 0) {
+		return 1;
+	}
+	dest->priority = CAN_INTERACT_J1939_PRIORITY(id);
+	dest->sa = CAN_INTERACT_J1939_SA(id);
+	if (CAN_INTERACT_J1939_PF(id) < 240) { /* PDU1 - PS is destination address */
+		dest->pgn = (uint32_t)((id >> 8) & 0x3FF00u);
+		dest->da = CAN_INTERACT_J1939_PS(id);
+	} else { /* PDU2 - PS is group extension */
+		dest->pgn = (uint32_t)((id >> 8) & 0x3FFFFu);
+		dest->da = CAN_INTERACT_J1939_ADDR_GLOBAL;
+	}
+	return 0;
+}
+
+canid_t can_interact_j1939_encode_id(const struct can_interact_j1939_id *id)
+{
+	canid_t res;
+
+	res = ((canid_t)(id->priority & 0x7u) << 26) | ((canid_t)(id->pgn & 0x3FFFFu) << 8) | id->sa;
+	if (((id->pgn >> 8) & 0xFFu) < 240) {
+		res = (res & ~((canid_t)0xFFu << 8)) | ((canid_t)id->da << 8);
+	}
+	return res | CAN_EFF_FLAG;
+}
+
+/**
+ * @brief _p_can_interact_j1939_slot - INTERNAL METHOD. finds dispatch table slot of PGN (or the empty slot it would occupy)
+ * @param const struct can_interact_j1939* - J1939 state
+ * @param const uint32_t - PGN
+ * @return size_t - index of slot, CAN_INTERACT_J1939_MAX_HANDLERS if PGN is absent and table is full
+ */
+static size_t _p_can_interact_j1939_slot(const struct can_interact_j1939 *j, const uint32_t pgn)
+{
+	size_t i, idx;
+
+	idx = (size_t)((pgn ^ (pgn >> 8) ^ (pgn >> 16)) * 0x9E3779B1u) & (CAN_INTERACT_J1939_MAX_HANDLERS - 1);
+	for (i = 0; i < CAN_INTERACT_J1939_MAX_HANDLERS; ++i) {
+		if (j->handlers[idx].pgn == pgn || j->handlers[idx].pgn == J1939_EMPTY_PGN) {
+			return idx;
+		}
+		idx = (idx + 1) & (CAN_INTERACT_J1939_MAX_HANDLERS - 1);
+	}
+	return CAN_INTERACT_J1939_MAX_HANDLERS;
+}
+
+/**
+ * @brief _p_can_interact_j1939_dispatch - INTERNAL METHOD. hands complete message to registered (or fallback) handler
+ * @param struct can_interact_j1939* - J1939 state
+ * @param const struct can_interact_j1939_msg* - message
+ */
+static void _p_can_interact_j1939_dispatch(struct can_interact_j1939 *j, const struct can_interact_j1939_msg *msg)
+{
+	const size_t idx = _p_can_interact_j1939_slot(j, msg->id.pgn);
+
+	if (idx != CAN_INTERACT_J1939_MAX_HANDLERS && j->handlers[idx].handler != NULL) {
+		j->handlers[idx].handler(msg, j->handlers[idx].ctx);
+	} else if (j->fallback != NULL) {
+		j->fallback(msg, j->fallback_ctx);
+	}
+}
+
+/**
+ * @brief _p_can_interact_j1939_send - INTERNAL METHOD. sends 8 byte J1939 frame from our address
+ * @param const struct can_interact_j1939* - J1939 state
+ * @param const uint8_t - priority
+ * @param const uint32_t - PGN
+ * @param const uint8_t - source address
+ * @param const uint8_t - destination address
+ * @param const uint8_t* - 8 byte payload
+ * @return int - error code, 0 on success (or if state is passive), errno value otherwise
+ */
+static int _p_can_interact_j1939_send(const struct can_interact_j1939 *j, const uint8_t priority, const uint32_t pgn, const uint8_t sa, const uint8_t da, const uint8_t *payload)
+{
+	struct can_frame frame;
+	struct can_interact_j1939_id id;
+
+	if (j->socket == -1) {
+		return 0;
+	}
+	id.priority = priority;
+	id.pgn = pgn;
+	id.sa = sa;
+	id.da = da;
+	memset(&frame, 0, sizeof(frame));
+	frame.can_id = can_interact_j1939_encode_id(&id);
+	frame.can_dlc = 8;
+	memcpy(frame.data, payload, 8);
+	return can_interact_send_frame(&frame, &j->socket);
+}
+
+/**
+ * @brief _p_can_interact_j1939_send_claim - INTERNAL METHOD. sends address claimed message for our current address
+ * @param const struct can_interact_j1939* - J1939 state
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_j1939_send_claim(const struct can_interact_j1939 *j)
+{
+	uint8_t payload[8];
+	size_t i;
+
+	for (i = 0; i < 8; ++i) { /* NAME is transmitted little endian */
+		payload[i] = (uint8_t)(j->name >> (8 * i));
+	}
+	return _p_can_interact_j1939_send(j, 6, CAN_INTERACT_J1939_PGN_ADDRESS_CLAIMED, j->address, CAN_INTERACT_J1939_ADDR_GLOBAL, payload);
+}
+
+/**
+ * @brief _p_can_interact_j1939_send_cm - INTERNAL METHOD. sends transport protocol connection management frame for session
+ * @param const struct can_interact_j1939* - J1939 state
+ * @param const struct can_interact_j1939_session* - session (we are its receiver)
+ * @param const uint8_t - control byte
+ * @param const uint8_t - byte 1 (packet count / abort reason)
+ * @param const uint8_t - byte 2 (next packet / unused)
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_j1939_send_cm(const struct can_interact_j1939 *j, const struct can_interact_j1939_session *session, const uint8_t control, const uint8_t b1, const uint8_t b2)
+{
+	uint8_t payload[8];
+
+	payload[0] = control;
+	payload[1] = b1;
+	payload[2] = b2;
+	payload[3] = 0xFF;
+	payload[4] = 0xFF;
+	if (control == J1939_TP_EOMA) {
+		payload[1] = (uint8_t)(session->size & 0xFFu);
+		payload[2] = (uint8_t)(session->size >> 8);
+		payload[3] = session->packets;
+	}
+	payload[5] = (uint8_t)(session->pgn & 0xFFu);
+	payload[6] = (uint8_t)((session->pgn >> 8) & 0xFFu);
+	payload[7] = (uint8_t)((session->pgn >> 16) & 0xFFu);
+	return _p_can_interact_j1939_send(j, 7, CAN_INTERACT_J1939_PGN_TP_CM, session->da, session->sa, payload);
+}
+
+/**
+ * @brief _p_can_interact_j1939_send_cts - INTERNAL METHOD. grants next window of packets for session and arms T2
+ * @param struct can_interact_j1939* - J1939 state
+ * @param struct can_interact_j1939_session* - session (we are its receiver)
+ * @param const uint64_t - current time in milliseconds
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_j1939_send_cts(struct can_interact_j1939 *j, struct can_interact_j1939_session *session, const uint64_t now_ms)
+{
+	unsigned int window;
+
+	window = (unsigned int)session->packets - session->next_seq + 1u;
+	if (window > session->window_max) {
+		window = session->window_max;
+	}
+	session->window_end = (uint8_t)(session->next_seq + window - 1u);
+	session->deadline_ms = now_ms + J1939_T2_MS;
+	return _p_can_interact_j1939_send_cm(j, session, J1939_TP_CTS, (uint8_t)window, session->next_seq);
+}
+
+/**
+ * @brief _p_can_interact_j1939_find - INTERNAL METHOD. finds active session between two addresses
+ * @param const struct can_interact_j1939* - J1939 state
+ * @param const uint8_t - source (sending) address
+ * @param const uint8_t - destination address (CAN_INTERACT_J1939_ADDR_GLOBAL for BAM)
+ * @return int16_t - index of session, -1 if none
+ */
+static int16_t _p_can_interact_j1939_find(const struct can_interact_j1939 *j, const uint8_t sa, const uint8_t da)
+{
+	int16_t idx;
+
+	idx = da == CAN_INTERACT_J1939_ADDR_GLOBAL ? j->bam_by_sa[sa] : j->cmdt_by_sa[sa];
+	while (idx != -1 && j->sessions[idx].da != da) {
+		idx = j->sessions[idx].next;
+	}
+	return idx;
+}
+
+/**
+ * @brief _p_can_interact_j1939_release - INTERNAL METHOD. unlinks session from its chain and returns buffer to pool
+ * @param struct can_interact_j1939* - J1939 state
+ * @param const int16_t - index of session
+ */
+static void _p_can_interact_j1939_release(struct can_interact_j1939 *j, const int16_t idx)
+{
+	struct can_interact_j1939_session *session = &j->sessions[idx];
+	int16_t *link;
+
+	link = session->da == CAN_INTERACT_J1939_ADDR_GLOBAL ? &j->bam_by_sa[session->sa] : &j->cmdt_by_sa[session->sa];
+	while (*link != idx) {
+		link = &j->sessions[*link].next;
+	}
+	*link = session->next;
+	session->mode = J1939_SESSION_FREE;
+	session->next = j->free_head;
+	j->free_head = idx;
+}
+
+/**
+ * @brief _p_can_interact_j1939_acquire - INTERNAL METHOD. takes buffer from pool and links it into source address chain
+ * @param struct can_interact_j1939* - J1939 state
+ * @param const uint8_t - source address
+ * @param const uint8_t - destination address
+ * @return int16_t - index of session, -1 if pool is exhausted
+ */
+static int16_t _p_can_interact_j1939_acquire(struct can_interact_j1939 *j, const uint8_t sa, const uint8_t da)
+{
+	struct can_interact_j1939_session *session;
+	int16_t *head;
+	int16_t idx;
+
+	idx = j->free_head;
+	if (idx == -1) {
+		return -1;
+	}
+	session = &j->sessions[idx];
+	j->free_head = session->next;
+	head = da == CAN_INTERACT_J1939_ADDR_GLOBAL ? &j->bam_by_sa[sa] : &j->cmdt_by_sa[sa];
+	session->sa = sa;
+	session->da = da;
+	session->next = *head;
+	*head = idx;
+	return idx;
+}
+
+/**
+ * @brief _p_can_interact_j1939_ours - INTERNAL METHOD. whether frames to an address should be answered by us
+ * @param const struct can_interact_j1939* - J1939 state
+ * @param const uint8_t - destination address
+ * @return int - 1 if addressed to us and we're able to respond, 0 otherwise
+ */
+static int _p_can_interact_j1939_ours(const struct can_interact_j1939 *j, const uint8_t da)
+{
+	return j->socket != -1 && da == j->address && (j->claim_state == J1939_CLAIM_PENDING || j->claim_state == J1939_CLAIM_DONE);
+}
+
+/**
+ * @brief _p_can_interact_j1939_tp_cm - INTERNAL METHOD. handles transport protocol connection management frame
+ * @param struct can_interact_j1939* - J1939 state
+ * @param const struct can_interact_j1939_id* - decoded identifier
+ * @param const struct can_frame* - frame
+ * @param const uint64_t - current time in milliseconds
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_j1939_tp_cm(struct can_interact_j1939 *j, const struct can_interact_j1939_id *id, const struct can_frame *frame, const uint64_t now_ms)
+{
+	struct can_interact_j1939_session *session;
+	const uint8_t *d = frame->data;
+	uint16_t size;
+	int16_t idx;
+	int ours;
+
+	if (frame->can_dlc < 8) {
+		return 0;
+	}
+
+	switch (d[0]) {
+	case J1939_TP_RTS:
+	case J1939_TP_BAM: {
+		if (d[0] == J1939_TP_BAM && id->da != CAN_INTERACT_J1939_ADDR_GLOBAL) {
+			return 0;
+		}
+		ours = d[0] == J1939_TP_RTS && _p_can_interact_j1939_ours(j, id->da);
+		size = (uint16_t)(d[1] | (d[2] << 8));
+		if (size < 9 || size > CAN_INTERACT_J1939_MAX_LEN || d[3] != (size + 6) / 7) {
+			return 0; /* malformed announcement */
+		}
+		idx = _p_can_interact_j1939_find(j, id->sa, id->da);
+		if (idx != -1) { /* a new announcement supersedes an unfinished transfer */
+			++j->stats.transfers_aborted;
+			_p_can_interact_j1939_release(j, idx);
+		}
+		idx = _p_can_interact_j1939_acquire(j, id->sa, id->da);
+		if (idx == -1) {
+			++j->stats.transfers_dropped;
+			if (ours) {
+				struct can_interact_j1939_session refused;
+				refused.sa = id->sa;
+				refused.da = id->da;
+				refused.pgn = (uint32_t)d[5] | ((uint32_t)d[6] << 8) | ((uint32_t)d[7] << 16);
+				return _p_can_interact_j1939_send_cm(j, &refused, J1939_TP_ABORT, J1939_ABORT_BUSY, 0xFF);
+			}
+			return 0;
+		}
+		session = &j->sessions[idx];
+		session->pgn = (uint32_t)d[5] | ((uint32_t)d[6] << 8) | ((uint32_t)d[7] << 16);
+		session->size = size;
+		session->packets = d[3];
+		session->next_seq = 1;
+		session->priority = id->priority;
+		session->window_max = d[4] == 0 ? 0xFF : d[4];
+		session->window_end = session->packets;
+		session->mode = ours ? J1939_SESSION_OURS : J1939_SESSION_LISTEN;
+		session->deadline_ms = now_ms + (d[0] == J1939_TP_BAM ? J1939_T1_MS : J1939_T2_MS);
+		return ours ? _p_can_interact_j1939_send_cts(j, session, now_ms) : 0;
+	}
+	case J1939_TP_CTS: { /* receiver (sa) grants sender (da) - track retransmission requests of transfers we only observe */
+		idx = _p_can_interact_j1939_find(j, id->da, id->sa);
+		if (idx != -1 && j->sessions[idx].mode == J1939_SESSION_LISTEN && d[1] != 0 && d[2] != 0 && d[2] <= j->sessions[idx].next_seq) {
+			j->sessions[idx].next_seq = d[2];
+			j->sessions[idx].deadline_ms = now_ms + J1939_T2_MS;
+		}
+		return 0;
+	}
+	case J1939_TP_ABORT: { /* either side may abort */
+		idx = _p_can_interact_j1939_find(j, id->sa, id->da);
+		if (idx == -1) {
+			idx = _p_can_interact_j1939_find(j, id->da, id->sa);
+		}
+		if (idx != -1) {
+			++j->stats.transfers_aborted;
+			_p_can_interact_j1939_release(j, idx);
+		}
+		return 0;
+	}
+	default:
+		return 0;
+	}
+}
+
+/**
+ * @brief _p_can_interact_j1939_tp_dt - INTERNAL METHOD. handles transport protocol data transfer frame
+ * @param struct can_interact_j1939* - J1939 state
+ * @param const struct can_interact_j1939_id* - decoded identifier
+ * @param const struct can_frame* - frame
+ * @param const uint64_t - current time in milliseconds
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_j1939_tp_dt(struct can_interact_j1939 *j, const struct can_interact_j1939_id *id, const struct can_frame *frame, const uint64_t now_ms)
+{
+	struct can_interact_j1939_session *session;
+	struct can_interact_j1939_msg msg;
+	size_t offset, n;
+	int16_t idx;
+	int res;
+	uint8_t seq;
+
+	idx = _p_can_interact_j1939_find(j, id->sa, id->da);
+	if (idx == -1 || frame->can_dlc < 2) {
+		return 0;
+	}
+	session = &j->sessions[idx];
+	seq = frame->data[0];
+
+	if (seq < session->next_seq) { /* duplicate, e.g. retransmission overlap */
+		return 0;
+	}
+	if (seq != session->next_seq || seq > session->window_end) {
+		++j->stats.transfers_aborted;
+		res = session->mode == J1939_SESSION_OURS ? _p_can_interact_j1939_send_cm(j, session, J1939_TP_ABORT, J1939_ABORT_BAD_SEQUENCE, 0xFF) : 0;
+		_p_can_interact_j1939_release(j, idx);
+		return res;
+	}
+
+	offset = (size_t)(seq - 1) * 7;
+	n = session->size - offset < 7 ? session->size - offset : 7;
+	if (n > (size_t)frame->can_dlc - 1) {
+		n = (size_t)frame->can_dlc - 1;
+	}
+	memcpy(session->data + offset, frame->data + 1, n);
+	++session->next_seq;
+	session->deadline_ms = now_ms + J1939_T1_MS;
+
+	if (seq == session->packets) {
+		res = session->mode == J1939_SESSION_OURS ? _p_can_interact_j1939_send_cm(j, session, J1939_TP_EOMA, 0, 0) : 0;
+		msg.id.priority = session->priority;
+		msg.id.pgn = session->pgn;
+		msg.id.sa = session->sa;
+		msg.id.da = session->da;
+		msg.data = session->data;
+		msg.len = session->size;
+		++j->stats.transfers_done;
+		_p_can_interact_j1939_dispatch(j, &msg);
+		_p_can_interact_j1939_release(j, idx);
+		return res;
+	}
+	if (session->mode == J1939_SESSION_OURS && seq == session->window_end) {
+		return _p_can_interact_j1939_send_cts(j, session, now_ms);
+	}
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_j1939_reclaim - INTERNAL METHOD. picks another address after losing a claim, or gives up
+ * @param struct can_interact_j1939* - J1939 state
+ * @param const uint64_t - current time in milliseconds
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_j1939_reclaim(struct can_interact_j1939 *j, const uint64_t now_ms)
+{
+	unsigned int addr;
+
+	if ((j->name >> 63) != 0) { /* arbitrary address capable - use dynamic range 128-247 */
+		for (addr = 128; addr <= 247; ++addr) {
+			if (addr != j->address && (j->name_known[addr / 8] & (1u << (addr % 8))) == 0) {
+				j->address = (uint8_t)addr;
+				j->claim_state = J1939_CLAIM_PENDING;
+				j->claim_deadline_ms = now_ms + J1939_CLAIM_MS;
+				return _p_can_interact_j1939_send_claim(j);
+			}
+		}
+	}
+	j->address = CAN_INTERACT_J1939_ADDR_NULL;
+	j->claim_state = J1939_CLAIM_FAILED;
+	return _p_can_interact_j1939_send_claim(j); /* "cannot claim" */
+}
+
+/**
+ * @brief _p_can_interact_j1939_address_claimed - INTERNAL METHOD. records claim from another node & resolves contention
+ * @param struct can_interact_j1939* - J1939 state
+ * @param const struct can_interact_j1939_id* - decoded identifier
+ * @param const struct can_frame* - frame
+ * @param const uint64_t - current time in milliseconds
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_j1939_address_claimed(struct can_interact_j1939 *j, const struct can_interact_j1939_id *id, const struct can_frame *frame, const uint64_t now_ms)
+{
+	uint64_t name;
+	size_t i;
+
+	if (frame->can_dlc < 8 || id->sa >= CAN_INTERACT_J1939_ADDR_NULL) {
+		return 0;
+	}
+	name = 0;
+	for (i = 0; i < 8; ++i) {
+		name |= (uint64_t)frame->data[i] << (8 * i);
+	}
+	j->names[id->sa] = name;
+	j->name_known[id->sa / 8] = (uint8_t)(j->name_known[id->sa / 8] | (1u << (id->sa % 8)));
+
+	if (id->sa != j->address || (j->claim_state != J1939_CLAIM_PENDING && j->claim_state != J1939_CLAIM_DONE) || name == j->name) {
+		return 0;
+	}
+	if (j->name < name) { /* lower NAME has priority - defend our address */
+		return _p_can_interact_j1939_send_claim(j);
+	}
+	return _p_can_interact_j1939_reclaim(j, now_ms);
+}
+
+void can_interact_j1939_init(struct can_interact_j1939 *j, const uint64_t name, const uint8_t address, const int *socket)
+{
+	size_t i;
+
+	memset(j, 0, sizeof(*j));
+	for (i = 0; i < CAN_INTERACT_J1939_MAX_SESSIONS; ++i) {
+		j->sessions[i].next = (int16_t)(i + 1 == CAN_INTERACT_J1939_MAX_SESSIONS ? -1 : (int)(i + 1));
+	}
+	for (i = 0; i < CAN_INTERACT_J1939_MAX_HANDLERS; ++i) {
+		j->handlers[i].pgn = J1939_EMPTY_PGN;
+	}
+	for (i = 0; i < 256; ++i) {
+		j->bam_by_sa[i] = -1;
+		j->cmdt_by_sa[i] = -1;
+	}
+	j->free_head = 0;
+	j->name = name;
+	j->address = address;
+	j->socket = socket == NULL ? -1 : *socket;
+	j->claim_state = J1939_CLAIM_NONE;
+}
+
+int can_interact_j1939_register(struct can_interact_j1939 *j, const uint32_t pgn, const can_interact_j1939_handler handler, void *ctx)
+{
+	const size_t idx = _p_can_interact_j1939_slot(j, pgn);
+
+	if (idx == CAN_INTERACT_J1939_MAX_HANDLERS) {
+		return 1;
+	}
+	j->handlers[idx].pgn = pgn; /* unregistering leaves the PGN in place so probe chains stay intact */
+	j->handlers[idx].handler = handler;
+	j->handlers[idx].ctx = ctx;
+	return 0;
+}
+
+void can_interact_j1939_register_fallback(struct can_interact_j1939 *j, const can_interact_j1939_handler handler, void *ctx)
+{
+	j->fallback = handler;
+	j->fallback_ctx = ctx;
+}
+
+int can_interact_j1939_claim(struct can_interact_j1939 *j, const uint64_t now_ms)
+{
+	if (j->address >= CAN_INTERACT_J1939_ADDR_NULL) {
+		return _p_can_interact_j1939_reclaim(j, now_ms);
+	}
+	if ((j->name_known[j->address / 8] & (1u << (j->address % 8))) != 0 && j->names[j->address] < j->name) {
+		return _p_can_interact_j1939_reclaim(j, now_ms); /* already owned by a node of higher priority */
+	}
+	j->claim_state = J1939_CLAIM_PENDING;
+	j->claim_deadline_ms = now_ms + J1939_CLAIM_MS;
+	return _p_can_interact_j1939_send_claim(j);
+}
+
+int can_interact_j1939_process(struct can_interact_j1939 *j, const struct can_frame *frame, const uint64_t now_ms)
+{
+	struct can_interact_j1939_msg msg;
+	uint32_t requested;
+	int res;
+
+	if (can_interact_j1939_decode_id(frame->can_id, &msg.id) != 0) {
+		return CAN_INTERACT_J1939_NOT_J1939;
+	}
+	++j->stats.frames;
+
+	switch (msg.id.pgn) {
+	case CAN_INTERACT_J1939_PGN_TP_CM:
+		return _p_can_interact_j1939_tp_cm(j, &msg.id, frame, now_ms);
+	case CAN_INTERACT_J1939_PGN_TP_DT:
+		return _p_can_interact_j1939_tp_dt(j, &msg.id, frame, now_ms);
+	case CAN_INTERACT_J1939_PGN_ADDRESS_CLAIMED:
+		res = _p_can_interact_j1939_address_claimed(j, &msg.id, frame, now_ms);
+		break;
+	case CAN_INTERACT_J1939_PGN_REQUEST:
+		res = 0;
+		if (frame->can_dlc >= 3 && j->socket != -1 && j->claim_state != J1939_CLAIM_NONE && (msg.id.da == CAN_INTERACT_J1939_ADDR_GLOBAL || msg.id.da == j->address)) {
+			requested = (uint32_t)frame->data[0] | ((uint32_t)frame->data[1] << 8) | ((uint32_t)frame->data[2] << 16);
+			if (requested == CAN_INTERACT_J1939_PGN_ADDRESS_CLAIMED) {
+				res = _p_can_interact_j1939_send_claim(j);
+			}
+		}
+		break;
+	default:
+		res = 0;
+		break;
+	}
+
+	msg.data = frame->data;
+	msg.len = frame->can_dlc;
+	_p_can_interact_j1939_dispatch(j, &msg);
+	return res;
+}
+
+int can_interact_j1939_tick(struct can_interact_j1939 *j, const uint64_t now_ms)
+{
+	struct can_interact_j1939_session *session;
+	int16_t i;
+	int res, err;
+
+	err = 0;
+	for (i = 0; i < CAN_INTERACT_J1939_MAX_SESSIONS; ++i) {
+		session = &j->sessions[i];
+		if (session->mode == J1939_SESSION_FREE || session->deadline_ms > now_ms) {
+			continue;
+		}
+		if (session->mode == J1939_SESSION_OURS) {
+			res = _p_can_interact_j1939_send_cm(j, session, J1939_TP_ABORT, J1939_ABORT_TIMEOUT, 0xFF);
+			err = err == 0 ? res : err;
+		}
+		++j->stats.transfers_timed_out;
+		_p_can_interact_j1939_release(j, i);
+	}
+	if (j->claim_state == J1939_CLAIM_PENDING && j->claim_deadline_ms <= now_ms) {
+		j->claim_state = J1939_CLAIM_DONE;
+	}
+	return err;
+}
+
+int can_interact_j1939_name(const struct can_interact_j1939 *j, const uint8_t address, uint64_t *name)
+{
+	if ((j->name_known[address / 8] & (1u << (address % 8))) == 0) {
+		return 1;
+	}
+	*name = j->names[address];
+	return 0;
+}
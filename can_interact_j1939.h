@@ -0,0 +1,266 @@
+#ifndef CAN_INTERACT_J1939_H
+#define CAN_INTERACT_J1939_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_interact.h"
+
+/**
+ * @brief C-style SAE J1939 layer built upon can_interact functionality
+ * Provides 29-bit identifier decoding, a PGN indexed dispatch table, address claiming and BAM / CMDT transport protocol reassembly
+ * All state (including reassembly buffers) lives in a single caller-provided struct - no allocation occurs while processing frames
+ * For the CXX API, see can_interact_j1939.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifndef CAN_INTERACT_J1939_MAX_SESSIONS
+#define CAN_INTERACT_J1939_MAX_SESSIONS 64 /* number of pooled transport protocol buffers (i.e. concurrent transfers) */
+#endif /* CAN_INTERACT_J1939_MAX_SESSIONS */
+
+#ifndef CAN_INTERACT_J1939_MAX_HANDLERS
+#define CAN_INTERACT_J1939_MAX_HANDLERS 256 /* capacity of PGN dispatch table, must be a power of two */
+#endif /* CAN_INTERACT_J1939_MAX_HANDLERS */
+
+#define CAN_INTERACT_J1939_MAX_LEN 1785 /* 255 packets * 7 bytes */
+
+#define CAN_INTERACT_J1939_ADDR_NULL 0xFE /* address used by nodes which could not claim an address */
+#define CAN_INTERACT_J1939_ADDR_GLOBAL 0xFF /* broadcast destination address */
+
+#define CAN_INTERACT_J1939_NOT_J1939 (-1) /* can_interact_j1939_process result for frames which are not J1939 frames, distinct from errno codes */
+
+#define CAN_INTERACT_J1939_PGN_REQUEST 0xEA00u
+#define CAN_INTERACT_J1939_PGN_ADDRESS_CLAIMED 0xEE00u
+#define CAN_INTERACT_J1939_PGN_TP_CM 0xEC00u
+#define CAN_INTERACT_J1939_PGN_TP_DT 0xEB00u
+
+/* Fast field extraction from a (29-bit) can_id - PDU1 PGNs (PF < 240) have their destination address stripped */
+#define CAN_INTERACT_J1939_PRIORITY(id) ((uint8_t)(((id) >> 26) & 0x7u))
+#define CAN_INTERACT_J1939_SA(id) ((uint8_t)((id) & 0xFFu))
+#define CAN_INTERACT_J1939_PF(id) ((uint8_t)(((id) >> 16) & 0xFFu))
+#define CAN_INTERACT_J1939_PS(id) ((uint8_t)(((id) >> 8) & 0xFFu))
+#define CAN_INTERACT_J1939_PGN(id) (CAN_INTERACT_J1939_PF(id) < 240 ? (uint32_t)(((id) >> 8) & 0x3FF00u) : (uint32_t)(((id) >> 8) & 0x3FFFFu))
+#define CAN_INTERACT_J1939_DA(id) (CAN_INTERACT_J1939_PF(id) < 240 ? CAN_INTERACT_J1939_PS(id) : (uint8_t)CAN_INTERACT_J1939_ADDR_GLOBAL)
+
+struct can_interact_j1939_id {
+	/**
+	 * @brief struct can_interact_j1939_id - fields of a J1939 29-bit identifier
+	 */
+	uint8_t priority; /* 0 (highest) - 7 (lowest) */
+	uint32_t pgn; /* 18-bit parameter group number (PS zeroed for PDU1 formats) */
+	uint8_t da; /* destination address (CAN_INTERACT_J1939_ADDR_GLOBAL for PDU2 formats) */
+	uint8_t sa; /* source address */
+};
+
+struct can_interact_j1939_msg {
+	/**
+	 * @brief struct can_interact_j1939_msg - complete J1939 message handed to handlers, either a single frame or a reassembled transfer
+	 * data is only valid for the duration of the handler call
+	 */
+	struct can_interact_j1939_id id;
+	const uint8_t *data;
+	uint16_t len;
+};
+
+/**
+ * @brief can_interact_j1939_handler - callback invoked upon receipt of a complete message
+ * @param const struct can_interact_j1939_msg* - the message
+ * @param void* - user context provided upon registration
+ */
+typedef void (*can_interact_j1939_handler)(const struct can_interact_j1939_msg *msg, void *ctx);
+
+enum can_interact_j1939_claim_state {
+	/**
+	 * @brief enum can_interact_j1939_claim_state - progress of the address claim procedure
+	 */
+	J1939_CLAIM_NONE = 0, /* no claim attempted */
+	J1939_CLAIM_PENDING, /* claim sent, waiting 250ms for contention */
+	J1939_CLAIM_DONE, /* address owned */
+	J1939_CLAIM_FAILED /* lost arbitration and could not pick another address */
+};
+
+struct can_interact_j1939_session {
+	/**
+	 * @brief struct can_interact_j1939_session - INTERNAL. pooled transport protocol reassembly buffer
+	 */
+	uint8_t data[CAN_INTERACT_J1939_MAX_LEN];
+	uint32_t pgn; /* pgn being transported */
+	uint64_t deadline_ms; /* point at which the transfer times out */
+	uint16_t size; /* total message size */
+	uint8_t packets; /* total number of packets */
+	uint8_t next_seq; /* next expected sequence number */
+	uint8_t window_end; /* last sequence number granted by the current CTS (CMDT only) */
+	uint8_t window_max; /* max packets per CTS as requested by the sender (CMDT only) */
+	uint8_t priority;
+	uint8_t sa;
+	uint8_t da; /* CAN_INTERACT_J1939_ADDR_GLOBAL for BAM */
+	uint8_t mode; /* 0 = free, 1 = listen only, 2 = addressed to us (we send flow control) */
+	int16_t next; /* next session in same source address chain / free list, -1 terminated */
+};
+
+struct can_interact_j1939_dispatch_entry {
+	/**
+	 * @brief struct can_interact_j1939_dispatch_entry - INTERNAL. slot of the open addressed PGN dispatch table
+	 */
+	uint32_t pgn; /* UINT32_MAX if empty */
+	can_interact_j1939_handler handler;
+	void *ctx;
+};
+
+struct can_interact_j1939_stats {
+	/**
+	 * @brief struct can_interact_j1939_stats - counters for health monitoring
+	 */
+	unsigned long frames; /* frames processed */
+	unsigned long transfers_done; /* reassembled messages delivered */
+	unsigned long transfers_aborted; /* transfers aborted by either side or due to sequence errors */
+	unsigned long transfers_timed_out; /* transfers discarded due to T1/T2 timeouts */
+	unsigned long transfers_dropped; /* transfers refused as the buffer pool was exhausted */
+};
+
+struct can_interact_j1939 {
+	/**
+	 * @brief struct can_interact_j1939 - J1939 node / monitor state
+	 * Large (~115KB with default settings) - declare statically or on the heap
+	 * Initialise with can_interact_j1939_init
+	 */
+	struct can_interact_j1939_session sessions[CAN_INTERACT_J1939_MAX_SESSIONS];
+	struct can_interact_j1939_dispatch_entry handlers[CAN_INTERACT_J1939_MAX_HANDLERS];
+	uint64_t names[256]; /* NAMEs of claimed addresses seen on the bus */
+	uint8_t name_known[256 / 8]; /* bitmap of valid entries in names */
+	int16_t bam_by_sa[256]; /* session chain heads of broadcast transfers, per source address */
+	int16_t cmdt_by_sa[256]; /* session chain heads of connection mode transfers, per source address */
+	int16_t free_head; /* head of free session list */
+	can_interact_j1939_handler fallback; /* handler for PGNs without a registered handler, may be NULL */
+	void *fallback_ctx;
+	struct can_interact_j1939_stats stats;
+	uint64_t name; /* our 64-bit NAME */
+	uint64_t claim_deadline_ms;
+	int socket; /* socket used to send claims & flow control, -1 for a passive monitor */
+	enum can_interact_j1939_claim_state claim_state;
+	uint8_t address; /* our (preferred, then claimed) address */
+};
+
+/**
+ * @brief can_interact_j1939_decode_id - splits 29-bit can_id into J1939 fields
+ *
+ * @param const canid_t - identifier of received frame (including flags)
+ *
+ * @param struct can_interact_j1939_id* - pointer to struct to write fields to
+ *
+ * @return int - exit code
+ * 0 on success, 1 if the identifier is not an extended (29-bit) data frame identifier
+ */
+int can_interact_j1939_decode_id(const canid_t id, struct can_interact_j1939_id *dest);
+
+/**
+ * @brief can_interact_j1939_encode_id - assembles 29-bit can_id (with CAN_EFF_FLAG set) from J1939 fields
+ *
+ * @param const struct can_interact_j1939_id* - fields. da is ignored for PDU2 PGNs
+ *
+ * @return canid_t - assembled identifier
+ */
+canid_t can_interact_j1939_encode_id(const struct can_interact_j1939_id *id);
+
+/**
+ * @brief can_interact_j1939_init - initialises J1939 state
+ *
+ * @param struct can_interact_j1939* - pointer to state to initialise
+ *
+ * @param const uint64_t - our 64-bit NAME (bit 63 set indicates arbitrary address capability)
+ *
+ * @param const uint8_t - preferred source address. CAN_INTERACT_J1939_ADDR_NULL for a listen-only node
+ *
+ * @param const int* - pointer to socket descriptor used for sending, or NULL for a passive monitor (no CTS or claims are sent)
+ */
+void can_interact_j1939_init(struct can_interact_j1939 *j1939, const uint64_t name, const uint8_t address, const int *socket);
+
+/**
+ * @brief can_interact_j1939_register - registers handler for PGN, replacing any existing one
+ *
+ * @param struct can_interact_j1939* - J1939 state
+ *
+ * @param const uint32_t - PGN to handle (PDU1 PGNs should have their PS byte zeroed)
+ *
+ * @param const can_interact_j1939_handler - handler to invoke, NULL to unregister
+ *
+ * @param void* - user context passed to handler
+ *
+ * @return int - exit code
+ * 0 on success, 1 if the dispatch table is full
+ */
+int can_interact_j1939_register(struct can_interact_j1939 *j1939, const uint32_t pgn, const can_interact_j1939_handler handler, void *ctx);
+
+/**
+ * @brief can_interact_j1939_register_fallback - registers handler for all PGNs without their own handler
+ *
+ * @param struct can_interact_j1939* - J1939 state
+ *
+ * @param const can_interact_j1939_handler - handler to invoke, NULL to unregister
+ *
+ * @param void* - user context passed to handler
+ */
+void can_interact_j1939_register_fallback(struct can_interact_j1939 *j1939, const can_interact_j1939_handler handler, void *ctx);
+
+/**
+ * @brief can_interact_j1939_claim - starts address claim procedure with our preferred address
+ *
+ * @param struct can_interact_j1939* - J1939 state
+ *
+ * @param const uint64_t - current monotonic time in milliseconds
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes for other writing errors
+ */
+int can_interact_j1939_claim(struct can_interact_j1939 *j1939, const uint64_t now_ms);
+
+/**
+ * @brief can_interact_j1939_process - processes received frame, driving address claiming & transport protocols and invoking handlers
+ *
+ * @param struct can_interact_j1939* - J1939 state
+ *
+ * @param const struct can_frame* - received frame
+ *
+ * @param const uint64_t - current monotonic time in milliseconds
+ *
+ * @return int - error code
+ * 0 on success, CAN_INTERACT_J1939_NOT_J1939 if the frame is not a J1939 (extended data) frame, positive values are errno codes from sending responses
+ */
+int can_interact_j1939_process(struct can_interact_j1939 *j1939, const struct can_frame *frame, const uint64_t now_ms);
+
+/**
+ * @brief can_interact_j1939_tick - expires stalled transfers and completes pending address claims
+ * Should be called periodically (e.g. every 50-100ms) or whenever the receive call times out
+ *
+ * @param struct can_interact_j1939* - J1939 state
+ *
+ * @param const uint64_t - current monotonic time in milliseconds
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes for other writing errors
+ */
+int can_interact_j1939_tick(struct can_interact_j1939 *j1939, const uint64_t now_ms);
+
+/**
+ * @brief can_interact_j1939_name - looks up NAME of node which has claimed an address
+ *
+ * @param const struct can_interact_j1939* - J1939 state
+ *
+ * @param const uint8_t - address to look up
+ *
+ * @param uint64_t* - pointer to write NAME to
+ *
+ * @return int - exit code
+ * 0 on success, 1 if no claim has been seen for the address
+ */
+int can_interact_j1939_name(const struct can_interact_j1939 *j1939, const uint8_t address, uint64_t *name);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_J1939_H */
@@ -0,0 +1,262 @@
+#ifndef CAN_INTERACT_J1939_HH
+#define CAN_INTERACT_J1939_HH
+#pragma once
+
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <chrono>
+#include <string>
+#include <stdexcept>
+#include <cstdint>
+
+#include "can_interact.hh"
+#include "can_interact_j1939.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact J1939 layer
+ * Wraps the C state in an owning class, accepting std::function handlers and defaulting timestamps to std::chrono::steady_clock
+ * For declarations for the native C library, see can_interact_j1939.h
+ */
+
+namespace can_interact {
+
+	class J1939 {
+		/**
+		  * @brief J1939 (class) - J1939 node (or passive monitor) processing frames received over a can_interact::CAN object
+		  */
+		public:
+			using handler_t = std::function<void(const can_interact_j1939_msg&)> ;
+
+		private:
+			std::unique_ptr<can_interact_j1939> _state ;
+			std::unordered_map<std::uint32_t, handler_t> _handlers ; // node based, so addresses of handlers are stable for use as C context
+			std::unique_ptr<handler_t> _fallback ; // heap allocated for the same reason, so moving this object keeps the C context valid
+
+			/**
+			  * @brief _trampoline - INTERNAL METHOD. forwards C callbacks to std::function handlers
+			  * @param const can_interact_j1939_msg* - message
+			  * @param void* - pointer to handler_t
+			  */
+			static void _trampoline(const can_interact_j1939_msg*, void*) ;
+
+			/**
+			  * @brief _now - INTERNAL METHOD. monotonic time in milliseconds
+			  * @return std::uint64_t - milliseconds since epoch of std::chrono::steady_clock
+			  */
+			static std::uint64_t _now() noexcept ;
+
+		public:
+			/**
+			  * @brief J1939 (constructor) (overload) - initialises node which responds to claims, requests & flow control over CAN connection
+			  * @param const CAN& - initialised CAN connection (should outlive this object)
+			  * @param const std::uint64_t - our 64-bit NAME
+			  * @param const std::uint8_t - preferred source address
+			  */
+			J1939(const CAN&, const std::uint64_t, const std::uint8_t) noexcept(false) ;
+
+			/**
+			  * @brief J1939 (constructor) (overload) - initialises passive monitor which never sends
+			  */
+			J1939() noexcept(false) ;
+
+			J1939(J1939&&) noexcept = default ;
+			J1939& operator=(J1939&&) noexcept = default ;
+
+			/**
+			  * @brief handler - registers handler for PGN, replacing existing one
+			  * @param const std::uint32_t - PGN (PS byte zeroed for PDU1 PGNs)
+			  * @param handler_t - handler, empty to unregister
+			  * @throws std::runtime_error - if dispatch table is full
+			  */
+			void handler(const std::uint32_t, handler_t) noexcept(false) ;
+
+			/**
+			  * @brief fallback - registers handler for PGNs without their own handler
+			  * @param handler_t - handler, empty to unregister
+			  */
+			void fallback(handler_t) noexcept ;
+
+			/**
+			  * @brief claim - starts address claim procedure
+			  * @param const std::uint64_t - current monotonic time in milliseconds (defaults to steady_clock)
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void claim(const std::uint64_t = _now()) noexcept(false) ;
+
+			/**
+			  * @brief process - processes received frame
+			  * @param const can_frame& - LINUX CAN frame struct
+			  * @param const std::uint64_t - current monotonic time in milliseconds (defaults to steady_clock)
+			  * @return bool - false if frame was not a J1939 frame
+			  * @throws std::runtime_error - if sending a response failed (errors reported by errno)
+			  */
+			bool process(const can_frame&, const std::uint64_t = _now()) noexcept(false) ;
+
+			/**
+			  * @brief tick - expires stalled transfers and completes pending address claims
+			  * @param const std::uint64_t - current monotonic time in milliseconds (defaults to steady_clock)
+			  * @throws std::runtime_error - if sending an abort failed (errors reported by errno)
+			  */
+			void tick(const std::uint64_t = _now()) noexcept(false) ;
+
+			/**
+			  * @brief address - getter for our current source address
+			  * @return std::uint8_t - address, CAN_INTERACT_J1939_ADDR_NULL if none could be claimed
+			  */
+			std::uint8_t address() const noexcept ;
+
+			/**
+			  * @brief state - getter for progress of address claim
+			  * @return can_interact_j1939_claim_state - state
+			  */
+			can_interact_j1939_claim_state state() const noexcept ;
+
+			/**
+			  * @brief stats - getter for health monitoring counters
+			  * @return const can_interact_j1939_stats& - counters
+			  */
+			const can_interact_j1939_stats& stats() const noexcept ;
+
+			/**
+			  * @brief name - looks up NAME of node which claimed address
+			  * @param const std::uint8_t - address
+			  * @return std::uint64_t - NAME
+			  * @throws std::invalid_argument - if no claim has been seen for address
+			  */
+			std::uint64_t name(const std::uint8_t) const noexcept(false) ;
+
+			/* Below are defaulted and deleted methods */
+			J1939(const J1939&) = delete ;
+			J1939& operator=(const J1939&) = delete ;
+	} ;
+
+	/**
+	  * @brief j1939_id - decodes 29-bit identifier into J1939 fields
+	  * @param const canid_t - identifier
+	  * @throws std::invalid_argument - if identifier is not an extended data frame identifier
+	  * @return can_interact_j1939_id - fields
+	  */
+	can_interact_j1939_id j1939_id(const canid_t) noexcept(false) ;
+
+}
+
+void can_interact::J1939::_trampoline(const can_interact_j1939_msg* msg, void* ctx)
+{
+	(*static_cast<handler_t*>(ctx))(*msg) ;
+}
+
+std::uint64_t can_interact::J1939::_now() noexcept
+{
+	return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()) ;
+}
+
+can_interact::J1939::J1939(const can_interact::CAN& can, const std::uint64_t name, const std::uint8_t address) noexcept(false) : _state(new can_interact_j1939), _fallback(new handler_t)
+{
+	const int socket = can.socket() ;
+	can_interact_j1939_init(this->_state.get(), name, address, &socket) ;
+}
+
+can_interact::J1939::J1939() noexcept(false) : _state(new can_interact_j1939), _fallback(new handler_t)
+{
+	can_interact_j1939_init(this->_state.get(), 0, CAN_INTERACT_J1939_ADDR_NULL, nullptr) ;
+}
+
+void can_interact::J1939::handler(const std::uint32_t pgn, handler_t handler) noexcept(false)
+{
+	if(!handler)
+	{
+		can_interact_j1939_register(this->_state.get(), pgn, nullptr, nullptr) ;
+		this->_handlers.erase(pgn) ;
+		return ;
+	}
+	handler_t& stored = this->_handlers[pgn] ;
+	stored = std::move(handler) ;
+	if(can_interact_j1939_register(this->_state.get(), pgn, &can_interact::J1939::_trampoline, &stored) != 0)
+	{
+		this->_handlers.erase(pgn) ;
+		throw std::runtime_error(std::string{"J1939 dispatch table full, cannot register PGN "} + std::to_string(pgn)) ;
+	}
+}
+
+void can_interact::J1939::fallback(handler_t handler) noexcept
+{
+	*this->_fallback = std::move(handler) ;
+	if(*this->_fallback)
+	{
+		can_interact_j1939_register_fallback(this->_state.get(), &can_interact::J1939::_trampoline, this->_fallback.get()) ;
+	}
+	else
+	{
+		can_interact_j1939_register_fallback(this->_state.get(), nullptr, nullptr) ;
+	}
+}
+
+void can_interact::J1939::claim(const std::uint64_t now_ms) noexcept(false)
+{
+	const int res = can_interact_j1939_claim(this->_state.get(), now_ms) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+bool can_interact::J1939::process(const can_frame& frame, const std::uint64_t now_ms) noexcept(false)
+{
+	const int res = can_interact_j1939_process(this->_state.get(), &frame, now_ms) ;
+	if(res == CAN_INTERACT_J1939_NOT_J1939)
+	{
+		return false ;
+	}
+	else if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return true ;
+}
+
+void can_interact::J1939::tick(const std::uint64_t now_ms) noexcept(false)
+{
+	const int res = can_interact_j1939_tick(this->_state.get(), now_ms) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+std::uint8_t can_interact::J1939::address() const noexcept
+{
+	return this->_state->address ;
+}
+
+can_interact_j1939_claim_state can_interact::J1939::state() const noexcept
+{
+	return this->_state->claim_state ;
+}
+
+const can_interact_j1939_stats& can_interact::J1939::stats() const noexcept
+{
+	return this->_state->stats ;
+}
+
+std::uint64_t can_interact::J1939::name(const std::uint8_t address) const noexcept(false)
+{
+	std::uint64_t name ;
+	if(can_interact_j1939_name(this->_state.get(), address, &name) != 0)
+	{
+		throw std::invalid_argument(std::string{"No address claim seen for address "} + std::to_string(address)) ;
+	}
+	return name ;
+}
+
+can_interact_j1939_id can_interact::j1939_id(const canid_t id) noexcept(false)
+{
+	can_interact_j1939_id fields ;
+	if(can_interact_j1939_decode_id(id, &fields) != 0)
+	{
+		throw std::invalid_argument("Identifier is not a 29-bit data frame identifier") ;
+	}
+	return fields ;
+}
+
+#endif // CAN_INTERACT_J1939_HH
@@ -0,0 +1,565 @@
+#define _DEFAULT_SOURCE
+
+#include <unistd.h> /* syscalls */
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <endian.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <linux/can.h>
+
+#include "can_interact_log.h"
+
+/**
+ * @brief C-style definitions of indexed, compressed log files
+ * For definitions for the CXX API, see can_interact_log.hh
+ */
+
+#define LOG_HEADER_LEN 8u
+#define LOG_BLOCK_HEADER_LEN 32u
+#define LOG_INDEX_ENTRY_LEN 32u
+#define LOG_TRAILER_LEN 16u
+#define LOG_BLOCK_MAGIC 0x304B4C42u /* "BLK0" */
+#define LOG_TRAILER_MAGIC 0x58444943u /* "CIDX" */
+#define LOG_ID_MASK (CAN_EFF_FLAG | CAN_EFF_MASK) /* identifiers are matched regardless of RTR / ERR flags */
+
+static const uint8_t _p_can_interact_log_magic[LOG_HEADER_LEN] = { 'C', 'I', 'L', 'O', 'G', 0, 0, 1 };
+
+/**
+ * @brief _p_can_interact_log_put32 - INTERNAL METHOD. stores little endian 32-bit value
+ * @param uint8_t* - destination
+ * @param const uint32_t - value
+ */
+static void _p_can_interact_log_put32(uint8_t *dest, const uint32_t value)
+{
+	const uint32_t le = htole32(value);
+	memcpy(dest, &le, sizeof(le));
+}
+
+/**
+ * @brief _p_can_interact_log_put64 - INTERNAL METHOD. stores little endian 64-bit value
+ * @param uint8_t* - destination
+ * @param const uint64_t - value
+ */
+static void _p_can_interact_log_put64(uint8_t *dest, const uint64_t value)
+{
+	const uint64_t le = htole64(value);
+	memcpy(dest, &le, sizeof(le));
+}
+
+/**
+ * @brief _p_can_interact_log_get32 - INTERNAL METHOD. loads little endian 32-bit value
+ * @param const uint8_t* - source
+ * @return uint32_t - value
+ */
+static uint32_t _p_can_interact_log_get32(const uint8_t *src)
+{
+	uint32_t le;
+	memcpy(&le, src, sizeof(le));
+	return le32toh(le);
+}
+
+/**
+ * @brief _p_can_interact_log_get64 - INTERNAL METHOD. loads little endian 64-bit value
+ * @param const uint8_t* - source
+ * @return uint64_t - value
+ */
+static uint64_t _p_can_interact_log_get64(const uint8_t *src)
+{
+	uint64_t le;
+	memcpy(&le, src, sizeof(le));
+	return le64toh(le);
+}
+
+/**
+ * @brief _p_can_interact_log_bit - INTERNAL METHOD. bitmap position of identifier
+ * @param const canid_t - identifier
+ * @return uint32_t - bit, exact for standard identifiers and hashed for extended ones
+ */
+static uint32_t _p_can_interact_log_bit(const canid_t id)
+{
+	if (id & CAN_EFF_FLAG) {
+		return (uint32_t)(((id & CAN_EFF_MASK) * 2654435761u) >> 21) & 0x7FFu;
+	}
+	return id & CAN_SFF_MASK;
+}
+
+/**
+ * @brief _p_can_interact_log_write_all - INTERNAL METHOD. writes buffers completely, retrying partial writes
+ * @param const int - file descriptor
+ * @param struct iovec* - buffers (modified)
+ * @param int - number of buffers
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_log_write_all(const int fd, struct iovec *iov, int iovcnt)
+{
+	ssize_t n;
+
+	while (iovcnt > 0) {
+		n = writev(fd, iov, iovcnt);
+		if (n < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			return (int)errno;
+		}
+		while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+			n -= (ssize_t)iov->iov_len;
+			++iov;
+			--iovcnt;
+		}
+		if (iovcnt > 0) {
+			iov->iov_base = (uint8_t*)iov->iov_base + n;
+			iov->iov_len -= (size_t)n;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_log_reset - INTERNAL METHOD. starts new block
+ * @param struct can_interact_log_writer* - writer
+ */
+static void _p_can_interact_log_reset(struct can_interact_log_writer *writer)
+{
+	writer->buf_len = 0;
+	writer->frames = 0;
+	writer->dict_len = 0;
+	memset(writer->lookup, 0xFF, sizeof(writer->lookup)); /* all -1 */
+	memset(writer->bitmap, 0, sizeof(writer->bitmap));
+}
+
+/**
+ * @brief _p_can_interact_log_flush - INTERNAL METHOD. writes out current block and records it in index
+ * @param struct can_interact_log_writer* - writer
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_log_flush(struct can_interact_log_writer *writer)
+{
+	uint8_t header[LOG_BLOCK_HEADER_LEN];
+	uint8_t dict[CAN_INTERACT_LOG_DICT_MAX * 4];
+	struct iovec iov[3];
+	uint8_t *grown, *entry;
+	size_t i;
+	int res;
+
+	if (writer->frames == 0) {
+		return 0;
+	}
+	if (writer->blocks == writer->index_cap) {
+		writer->index_cap = writer->index_cap == 0 ? 64 : writer->index_cap * 2;
+		grown = (uint8_t*)realloc(writer->index, writer->index_cap * LOG_INDEX_ENTRY_LEN);
+		if (grown == NULL) {
+			return ENOMEM;
+		}
+		writer->index = grown;
+		grown = (uint8_t*)realloc(writer->bitmaps, writer->index_cap * CAN_INTERACT_LOG_BITMAP_BYTES);
+		if (grown == NULL) {
+			return ENOMEM;
+		}
+		writer->bitmaps = grown;
+	}
+
+	memset(header, 0, sizeof(header));
+	_p_can_interact_log_put32(header, LOG_BLOCK_MAGIC);
+	_p_can_interact_log_put32(header + 4, writer->frames);
+	_p_can_interact_log_put64(header + 8, writer->first_ns);
+	_p_can_interact_log_put64(header + 16, writer->last_ns);
+	_p_can_interact_log_put32(header + 24, (uint32_t)writer->buf_len);
+	header[28] = (uint8_t)(writer->dict_len & 0xFFu);
+	header[29] = (uint8_t)(writer->dict_len >> 8);
+	for (i = 0; i < writer->dict_len; ++i) {
+		_p_can_interact_log_put32(dict + i * 4, writer->dict[i]);
+	}
+	iov[0].iov_base = header;
+	iov[0].iov_len = sizeof(header);
+	iov[1].iov_base = dict;
+	iov[1].iov_len = (size_t)writer->dict_len * 4;
+	iov[2].iov_base = writer->buf;
+	iov[2].iov_len = writer->buf_len;
+	res = _p_can_interact_log_write_all(writer->fd, iov, 3);
+	if (res != 0) {
+		return res;
+	}
+
+	entry = writer->index + (size_t)writer->blocks * LOG_INDEX_ENTRY_LEN;
+	memset(entry, 0, LOG_INDEX_ENTRY_LEN);
+	_p_can_interact_log_put64(entry, writer->offset);
+	_p_can_interact_log_put64(entry + 8, writer->first_ns);
+	_p_can_interact_log_put64(entry + 16, writer->last_ns);
+	_p_can_interact_log_put32(entry + 24, writer->frames);
+	memcpy(writer->bitmaps + (size_t)writer->blocks * CAN_INTERACT_LOG_BITMAP_BYTES, writer->bitmap, CAN_INTERACT_LOG_BITMAP_BYTES);
+	++writer->blocks;
+	writer->offset += LOG_BLOCK_HEADER_LEN + (uint64_t)writer->dict_len * 4 + writer->buf_len;
+	_p_can_interact_log_reset(writer);
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_log_entry - INTERNAL METHOD. looks up (or adds) dictionary entry of identifier in current block
+ * @param struct can_interact_log_writer* - writer
+ * @param const canid_t - identifier
+ * @return int - dictionary index, -1 if the dictionary is full
+ */
+static int _p_can_interact_log_entry(struct can_interact_log_writer *writer, const canid_t id)
+{
+	size_t slot = (size_t)((id * 2654435761u) >> 23) & (CAN_INTERACT_LOG_DICT_MAX * 2 - 1);
+
+	while (writer->lookup[slot] != -1) {
+		if (writer->dict[writer->lookup[slot]] == id) {
+			return writer->lookup[slot];
+		}
+		slot = (slot + 1) & (CAN_INTERACT_LOG_DICT_MAX * 2 - 1);
+	}
+	if (writer->dict_len == CAN_INTERACT_LOG_DICT_MAX) {
+		return -1;
+	}
+	writer->lookup[slot] = (int16_t)writer->dict_len;
+	writer->dict[writer->dict_len] = id;
+	memset(writer->last[writer->dict_len], 0, 8);
+	writer->bitmap[_p_can_interact_log_bit(id) >> 3] |= (uint8_t)(1u << (_p_can_interact_log_bit(id) & 7u));
+	return writer->dict_len++;
+}
+
+int can_interact_log_create(struct can_interact_log_writer *writer, const char *path)
+{
+	struct iovec iov;
+
+	writer->index = NULL;
+	writer->bitmaps = NULL;
+	writer->index_cap = 0;
+	writer->blocks = 0;
+	writer->first_ns = 0;
+	writer->last_ns = 0;
+	writer->offset = LOG_HEADER_LEN;
+	_p_can_interact_log_reset(writer);
+	writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (writer->fd == -1) {
+		return (int)errno;
+	}
+	iov.iov_base = (void*)_p_can_interact_log_magic;
+	iov.iov_len = LOG_HEADER_LEN;
+	return _p_can_interact_log_write_all(writer->fd, &iov, 1);
+}
+
+int can_interact_log_write(struct can_interact_log_writer *writer, const struct can_interact_timed_frame *frames, const size_t len)
+{
+	const struct can_frame *frame;
+	uint8_t *out, *mask;
+	uint64_t delta;
+	uint8_t dlc, x;
+	size_t i, b;
+	int idx, res;
+
+	for (i = 0; i < len; ++i) {
+		frame = &frames[i].frame;
+		if (frames[i].timestamp_ns < writer->last_ns) {
+			return EINVAL;
+		}
+		if (writer->frames == CAN_INTERACT_LOG_BLOCK_FRAMES) {
+			res = _p_can_interact_log_flush(writer);
+			if (res != 0) {
+				return res;
+			}
+		}
+		idx = _p_can_interact_log_entry(writer, frame->can_id);
+		if (idx < 0) { /* dictionary full, start new block */
+			res = _p_can_interact_log_flush(writer);
+			if (res != 0) {
+				return res;
+			}
+			idx = _p_can_interact_log_entry(writer, frame->can_id);
+		}
+		if (writer->frames == 0) {
+			writer->first_ns = frames[i].timestamp_ns;
+			writer->last_ns = frames[i].timestamp_ns;
+		}
+
+		out = writer->buf + writer->buf_len;
+		for (delta = frames[i].timestamp_ns - writer->last_ns; delta >= 0x80u; delta >>= 7) { /* LEB128 varint */
+			*out++ = (uint8_t)(delta | 0x80u);
+		}
+		*out++ = (uint8_t)delta;
+		*out++ = (uint8_t)idx;
+		dlc = frame->can_dlc > 8 ? 8 : frame->can_dlc;
+		*out++ = dlc;
+		if (dlc > 0) {
+			mask = out++;
+			*mask = 0;
+			for (b = 0; b < dlc; ++b) { /* keep bytes which changed since identifier's previous frame */
+				x = (uint8_t)(frame->data[b] ^ writer->last[idx][b]);
+				if (x != 0) {
+					*mask |= (uint8_t)(1u << b);
+					*out++ = x;
+				}
+			}
+			memcpy(writer->last[idx], frame->data, dlc);
+		}
+		writer->buf_len = (size_t)(out - writer->buf);
+		writer->last_ns = frames[i].timestamp_ns;
+		++writer->frames;
+	}
+	return 0;
+}
+
+int can_interact_log_close(struct can_interact_log_writer *writer)
+{
+	uint8_t trailer[LOG_TRAILER_LEN];
+	struct iovec iov[3];
+	int res;
+
+	res = _p_can_interact_log_flush(writer);
+	if (res == 0) {
+		_p_can_interact_log_put64(trailer, writer->offset);
+		_p_can_interact_log_put32(trailer + 8, writer->blocks);
+		_p_can_interact_log_put32(trailer + 12, LOG_TRAILER_MAGIC);
+		iov[0].iov_base = writer->index;
+		iov[0].iov_len = (size_t)writer->blocks * LOG_INDEX_ENTRY_LEN;
+		iov[1].iov_base = writer->bitmaps;
+		iov[1].iov_len = (size_t)writer->blocks * CAN_INTERACT_LOG_BITMAP_BYTES;
+		iov[2].iov_base = trailer;
+		iov[2].iov_len = sizeof(trailer);
+		res = _p_can_interact_log_write_all(writer->fd, iov, 3);
+	}
+	free(writer->index);
+	free(writer->bitmaps);
+	writer->index = NULL;
+	writer->bitmaps = NULL;
+	if (close(writer->fd) != 0 && res == 0) {
+		res = (int)errno;
+	}
+	return res;
+}
+
+int can_interact_log_map(struct can_interact_log_reader *reader, const char *path)
+{
+	struct stat st;
+	const uint8_t *trailer;
+	uint64_t index_offset;
+	void *base;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		return (int)errno;
+	}
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return (int)errno;
+	}
+	if ((size_t)st.st_size < LOG_HEADER_LEN + LOG_TRAILER_LEN) {
+		close(fd);
+		return EBADMSG;
+	}
+	base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); /* the mapping keeps the file open */
+	if (base == MAP_FAILED) {
+		return (int)errno;
+	}
+	reader->base = (const uint8_t*)base;
+	reader->len = (size_t)st.st_size;
+
+	trailer = reader->base + reader->len - LOG_TRAILER_LEN;
+	index_offset = _p_can_interact_log_get64(trailer);
+	reader->blocks = _p_can_interact_log_get32(trailer + 8);
+	if (memcmp(reader->base, _p_can_interact_log_magic, LOG_HEADER_LEN) != 0
+			|| _p_can_interact_log_get32(trailer + 12) != LOG_TRAILER_MAGIC
+			|| index_offset > reader->len - LOG_TRAILER_LEN /* bound each field before summing, so a crafted trailer cannot wrap the sum */
+			|| reader->blocks > (reader->len - LOG_TRAILER_LEN - index_offset) / (LOG_INDEX_ENTRY_LEN + CAN_INTERACT_LOG_BITMAP_BYTES)
+			|| index_offset + (uint64_t)reader->blocks * (LOG_INDEX_ENTRY_LEN + CAN_INTERACT_LOG_BITMAP_BYTES) + LOG_TRAILER_LEN != reader->len) {
+		can_interact_log_unmap(reader);
+		return EBADMSG;
+	}
+	reader->index = reader->base + index_offset;
+	reader->bitmaps = reader->index + (size_t)reader->blocks * LOG_INDEX_ENTRY_LEN;
+	return 0;
+}
+
+void can_interact_log_query(const struct can_interact_log_reader *reader, struct can_interact_log_cursor *cursor, const uint64_t from_ns, const uint64_t to_ns, const canid_t *ids, const size_t ids_len)
+{
+	uint32_t lo = 0, hi = reader->blocks, mid;
+
+	cursor->reader = reader;
+	cursor->ids = ids;
+	cursor->ids_len = ids == NULL ? 0 : ids_len;
+	cursor->from_ns = from_ns;
+	cursor->to_ns = to_ns;
+	cursor->remaining = 0;
+	cursor->blocks_decoded = 0;
+	cursor->blocks_skipped = 0;
+	while (lo < hi) { /* first block ending at or after start of range, blocks are in time order */
+		mid = lo + (hi - lo) / 2;
+		if (_p_can_interact_log_get64(reader->index + (size_t)mid * LOG_INDEX_ENTRY_LEN + 16) < from_ns) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	cursor->block = lo;
+	cursor->block_end = reader->blocks;
+}
+
+uint32_t can_interact_log_blocks(const struct can_interact_log_reader *reader)
+{
+	return reader->blocks;
+}
+
+void can_interact_log_range(struct can_interact_log_cursor *cursor, const uint32_t first, const uint32_t last)
+{
+	if (cursor->block < first) {
+		cursor->block = first;
+	}
+	if (last < cursor->block_end) {
+		cursor->block_end = last;
+	}
+}
+
+/**
+ * @brief _p_can_interact_log_open_block - INTERNAL METHOD. prepares decoding of block if it may hold matching frames
+ * @param struct can_interact_log_cursor* - cursor
+ * @param const uint32_t - block
+ * @return int - 1 if block was opened, 0 if it holds no matching identifiers, -1 if it is corrupt
+ */
+static int _p_can_interact_log_open_block(struct can_interact_log_cursor *cursor, const uint32_t block)
+{
+	const struct can_interact_log_reader *reader = cursor->reader;
+	const uint8_t *bitmap = reader->bitmaps + (size_t)block * CAN_INTERACT_LOG_BITMAP_BYTES;
+	const uint8_t *header;
+	uint64_t offset;
+	uint32_t bit, frames, enc_len, dict_len, d;
+	size_t i;
+	int any;
+
+	if (cursor->ids != NULL) {
+		any = 0;
+		for (i = 0; i < cursor->ids_len && !any; ++i) {
+			bit = _p_can_interact_log_bit(cursor->ids[i] & LOG_ID_MASK);
+			any = (bitmap[bit >> 3] >> (bit & 7u)) & 1u;
+		}
+		if (!any) {
+			return 0;
+		}
+	}
+
+	offset = _p_can_interact_log_get64(reader->index + (size_t)block * LOG_INDEX_ENTRY_LEN);
+	if (offset > (uint64_t)(reader->index - reader->base) || (uint64_t)(reader->index - reader->base) - offset < LOG_BLOCK_HEADER_LEN) {
+		return -1;
+	}
+	header = reader->base + offset;
+	frames = _p_can_interact_log_get32(header + 4);
+	enc_len = _p_can_interact_log_get32(header + 24);
+	dict_len = (uint32_t)header[28] | ((uint32_t)header[29] << 8);
+	if (_p_can_interact_log_get32(header) != LOG_BLOCK_MAGIC || dict_len > CAN_INTERACT_LOG_DICT_MAX
+			|| offset + LOG_BLOCK_HEADER_LEN + (uint64_t)dict_len * 4 + enc_len > (uint64_t)(reader->index - reader->base)) {
+		return -1;
+	}
+
+	cursor->dict = header + LOG_BLOCK_HEADER_LEN;
+	cursor->dict_len = dict_len;
+	any = 0;
+	for (d = 0; d < dict_len; ++d) { /* the dictionary is exact, so bitmap collisions end here */
+		cursor->want[d] = cursor->ids == NULL;
+		for (i = 0; i < cursor->ids_len && !cursor->want[d]; ++i) {
+			cursor->want[d] = ((_p_can_interact_log_get32(cursor->dict + d * 4) ^ cursor->ids[i]) & LOG_ID_MASK) == 0;
+		}
+		any |= cursor->want[d];
+	}
+	if (!any) {
+		return 0;
+	}
+	memset(cursor->last, 0, (size_t)dict_len * 8);
+	cursor->pos = cursor->dict + (size_t)dict_len * 4;
+	cursor->end = cursor->pos + enc_len;
+	cursor->remaining = frames;
+	cursor->ts = _p_can_interact_log_get64(header + 8);
+	return 1;
+}
+
+int can_interact_log_next(struct can_interact_log_cursor *cursor, struct can_interact_timed_frame *frame)
+{
+	const struct can_interact_log_reader *reader = cursor->reader;
+	const uint8_t *entry;
+	uint64_t delta;
+	unsigned int shift;
+	uint8_t idx, dlc, mask, b;
+	int res;
+
+	for (;;) {
+		while (cursor->remaining == 0) {
+			if (cursor->block >= cursor->block_end) {
+				return ENOENT;
+			}
+			entry = reader->index + (size_t)cursor->block * LOG_INDEX_ENTRY_LEN;
+			if (_p_can_interact_log_get64(entry + 8) > cursor->to_ns) { /* this and all later blocks start after range */
+				cursor->block = cursor->block_end;
+				return ENOENT;
+			}
+			res = _p_can_interact_log_open_block(cursor, cursor->block++);
+			if (res < 0) {
+				return EBADMSG;
+			}
+			if (res == 0) {
+				++cursor->blocks_skipped;
+			} else {
+				++cursor->blocks_decoded;
+			}
+		}
+
+		delta = 0;
+		shift = 0;
+		do {
+			if (cursor->pos >= cursor->end || shift > 63) {
+				return EBADMSG;
+			}
+			delta |= (uint64_t)(*cursor->pos & 0x7Fu) << shift;
+			shift += 7;
+		} while (*cursor->pos++ & 0x80u);
+		if (cursor->end - cursor->pos < 2) {
+			return EBADMSG;
+		}
+		idx = *cursor->pos++;
+		dlc = *cursor->pos++;
+		if (idx >= cursor->dict_len || dlc > 8 || (dlc > 0 && cursor->pos >= cursor->end)) {
+			return EBADMSG;
+		}
+		if (dlc > 0) {
+			mask = *cursor->pos++;
+			for (b = 0; b < dlc; ++b) {
+				if ((mask >> b) & 1u) {
+					if (cursor->pos >= cursor->end) {
+						return EBADMSG;
+					}
+					cursor->last[idx][b] ^= *cursor->pos++;
+				}
+			}
+		}
+		cursor->ts += delta;
+		--cursor->remaining;
+
+		if (cursor->ts > cursor->to_ns) {
+			cursor->remaining = 0;
+			cursor->block = cursor->block_end;
+			return ENOENT;
+		}
+		if (cursor->want[idx] && cursor->ts >= cursor->from_ns) {
+			memset(&frame->frame, 0, sizeof(struct can_frame));
+			frame->frame.can_id = _p_can_interact_log_get32(cursor->dict + (size_t)idx * 4);
+			frame->frame.can_dlc = dlc;
+			memcpy(frame->frame.data, cursor->last[idx], dlc);
+			frame->timestamp_ns = cursor->ts;
+			return 0;
+		}
+	}
+}
+
+int can_interact_log_unmap(struct can_interact_log_reader *reader)
+{
+	return munmap((void*)reader->base, reader->len) == 0 ? 0 : (int)errno;
+}
@@ -0,0 +1,208 @@
+#ifndef CAN_INTERACT_LOG_H
+#define CAN_INTERACT_LOG_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+#include "can_interact.h"
+
+/**
+ * @brief C-style indexed, compressed log files of timestamped frames
+ * Frames are stored in self-contained blocks: timestamps as varint deltas, identifiers as indices into a per-block dictionary,
+ * payloads XOR-ed against the previous payload of the same identifier with zero bytes suppressed
+ * A trailing index holds each block's time range and a bitmap of its identifiers, so that readers map the file and only decode blocks matching a query
+ * For the CXX API, see can_interact_log.hh
+ *
+ * Layout (little endian):
+ *  file header  - magic "CILOG\0\0\1" (8)
+ *  block        - magic "BLK0" (4), frames (4), first timestamp (8), last timestamp (8), encoded length (4), dictionary length (2), reserved (2),
+ *                 dictionary of identifiers (4 each), encoded frames
+ *  index        - per block: offset (8), first timestamp (8), last timestamp (8), frames (4), reserved (4)
+ *  bitmaps      - per block: CAN_INTERACT_LOG_BITMAP_BYTES (standard identifiers map exactly, extended identifiers are hashed)
+ *  trailer      - index offset (8), blocks (4), magic "CIDX" (4)
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifndef CAN_INTERACT_LOG_BLOCK_FRAMES
+#define CAN_INTERACT_LOG_BLOCK_FRAMES 4096 /* frames per block, bounds the work of decoding a matching block */
+#endif /* CAN_INTERACT_LOG_BLOCK_FRAMES */
+
+#define CAN_INTERACT_LOG_DICT_MAX 256 /* distinct identifiers per block (one byte index) */
+#define CAN_INTERACT_LOG_RECORD_MAX 21 /* worst case encoded frame: varint delta (10), index (1), dlc (1), mask (1), payload (8) */
+#define CAN_INTERACT_LOG_BITMAP_BYTES 256 /* 2048 bits, i.e. one per standard identifier */
+
+struct can_interact_log_writer {
+	/**
+	 * @brief struct can_interact_log_writer - log file being written (~100KB with default settings)
+	 * Open with can_interact_log_create, finish with can_interact_log_close (a file without index cannot be read)
+	 */
+	uint8_t buf[CAN_INTERACT_LOG_BLOCK_FRAMES * CAN_INTERACT_LOG_RECORD_MAX]; /* encoded frames of current block */
+	uint8_t last[CAN_INTERACT_LOG_DICT_MAX][8]; /* previous payload per dictionary entry */
+	uint8_t bitmap[CAN_INTERACT_LOG_BITMAP_BYTES];
+	canid_t dict[CAN_INTERACT_LOG_DICT_MAX];
+	int16_t lookup[CAN_INTERACT_LOG_DICT_MAX * 2]; /* open addressed identifier to dictionary index table, -1 if empty */
+	uint8_t *index; /* grown as blocks are written */
+	uint8_t *bitmaps;
+	size_t index_cap; /* in blocks */
+	uint32_t blocks;
+	size_t buf_len;
+	uint32_t frames; /* in current block */
+	uint16_t dict_len;
+	uint64_t first_ns;
+	uint64_t last_ns;
+	uint64_t offset; /* of next block in file */
+	int fd;
+};
+
+struct can_interact_log_reader {
+	/**
+	 * @brief struct can_interact_log_reader - memory mapped log file
+	 */
+	const uint8_t *base;
+	size_t len;
+	const uint8_t *index;
+	const uint8_t *bitmaps;
+	uint32_t blocks;
+};
+
+struct can_interact_log_cursor {
+	/**
+	 * @brief struct can_interact_log_cursor - position of a query within a log file, see can_interact_log_query
+	 */
+	const struct can_interact_log_reader *reader;
+	const canid_t *ids; /* NULL matches all identifiers */
+	size_t ids_len;
+	uint64_t from_ns;
+	uint64_t to_ns;
+	uint32_t block; /* next block to consider */
+	uint32_t block_end; /* blocks from here on are not considered, see can_interact_log_range */
+	uint32_t remaining; /* frames left in current block */
+	const uint8_t *pos; /* next encoded frame */
+	const uint8_t *end;
+	const uint8_t *dict;
+	uint32_t dict_len;
+	uint64_t ts; /* timestamp of previous frame */
+	uint8_t want[CAN_INTERACT_LOG_DICT_MAX]; /* whether dictionary entry of current block matches */
+	uint8_t last[CAN_INTERACT_LOG_DICT_MAX][8];
+	unsigned long blocks_decoded; /* blocks which passed the index, for judging selectivity */
+	unsigned long blocks_skipped;
+};
+
+/**
+ * @brief can_interact_log_create - creates (truncating) log file for writing
+ *
+ * @param struct can_interact_log_writer* - writer to initialise
+ *
+ * @param const char* - path
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_log_create(struct can_interact_log_writer *writer, const char *path);
+
+/**
+ * @brief can_interact_log_write - appends frames, writing out blocks as they fill up
+ *
+ * @param struct can_interact_log_writer* - writer
+ *
+ * @param const struct can_interact_timed_frame* - frames, timestamps must not decrease (across calls too)
+ *
+ * @param const size_t - number of frames
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if a timestamp decreased (frames before it were written), for other non-zero values refer to errno codes
+ */
+int can_interact_log_write(struct can_interact_log_writer *writer, const struct can_interact_timed_frame *frames, const size_t len);
+
+/**
+ * @brief can_interact_log_close - writes out last block, index and trailer, then closes file
+ *
+ * @param struct can_interact_log_writer* - writer
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_log_close(struct can_interact_log_writer *writer);
+
+/**
+ * @brief can_interact_log_map - maps log file for reading
+ *
+ * @param struct can_interact_log_reader* - reader to initialise
+ *
+ * @param const char* - path
+ *
+ * @return int - error code
+ * Note: 0 on success, EBADMSG if the file is not a complete log file, for other non-zero values refer to errno codes
+ */
+int can_interact_log_map(struct can_interact_log_reader *reader, const char *path);
+
+/**
+ * @brief can_interact_log_query - starts query for frames within time range and (optionally) of given identifiers
+ * Blocks outside the time range or without any of the identifiers are skipped without being decoded
+ *
+ * @param const struct can_interact_log_reader* - reader (must outlive cursor)
+ *
+ * @param struct can_interact_log_cursor* - cursor to initialise
+ *
+ * @param const uint64_t - start of time range in nanoseconds (inclusive)
+ *
+ * @param const uint64_t - end of time range in nanoseconds (inclusive)
+ *
+ * @param const canid_t* - identifiers to match (including flags such as CAN_EFF_FLAG, must outlive cursor), NULL to match all
+ *
+ * @param const size_t - number of identifiers
+ */
+void can_interact_log_query(const struct can_interact_log_reader *reader, struct can_interact_log_cursor *cursor, const uint64_t from_ns, const uint64_t to_ns, const canid_t *ids, const size_t ids_len);
+
+/**
+ * @brief can_interact_log_blocks - getter for number of blocks of log file, e.g. to split queries with can_interact_log_range
+ *
+ * @param const struct can_interact_log_reader* - reader
+ *
+ * @return uint32_t - number of blocks
+ */
+uint32_t can_interact_log_blocks(const struct can_interact_log_reader *reader);
+
+/**
+ * @brief can_interact_log_range - restricts started query to range of blocks, so that disjoint ranges can be read concurrently
+ *
+ * @param struct can_interact_log_cursor* - cursor, just initialised with can_interact_log_query
+ *
+ * @param const uint32_t - first block (inclusive)
+ *
+ * @param const uint32_t - last block (exclusive)
+ */
+void can_interact_log_range(struct can_interact_log_cursor *cursor, const uint32_t first, const uint32_t last);
+
+/**
+ * @brief can_interact_log_next - reads next frame matching query, in file (i.e. time) order
+ *
+ * @param struct can_interact_log_cursor* - cursor
+ *
+ * @param struct can_interact_timed_frame* - pointer to frame to write to
+ *
+ * @return int - error code
+ * Note: 0 on success, ENOENT if no frames are left, EBADMSG if a block is corrupt
+ */
+int can_interact_log_next(struct can_interact_log_cursor *cursor, struct can_interact_timed_frame *frame);
+
+/**
+ * @brief can_interact_log_unmap - unmaps log file
+ *
+ * @param struct can_interact_log_reader* - reader
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_log_unmap(struct can_interact_log_reader *reader);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_LOG_H */
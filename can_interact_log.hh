@@ -0,0 +1,272 @@
+#ifndef CAN_INTERACT_LOG_HH
+#define CAN_INTERACT_LOG_HH
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <utility>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <errno.h>
+
+#include "can_interact.hh"
+#include "can_interact_log.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact indexed, compressed log files
+ * For declarations for the native C library, see can_interact_log.h
+ */
+
+namespace can_interact {
+
+	class LogWriter {
+		/**
+		  * @brief LogWriter (class) - writes log file, index is written on close (or destruction)
+		  */
+		private:
+			std::unique_ptr<can_interact_log_writer> _state ;
+			bool _open ;
+
+		public:
+			/**
+			  * @brief LogWriter (constructor) - creates (truncating) log file
+			  * @param const std::string& - path
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			LogWriter(const std::string&) noexcept(false) ;
+
+			LogWriter(LogWriter&&) noexcept = default ;
+			LogWriter& operator=(LogWriter&&) noexcept = default ;
+
+			/**
+			  * @brief write (overload) - appends frames
+			  * @param const can_interact_timed_frame* - frames, timestamps must not decrease
+			  * @param const std::size_t - number of frames
+			  * @throws std::invalid_argument - if a timestamp decreased
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void write(const can_interact_timed_frame*, const std::size_t) noexcept(false) ;
+
+			/**
+			  * @brief write (overload) - appends frame
+			  * @param const can_interact_timed_frame& - frame, timestamp must not decrease
+			  * @throws std::invalid_argument - if the timestamp decreased
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void write(const can_interact_timed_frame&) noexcept(false) ;
+
+			/**
+			  * @brief close - writes out last block and index, then closes file
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void close() noexcept(false) ;
+
+			/**
+			  * @brief ~LogWriter (destructor) - closes file if still open (errors are not reported, call close beforehand to observe them)
+			  */
+			~LogWriter() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			LogWriter() = delete ;
+			LogWriter(const LogWriter&) = delete ;
+			LogWriter& operator=(const LogWriter&) = delete ;
+	} ;
+
+	class LogQuery {
+		/**
+		  * @brief LogQuery (class) - frames of a log file matching time range and identifiers, see LogReader::query
+		  */
+		private:
+			std::vector<canid_t> _ids ;
+			std::unique_ptr<can_interact_log_cursor> _cursor ;
+
+		public:
+			/**
+			  * @brief LogQuery (constructor) - starts query, prefer LogReader::query
+			  * @param const can_interact_log_reader& - mapped log file (must outlive query)
+			  * @param const std::uint64_t - start of time range in nanoseconds (inclusive)
+			  * @param const std::uint64_t - end of time range in nanoseconds (inclusive)
+			  * @param std::vector<canid_t> - identifiers to match, empty to match all
+			  */
+			LogQuery(const can_interact_log_reader&, const std::uint64_t, const std::uint64_t, std::vector<canid_t>) noexcept(false) ;
+
+			LogQuery(LogQuery&&) noexcept = default ;
+			LogQuery& operator=(LogQuery&&) noexcept = default ;
+
+			/**
+			  * @brief next - reads next matching frame in time order
+			  * @param can_interact_timed_frame& - frame to write to
+			  * @return bool - false once no frames are left
+			  * @throws std::runtime_error - if the file is corrupt
+			  */
+			bool next(can_interact_timed_frame&) noexcept(false) ;
+
+			/**
+			  * @brief blocks_decoded - getter for number of blocks decoded so far
+			  * @return unsigned long - blocks passing the index
+			  */
+			unsigned long blocks_decoded() const noexcept ;
+
+			/**
+			  * @brief blocks_skipped - getter for number of blocks skipped so far (within time range, but without matching identifiers)
+			  * @return unsigned long - blocks ruled out by the index
+			  */
+			unsigned long blocks_skipped() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			LogQuery() = delete ;
+			LogQuery(const LogQuery&) = delete ;
+			LogQuery& operator=(const LogQuery&) = delete ;
+	} ;
+
+	class LogReader {
+		/**
+		  * @brief LogReader (class) - memory mapped log file, queries may run concurrently
+		  */
+		private:
+			std::unique_ptr<can_interact_log_reader> _state ;
+
+		public:
+			/**
+			  * @brief LogReader (constructor) - maps log file
+			  * @param const std::string& - path
+			  * @throws std::runtime_error - if the file cannot be mapped or is not a complete log file
+			  */
+			LogReader(const std::string&) noexcept(false) ;
+
+			LogReader(LogReader&&) noexcept = default ;
+			LogReader& operator=(LogReader&&) noexcept = default ;
+
+			/**
+			  * @brief query - starts query for frames within time range and of given identifiers
+			  * @param const std::uint64_t - start of time range in nanoseconds (inclusive)
+			  * @param const std::uint64_t - end of time range in nanoseconds (inclusive)
+			  * @param std::vector<canid_t> - identifiers to match (including flags such as CAN_EFF_FLAG), empty to match all
+			  * @return LogQuery - query, must not outlive this object
+			  */
+			LogQuery query(const std::uint64_t, const std::uint64_t, std::vector<canid_t> = {}) const noexcept(false) ;
+
+			/**
+			  * @brief ~LogReader (destructor) - unmaps log file
+			  */
+			~LogReader() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			LogReader() = delete ;
+			LogReader(const LogReader&) = delete ;
+			LogReader& operator=(const LogReader&) = delete ;
+	} ;
+
+}
+
+can_interact::LogWriter::LogWriter(const std::string& path) noexcept(false)
+	: _state{new can_interact_log_writer}, _open{false}
+{
+	const int res = can_interact_log_create(this->_state.get(), path.c_str()) ;
+	if(res != 0)
+	{
+		if(this->_state->fd != -1)
+		{
+			can_interact_log_close(this->_state.get()) ;
+		}
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	this->_open = true ;
+}
+
+void can_interact::LogWriter::write(const can_interact_timed_frame* frames, const std::size_t len) noexcept(false)
+{
+	const int res = can_interact_log_write(this->_state.get(), frames, len) ;
+	if(res == EINVAL)
+	{
+		throw std::invalid_argument(std::string{"Timestamps must not decrease"}) ;
+	}
+	else if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::LogWriter::write(const can_interact_timed_frame& frame) noexcept(false)
+{
+	this->write(&frame, 1) ;
+}
+
+void can_interact::LogWriter::close() noexcept(false)
+{
+	if(this->_open)
+	{
+		this->_open = false ;
+		const int res = can_interact_log_close(this->_state.get()) ;
+		if(res != 0)
+		{
+			throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+		}
+	}
+}
+
+can_interact::LogWriter::~LogWriter() noexcept
+{
+	if(this->_state && this->_open)
+	{
+		can_interact_log_close(this->_state.get()) ;
+	}
+}
+
+can_interact::LogQuery::LogQuery(const can_interact_log_reader& reader, const std::uint64_t from, const std::uint64_t to, std::vector<canid_t> ids) noexcept(false)
+	: _ids{std::move(ids)}, _cursor{new can_interact_log_cursor}
+{
+	can_interact_log_query(&reader, this->_cursor.get(), from, to, this->_ids.empty() ? nullptr : this->_ids.data(), this->_ids.size()) ;
+}
+
+bool can_interact::LogQuery::next(can_interact_timed_frame& frame) noexcept(false)
+{
+	const int res = can_interact_log_next(this->_cursor.get(), &frame) ;
+	if(res == ENOENT)
+	{
+		return false ;
+	}
+	else if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return true ;
+}
+
+unsigned long can_interact::LogQuery::blocks_decoded() const noexcept
+{
+	return this->_cursor->blocks_decoded ;
+}
+
+unsigned long can_interact::LogQuery::blocks_skipped() const noexcept
+{
+	return this->_cursor->blocks_skipped ;
+}
+
+can_interact::LogReader::LogReader(const std::string& path) noexcept(false)
+	: _state{new can_interact_log_reader}
+{
+	const int res = can_interact_log_map(this->_state.get(), path.c_str()) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+can_interact::LogQuery can_interact::LogReader::query(const std::uint64_t from, const std::uint64_t to, std::vector<canid_t> ids) const noexcept(false)
+{
+	return LogQuery{*this->_state, from, to, std::move(ids)} ;
+}
+
+can_interact::LogReader::~LogReader() noexcept
+{
+	if(this->_state)
+	{
+		can_interact_log_unmap(this->_state.get()) ;
+	}
+}
+
+#endif // CAN_INTERACT_LOG_HH
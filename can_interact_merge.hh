@@ -0,0 +1,370 @@
+#ifndef CAN_INTERACT_MERGE_HH
+#define CAN_INTERACT_MERGE_HH
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+
+#include "can_interact.hh"
+
+/**
+ * @brief CXX API (C++11) time ordered k-way merge of several frame streams (e.g. can0..can5) into one, tagging each frame with its source
+ * Every source delivers frames in timestamp order on its own - the merger keeps one head per source in a small heap and emits the earliest
+ * A head is emitted once every live source has a frame buffered (nothing earlier can arrive), or once it is older than the maximum reordering delay
+ * Live sources use kernel receive timestamps (CLOCK_REALTIME), file sources (see can_interact_text.hh, can_interact_log.hh) never hold back the merge
+ */
+
+namespace can_interact {
+
+	class StreamMerger {
+		/**
+		  * @brief StreamMerger (class) - merges live and recorded frame sources by timestamp
+		  */
+		public:
+			/**
+			  * @brief pull_t - file source, fills array with next frames, returns number of frames (0 at end of source)
+			  */
+			typedef std::function<std::size_t(can_interact_timed_frame*, std::size_t)> pull_t ;
+
+			struct tagged_t {
+				/**
+				  * @brief tagged_t - merged frame and index of its source (in order of adding, see name)
+				  */
+				can_interact_timed_frame frame ;
+				std::size_t source ;
+			} ;
+
+			struct stats_t {
+				/**
+				  * @brief stats_t - merge counters
+				  */
+				std::uint64_t emitted ;
+				std::uint64_t forced ; // emitted on reaching the maximum delay while a live source had nothing buffered
+				std::uint64_t late ; // emitted with a timestamp below an earlier emitted one (arrived after the maximum delay)
+			} ;
+
+		private:
+			struct _source {
+				/**
+				  * @brief _source - INTERNAL. buffered batch of one source
+				  */
+				std::string name ;
+				int socket ; // -1 for file sources
+				pull_t pull ;
+				can_interact_timed_frame buf[CAN_INTERACT_MAX_BATCH] ;
+				std::size_t head ;
+				std::size_t len ;
+				bool ended ;
+			} ;
+
+			std::vector<std::unique_ptr<_source>> _sources ;
+			std::vector<std::pair<std::uint64_t, std::size_t>> _heap ; // timestamp and source of each buffered head, earliest first
+			std::uint64_t _delay_ns ;
+			std::uint64_t _last_ns ;
+			stats_t _stats ;
+
+			/**
+			  * @brief _fill - INTERNAL METHOD. refills empty buffer of source and pushes its head onto heap
+			  * @param const std::size_t - source
+			  * @param const bool - whether live source is known to be readable (otherwise it is polled without blocking)
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void _fill(const std::size_t, const bool) noexcept(false) ;
+
+			/**
+			  * @brief _waiting - INTERNAL METHOD. counts live sources without buffered frames, which hold back the merge
+			  * @return std::size_t - number of sources
+			  */
+			std::size_t _waiting() const noexcept ;
+
+			/**
+			  * @brief _now - INTERNAL METHOD. current time on the clock of kernel receive timestamps
+			  * @return std::uint64_t - CLOCK_REALTIME nanoseconds
+			  */
+			static std::uint64_t _now() noexcept ;
+
+		public:
+			/**
+			  * @brief StreamMerger (constructor) - creates merger without sources
+			  * @param const std::uint64_t - maximum reordering delay in nanoseconds, i.e. how long a frame may wait for earlier frames of idle live sources
+			  */
+			StreamMerger(const std::uint64_t) noexcept ;
+
+			StreamMerger(StreamMerger&&) noexcept = default ;
+			StreamMerger& operator=(StreamMerger&&) noexcept = default ;
+
+			/**
+			  * @brief add (overload) - adds live source, enabling its kernel receive timestamps
+			  * @param const std::string& - name of source, e.g. interface name
+			  * @param const CAN& - connection (must outlive merger)
+			  * @return std::size_t - index of source, as tagged on its frames
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::size_t add(const std::string&, const CAN&) noexcept(false) ;
+
+			/**
+			  * @brief add (overload) - adds file source
+			  * @param const std::string& - name of source, e.g. interface the file was recorded on
+			  * @param pull_t - callable reading next frames (e.g. TextParser::parse), returning 0 at end
+			  * @return std::size_t - index of source, as tagged on its frames
+			  */
+			std::size_t add(const std::string&, pull_t) noexcept(false) ;
+
+			/**
+			  * @brief next - emits next frames in timestamp order, waiting for live sources if needed
+			  * @param tagged_t* - array to write frames to
+			  * @param const std::size_t - capacity of array
+			  * @param const int - maximum wait in milliseconds, -1 to wait until frames can be emitted
+			  * @return std::size_t - number of frames emitted, 0 on timeout or once all sources ended (see ended)
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::size_t next(tagged_t*, const std::size_t, const int) noexcept(false) ;
+
+			/**
+			  * @brief ended - whether all sources ended and every frame was emitted (live sources never end)
+			  * @return bool - end of merged stream
+			  */
+			bool ended() const noexcept ;
+
+			/**
+			  * @brief name - getter for name of source
+			  * @param const std::size_t - index of source
+			  * @return const std::string& - name given when adding
+			  */
+			const std::string& name(const std::size_t) const noexcept ;
+
+			/**
+			  * @brief stats - getter for merge counters
+			  * @return stats_t - counters
+			  */
+			stats_t stats() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			StreamMerger() = delete ;
+			StreamMerger(const StreamMerger&) = delete ;
+			StreamMerger& operator=(const StreamMerger&) = delete ;
+	} ;
+
+}
+
+can_interact::StreamMerger::StreamMerger(const std::uint64_t delay_ns) noexcept
+	: _sources{}, _heap{}, _delay_ns{delay_ns}, _last_ns{0}, _stats{0, 0, 0}
+{
+}
+
+std::uint64_t can_interact::StreamMerger::_now() noexcept
+{
+	timespec now ;
+	clock_gettime(CLOCK_REALTIME, &now) ;
+	return static_cast<std::uint64_t>(now.tv_sec) * 1000000000u + static_cast<std::uint64_t>(now.tv_nsec) ;
+}
+
+std::size_t can_interact::StreamMerger::add(const std::string& name, const CAN& can) noexcept(false)
+{
+	can.timestamps() ;
+	std::unique_ptr<_source> source{new _source} ;
+	source->name = name ;
+	source->socket = can.socket() ;
+	source->head = 0 ;
+	source->len = 0 ;
+	source->ended = false ;
+	this->_sources.push_back(std::move(source)) ;
+	this->_heap.reserve(this->_sources.size()) ;
+	return this->_sources.size() - 1 ;
+}
+
+std::size_t can_interact::StreamMerger::add(const std::string& name, pull_t pull) noexcept(false)
+{
+	std::unique_ptr<_source> source{new _source} ;
+	source->name = name ;
+	source->socket = -1 ;
+	source->pull = std::move(pull) ;
+	source->head = 0 ;
+	source->len = 0 ;
+	source->ended = false ;
+	this->_sources.push_back(std::move(source)) ;
+	this->_heap.reserve(this->_sources.size()) ;
+	this->_fill(this->_sources.size() - 1, false) ;
+	return this->_sources.size() - 1 ;
+}
+
+void can_interact::StreamMerger::_fill(const std::size_t idx, const bool readable) noexcept(false)
+{
+	_source& source = *this->_sources[idx] ;
+	source.head = 0 ;
+	source.len = 0 ;
+	if(source.ended)
+	{
+		return ;
+	}
+	if(source.socket == -1)
+	{
+		source.len = source.pull(source.buf, CAN_INTERACT_MAX_BATCH) ;
+		source.ended = source.len == 0 ;
+	}
+	else
+	{
+		pollfd fd = {source.socket, POLLIN, 0} ;
+		if(!readable && poll(&fd, 1, 0) <= 0)
+		{
+			return ;
+		}
+		const int res = can_interact_get_frames(source.buf, CAN_INTERACT_MAX_BATCH, &source.len, &source.socket) ;
+		if(res != 0 && res != EAGAIN && res != EINTR)
+		{
+			throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+		}
+	}
+	if(source.len > 0)
+	{
+		const std::greater<std::pair<std::uint64_t, std::size_t>> later ;
+		this->_heap.emplace_back(source.buf[0].timestamp_ns, idx) ;
+		std::push_heap(this->_heap.begin(), this->_heap.end(), later) ;
+	}
+}
+
+std::size_t can_interact::StreamMerger::_waiting() const noexcept
+{
+	std::size_t waiting = 0 ;
+	for(const std::unique_ptr<_source>& source : this->_sources)
+	{
+		waiting += source->socket != -1 && source->head == source->len ? 1 : 0 ;
+	}
+	return waiting ;
+}
+
+std::size_t can_interact::StreamMerger::next(tagged_t* frames, const std::size_t len, const int timeout_ms) noexcept(false)
+{
+	const std::greater<std::pair<std::uint64_t, std::size_t>> later ;
+	const std::uint64_t deadline = timeout_ms < 0 ? UINT64_MAX : StreamMerger::_now() + static_cast<std::uint64_t>(timeout_ms) * 1000000u ;
+	std::vector<pollfd> fds ;
+	std::vector<std::size_t> polled ;
+
+	for(;;)
+	{
+		// pick up whatever live sources already have queued, so the heap sees all available heads
+		for(std::size_t i = 0 ; i < this->_sources.size() ; ++i)
+		{
+			if(this->_sources[i]->socket != -1 && this->_sources[i]->head == this->_sources[i]->len)
+			{
+				this->_fill(i, false) ;
+			}
+		}
+
+		std::size_t emitted = 0 ;
+		std::uint64_t now = StreamMerger::_now() ;
+		while(emitted < len && !this->_heap.empty())
+		{
+			const std::pair<std::uint64_t, std::size_t> top = this->_heap.front() ;
+			const bool complete = this->_waiting() == 0 ;
+			if(!complete && (now < top.first || now - top.first < this->_delay_ns))
+			{
+				break ; // an idle live source may still deliver an earlier frame
+			}
+			std::pop_heap(this->_heap.begin(), this->_heap.end(), later) ;
+			this->_heap.pop_back() ;
+
+			_source& source = *this->_sources[top.second] ;
+			frames[emitted].frame = source.buf[source.head++] ;
+			frames[emitted].source = top.second ;
+			++emitted ;
+			++this->_stats.emitted ;
+			this->_stats.forced += complete ? 0 : 1 ;
+			if(top.first < this->_last_ns)
+			{
+				++this->_stats.late ;
+			}
+			else
+			{
+				this->_last_ns = top.first ;
+			}
+
+			if(source.head < source.len)
+			{
+				this->_heap.emplace_back(source.buf[source.head].timestamp_ns, top.second) ;
+				std::push_heap(this->_heap.begin(), this->_heap.end(), later) ;
+			}
+			else
+			{
+				this->_fill(top.second, false) ;
+			}
+		}
+		if(emitted > 0 || this->ended())
+		{
+			return emitted ;
+		}
+
+		// wait for an idle live source, or until the earliest head reaches the maximum delay
+		now = StreamMerger::_now() ;
+		if(now >= deadline)
+		{
+			return 0 ;
+		}
+		std::uint64_t wake = deadline ;
+		if(!this->_heap.empty() && this->_heap.front().first <= UINT64_MAX - this->_delay_ns)
+		{
+			wake = std::min(wake, this->_heap.front().first + this->_delay_ns) ;
+		}
+		fds.clear() ;
+		polled.clear() ;
+		for(std::size_t i = 0 ; i < this->_sources.size() ; ++i)
+		{
+			if(this->_sources[i]->socket != -1 && this->_sources[i]->head == this->_sources[i]->len)
+			{
+				fds.push_back(pollfd{this->_sources[i]->socket, POLLIN, 0}) ;
+				polled.push_back(i) ;
+			}
+		}
+		const int wait_ms = wake == UINT64_MAX ? -1 : (wake <= now ? 0 : static_cast<int>(std::min<std::uint64_t>((wake - now + 999999u) / 1000000u, 60000u))) ;
+		const int ready = poll(fds.data(), fds.size(), wait_ms) ;
+		if(ready < 0 && errno != EINTR)
+		{
+			throw std::runtime_error(std::string{"Errno "} + std::to_string(errno)) ;
+		}
+		for(std::size_t i = 0 ; ready > 0 && i < fds.size() ; ++i)
+		{
+			if(fds[i].revents & POLLIN)
+			{
+				this->_fill(polled[i], true) ;
+			}
+		}
+	}
+}
+
+bool can_interact::StreamMerger::ended() const noexcept
+{
+	if(!this->_heap.empty())
+	{
+		return false ;
+	}
+	for(const std::unique_ptr<_source>& source : this->_sources)
+	{
+		if(!source->ended)
+		{
+			return false ;
+		}
+	}
+	return true ;
+}
+
+const std::string& can_interact::StreamMerger::name(const std::size_t idx) const noexcept
+{
+	return this->_sources[idx]->name ;
+}
+
+can_interact::StreamMerger::stats_t can_interact::StreamMerger::stats() const noexcept
+{
+	return this->_stats ;
+}
+
+#endif // CAN_INTERACT_MERGE_HH
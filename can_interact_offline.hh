@@ -0,0 +1,541 @@
+#ifndef CAN_INTERACT_OFFLINE_HH
+#define CAN_INTERACT_OFFLINE_HH
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <exception>
+#include <unordered_map>
+#include <algorithm>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <errno.h>
+
+#include "can_interact.hh"
+#include "can_interact_log.h"
+#include "can_interact_text.h"
+
+/**
+ * @brief CXX API (C++11) parallel offline decoding of capture files into per-signal time series
+ * The capture is split into chunks (groups of log blocks, or newline aligned ranges of text), which a work-stealing pool decodes concurrently
+ * Per-chunk columns are then merged in timestamp order, ties keeping file order, so results equal a sequential pass over the file followed by a stable sort by timestamp
+ * Values are produced by can_interact_decode, exactly as when decoding received frames online
+ * Requires linking with -pthread
+ */
+
+namespace can_interact {
+
+	class OfflineDecoder {
+		/**
+		  * @brief OfflineDecoder (class) - decodes signals of whole capture files using all cores
+		  */
+		public:
+			struct signal_t {
+				/**
+				  * @brief signal_t - signal to extract, bytes [offset, offset + length) of frames with identifier id are passed to can_interact_decode
+				  */
+				canid_t id ; // including CAN_EFF_FLAG for extended identifiers
+				std::uint8_t offset ;
+				std::uint8_t length ; // 1-8, 4 or 8 for DATA_TYPE_FLOAT
+				can_interact_data_type type ;
+				can_interact_endianness endianness ;
+			} ;
+
+			union value_t {
+				/**
+				  * @brief value_t - decoded value, member according to signal_t::type
+				  */
+				std::uint64_t u ;
+				std::int64_t i ;
+				double f ;
+			} ;
+
+			struct column_t {
+				/**
+				  * @brief column_t - time series of one signal, both vectors have equal length
+				  */
+				std::vector<std::uint64_t> timestamps ;
+				std::vector<value_t> values ;
+			} ;
+
+			struct stats_t {
+				/**
+				  * @brief stats_t - counters of the last decode call
+				  */
+				std::uint64_t frames ; // frames read from capture (log files only yield frames of signal identifiers)
+				std::uint64_t samples ; // values decoded
+				std::uint64_t skipped ; // frames of a signal's identifier too short for it
+				std::uint64_t chunks ;
+				std::uint64_t steals ; // chunks run by a thread other than the one they were dealt to
+			} ;
+
+		private:
+			std::vector<signal_t> _signals ;
+			std::unordered_map<canid_t, std::vector<std::size_t>> _index ; // identifier to signals
+			std::size_t _threads ;
+			stats_t _stats ;
+
+			struct _chunk {
+				/**
+				  * @brief _chunk - INTERNAL. output of decoding one chunk
+				  */
+				std::vector<column_t> columns ;
+				std::uint64_t frames ;
+				std::uint64_t skipped ;
+				int res ;
+			} ;
+
+			/**
+			  * @brief _run - INTERNAL METHOD. runs tasks on worker threads, each owning a deque of tasks and stealing from others once it is empty
+			  * @param const std::size_t - number of tasks
+			  * @param const std::function<void(std::size_t)>& - task, called with task index
+			  * @return std::uint64_t - number of stolen tasks
+			  * @throws - the first exception of a task, rethrown on the calling thread once all workers were joined
+			  */
+			std::uint64_t _run(const std::size_t, const std::function<void(std::size_t)>&) const noexcept(false) ;
+
+			/**
+			  * @brief _decode - INTERNAL METHOD. decodes signals of frame into chunk's columns
+			  * @param const can_interact_timed_frame& - frame
+			  * @param _chunk& - chunk output
+			  */
+			void _decode(const can_interact_timed_frame&, _chunk&) const noexcept ;
+
+			/**
+			  * @brief _merge - INTERNAL METHOD. merges chunk columns in timestamp order
+			  * @param std::vector<_chunk>& - decoded chunks (columns are consumed)
+			  * @return std::vector<column_t> - one column per signal
+			  */
+			std::vector<column_t> _merge(std::vector<_chunk>&) noexcept(false) ;
+
+		public:
+			/**
+			  * @brief OfflineDecoder (constructor) - sets up decoder
+			  * @param std::vector<signal_t> - signals to extract
+			  * @param const std::size_t - worker threads, 0 for one per core
+			  * @throws std::invalid_argument - if a signal does not fit into a frame or has an invalid length for its type
+			  */
+			OfflineDecoder(std::vector<signal_t>, const std::size_t = 0) noexcept(false) ;
+
+			OfflineDecoder(OfflineDecoder&&) noexcept = default ;
+			OfflineDecoder& operator=(OfflineDecoder&&) noexcept = default ;
+
+			/**
+			  * @brief decode_log - decodes log file written by can_interact_log (see can_interact_log.h), only blocks holding signal identifiers are read
+			  * @param const std::string& - path
+			  * @param const std::uint32_t - blocks per chunk
+			  * @return std::vector<column_t> - one column per signal, in order of construction
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::vector<column_t> decode_log(const std::string&, const std::uint32_t = 16) noexcept(false) ;
+
+			/**
+			  * @brief decode_text - decodes candump / ASC text log (see can_interact_text.h)
+			  * @param const std::string& - path
+			  * @param const can_interact_text_format - format of file
+			  * @param const std::uint64_t - added to ASC timestamps (measurement start)
+			  * @param const std::size_t - bytes per chunk
+			  * @return std::vector<column_t> - one column per signal, in order of construction
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::vector<column_t> decode_text(const std::string&, const can_interact_text_format, const std::uint64_t = 0, const std::size_t = 1 << 22) noexcept(false) ;
+
+			/**
+			  * @brief stats - getter for counters of the last decode call
+			  * @return stats_t - counters
+			  */
+			stats_t stats() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			OfflineDecoder() = delete ;
+			OfflineDecoder(const OfflineDecoder&) = delete ;
+			OfflineDecoder& operator=(const OfflineDecoder&) = delete ;
+	} ;
+
+}
+
+can_interact::OfflineDecoder::OfflineDecoder(std::vector<signal_t> signals, const std::size_t threads) noexcept(false)
+	: _signals{std::move(signals)}, _index{}, _threads{threads}, _stats{0, 0, 0, 0, 0}
+{
+	for(std::size_t i = 0 ; i < this->_signals.size() ; ++i)
+	{
+		const signal_t& signal = this->_signals[i] ;
+		if(signal.length == 0 || signal.offset + signal.length > 8 || (signal.type == DATA_TYPE_FLOAT && signal.length != 4 && signal.length != 8))
+		{
+			throw std::invalid_argument(std::string{"Invalid signal layout for id "} + std::to_string(signal.id)) ;
+		}
+		this->_index[signal.id].push_back(i) ;
+	}
+	if(this->_threads == 0)
+	{
+		this->_threads = std::thread::hardware_concurrency() == 0 ? 1 : std::thread::hardware_concurrency() ;
+	}
+}
+
+std::uint64_t can_interact::OfflineDecoder::_run(const std::size_t count, const std::function<void(std::size_t)>& task) const noexcept(false)
+{
+	const std::size_t workers = std::min(this->_threads, count) ;
+	if(workers <= 1)
+	{
+		for(std::size_t i = 0 ; i < count ; ++i)
+		{
+			task(i) ;
+		}
+		return 0 ;
+	}
+
+	struct queue_t
+	{
+		std::mutex lock ;
+		std::deque<std::size_t> tasks ;
+	} ;
+	std::unique_ptr<queue_t[]> queues{new queue_t[workers]} ;
+	// contiguous ranges, so neighbouring chunks (and their pages) stay with one thread unless stolen
+	for(std::size_t i = 0 ; i < count ; ++i)
+	{
+		queues[i * workers / count].tasks.push_back(i) ;
+	}
+
+	std::atomic<std::uint64_t> steals{0} ;
+	std::atomic<bool> failed{false} ; // remaining tasks are abandoned after the first exception
+	std::exception_ptr error ;
+	std::mutex error_lock ;
+	const auto fail = [&]()
+	{
+		std::lock_guard<std::mutex> guard(error_lock) ;
+		if(!error)
+		{
+			error = std::current_exception() ;
+		}
+		failed.store(true, std::memory_order_relaxed) ;
+	} ;
+	const auto work = [&](const std::size_t self)
+	{
+		for(;;)
+		{
+			std::size_t next = count ;
+			{
+				std::lock_guard<std::mutex> guard(queues[self].lock) ;
+				if(!queues[self].tasks.empty())
+				{
+					next = queues[self].tasks.front() ;
+					queues[self].tasks.pop_front() ;
+				}
+			}
+			for(std::size_t i = 1 ; next == count && i < workers ; ++i)
+			{
+				queue_t& victim = queues[(self + i) % workers] ;
+				std::lock_guard<std::mutex> guard(victim.lock) ;
+				if(!victim.tasks.empty())
+				{
+					next = victim.tasks.back() ; // steal from the far end, away from the owner
+					victim.tasks.pop_back() ;
+					steals.fetch_add(1, std::memory_order_relaxed) ;
+				}
+			}
+			if(next == count || failed.load(std::memory_order_relaxed))
+			{
+				return ; // tasks never spawn tasks, so empty queues stay empty
+			}
+			try
+			{
+				task(next) ;
+			}
+			catch(...) // must not escape a thread (or this one while others are joinable)
+			{
+				fail() ;
+				return ;
+			}
+		}
+	} ;
+
+	std::vector<std::thread> threads ;
+	try
+	{
+		threads.reserve(workers - 1) ;
+		for(std::size_t i = 1 ; i < workers ; ++i)
+		{
+			threads.emplace_back(work, i) ;
+		}
+	}
+	catch(...)
+	{
+		fail() ;
+	}
+	work(0) ;
+	for(std::thread& thread : threads)
+	{
+		thread.join() ;
+	}
+	if(error)
+	{
+		std::rethrow_exception(error) ;
+	}
+	return steals.load() ;
+}
+
+void can_interact::OfflineDecoder::_decode(const can_interact_timed_frame& frame, _chunk& chunk) const noexcept
+{
+	++chunk.frames ;
+	if(frame.frame.can_id & (CAN_RTR_FLAG | CAN_ERR_FLAG))
+	{
+		return ;
+	}
+	const std::unordered_map<canid_t, std::vector<std::size_t>>::const_iterator it = this->_index.find(frame.frame.can_id) ;
+	if(it == this->_index.end())
+	{
+		return ;
+	}
+	for(const std::size_t i : it->second)
+	{
+		const signal_t& signal = this->_signals[i] ;
+		if(signal.offset + signal.length > frame.frame.can_dlc)
+		{
+			++chunk.skipped ;
+			continue ;
+		}
+		can_frame part ;
+		std::memset(&part, 0, sizeof(part)) ;
+		part.can_id = frame.frame.can_id ;
+		part.can_dlc = signal.length ;
+		std::memcpy(part.data, frame.frame.data + signal.offset, signal.length) ;
+		value_t value ;
+		if(can_interact_decode(&part, signal.type, signal.endianness, &value) != 0)
+		{
+			++chunk.skipped ;
+			continue ;
+		}
+		chunk.columns[i].timestamps.push_back(frame.timestamp_ns) ;
+		chunk.columns[i].values.push_back(value) ;
+	}
+}
+
+std::vector<can_interact::OfflineDecoder::column_t> can_interact::OfflineDecoder::_merge(std::vector<_chunk>& chunks) noexcept(false)
+{
+	for(const _chunk& chunk : chunks)
+	{
+		if(chunk.res != 0)
+		{
+			throw std::runtime_error(std::string{"Errno "} + std::to_string(chunk.res)) ;
+		}
+		this->_stats.frames += chunk.frames ;
+		this->_stats.skipped += chunk.skipped ;
+	}
+
+	std::vector<column_t> merged(this->_signals.size()) ;
+	this->_run(this->_signals.size(), [&](const std::size_t signal)
+	{
+		// text captures of several interfaces need not be in time order, so order each chunk first (stable, so ties keep file order)
+		std::size_t total = 0 ;
+		for(_chunk& chunk : chunks)
+		{
+			column_t& column = chunk.columns[signal] ;
+			total += column.timestamps.size() ;
+			if(!std::is_sorted(column.timestamps.begin(), column.timestamps.end()))
+			{
+				std::vector<std::size_t> order(column.timestamps.size()) ;
+				for(std::size_t i = 0 ; i < order.size() ; ++i)
+				{
+					order[i] = i ;
+				}
+				std::stable_sort(order.begin(), order.end(), [&](const std::size_t a, const std::size_t b) { return column.timestamps[a] < column.timestamps[b] ; }) ;
+				column_t sorted ;
+				sorted.timestamps.reserve(order.size()) ;
+				sorted.values.reserve(order.size()) ;
+				for(const std::size_t i : order)
+				{
+					sorted.timestamps.push_back(column.timestamps[i]) ;
+					sorted.values.push_back(column.values[i]) ;
+				}
+				column = std::move(sorted) ;
+			}
+		}
+
+		// k-way merge over chunk heads, ordered by timestamp then chunk
+		typedef std::pair<std::uint64_t, std::size_t> head_t ;
+		std::vector<head_t> heap ;
+		std::vector<std::size_t> pos(chunks.size(), 0) ;
+		for(std::size_t c = 0 ; c < chunks.size() ; ++c)
+		{
+			if(!chunks[c].columns[signal].timestamps.empty())
+			{
+				heap.emplace_back(chunks[c].columns[signal].timestamps[0], c) ;
+			}
+		}
+		const std::greater<head_t> later ;
+		std::make_heap(heap.begin(), heap.end(), later) ;
+		column_t& out = merged[signal] ;
+		out.timestamps.reserve(total) ;
+		out.values.reserve(total) ;
+		while(!heap.empty())
+		{
+			std::pop_heap(heap.begin(), heap.end(), later) ;
+			const std::size_t c = heap.back().second ;
+			heap.pop_back() ;
+			const column_t& column = chunks[c].columns[signal] ;
+			// copy the run which stays at or before the next chunk's head, the common case for captures in time order is one run per chunk
+			const std::uint64_t limit = heap.empty() ? UINT64_MAX : heap.front().first ;
+			const std::size_t tie = heap.empty() ? chunks.size() : heap.front().second ;
+			std::size_t end = pos[c] ;
+			while(end < column.timestamps.size() && (column.timestamps[end] < limit || (column.timestamps[end] == limit && c < tie)))
+			{
+				++end ;
+			}
+			out.timestamps.insert(out.timestamps.end(), column.timestamps.begin() + static_cast<std::ptrdiff_t>(pos[c]), column.timestamps.begin() + static_cast<std::ptrdiff_t>(end)) ;
+			out.values.insert(out.values.end(), column.values.begin() + static_cast<std::ptrdiff_t>(pos[c]), column.values.begin() + static_cast<std::ptrdiff_t>(end)) ;
+			pos[c] = end ;
+			if(end < column.timestamps.size())
+			{
+				heap.emplace_back(column.timestamps[end], c) ;
+				std::push_heap(heap.begin(), heap.end(), later) ;
+			}
+		}
+		for(_chunk& chunk : chunks)
+		{
+			chunk.columns[signal] = column_t{} ; // release as soon as merged
+		}
+	}) ;
+	return merged ;
+}
+
+std::vector<can_interact::OfflineDecoder::column_t> can_interact::OfflineDecoder::decode_log(const std::string& path, const std::uint32_t blocks_per_chunk) noexcept(false)
+{
+	can_interact_log_reader reader ;
+	const int res = can_interact_log_map(&reader, path.c_str()) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	std::vector<canid_t> ids ;
+	for(const std::pair<const canid_t, std::vector<std::size_t>>& entry : this->_index)
+	{
+		ids.push_back(entry.first) ;
+	}
+
+	const std::uint32_t step = blocks_per_chunk == 0 ? 1 : blocks_per_chunk ;
+	const std::uint32_t blocks = can_interact_log_blocks(&reader) ;
+	std::vector<_chunk> chunks((blocks + step - 1) / step) ;
+	this->_stats = stats_t{0, 0, 0, chunks.size(), 0} ;
+	try
+	{
+		this->_stats.steals = this->_run(chunks.size(), [&](const std::size_t c)
+		{
+			_chunk& chunk = chunks[c] ;
+			chunk.columns.resize(this->_signals.size()) ;
+			chunk.frames = 0 ;
+			chunk.skipped = 0 ;
+			std::unique_ptr<can_interact_log_cursor> cursor{new can_interact_log_cursor} ;
+			can_interact_log_query(&reader, cursor.get(), 0, UINT64_MAX, ids.empty() ? nullptr : ids.data(), ids.size()) ;
+			can_interact_log_range(cursor.get(), static_cast<std::uint32_t>(c) * step, std::min(blocks, static_cast<std::uint32_t>(c + 1) * step)) ;
+			can_interact_timed_frame frame ;
+			while((chunk.res = can_interact_log_next(cursor.get(), &frame)) == 0)
+			{
+				this->_decode(frame, chunk) ;
+			}
+			if(chunk.res == ENOENT)
+			{
+				chunk.res = 0 ;
+			}
+		}) ;
+	}
+	catch(...)
+	{
+		can_interact_log_unmap(&reader) ;
+		throw ;
+	}
+	can_interact_log_unmap(&reader) ;
+
+	std::vector<column_t> merged = this->_merge(chunks) ;
+	for(const column_t& column : merged)
+	{
+		this->_stats.samples += column.timestamps.size() ;
+	}
+	return merged ;
+}
+
+std::vector<can_interact::OfflineDecoder::column_t> can_interact::OfflineDecoder::decode_text(const std::string& path, const can_interact_text_format format, const std::uint64_t base_ns, const std::size_t chunk_bytes) noexcept(false)
+{
+	can_interact_text_parser file ;
+	const int res = can_interact_text_open(&file, path.c_str(), format) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+
+	// ASC headers set the identifier base for the whole file, pick it up before splitting
+	int decimal = 0 ;
+	if(format == TEXT_ASC)
+	{
+		can_interact_text_parser header = file ;
+		can_interact_timed_frame first ;
+		can_interact_text_parse(&header, &first, 1) ;
+		decimal = header.decimal ;
+	}
+
+	std::vector<std::pair<const char*, const char*>> ranges ;
+	const std::size_t step = chunk_bytes == 0 ? 1 : chunk_bytes ;
+	for(const char* start = file.pos ; start < file.end ;)
+	{
+		const char* end = static_cast<std::size_t>(file.end - start) > step ? start + step : file.end ;
+		const char* newline = end < file.end ? static_cast<const char*>(std::memchr(end, '\n', static_cast<std::size_t>(file.end - end))) : nullptr ;
+		end = newline == nullptr ? file.end : newline + 1 ;
+		ranges.emplace_back(start, end) ;
+		start = end ;
+	}
+
+	std::vector<_chunk> chunks(ranges.size()) ;
+	this->_stats = stats_t{0, 0, 0, chunks.size(), 0} ;
+	try
+	{
+		this->_stats.steals = this->_run(chunks.size(), [&](const std::size_t c)
+		{
+			_chunk& chunk = chunks[c] ;
+			chunk.columns.resize(this->_signals.size()) ;
+			chunk.frames = 0 ;
+			chunk.skipped = 0 ;
+			chunk.res = 0 ;
+			can_interact_text_parser parser ;
+			can_interact_text_init(&parser, ranges[c].first, static_cast<std::size_t>(ranges[c].second - ranges[c].first), format) ;
+			parser.base_ns = base_ns ;
+			parser.decimal = decimal ;
+			can_interact_timed_frame frames[CAN_INTERACT_MAX_BATCH] ;
+			std::size_t parsed ;
+			while((parsed = can_interact_text_parse(&parser, frames, CAN_INTERACT_MAX_BATCH)) != 0)
+			{
+				for(std::size_t i = 0 ; i < parsed ; ++i)
+				{
+					this->_decode(frames[i], chunk) ;
+				}
+			}
+		}) ;
+	}
+	catch(...)
+	{
+		can_interact_text_close(&file) ;
+		throw ;
+	}
+	can_interact_text_close(&file) ;
+
+	std::vector<column_t> merged = this->_merge(chunks) ;
+	for(const column_t& column : merged)
+	{
+		this->_stats.samples += column.timestamps.size() ;
+	}
+	return merged ;
+}
+
+can_interact::OfflineDecoder::stats_t can_interact::OfflineDecoder::stats() const noexcept
+{
+	return this->_stats ;
+}
+
+#endif // CAN_INTERACT_OFFLINE_HH
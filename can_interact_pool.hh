@@ -0,0 +1,397 @@
+#ifndef CAN_INTERACT_POOL_HH
+#define CAN_INTERACT_POOL_HH
+#pragma once
+
+#include <memory>
+#include <atomic>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "can_interact.hh"
+
+/**
+ * @brief CXX API (C++11) slab of reference counted frame batches, letting one received batch be shared read-only by many consumers
+ * All storage is allocated when the pool is constructed - acquiring, sharing and releasing batches never allocates
+ * The pool must outlive every batch handed out by it
+ */
+
+namespace can_interact {
+
+	class FramePool ;
+
+	class FrameBatch {
+		/**
+		  * @brief FrameBatch (class) - shared, read-only handle to a batch of timestamped frames living in a FramePool
+		  * Copying a handle adds a reference, the batch returns to its pool when the last handle is destroyed
+		  */
+		friend class FramePool ;
+
+		private:
+			FramePool* _pool ;
+			std::uint32_t _block ;
+
+			/**
+			  * @brief FrameBatch (constructor) (overload) - INTERNAL. adopts freshly acquired block (reference count already 1)
+			  * @param FramePool* - owning pool
+			  * @param const std::uint32_t - index of block
+			  */
+			FrameBatch(FramePool*, const std::uint32_t) noexcept ;
+
+			/**
+			  * @brief _release - INTERNAL METHOD. drops reference held by this handle, if any
+			  */
+			void _release() noexcept ;
+
+		public:
+			/**
+			  * @brief FrameBatch (constructor) (overload) - empty handle
+			  */
+			FrameBatch() noexcept ;
+
+			/**
+			  * @brief FrameBatch (copy constructor) - shares batch, adding a reference
+			  * @param const FrameBatch& - lvalue reference to existing handle
+			  */
+			FrameBatch(const FrameBatch&) noexcept ;
+
+			/**
+			  * @brief operator= (copy assignment) - shares batch, adding a reference and dropping the previously held one
+			  * @param const FrameBatch& - lvalue reference to existing handle
+			  * @return FrameBatch& - reference to assigned handle
+			  */
+			FrameBatch& operator=(const FrameBatch&) noexcept ;
+
+			/**
+			  * @brief FrameBatch (move constructor) - takes over reference and empties previous handle
+			  * @param FrameBatch&& - rvalue reference to existing handle
+			  */
+			FrameBatch(FrameBatch&&) noexcept ;
+
+			/**
+			  * @brief operator= (move assignment) - takes over reference and empties previous handle
+			  * @param FrameBatch&& - rvalue reference to existing handle
+			  * @return FrameBatch& - reference to assigned handle
+			  */
+			FrameBatch& operator=(FrameBatch&&) noexcept ;
+
+			/**
+			  * @brief operator bool - whether handle refers to a batch
+			  * @return bool - false for empty handles (e.g. pool was exhausted)
+			  */
+			explicit operator bool() const noexcept ;
+
+			/**
+			  * @brief size - getter for number of frames in batch
+			  * @return std::size_t - number of frames, 0 for empty handles
+			  */
+			std::size_t size() const noexcept ;
+
+			/**
+			  * @brief data - getter for frames of batch
+			  * @return const can_interact_timed_frame* - frames, nullptr for empty handles
+			  */
+			const can_interact_timed_frame* data() const noexcept ;
+
+			/**
+			  * @brief operator[] - getter for single frame of batch (unchecked)
+			  * @param const std::size_t - index of frame
+			  * @return const can_interact_timed_frame& - frame
+			  */
+			const can_interact_timed_frame& operator[](const std::size_t) const noexcept ;
+
+			/**
+			  * @brief begin - iterator to first frame
+			  * @return const can_interact_timed_frame* - pointer to first frame
+			  */
+			const can_interact_timed_frame* begin() const noexcept ;
+
+			/**
+			  * @brief end - iterator past last frame
+			  * @return const can_interact_timed_frame* - pointer past last frame
+			  */
+			const can_interact_timed_frame* end() const noexcept ;
+
+			/**
+			  * @brief use_count - getter for number of handles sharing batch
+			  * @return std::uint32_t - reference count, 0 for empty handles
+			  */
+			std::uint32_t use_count() const noexcept ;
+
+			/**
+			  * @brief ~FrameBatch (destructor) - drops reference, returning batch to pool if it was the last one
+			  */
+			~FrameBatch() noexcept ;
+	} ;
+
+	class FramePool {
+		/**
+		  * @brief FramePool (class) - fixed number of frame batch blocks, handed out as FrameBatch handles
+		  * Free blocks are kept on a lock-free (tagged) stack, so batches may be released from any thread
+		  */
+		friend class FrameBatch ;
+
+		private:
+			struct _header {
+				/**
+				  * @brief _header - INTERNAL. bookkeeping of one block
+				  */
+				std::atomic<std::uint32_t> refs ;
+				std::uint32_t count ; // frames held
+				std::atomic<std::uint32_t> next ; // next free block
+			} ;
+
+			static constexpr std::uint32_t _NIL = 0xFFFFFFFFu ;
+
+			std::unique_ptr<_header[]> _headers ;
+			std::unique_ptr<can_interact_timed_frame[]> _frames ;
+			std::size_t _blocks ;
+			std::size_t _capacity ; // frames per block
+			std::atomic<std::uint64_t> _free ; // (tag << 32) | head index
+			std::atomic<std::size_t> _available ;
+
+			/**
+			  * @brief _pop - INTERNAL METHOD. takes block off free stack
+			  * @return std::uint32_t - block index, _NIL if exhausted
+			  */
+			std::uint32_t _pop() noexcept ;
+
+			/**
+			  * @brief _push - INTERNAL METHOD. returns block to free stack
+			  * @param const std::uint32_t - block index
+			  */
+			void _push(const std::uint32_t) noexcept ;
+
+		public:
+			/**
+			  * @brief FramePool (constructor) - allocates all blocks up front
+			  * @param const std::size_t - number of blocks (max batches alive at once)
+			  * @param const std::size_t - frames per block
+			  * @throws std::invalid_argument - if either size is 0
+			  */
+			FramePool(const std::size_t, const std::size_t = CAN_INTERACT_MAX_BATCH) noexcept(false) ;
+
+			/**
+			  * @brief receive - receives batch of timestamped frames directly into a pooled block
+			  * @param const CAN& - CAN connection to receive from (blocks until at least one frame is available)
+			  * @return FrameBatch - handle to received batch, empty if pool is exhausted (no receive is attempted)
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			FrameBatch receive(const CAN&) noexcept(false) ;
+
+			/**
+			  * @brief make - copies frames from another source into a pooled block
+			  * @param const can_interact_timed_frame* - frames
+			  * @param const std::size_t - number of frames (truncated to block capacity)
+			  * @return FrameBatch - handle to batch, empty if pool is exhausted
+			  */
+			FrameBatch make(const can_interact_timed_frame*, const std::size_t) noexcept ;
+
+			/**
+			  * @brief available - getter for number of free blocks
+			  * @return std::size_t - free blocks (approximate while other threads acquire / release)
+			  */
+			std::size_t available() const noexcept ;
+
+			/**
+			  * @brief capacity - getter for frames per block
+			  * @return std::size_t - frames per block
+			  */
+			std::size_t capacity() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			FramePool() = delete ;
+			FramePool(const FramePool&) = delete ;
+			FramePool& operator=(const FramePool&) = delete ;
+	} ;
+
+}
+
+can_interact::FrameBatch::FrameBatch(can_interact::FramePool* pool, const std::uint32_t block) noexcept : _pool(pool), _block(block) {}
+
+can_interact::FrameBatch::FrameBatch() noexcept : _pool(nullptr), _block(0) {}
+
+can_interact::FrameBatch::FrameBatch(const can_interact::FrameBatch& batch) noexcept : _pool(batch._pool), _block(batch._block)
+{
+	if(this->_pool != nullptr)
+	{
+		this->_pool->_headers[this->_block].refs.fetch_add(1, std::memory_order_relaxed) ;
+	}
+}
+
+can_interact::FrameBatch& can_interact::FrameBatch::operator=(const can_interact::FrameBatch& batch) noexcept
+{
+	if(this != &batch)
+	{
+		if(batch._pool != nullptr)
+		{
+			batch._pool->_headers[batch._block].refs.fetch_add(1, std::memory_order_relaxed) ;
+		}
+		this->_release() ;
+		this->_pool = batch._pool ;
+		this->_block = batch._block ;
+	}
+	return *this ;
+}
+
+can_interact::FrameBatch::FrameBatch(can_interact::FrameBatch&& batch) noexcept : _pool(batch._pool), _block(batch._block)
+{
+	batch._pool = nullptr ;
+}
+
+can_interact::FrameBatch& can_interact::FrameBatch::operator=(can_interact::FrameBatch&& batch) noexcept
+{
+	if(this != &batch)
+	{
+		this->_release() ;
+		this->_pool = batch._pool ;
+		this->_block = batch._block ;
+		batch._pool = nullptr ;
+	}
+	return *this ;
+}
+
+void can_interact::FrameBatch::_release() noexcept
+{
+	if(this->_pool != nullptr && this->_pool->_headers[this->_block].refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		this->_pool->_push(this->_block) ;
+	}
+	this->_pool = nullptr ;
+}
+
+can_interact::FrameBatch::operator bool() const noexcept
+{
+	return this->_pool != nullptr ;
+}
+
+std::size_t can_interact::FrameBatch::size() const noexcept
+{
+	return this->_pool == nullptr ? 0 : this->_pool->_headers[this->_block].count ;
+}
+
+const can_interact_timed_frame* can_interact::FrameBatch::data() const noexcept
+{
+	return this->_pool == nullptr ? nullptr : &this->_pool->_frames[this->_block * this->_pool->_capacity] ;
+}
+
+const can_interact_timed_frame& can_interact::FrameBatch::operator[](const std::size_t idx) const noexcept
+{
+	return this->data()[idx] ;
+}
+
+const can_interact_timed_frame* can_interact::FrameBatch::begin() const noexcept
+{
+	return this->data() ;
+}
+
+const can_interact_timed_frame* can_interact::FrameBatch::end() const noexcept
+{
+	return this->data() + this->size() ;
+}
+
+std::uint32_t can_interact::FrameBatch::use_count() const noexcept
+{
+	return this->_pool == nullptr ? 0 : this->_pool->_headers[this->_block].refs.load(std::memory_order_relaxed) ;
+}
+
+can_interact::FrameBatch::~FrameBatch() noexcept
+{
+	this->_release() ;
+}
+
+can_interact::FramePool::FramePool(const std::size_t blocks, const std::size_t capacity) noexcept(false) : _blocks(blocks), _capacity(capacity), _free{0}, _available{blocks}
+{
+	if(blocks == 0 || capacity == 0 || blocks >= _NIL)
+	{
+		throw std::invalid_argument("Frame pool needs a non-zero number of blocks and frames per block") ;
+	}
+	this->_headers.reset(new _header[blocks]) ;
+	this->_frames.reset(new can_interact_timed_frame[blocks * capacity]) ;
+	for(std::size_t i = 0 ; i < blocks ; ++i)
+	{
+		this->_headers[i].refs.store(0, std::memory_order_relaxed) ;
+		this->_headers[i].count = 0 ;
+		this->_headers[i].next.store(i + 1 == blocks ? _NIL : static_cast<std::uint32_t>(i + 1), std::memory_order_relaxed) ;
+	}
+	this->_free.store(0, std::memory_order_release) ; // tag 0, head block 0
+}
+
+std::uint32_t can_interact::FramePool::_pop() noexcept
+{
+	std::uint64_t head = this->_free.load(std::memory_order_acquire) ;
+	for(;;)
+	{
+		const std::uint32_t idx = static_cast<std::uint32_t>(head) ;
+		if(idx == _NIL)
+		{
+			return _NIL ;
+		}
+		// tag is bumped on every change, so a block popped & pushed meanwhile cannot be mistaken for an unchanged head
+		const std::uint64_t next = (((head >> 32) + 1) << 32) | this->_headers[idx].next.load(std::memory_order_relaxed) ;
+		if(this->_free.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			this->_available.fetch_sub(1, std::memory_order_relaxed) ;
+			return idx ;
+		}
+	}
+}
+
+void can_interact::FramePool::_push(const std::uint32_t idx) noexcept
+{
+	std::uint64_t head = this->_free.load(std::memory_order_relaxed) ;
+	for(;;)
+	{
+		this->_headers[idx].next.store(static_cast<std::uint32_t>(head), std::memory_order_relaxed) ;
+		const std::uint64_t next = (((head >> 32) + 1) << 32) | idx ;
+		if(this->_free.compare_exchange_weak(head, next, std::memory_order_release, std::memory_order_relaxed))
+		{
+			this->_available.fetch_add(1, std::memory_order_relaxed) ;
+			return ;
+		}
+	}
+}
+
+can_interact::FrameBatch can_interact::FramePool::receive(const can_interact::CAN& can) noexcept(false)
+{
+	const std::uint32_t idx = this->_pop() ;
+	if(idx == _NIL)
+	{
+		return FrameBatch() ;
+	}
+	_header& header = this->_headers[idx] ;
+	header.refs.store(1, std::memory_order_relaxed) ;
+	header.count = 0 ;
+	FrameBatch batch(this, idx) ; // returns block to pool should receiving throw
+	header.count = static_cast<std::uint32_t>(can.frames(&this->_frames[idx * this->_capacity], this->_capacity)) ;
+	return batch ;
+}
+
+can_interact::FrameBatch can_interact::FramePool::make(const can_interact_timed_frame* frames, const std::size_t len) noexcept
+{
+	const std::uint32_t idx = this->_pop() ;
+	if(idx == _NIL)
+	{
+		return FrameBatch() ;
+	}
+	_header& header = this->_headers[idx] ;
+	const std::size_t count = len < this->_capacity ? len : this->_capacity ;
+	std::memcpy(&this->_frames[idx * this->_capacity], frames, sizeof(can_interact_timed_frame) * count) ;
+	header.count = static_cast<std::uint32_t>(count) ;
+	header.refs.store(1, std::memory_order_relaxed) ;
+	return FrameBatch(this, idx) ;
+}
+
+std::size_t can_interact::FramePool::available() const noexcept
+{
+	return this->_available.load(std::memory_order_relaxed) ;
+}
+
+std::size_t can_interact::FramePool::capacity() const noexcept
+{
+	return this->_capacity ;
+}
+
+#endif // CAN_INTERACT_POOL_HH
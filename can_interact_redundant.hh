@@ -0,0 +1,420 @@
+#ifndef CAN_INTERACT_REDUNDANT_HH
+#define CAN_INTERACT_REDUNDANT_HH
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+
+#include "can_interact.hh"
+
+/**
+ * @brief CXX API (C++11) redundancy stage for traffic mirrored on two or more physical buses, forwarding the first copy of every frame
+ * Frames are identified by identifier plus payload, or for identifiers with an embedded alive counter (see can_interact_e2e.h) by identifier
+ * plus counter. A small open addressed cache remembers each recent frame with the buses it was seen on: a copy arriving within the window
+ * from a bus that has not delivered it yet is a duplicate and dropped, anything else is forwarded at once. Per bus counters of won and
+ * lost races and of frames that only that bus delivered show the health of each bus (settled once cache entries expire, see flush)
+ * Frames are compared on kernel receive timestamps (CLOCK_REALTIME), and buffered frames of several buses are processed earliest first
+ */
+
+namespace can_interact {
+
+	class RedundantReceiver {
+		/**
+		  * @brief RedundantReceiver (class) - merges redundant buses, suppressing duplicates
+		  */
+		public:
+			struct tagged_t {
+				/**
+				  * @brief tagged_t - forwarded frame and index of the bus it arrived on first
+				  */
+				can_interact_timed_frame frame ;
+				std::size_t source ;
+			} ;
+
+			struct stats_t {
+				/**
+				  * @brief stats_t - health counters of one bus
+				  */
+				std::uint64_t wins ; // frames forwarded from this bus
+				std::uint64_t losses ; // duplicates dropped, another bus was first
+				std::uint64_t single ; // frames no other bus delivered within the window
+			} ;
+
+		private:
+			struct _entry {
+				/**
+				  * @brief _entry - INTERNAL. slot of the recent-frame cache
+				  */
+				std::uint64_t key ;
+				std::uint64_t time_ns ; // arrival of first copy
+				std::uint32_t seen ; // bitmask of buses that delivered a copy
+				std::uint32_t winner ; // bus of first copy
+				bool used ;
+			} ;
+
+			struct _source {
+				/**
+				  * @brief _source - INTERNAL. buffered batch and counters of one bus
+				  */
+				std::string name ;
+				int socket ;
+				can_interact_timed_frame buf[CAN_INTERACT_MAX_BATCH] ;
+				std::size_t head ;
+				std::size_t len ;
+				stats_t stats ;
+			} ;
+
+			static constexpr std::size_t _probes = 8 ; // slots searched per key
+			static constexpr std::size_t _max_sources = 32 ; // bits of _entry::seen
+
+			std::vector<std::unique_ptr<_source>> _sources ;
+			std::vector<_entry> _cache ;
+			std::unordered_map<canid_t, std::pair<std::size_t, std::uint8_t>> _counters ; // identifier to counter byte and mask
+			std::uint64_t _window_ns ;
+
+			/**
+			  * @brief _key - INTERNAL METHOD. identity of frame, hash of identifier and payload (or counter)
+			  * @param const can_frame& - frame
+			  * @return std::uint64_t - key
+			  */
+			std::uint64_t _key(const can_frame&) const noexcept ;
+
+			/**
+			  * @brief _finish - INTERNAL METHOD. settles single-bus counter of cache entry before it is reused
+			  * @param _entry& - entry
+			  */
+			void _finish(_entry&) noexcept ;
+
+			/**
+			  * @brief _now - INTERNAL METHOD. current time on the clock of kernel receive timestamps
+			  * @return std::uint64_t - CLOCK_REALTIME nanoseconds
+			  */
+			static std::uint64_t _now() noexcept ;
+
+		public:
+			/**
+			  * @brief RedundantReceiver (constructor) - creates stage without buses
+			  * @param const std::uint64_t - window in nanoseconds within which copies on other buses are duplicates (above the worst skew between buses,
+			  * below the period of frames with unchanging payload)
+			  * @param const std::size_t - cache slots, rounded up to a power of two (a few times the frames received per window)
+			  */
+			RedundantReceiver(const std::uint64_t, const std::size_t = 1024) noexcept(false) ;
+
+			RedundantReceiver(RedundantReceiver&&) noexcept = default ;
+			RedundantReceiver& operator=(RedundantReceiver&&) noexcept = default ;
+
+			/**
+			  * @brief add (overload) - adds bus, enabling its kernel receive timestamps
+			  * @param const std::string& - name of bus, e.g. interface name
+			  * @param const CAN& - connection (must outlive stage)
+			  * @return std::size_t - index of bus, as tagged on its frames
+			  * @throws std::runtime_error - if 32 buses were added, or in case can_interact_* functionality returns non-zero error
+			  */
+			std::size_t add(const std::string&, const CAN&) noexcept(false) ;
+
+			/**
+			  * @brief add (overload) - adds bus whose frames are handed to offer, e.g. a recorded log, ignored by next
+			  * @param const std::string& - name of bus
+			  * @return std::size_t - index of bus, as passed to offer
+			  * @throws std::runtime_error - if 32 buses were added
+			  */
+			std::size_t add(const std::string&) noexcept(false) ;
+
+			/**
+			  * @brief counter - identifies frames of an identifier by an embedded alive counter instead of their whole payload
+			  * @param const canid_t - identifier (including CAN_EFF_FLAG for extended identifiers)
+			  * @param const std::size_t - byte holding counter
+			  * @param const std::uint8_t - mask of counter bits within byte, e.g. 0x0F
+			  * @throws std::invalid_argument - if byte is beyond classical payload
+			  */
+			void counter(const canid_t, const std::size_t, const std::uint8_t) noexcept(false) ;
+
+			/**
+			  * @brief offer - decides on a frame received by own means, e.g. from recorded logs of each bus
+			  * @param const can_interact_timed_frame& - frame (timestamp 0 uses current time)
+			  * @param const std::size_t - index of bus it arrived on
+			  * @return bool - true if it is the first copy and is to be forwarded, false for copies and for unknown bus indices
+			  */
+			bool offer(const can_interact_timed_frame&, const std::size_t) noexcept ;
+
+			/**
+			  * @brief next - receives from all buses and returns first copies
+			  * @param tagged_t* - array to write frames to
+			  * @param const std::size_t - capacity of array
+			  * @param const int - maximum wait in milliseconds, -1 to wait until a frame arrives
+			  * @return std::size_t - number of frames written, 0 on timeout or interruption
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::size_t next(tagged_t*, const std::size_t, const int) noexcept(false) ;
+
+			/**
+			  * @brief flush - settles single-bus counters of entries older than the window, e.g. before reading stats
+			  */
+			void flush() noexcept ;
+
+			/**
+			  * @brief name - getter for name of bus
+			  * @param const std::size_t - index of bus
+			  * @return const std::string& - name given when adding
+			  */
+			const std::string& name(const std::size_t) const noexcept ;
+
+			/**
+			  * @brief stats - getter for health counters of bus
+			  * @param const std::size_t - index of bus
+			  * @return stats_t - counters
+			  */
+			stats_t stats(const std::size_t) const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			RedundantReceiver() = delete ;
+			RedundantReceiver(const RedundantReceiver&) = delete ;
+			RedundantReceiver& operator=(const RedundantReceiver&) = delete ;
+	} ;
+
+}
+
+constexpr std::size_t can_interact::RedundantReceiver::_probes ;
+constexpr std::size_t can_interact::RedundantReceiver::_max_sources ;
+
+can_interact::RedundantReceiver::RedundantReceiver(const std::uint64_t window_ns, const std::size_t capacity) noexcept(false)
+	: _sources{}, _cache{}, _counters{}, _window_ns{window_ns}
+{
+	std::size_t slots = RedundantReceiver::_probes ;
+	while(slots < capacity)
+	{
+		slots <<= 1 ;
+	}
+	this->_cache.assign(slots, _entry{0, 0, 0, 0, false}) ;
+}
+
+std::uint64_t can_interact::RedundantReceiver::_now() noexcept
+{
+	timespec now ;
+	clock_gettime(CLOCK_REALTIME, &now) ;
+	return static_cast<std::uint64_t>(now.tv_sec) * 1000000000u + static_cast<std::uint64_t>(now.tv_nsec) ;
+}
+
+std::size_t can_interact::RedundantReceiver::add(const std::string& name, const CAN& can) noexcept(false)
+{
+	if(this->_sources.size() == RedundantReceiver::_max_sources)
+	{
+		throw std::runtime_error(std::string{"At most "} + std::to_string(RedundantReceiver::_max_sources) + " redundant buses") ;
+	}
+	can.timestamps() ;
+	const std::size_t idx = this->add(name) ;
+	this->_sources[idx]->socket = can.socket() ;
+	return idx ;
+}
+
+std::size_t can_interact::RedundantReceiver::add(const std::string& name) noexcept(false)
+{
+	if(this->_sources.size() == RedundantReceiver::_max_sources)
+	{
+		throw std::runtime_error(std::string{"At most "} + std::to_string(RedundantReceiver::_max_sources) + " redundant buses") ;
+	}
+	std::unique_ptr<_source> source{new _source} ;
+	source->name = name ;
+	source->socket = -1 ;
+	source->head = 0 ;
+	source->len = 0 ;
+	source->stats = stats_t{0, 0, 0} ;
+	this->_sources.push_back(std::move(source)) ;
+	return this->_sources.size() - 1 ;
+}
+
+void can_interact::RedundantReceiver::counter(const canid_t id, const std::size_t byte, const std::uint8_t mask) noexcept(false)
+{
+	if(byte >= CAN_MAX_DLEN)
+	{
+		throw std::invalid_argument(std::string{"Counter byte "} + std::to_string(byte) + " beyond payload") ;
+	}
+	this->_counters[id] = std::make_pair(byte, mask) ;
+}
+
+std::uint64_t can_interact::RedundantReceiver::_key(const can_frame& frame) const noexcept
+{
+	std::uint64_t key = 14695981039346656037u ; // FNV-1a offset basis
+	const auto mix = [&key](const std::uint64_t value)
+	{
+		key = (key ^ value) * 1099511628211u ;
+	} ;
+	mix(frame.can_id) ;
+	const auto counter = this->_counters.empty() ? this->_counters.end() : this->_counters.find(frame.can_id & (CAN_EFF_FLAG | CAN_EFF_MASK)) ;
+	if(counter != this->_counters.end())
+	{
+		mix(frame.data[counter->second.first] & counter->second.second) ;
+	}
+	else
+	{
+		mix(frame.can_dlc) ;
+		for(std::size_t i = 0 ; i < frame.can_dlc && i < CAN_MAX_DLEN ; ++i)
+		{
+			mix(frame.data[i]) ;
+		}
+	}
+	key ^= key >> 33 ; // spread into the low bits used as slot index
+	key *= 0xff51afd7ed558ccdu ;
+	return key ^ (key >> 33) ;
+}
+
+void can_interact::RedundantReceiver::_finish(_entry& entry) noexcept
+{
+	if(entry.used && (entry.seen & (entry.seen - 1)) == 0 && entry.winner < this->_sources.size())
+	{
+		++this->_sources[entry.winner]->stats.single ;
+	}
+	entry.used = false ;
+}
+
+bool can_interact::RedundantReceiver::offer(const can_interact_timed_frame& frame, const std::size_t source) noexcept
+{
+	if(source >= this->_sources.size())
+	{
+		return false ;
+	}
+	const std::uint64_t now = frame.timestamp_ns != 0 ? frame.timestamp_ns : RedundantReceiver::_now() ;
+	const std::uint64_t key = this->_key(frame.frame) ;
+	const std::uint32_t bit = 1u << source ;
+	const std::size_t mask = this->_cache.size() - 1 ;
+	_entry* victim = nullptr ; // first unused or expired slot, else the oldest probed one
+	bool stale = false ;
+
+	for(std::size_t i = 0 ; i < RedundantReceiver::_probes ; ++i)
+	{
+		_entry& entry = this->_cache[(key + i) & mask] ;
+		const bool fresh = entry.used && (now < entry.time_ns || now - entry.time_ns <= this->_window_ns) ;
+		if(fresh && entry.key == key)
+		{
+			if(!(entry.seen & bit))
+			{
+				entry.seen |= bit ;
+				++this->_sources[source]->stats.losses ;
+				return false ;
+			}
+			victim = &entry ; // same bus again, so a new instance of a frame with unchanged payload
+			break ;
+		}
+		if(!fresh && !stale)
+		{
+			victim = &entry ;
+			stale = true ;
+		}
+		else if(fresh && !stale && (victim == nullptr || entry.time_ns < victim->time_ns))
+		{
+			victim = &entry ;
+		}
+	}
+	this->_finish(*victim) ;
+	*victim = _entry{key, now, bit, static_cast<std::uint32_t>(source), true} ;
+	++this->_sources[source]->stats.wins ;
+	return true ;
+}
+
+std::size_t can_interact::RedundantReceiver::next(tagged_t* frames, const std::size_t len, const int timeout_ms) noexcept(false)
+{
+	std::vector<pollfd> fds(this->_sources.size()) ;
+	const std::uint64_t deadline_ns = RedundantReceiver::_now() + static_cast<std::uint64_t>(timeout_ms < 0 ? 0 : timeout_ms) * 1000000u ;
+
+	for(;;)
+	{
+		std::size_t emitted = 0 ;
+		while(emitted < len)
+		{
+			// earliest buffered head first, so races are decided on arrival time rather than on read order
+			std::size_t best = this->_sources.size() ;
+			for(std::size_t i = 0 ; i < this->_sources.size() ; ++i)
+			{
+				const _source& source = *this->_sources[i] ;
+				if(source.head < source.len && (best == this->_sources.size()
+						|| source.buf[source.head].timestamp_ns < this->_sources[best]->buf[this->_sources[best]->head].timestamp_ns))
+				{
+					best = i ;
+				}
+			}
+			if(best == this->_sources.size())
+			{
+				break ;
+			}
+			_source& source = *this->_sources[best] ;
+			const can_interact_timed_frame& frame = source.buf[source.head++] ;
+			if(this->offer(frame, best))
+			{
+				frames[emitted].frame = frame ;
+				frames[emitted].source = best ;
+				++emitted ;
+			}
+		}
+		if(emitted > 0)
+		{
+			return emitted ;
+		}
+
+		for(std::size_t i = 0 ; i < this->_sources.size() ; ++i)
+		{
+			fds[i] = pollfd{this->_sources[i]->socket, POLLIN, 0} ; // poll skips negative descriptors of offer-only buses
+		}
+		int remaining_ms = timeout_ms ; // rounds that only delivered duplicates must not extend the caller's timeout
+		if(timeout_ms >= 0)
+		{
+			const std::uint64_t now = RedundantReceiver::_now() ;
+			remaining_ms = now >= deadline_ns ? 0 : static_cast<int>((deadline_ns - now + 999999u) / 1000000u) ;
+		}
+		const int ready = poll(fds.data(), fds.size(), remaining_ms) ;
+		if(ready < 0 && errno != EINTR)
+		{
+			throw std::runtime_error(std::string{"Errno "} + std::to_string(errno)) ;
+		}
+		if(ready <= 0)
+		{
+			return 0 ;
+		}
+		for(std::size_t i = 0 ; i < fds.size() ; ++i)
+		{
+			if(fds[i].revents & POLLIN)
+			{
+				_source& source = *this->_sources[i] ;
+				source.head = 0 ;
+				const int res = can_interact_get_frames(source.buf, CAN_INTERACT_MAX_BATCH, &source.len, &source.socket) ;
+				if(res != 0 && res != EAGAIN && res != EINTR)
+				{
+					throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+				}
+			}
+		}
+	}
+}
+
+void can_interact::RedundantReceiver::flush() noexcept
+{
+	const std::uint64_t now = RedundantReceiver::_now() ;
+	for(_entry& entry : this->_cache)
+	{
+		if(entry.used && now > entry.time_ns && now - entry.time_ns > this->_window_ns)
+		{
+			this->_finish(entry) ;
+		}
+	}
+}
+
+const std::string& can_interact::RedundantReceiver::name(const std::size_t idx) const noexcept
+{
+	return this->_sources[idx]->name ;
+}
+
+can_interact::RedundantReceiver::stats_t can_interact::RedundantReceiver::stats(const std::size_t idx) const noexcept
+{
+	return this->_sources[idx]->stats ;
+}
+
+#endif // CAN_INTERACT_REDUNDANT_HH
@@ -0,0 +1,337 @@
+#ifndef CAN_INTERACT_RING_HH
+#define CAN_INTERACT_RING_HH
+#pragma once
+
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <climits>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <unistd.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "can_interact.hh"
+
+/**
+ * @brief CXX API (C++11) single producer / multi consumer broadcast ring for received frames
+ * One thread receives from a single can_interact::CAN and publishes into the ring, every subscriber reads every frame at its own pace by tracking its own sequence cursor
+ * The producer never waits for subscribers - a subscriber falling more than the ring's capacity behind is told how many frames it lost (overrun)
+ */
+
+namespace can_interact {
+
+	enum class wait_strategy {
+		/**
+		  * @brief wait_strategy - how a subscriber waits for frames not yet published
+		  */
+		spin, // busy poll - lowest latency, burns a core
+		yield, // poll, yielding the processor between attempts
+		futex // sleep in the kernel until the producer publishes - no CPU use while idle
+	} ;
+
+	class BroadcastRing {
+		/**
+		  * @brief BroadcastRing (class) - fixed capacity ring of timestamped frames with a single publishing thread
+		  */
+		friend class RingSubscriber ;
+
+		private:
+			struct _slot {
+				/**
+				  * @brief _slot - INTERNAL. frame plus sequence tag (sequence + 1 once published, _WRITING bit set while being overwritten)
+				  */
+				std::atomic<std::uint64_t> tag ;
+				can_interact_timed_frame value ;
+			} ;
+
+			static constexpr std::uint64_t _WRITING = 1ull << 63 ;
+
+			std::unique_ptr<_slot[]> _slots ;
+			std::size_t _mask ;
+			char _pad_front[64] ;
+			std::atomic<std::uint64_t> _cursor ; // next sequence to publish
+			char _pad_back[64] ;
+			std::atomic<std::uint32_t> _futex ; // bumped on publish, futex word for sleeping subscribers
+			std::atomic<std::uint32_t> _sleepers ;
+
+		public:
+			/**
+			  * @brief BroadcastRing (constructor) - allocates ring
+			  * @param const std::size_t - capacity in frames, must be a power of two
+			  * @throws std::invalid_argument - if capacity is not a non-zero power of two
+			  */
+			explicit BroadcastRing(const std::size_t) noexcept(false) ;
+
+			/**
+			  * @brief publish (overload) - publishes single frame (producer thread only)
+			  * @param const can_interact_timed_frame& - frame
+			  */
+			void publish(const can_interact_timed_frame&) noexcept ;
+
+			/**
+			  * @brief publish (overload) - publishes batch of frames, waking sleeping subscribers once (producer thread only)
+			  * @param const can_interact_timed_frame* - frames
+			  * @param const std::size_t - number of frames
+			  */
+			void publish(const can_interact_timed_frame*, const std::size_t) noexcept ;
+
+			/**
+			  * @brief pump - receives one batch from CAN connection and publishes it (producer thread only)
+			  * @param const CAN& - CAN connection to receive from (blocks until at least one frame is available)
+			  * @return std::size_t - number of frames published
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::size_t pump(const CAN&) noexcept(false) ;
+
+			/**
+			  * @brief cursor - getter for sequence number the next published frame will have
+			  * @return std::uint64_t - sequence
+			  */
+			std::uint64_t cursor() const noexcept ;
+
+			/**
+			  * @brief capacity - getter for capacity of ring
+			  * @return std::size_t - capacity in frames
+			  */
+			std::size_t capacity() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			BroadcastRing() = delete ;
+			BroadcastRing(const BroadcastRing&) = delete ;
+			BroadcastRing& operator=(const BroadcastRing&) = delete ;
+	} ;
+
+	class RingSubscriber {
+		/**
+		  * @brief RingSubscriber (class) - independent reader of a BroadcastRing, owned and used by a single consumer thread
+		  */
+		private:
+			BroadcastRing& _ring ;
+			std::uint64_t _next ; // sequence of next frame to read
+			std::uint64_t _overruns ; // frames lost due to being overwritten before being read
+			wait_strategy _strategy ;
+
+			/**
+			  * @brief _try - INTERNAL METHOD. attempts to read next frame without waiting
+			  * @param can_interact_timed_frame& - frame to write to
+			  * @return bool - true if frame was read
+			  */
+			bool _try(can_interact_timed_frame&) noexcept ;
+
+		public:
+			/**
+			  * @brief RingSubscriber (constructor) - subscribes to ring
+			  * @param BroadcastRing& - ring (must outlive subscriber)
+			  * @param const wait_strategy - how to wait for frames in next()
+			  * @param const bool - true to start at the next published frame, false to start at the oldest frame still held by the ring
+			  */
+			RingSubscriber(BroadcastRing&, const wait_strategy = wait_strategy::futex, const bool = true) noexcept ;
+
+			/**
+			  * @brief poll - reads next frame if one is available, never waits
+			  * @param can_interact_timed_frame& - frame to write to
+			  * @return bool - false if no new frame has been published
+			  */
+			bool poll(can_interact_timed_frame&) noexcept ;
+
+			/**
+			  * @brief next (overload) - reads next frame, waiting according to wait strategy
+			  * @return can_interact_timed_frame - frame
+			  */
+			can_interact_timed_frame next() noexcept ;
+
+			/**
+			  * @brief next (overload) - reads next frame, waiting according to wait strategy for at most timeout
+			  * @param can_interact_timed_frame& - frame to write to
+			  * @param const std::chrono::nanoseconds - maximum time to wait
+			  * @return bool - false on timeout
+			  */
+			bool next(can_interact_timed_frame&, const std::chrono::nanoseconds) noexcept ;
+
+			/**
+			  * @brief lag - getter for number of published frames not yet read
+			  * @return std::uint64_t - lag in frames (above capacity means frames will be lost)
+			  */
+			std::uint64_t lag() const noexcept ;
+
+			/**
+			  * @brief overruns - getter for number of frames lost as they were overwritten before being read
+			  * @return std::uint64_t - lost frames
+			  */
+			std::uint64_t overruns() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			RingSubscriber() = delete ;
+	} ;
+
+}
+
+can_interact::BroadcastRing::BroadcastRing(const std::size_t capacity) noexcept(false) : _mask(capacity - 1), _cursor{0}, _futex{0}, _sleepers{0}
+{
+	if(capacity == 0 || (capacity & (capacity - 1)) != 0)
+	{
+		throw std::invalid_argument(std::string{"Ring capacity must be a power of two, got "} + std::to_string(capacity)) ;
+	}
+	this->_slots.reset(new _slot[capacity]) ;
+	for(std::size_t i = 0 ; i < capacity ; ++i)
+	{
+		this->_slots[i].tag.store(0, std::memory_order_relaxed) ;
+	}
+}
+
+void can_interact::BroadcastRing::publish(const can_interact_timed_frame& frame) noexcept
+{
+	this->publish(&frame, 1) ;
+}
+
+void can_interact::BroadcastRing::publish(const can_interact_timed_frame* frames, const std::size_t len) noexcept
+{
+	std::uint64_t seq = this->_cursor.load(std::memory_order_relaxed) ;
+	for(std::size_t i = 0 ; i < len ; ++i, ++seq)
+	{
+		_slot& slot = this->_slots[seq & this->_mask] ;
+		slot.tag.store(_WRITING | (seq + 1), std::memory_order_relaxed) ;
+		std::atomic_thread_fence(std::memory_order_release) ;
+		slot.value = frames[i] ;
+		slot.tag.store(seq + 1, std::memory_order_release) ;
+	}
+	this->_cursor.store(seq, std::memory_order_release) ;
+	this->_futex.fetch_add(1, std::memory_order_release) ;
+	if(this->_sleepers.load(std::memory_order_seq_cst) != 0)
+	{
+		syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&this->_futex), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0) ;
+	}
+}
+
+std::size_t can_interact::BroadcastRing::pump(const can_interact::CAN& can) noexcept(false)
+{
+	can_interact_timed_frame batch[CAN_INTERACT_MAX_BATCH] ;
+	const std::size_t received = can.frames(batch, CAN_INTERACT_MAX_BATCH) ;
+	this->publish(batch, received) ;
+	return received ;
+}
+
+std::uint64_t can_interact::BroadcastRing::cursor() const noexcept
+{
+	return this->_cursor.load(std::memory_order_acquire) ;
+}
+
+std::size_t can_interact::BroadcastRing::capacity() const noexcept
+{
+	return this->_mask + 1 ;
+}
+
+can_interact::RingSubscriber::RingSubscriber(can_interact::BroadcastRing& ring, const can_interact::wait_strategy strategy, const bool from_latest) noexcept : _ring(ring), _overruns(0), _strategy(strategy)
+{
+	const std::uint64_t cursor = ring.cursor() ;
+	this->_next = from_latest ? cursor : (cursor > ring.capacity() ? cursor - ring.capacity() : 0) ;
+}
+
+bool can_interact::RingSubscriber::_try(can_interact_timed_frame& frame) noexcept
+{
+	for(;;)
+	{
+		const BroadcastRing::_slot& slot = this->_ring._slots[this->_next & this->_ring._mask] ;
+		const std::uint64_t expected = this->_next + 1 ;
+		const std::uint64_t before = slot.tag.load(std::memory_order_acquire) ;
+		const std::uint64_t published = before & ~BroadcastRing::_WRITING ;
+		if(published < expected || before == (BroadcastRing::_WRITING | expected))
+		{
+			return false ; // not yet (fully) published
+		}
+		if(published == expected)
+		{
+			frame = slot.value ;
+			std::atomic_thread_fence(std::memory_order_acquire) ;
+			if(slot.tag.load(std::memory_order_relaxed) == before)
+			{
+				++this->_next ;
+				return true ;
+			}
+		}
+		// overwritten by a later lap - skip to oldest frame the ring still holds
+		const std::uint64_t cursor = this->_ring.cursor() ;
+		const std::uint64_t oldest = cursor > this->_ring.capacity() ? cursor - this->_ring.capacity() : 0 ;
+		if(oldest > this->_next)
+		{
+			this->_overruns += oldest - this->_next ;
+			this->_next = oldest ;
+		}
+		else
+		{
+			++this->_overruns ;
+			++this->_next ;
+		}
+	}
+}
+
+bool can_interact::RingSubscriber::poll(can_interact_timed_frame& frame) noexcept
+{
+	return this->_try(frame) ;
+}
+
+can_interact_timed_frame can_interact::RingSubscriber::next() noexcept
+{
+	can_interact_timed_frame frame ;
+	while(!this->next(frame, std::chrono::seconds{1})) {}
+	return frame ;
+}
+
+bool can_interact::RingSubscriber::next(can_interact_timed_frame& frame, const std::chrono::nanoseconds timeout) noexcept
+{
+	const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout ;
+	for(;;)
+	{
+		const std::uint32_t word = this->_ring._futex.load(std::memory_order_acquire) ;
+		if(this->_try(frame))
+		{
+			return true ;
+		}
+		const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now() ;
+		if(now >= deadline)
+		{
+			return false ;
+		}
+		switch(this->_strategy)
+		{
+		case wait_strategy::spin:
+			break ;
+		case wait_strategy::yield:
+			std::this_thread::yield() ;
+			break ;
+		case wait_strategy::futex:
+		{
+			const std::chrono::nanoseconds left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now) ;
+			timespec ts ;
+			ts.tv_sec = static_cast<time_t>(left.count() / 1000000000) ;
+			ts.tv_nsec = static_cast<long>(left.count() % 1000000000) ;
+			this->_ring._sleepers.fetch_add(1, std::memory_order_seq_cst) ;
+			if(this->_ring._futex.load(std::memory_order_seq_cst) == word) // re-check after announcing ourselves, the producer may have missed us
+			{
+				syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&this->_ring._futex), FUTEX_WAIT_PRIVATE, word, &ts, nullptr, 0) ;
+			}
+			this->_ring._sleepers.fetch_sub(1, std::memory_order_relaxed) ;
+			break ;
+		}
+		}
+	}
+}
+
+std::uint64_t can_interact::RingSubscriber::lag() const noexcept
+{
+	return this->_ring.cursor() - this->_next ;
+}
+
+std::uint64_t can_interact::RingSubscriber::overruns() const noexcept
+{
+	return this->_overruns ;
+}
+
+#endif // CAN_INTERACT_RING_HH
@@ -0,0 +1,146 @@
+#define _GNU_SOURCE /* CPU_SET, sched_setaffinity */
+
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <errno.h>
+#include <malloc.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "can_interact_rt.h"
+
+/**
+ * @brief C-style definitions of the real-time configuration
+ * For definitions for the CXX API, see can_interact_rt.hh
+ */
+
+/**
+ * @brief _p_can_interact_rt_now - INTERNAL METHOD. current time
+ * @param const clockid_t - clock
+ * @return uint64_t - nanoseconds
+ */
+static uint64_t _p_can_interact_rt_now(const clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief _p_can_interact_rt_stack - INTERNAL METHOD. touches stack below the caller's frame
+ * Not inlined, so the array lives in a frame of its own
+ */
+static void __attribute__((noinline)) _p_can_interact_rt_stack(void)
+{
+	volatile unsigned char stack[CAN_INTERACT_RT_STACK];
+	size_t i;
+	const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+	for (i = 0; i < sizeof(stack); i += page) {
+		stack[i] = 0;
+	}
+}
+
+int can_interact_rt_apply(const struct can_interact_rt_config *config)
+{
+	struct sched_param param;
+	cpu_set_t set;
+
+	if (config->cpu >= 0) {
+		if (config->cpu >= CPU_SETSIZE) {
+			return EINVAL;
+		}
+		CPU_ZERO(&set);
+		CPU_SET((size_t)config->cpu, &set);
+		if (sched_setaffinity(0, sizeof(set), &set) == -1) { /* 0 is the calling thread */
+			return (int)errno;
+		}
+	}
+	if (config->lock_memory) {
+		mallopt(M_TRIM_THRESHOLD, -1); /* keep freed heap mapped (and locked) */
+		mallopt(M_MMAP_MAX, 0); /* serve large allocations from the heap rather than fresh mappings */
+		if (mlockall(MCL_CURRENT | MCL_FUTURE) == -1) {
+			return (int)errno;
+		}
+	}
+	if (config->policy != SCHED_OTHER || config->priority != 0) {
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = config->priority;
+		if (sched_setscheduler(0, config->policy, &param) == -1) {
+			return (int)errno;
+		}
+	}
+	if (config->prefault_stack) {
+		_p_can_interact_rt_stack();
+	}
+	return 0;
+}
+
+void can_interact_rt_prefault(void *buffer, const size_t len)
+{
+	volatile unsigned char *bytes = (volatile unsigned char*)buffer;
+	const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	size_t i;
+
+	for (i = 0; i < len; i += page) {
+		bytes[i] = bytes[i]; /* write fault, also for untouched anonymous memory */
+	}
+	if (len > 0) {
+		bytes[len - 1] = bytes[len - 1];
+	}
+}
+
+void can_interact_rt_stats_init(struct can_interact_rt_stats *stats)
+{
+	can_interact_hist_init(&stats->latency);
+	stats->overruns = 0;
+}
+
+int can_interact_rt_timer_init(struct can_interact_rt_timer *timer, const uint64_t period_ns)
+{
+	if (period_ns == 0) {
+		return EINVAL;
+	}
+	can_interact_rt_stats_init(&timer->stats);
+	timer->period_ns = period_ns;
+	timer->next_ns = _p_can_interact_rt_now(CLOCK_MONOTONIC) + period_ns;
+	return 0;
+}
+
+uint64_t can_interact_rt_timer_wait(struct can_interact_rt_timer *timer)
+{
+	struct timespec ts;
+	uint64_t now, late, missed;
+
+	now = _p_can_interact_rt_now(CLOCK_MONOTONIC);
+	if (now > timer->next_ns + timer->period_ns) { /* skip missed periods, keeping the phase */
+		missed = (now - timer->next_ns) / timer->period_ns;
+		timer->stats.overruns += missed;
+		timer->next_ns += missed * timer->period_ns;
+	}
+	ts.tv_sec = (time_t)(timer->next_ns / 1000000000u);
+	ts.tv_nsec = (long)(timer->next_ns % 1000000000u);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+	}
+	now = _p_can_interact_rt_now(CLOCK_MONOTONIC);
+	late = now > timer->next_ns ? now - timer->next_ns : 0;
+	can_interact_hist_record(&timer->stats.latency, late);
+	timer->next_ns += timer->period_ns;
+	return late;
+}
+
+void can_interact_rt_received(struct can_interact_rt_stats *stats, const struct can_interact_timed_frame *frame)
+{
+	uint64_t now;
+
+	if (frame->timestamp_ns == 0) {
+		return;
+	}
+	now = _p_can_interact_rt_now(CLOCK_REALTIME); /* kernel receive timestamps are CLOCK_REALTIME */
+	can_interact_hist_record(&stats->latency, now > frame->timestamp_ns ? now - frame->timestamp_ns : 0);
+}
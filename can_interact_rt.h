@@ -0,0 +1,121 @@
+#ifndef CAN_INTERACT_RT_H
+#define CAN_INTERACT_RT_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_interact.h"
+#include "can_interact_hist.h"
+
+/**
+ * @brief C-style opt-in real-time configuration for receiver / transmitter threads, and wakeup latency recording to verify it
+ * can_interact_rt_apply configures the calling thread: CPU affinity, locking all current and future memory (with glibc's malloc told to
+ * keep freed memory instead of returning it to the kernel), a scheduling policy and priority (e.g. SCHED_FIFO) and a prefaulted stack.
+ * Buffers allocated afterwards are prefaulted with can_interact_rt_prefault, so the loop itself takes no page faults
+ * can_interact_rt_timer_wait runs a periodic loop on absolute CLOCK_MONOTONIC deadlines and records how late each wakeup was;
+ * can_interact_rt_received does the same for event driven receivers, from kernel receive timestamps (see can_interact_timestamps)
+ * Real-time policies and memory locking need CAP_SYS_NICE / CAP_IPC_LOCK (or matching rlimits)
+ * For the CXX API, see can_interact_rt.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifndef CAN_INTERACT_RT_STACK
+#define CAN_INTERACT_RT_STACK (256 * 1024) /* bytes of stack prefaulted by can_interact_rt_apply */
+#endif /* CAN_INTERACT_RT_STACK */
+
+struct can_interact_rt_config {
+	/**
+	 * @brief struct can_interact_rt_config - settings applied by can_interact_rt_apply, zero initialised changes nothing
+	 */
+	int policy; /* SCHED_FIFO, SCHED_RR or SCHED_OTHER (0, leaves scheduling as is) */
+	int priority; /* 1 (lowest) to 99 for SCHED_FIFO / SCHED_RR */
+	int cpu; /* core to pin thread to, -1 to leave affinity as is */
+	uint8_t lock_memory; /* mlockall(MCL_CURRENT | MCL_FUTURE) and no heap trimming */
+	uint8_t prefault_stack; /* touch CAN_INTERACT_RT_STACK bytes of stack */
+};
+
+struct can_interact_rt_stats {
+	/**
+	 * @brief struct can_interact_rt_stats - wakeup latencies in nanoseconds
+	 */
+	struct can_interact_hist latency;
+	uint64_t overruns; /* periods skipped because an iteration ran past the next deadline */
+};
+
+struct can_interact_rt_timer {
+	/**
+	 * @brief struct can_interact_rt_timer - periodic loop state, see can_interact_rt_timer_init
+	 */
+	struct can_interact_rt_stats stats;
+	uint64_t period_ns;
+	uint64_t next_ns; /* next deadline, CLOCK_MONOTONIC */
+};
+
+/**
+ * @brief can_interact_rt_apply - applies configuration to the calling thread
+ *
+ * @param const struct can_interact_rt_config* - configuration
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL for an invalid cpu, for other non-zero values refer to errno codes of sched_setaffinity, mlockall and
+ * sched_setscheduler (e.g. EPERM without privileges), settings before the failing one stay applied
+ */
+int can_interact_rt_apply(const struct can_interact_rt_config *config);
+
+/**
+ * @brief can_interact_rt_prefault - touches every page of a buffer, so later accesses take no page faults (once memory is locked)
+ *
+ * @param void* - buffer, contents are preserved
+ *
+ * @param const size_t - size in bytes
+ */
+void can_interact_rt_prefault(void *buffer, const size_t len);
+
+/**
+ * @brief can_interact_rt_timer_init - starts periodic loop, first deadline is one period from now
+ *
+ * @param struct can_interact_rt_timer* - timer to initialise
+ *
+ * @param const uint64_t - period in nanoseconds
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if period is 0
+ */
+int can_interact_rt_timer_init(struct can_interact_rt_timer *timer, const uint64_t period_ns);
+
+/**
+ * @brief can_interact_rt_timer_wait - sleeps until next deadline and records the wakeup latency
+ * If the deadline has passed by more than a period, the missed periods are counted as overruns and skipped instead of running late
+ * iterations back to back
+ *
+ * @param struct can_interact_rt_timer* - timer
+ *
+ * @return uint64_t - wakeup latency in nanoseconds
+ */
+uint64_t can_interact_rt_timer_wait(struct can_interact_rt_timer *timer);
+
+/**
+ * @brief can_interact_rt_received - records latency from a frame's kernel receive timestamp until now
+ *
+ * @param struct can_interact_rt_stats* - stats to record to, initialise with can_interact_rt_stats_init
+ *
+ * @param const struct can_interact_timed_frame* - received frame (ignored without timestamp)
+ */
+void can_interact_rt_received(struct can_interact_rt_stats *stats, const struct can_interact_timed_frame *frame);
+
+/**
+ * @brief can_interact_rt_stats_init - clears stats
+ *
+ * @param struct can_interact_rt_stats* - stats to initialise
+ */
+void can_interact_rt_stats_init(struct can_interact_rt_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_RT_H */
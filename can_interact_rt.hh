@@ -0,0 +1,175 @@
+#ifndef CAN_INTERACT_RT_HH
+#define CAN_INTERACT_RT_HH
+#pragma once
+
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include "can_interact.hh"
+#include "can_interact_rt.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact real-time configuration
+ * For declarations for the native C library, see can_interact_rt.h
+ */
+
+namespace can_interact {
+
+	class RealTime {
+		/**
+		  * @brief RealTime (class) - real-time configuration of one receiver / transmitter thread, with its wakeup latency record
+		  */
+		public:
+			typedef can_interact_rt_config config_t ;
+
+		private:
+			config_t _config ;
+			std::unique_ptr<can_interact_rt_timer> _timer ;
+
+		public:
+			/**
+			  * @brief RealTime (constructor) - prepares configuration, nothing is applied yet
+			  * @param const config_t& - scheduling policy and priority, cpu, memory locking and stack prefaulting
+			  * @param const std::uint64_t - loop period in nanoseconds for wait, 0 for event driven loops recording with received
+			  */
+			RealTime(const config_t&, const std::uint64_t = 0) noexcept(false) ;
+
+			RealTime(RealTime&&) noexcept = default ;
+			RealTime& operator=(RealTime&&) noexcept = default ;
+
+			/**
+			  * @brief apply - applies configuration to the calling thread (call it first thing on the thread to configure) and starts the period
+			  * @throws std::runtime_error - on errors reported by errno (e.g. missing privileges)
+			  */
+			void apply() noexcept(false) ;
+
+			/**
+			  * @brief wait - sleeps until next period and records the wakeup latency
+			  * @return std::uint64_t - wakeup latency in nanoseconds
+			  * @throws std::logic_error - if constructed without period
+			  */
+			std::uint64_t wait() noexcept(false) ;
+
+			/**
+			  * @brief received - records latency from a frame's kernel receive timestamp (see CAN::timestamps) until now
+			  * @param const can_interact_timed_frame& - received frame
+			  */
+			void received(const can_interact_timed_frame&) noexcept ;
+
+			/**
+			  * @brief percentile - wakeup latency percentile
+			  * @param const double - percentile from 0 to 100
+			  * @return std::uint64_t - nanoseconds
+			  */
+			std::uint64_t percentile(const double) const noexcept ;
+
+			/**
+			  * @brief max - worst wakeup latency
+			  * @return std::uint64_t - nanoseconds
+			  */
+			std::uint64_t max() const noexcept ;
+
+			/**
+			  * @brief iterations - number of recorded wakeups
+			  * @return std::uint64_t - count
+			  */
+			std::uint64_t iterations() const noexcept ;
+
+			/**
+			  * @brief overruns - periods skipped because an iteration ran too long
+			  * @return std::uint64_t - count
+			  */
+			std::uint64_t overruns() const noexcept ;
+
+			/**
+			  * @brief reset - clears recorded latencies, e.g. after warm-up
+			  */
+			void reset() noexcept ;
+
+			/**
+			  * @brief prefault - touches every page of a buffer allocated after apply
+			  * @param void* - buffer
+			  * @param const std::size_t - size in bytes
+			  */
+			static void prefault(void*, const std::size_t) noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			RealTime(const RealTime&) = delete ;
+			RealTime& operator=(const RealTime&) = delete ;
+			RealTime() = delete ;
+	} ;
+
+}
+
+can_interact::RealTime::RealTime(const config_t& config, const std::uint64_t period_ns) noexcept(false) : _config(config), _timer{new can_interact_rt_timer}
+{
+	can_interact_rt_stats_init(&this->_timer->stats) ;
+	this->_timer->period_ns = period_ns ;
+	this->_timer->next_ns = 0 ;
+}
+
+void can_interact::RealTime::apply() noexcept(false)
+{
+	const int res = can_interact_rt_apply(&this->_config) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	if(this->_timer->period_ns != 0)
+	{
+		can_interact_rt_timer_init(this->_timer.get(), this->_timer->period_ns) ;
+	}
+}
+
+std::uint64_t can_interact::RealTime::wait() noexcept(false)
+{
+	if(this->_timer->period_ns == 0)
+	{
+		throw std::logic_error("RealTime::wait needs a period") ;
+	}
+	if(this->_timer->next_ns == 0) // apply was not called
+	{
+		can_interact_rt_timer_init(this->_timer.get(), this->_timer->period_ns) ;
+	}
+	return can_interact_rt_timer_wait(this->_timer.get()) ;
+}
+
+void can_interact::RealTime::received(const can_interact_timed_frame& frame) noexcept
+{
+	can_interact_rt_received(&this->_timer->stats, &frame) ;
+}
+
+std::uint64_t can_interact::RealTime::percentile(const double percentile) const noexcept
+{
+	return can_interact_hist_percentile(&this->_timer->stats.latency, percentile) ;
+}
+
+std::uint64_t can_interact::RealTime::max() const noexcept
+{
+	return this->_timer->stats.latency.max ;
+}
+
+std::uint64_t can_interact::RealTime::iterations() const noexcept
+{
+	return this->_timer->stats.latency.total ;
+}
+
+std::uint64_t can_interact::RealTime::overruns() const noexcept
+{
+	return this->_timer->stats.overruns ;
+}
+
+void can_interact::RealTime::reset() noexcept
+{
+	can_interact_rt_stats_init(&this->_timer->stats) ;
+}
+
+void can_interact::RealTime::prefault(void* buffer, const std::size_t len) noexcept
+{
+	can_interact_rt_prefault(buffer, len) ;
+}
+
+#endif // CAN_INTERACT_RT_HH
@@ -0,0 +1,324 @@
+#ifndef CAN_INTERACT_SHARD_HH
+#define CAN_INTERACT_SHARD_HH
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <functional>
+#include <unordered_map>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <errno.h>
+
+#include "can_interact.hh"
+
+/**
+ * @brief CXX API (C++11) multi-core receiver, spreading one interface's traffic over several CAN_RAW sockets
+ * Each shard owns a socket whose kernel filter only admits its share of the subscribed ids, so each frame is received (and decoded) by exactly one thread
+ * Shards only write to their own counters and latest-value slots - readers merge them without taking locks on the receive path
+ * Requires linking with -pthread
+ */
+
+namespace can_interact {
+
+	class ShardedReceiver {
+		/**
+		  * @brief ShardedReceiver (class) - receives frames of a set of ids on several pinned threads
+		  */
+		public:
+			/**
+			  * @brief handler_t - invoked on the shard's thread for every received frame
+			  * @param const std::size_t - index of shard
+			  * @param const can_interact_timed_frame& - received frame
+			  */
+			using handler_t = std::function<void(const std::size_t, const can_interact_timed_frame&)> ;
+
+			struct stats_t {
+				/**
+				  * @brief stats_t - receive counters of one shard, or the sum of all shards
+				  */
+				std::uint64_t frames ;
+				std::uint64_t batches ; // receive syscalls which returned frames
+				std::uint64_t errors ; // failed receive syscalls (timeouts excluded)
+			} ;
+
+		private:
+			struct _slot {
+				/**
+				  * @brief _slot - INTERNAL. latest frame of one id, published by its shard under a sequence lock
+				  */
+				std::atomic<std::uint32_t> seq ; // odd while being written, 0 if never written
+				can_interact_timed_frame value ;
+			} ;
+
+			struct _shard {
+				/**
+				  * @brief _shard - INTERNAL. state owned by a single receive thread, padded against false sharing
+				  */
+				char _pad_front[64] ;
+				CAN can ;
+				std::vector<std::uint32_t> ids ;
+				int core ; // -1 if not pinned
+				std::atomic<std::uint64_t> frames ;
+				std::atomic<std::uint64_t> batches ;
+				std::atomic<std::uint64_t> errors ;
+				std::thread thread ;
+				char _pad_back[64] ;
+
+				_shard(const std::string& device, const int core) noexcept(false) : can(device), core(core), frames{0}, batches{0}, errors{0} {}
+			} ;
+
+			std::vector<std::unique_ptr<_shard>> _shards ;
+			std::unique_ptr<_slot[]> _slots ;
+			std::unordered_map<canid_t, std::size_t> _index ; // id -> slot, immutable once constructed
+			handler_t _handler ;
+			std::atomic<bool> _running ;
+
+			/**
+			  * @brief _run - INTERNAL METHOD. receive loop of a shard
+			  * @param const std::size_t - index of shard
+			  */
+			void _run(const std::size_t) noexcept ;
+
+		public:
+			/**
+			  * @brief ShardedReceiver (constructor) - opens and filters one socket per shard
+			  * Ids are dealt round-robin over the shards. Fewer shards than cores are created if there are fewer ids than cores
+			  * @param const std::string& - name of device
+			  * @param const std::vector<std::uint32_t>& - ids to receive
+			  * @param const std::vector<int>& - core to pin each shard's thread to (-1 to leave a shard unpinned), one entry per shard
+			  * @param handler_t - invoked on shard threads for every frame, may be empty if only latest values are of interest
+			  * @throws std::invalid_argument - if no ids or cores are provided
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			ShardedReceiver(const std::string&, const std::vector<std::uint32_t>&, const std::vector<int>&, handler_t) noexcept(false) ;
+
+			/**
+			  * @brief start - spawns and pins shard threads
+			  * @throws std::runtime_error - if already running, or pinning a thread fails (errors reported by errno)
+			  */
+			void start() noexcept(false) ;
+
+			/**
+			  * @brief stop - signals shard threads to finish and joins them (takes up to one receive timeout, 100ms)
+			  */
+			void stop() noexcept ;
+
+			/**
+			  * @brief shards - getter for number of shards
+			  * @return std::size_t - number of shards
+			  */
+			std::size_t shards() const noexcept ;
+
+			/**
+			  * @brief stats (overload) - counters of a single shard
+			  * @param const std::size_t - index of shard
+			  * @return stats_t - counters
+			  */
+			stats_t stats(const std::size_t) const noexcept ;
+
+			/**
+			  * @brief stats (overload) - counters summed across all shards
+			  * @return stats_t - counters
+			  */
+			stats_t stats() const noexcept ;
+
+			/**
+			  * @brief latest - copies latest frame received for id, without blocking its shard
+			  * @param const canid_t - id
+			  * @param can_interact_timed_frame& - frame to write to
+			  * @return bool - false if id is not subscribed or nothing has been received yet
+			  */
+			bool latest(const canid_t, can_interact_timed_frame&) const noexcept ;
+
+			/**
+			  * @brief ~ShardedReceiver (destructor) - stops shard threads
+			  */
+			~ShardedReceiver() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			ShardedReceiver() = delete ;
+			ShardedReceiver(const ShardedReceiver&) = delete ;
+			ShardedReceiver& operator=(const ShardedReceiver&) = delete ;
+	} ;
+
+}
+
+can_interact::ShardedReceiver::ShardedReceiver(const std::string& device, const std::vector<std::uint32_t>& ids, const std::vector<int>& cores, handler_t handler) noexcept(false) : _handler(std::move(handler)), _running{false}
+{
+	if(ids.empty() || cores.empty())
+	{
+		throw std::invalid_argument("Sharded receiver needs at least one id and one core") ;
+	}
+	const std::size_t count = cores.size() < ids.size() ? cores.size() : ids.size() ;
+	for(std::size_t i = 0 ; i < count ; ++i)
+	{
+		this->_shards.emplace_back(new _shard(device, cores[i])) ;
+	}
+	for(std::size_t i = 0 ; i < ids.size() ; ++i)
+	{
+		this->_shards[i % count]->ids.push_back(ids[i]) ;
+	}
+
+	// slots are laid out shard by shard so each shard writes to a contiguous region
+	this->_slots.reset(new _slot[ids.size()]) ;
+	std::size_t slot = 0 ;
+	const timeval timeout = {0, 100000} ; // lets threads notice stop()
+	for(std::unique_ptr<_shard>& shard : this->_shards)
+	{
+		for(const std::uint32_t id : shard->ids)
+		{
+			this->_slots[slot].seq.store(0, std::memory_order_relaxed) ;
+			this->_index[static_cast<canid_t>(id)] = slot++ ;
+		}
+		shard->can.filter(shard->ids) ;
+		shard->can.timestamps() ;
+		if(setsockopt(shard->can.socket(), SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) != 0)
+		{
+			throw std::runtime_error(std::string{"Errno "} + std::to_string(errno)) ;
+		}
+	}
+}
+
+void can_interact::ShardedReceiver::_run(const std::size_t idx) noexcept
+{
+	_shard& shard = *this->_shards[idx] ;
+	const int socket = shard.can.socket() ;
+	can_interact_timed_frame batch[CAN_INTERACT_MAX_BATCH] ;
+
+	while(this->_running.load(std::memory_order_relaxed))
+	{
+		std::size_t received ;
+		const int res = can_interact_get_frames(batch, CAN_INTERACT_MAX_BATCH, &received, &socket) ;
+		if(res == EAGAIN || res == EWOULDBLOCK || res == EINTR)
+		{
+			continue ;
+		}
+		else if(res != 0)
+		{
+			shard.errors.store(shard.errors.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed) ;
+			continue ;
+		}
+		// single writer per counter - plain load/store rather than locked read-modify-write
+		shard.batches.store(shard.batches.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed) ;
+		shard.frames.store(shard.frames.load(std::memory_order_relaxed) + received, std::memory_order_relaxed) ;
+
+		for(std::size_t i = 0 ; i < received ; ++i)
+		{
+			const std::unordered_map<canid_t, std::size_t>::const_iterator it = this->_index.find(batch[i].frame.can_id & CAN_EFF_MASK) ;
+			if(it != this->_index.end())
+			{
+				_slot& slot = this->_slots[it->second] ;
+				const std::uint32_t seq = slot.seq.load(std::memory_order_relaxed) ;
+				slot.seq.store(seq + 1, std::memory_order_relaxed) ;
+				std::atomic_thread_fence(std::memory_order_release) ;
+				slot.value = batch[i] ;
+				slot.seq.store(seq + 2, std::memory_order_release) ;
+			}
+			if(this->_handler)
+			{
+				this->_handler(idx, batch[i]) ;
+			}
+		}
+	}
+}
+
+void can_interact::ShardedReceiver::start() noexcept(false)
+{
+	if(this->_running.exchange(true))
+	{
+		throw std::runtime_error("Sharded receiver already running") ;
+	}
+	for(std::size_t i = 0 ; i < this->_shards.size() ; ++i)
+	{
+		_shard& shard = *this->_shards[i] ;
+		shard.thread = std::thread(&can_interact::ShardedReceiver::_run, this, i) ;
+		if(shard.core >= 0)
+		{
+			cpu_set_t set ;
+			CPU_ZERO(&set) ;
+			CPU_SET(static_cast<std::size_t>(shard.core), &set) ;
+			const int res = pthread_setaffinity_np(shard.thread.native_handle(), sizeof(set), &set) ;
+			if(res != 0)
+			{
+				this->stop() ;
+				throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+			}
+		}
+	}
+}
+
+void can_interact::ShardedReceiver::stop() noexcept
+{
+	this->_running.store(false) ;
+	for(std::unique_ptr<_shard>& shard : this->_shards)
+	{
+		if(shard->thread.joinable())
+		{
+			shard->thread.join() ;
+		}
+	}
+}
+
+std::size_t can_interact::ShardedReceiver::shards() const noexcept
+{
+	return this->_shards.size() ;
+}
+
+can_interact::ShardedReceiver::stats_t can_interact::ShardedReceiver::stats(const std::size_t idx) const noexcept
+{
+	const _shard& shard = *this->_shards[idx] ;
+	return stats_t{shard.frames.load(std::memory_order_relaxed), shard.batches.load(std::memory_order_relaxed), shard.errors.load(std::memory_order_relaxed)} ;
+}
+
+can_interact::ShardedReceiver::stats_t can_interact::ShardedReceiver::stats() const noexcept
+{
+	stats_t total{0, 0, 0} ;
+	for(std::size_t i = 0 ; i < this->_shards.size() ; ++i)
+	{
+		const stats_t shard = this->stats(i) ;
+		total.frames += shard.frames ;
+		total.batches += shard.batches ;
+		total.errors += shard.errors ;
+	}
+	return total ;
+}
+
+bool can_interact::ShardedReceiver::latest(const canid_t id, can_interact_timed_frame& frame) const noexcept
+{
+	const std::unordered_map<canid_t, std::size_t>::const_iterator it = this->_index.find(id & CAN_EFF_MASK) ;
+	if(it == this->_index.end())
+	{
+		return false ;
+	}
+	const _slot& slot = this->_slots[it->second] ;
+	std::uint32_t before, after ;
+	do
+	{
+		before = slot.seq.load(std::memory_order_acquire) ;
+		if(before == 0)
+		{
+			return false ;
+		}
+		frame = slot.value ;
+		std::atomic_thread_fence(std::memory_order_acquire) ;
+		after = slot.seq.load(std::memory_order_relaxed) ;
+	} while((before & 1) != 0 || before != after) ;
+	return true ;
+}
+
+can_interact::ShardedReceiver::~ShardedReceiver() noexcept
+{
+	this->stop() ;
+}
+
+#endif // CAN_INTERACT_SHARD_HH
@@ -0,0 +1,398 @@
+#define _GNU_SOURCE /* syscall */
+
+#include <unistd.h> /* syscalls */
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "can_interact.h"
+#include "can_interact_shm.h"
+
+/**
+ * @brief C-style definitions of shared memory frame bus
+ * Shared fields are accessed with GCC __atomic builtins, futexes are process shared (no FUTEX_PRIVATE_FLAG)
+ * For definitions for the CXX API, see can_interact_shm.hh
+ */
+
+#define SHM_WRITING ((uint64_t)1 << 63)
+
+/**
+ * @brief _p_can_interact_shm_futex_wait - INTERNAL METHOD. sleeps while futex word holds value
+ * @param uint32_t* - futex word
+ * @param const uint32_t - expected value
+ * @param const int - timeout in milliseconds, -1 for none
+ */
+static void _p_can_interact_shm_futex_wait(uint32_t *word, const uint32_t val, const int timeout_ms)
+{
+	struct timespec ts;
+
+	ts.tv_sec = timeout_ms / 1000;
+	ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000;
+	syscall(SYS_futex, word, FUTEX_WAIT, val, timeout_ms < 0 ? NULL : &ts, NULL, 0);
+}
+
+/**
+ * @brief _p_can_interact_shm_futex_wake - INTERNAL METHOD. wakes sleepers of futex word
+ * @param uint32_t* - futex word
+ * @param const int - number of sleepers to wake
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_shm_futex_wake(uint32_t *word, const int count)
+{
+	return syscall(SYS_futex, word, FUTEX_WAKE, count, NULL, NULL, 0) == -1 ? (int)errno : 0;
+}
+
+/**
+ * @brief _p_can_interact_shm_map - INTERNAL METHOD. opens (optionally creating) and maps shared memory object
+ * @param const char* - name
+ * @param const size_t - length to map, or 0 to map the object's current size
+ * @param const int - non-zero to create (and size) the object
+ * @param const int - non-zero to map read-only
+ * @param size_t* - pointer to write mapped length to
+ * @param void** - pointer to write mapping to
+ * @return int - error code, 0 on success, errno value otherwise
+ */
+static int _p_can_interact_shm_map(const char *name, const size_t len, const int create, const int read_only, size_t *mapped_len, void **mapping)
+{
+	struct stat st;
+	size_t n;
+	int fd, err;
+
+	fd = shm_open(name, create ? (O_RDWR | O_CREAT | O_EXCL) : (read_only ? O_RDONLY : O_RDWR), CAN_INTERACT_SHM_MODE);
+	if (fd == -1) {
+		return (int)errno;
+	}
+	n = len;
+	if (create) {
+		if (ftruncate(fd, (off_t)len) == -1) {
+			err = (int)errno;
+			close(fd);
+			shm_unlink(name);
+			return err;
+		}
+	} else {
+		if (fstat(fd, &st) == -1) {
+			err = (int)errno;
+			close(fd);
+			return err;
+		}
+		n = (size_t)st.st_size;
+	}
+	*mapping = mmap(NULL, n, read_only ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+	err = (int)errno;
+	close(fd); /* mapping stays valid */
+	if (*mapping == MAP_FAILED) {
+		if (create) {
+			shm_unlink(name);
+		}
+		return err;
+	}
+	*mapped_len = n;
+	return 0;
+}
+
+int can_interact_shm_create(struct can_interact_shm *shm, const char *name, const uint32_t capacity, const uint32_t tx_capacity)
+{
+	char tx_name[sizeof(shm->name) + 3];
+	void *mapping;
+	uint32_t i;
+	int res;
+
+	memset(shm, 0, sizeof(*shm));
+	if (capacity == 0 || (capacity & (capacity - 1)) != 0 || (tx_capacity & (tx_capacity - 1)) != 0 || strlen(name) >= sizeof(shm->name) - 3) {
+		return EINVAL;
+	}
+	strcpy(shm->name, name);
+	shm->server = 1;
+
+	shm_unlink(name); /* stale object of a previous server */
+	res = _p_can_interact_shm_map(name, sizeof(struct can_interact_shm_header) + sizeof(struct can_interact_shm_rx_slot) * capacity, 1, 0, &shm->len, &mapping);
+	if (res != 0) {
+		return res;
+	}
+	shm->header = (struct can_interact_shm_header*)mapping;
+	shm->slots = (struct can_interact_shm_rx_slot*)(shm->header + 1);
+	/* object is zero filled - tags of 0 mean empty */
+	shm->header->capacity = capacity;
+	shm->header->tx_capacity = tx_capacity;
+	shm->header->version = CAN_INTERACT_SHM_VERSION;
+
+	if (tx_capacity != 0) {
+		strcpy(tx_name, name);
+		strcat(tx_name, ".tx");
+		shm_unlink(tx_name);
+		res = _p_can_interact_shm_map(tx_name, sizeof(struct can_interact_shm_tx_header) + sizeof(struct can_interact_shm_tx_slot) * tx_capacity, 1, 0, &shm->tx_len, &mapping);
+		if (res != 0) {
+			munmap(shm->header, shm->len);
+			shm_unlink(name);
+			return res;
+		}
+		shm->tx_header = (struct can_interact_shm_tx_header*)mapping;
+		shm->tx_slots = (struct can_interact_shm_tx_slot*)(shm->tx_header + 1);
+		for (i = 0; i < tx_capacity; ++i) {
+			shm->tx_slots[i].seq = i;
+		}
+	}
+	__atomic_store_n(&shm->header->magic, CAN_INTERACT_SHM_MAGIC, __ATOMIC_RELEASE); /* clients may attach from here on */
+	return 0;
+}
+
+int can_interact_shm_publish(struct can_interact_shm *shm, const struct can_interact_timed_frame *frames, const size_t len)
+{
+	struct can_interact_shm_rx_slot *slot;
+	const uint64_t mask = shm->header->capacity - 1;
+	uint64_t seq;
+	size_t i;
+
+	seq = __atomic_load_n(&shm->header->cursor, __ATOMIC_RELAXED);
+	for (i = 0; i < len; ++i, ++seq) {
+		slot = &shm->slots[seq & mask];
+		__atomic_store_n(&slot->tag, SHM_WRITING | (seq + 1), __ATOMIC_RELAXED);
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		slot->value = frames[i];
+		__atomic_store_n(&slot->tag, seq + 1, __ATOMIC_RELEASE);
+	}
+	__atomic_store_n(&shm->header->cursor, seq, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&shm->header->futex, 1, __ATOMIC_RELEASE);
+	/* clients map the ring read-only and cannot announce themselves as sleeping, so wake unconditionally - once per batch */
+	return _p_can_interact_shm_futex_wake(&shm->header->futex, INT_MAX);
+}
+
+int can_interact_shm_serve_rx(struct can_interact_shm *shm, const int *socket)
+{
+	struct can_interact_timed_frame batch[CAN_INTERACT_MAX_BATCH];
+	size_t received;
+	int res;
+
+	res = can_interact_get_frames(batch, CAN_INTERACT_MAX_BATCH, &received, socket);
+	if (res != 0) {
+		return res;
+	}
+	return can_interact_shm_publish(shm, batch, received);
+}
+
+int can_interact_shm_serve_tx(struct can_interact_shm *shm, const int *socket, const int timeout_ms, size_t *sent)
+{
+	struct can_interact_shm_tx_header *header = shm->tx_header;
+	struct can_interact_shm_tx_slot *slot;
+	struct can_frame frame;
+	uint64_t mask, pos;
+	uint32_t word;
+	size_t n;
+	int res;
+
+	if (sent != NULL) {
+		*sent = 0;
+	}
+	if (header == NULL) {
+		return ENOTSUP;
+	}
+	mask = shm->header->tx_capacity - 1;
+	pos = header->dequeue; /* only the server writes dequeue */
+
+	word = __atomic_load_n(&header->futex, __ATOMIC_ACQUIRE);
+	slot = &shm->tx_slots[pos & mask];
+	if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+		_p_can_interact_shm_futex_wait(&header->futex, word, timeout_ms);
+	}
+
+	for (n = 0;; ++n) {
+		slot = &shm->tx_slots[pos & mask];
+		if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+			break;
+		}
+		frame = slot->frame;
+		__atomic_store_n(&slot->seq, pos + mask + 1, __ATOMIC_RELEASE); /* free slot for next lap */
+		header->dequeue = ++pos;
+		res = can_interact_send_frame(&frame, socket);
+		if (res != 0) {
+			if (sent != NULL) {
+				*sent = n;
+			}
+			return res;
+		}
+	}
+	if (sent != NULL) {
+		*sent = n;
+	}
+	return 0;
+}
+
+int can_interact_shm_attach(struct can_interact_shm *shm, const char *name)
+{
+	char tx_name[sizeof(shm->name) + 3];
+	void *mapping;
+	int res;
+
+	memset(shm, 0, sizeof(*shm));
+	if (strlen(name) >= sizeof(shm->name) - 3) {
+		return EINVAL;
+	}
+	strcpy(shm->name, name);
+
+	res = _p_can_interact_shm_map(name, 0, 0, 1, &shm->len, &mapping);
+	if (res != 0) {
+		return res;
+	}
+	shm->header = (struct can_interact_shm_header*)mapping;
+	shm->slots = (struct can_interact_shm_rx_slot*)(shm->header + 1);
+	if (shm->len < sizeof(struct can_interact_shm_header)
+		|| __atomic_load_n(&shm->header->magic, __ATOMIC_ACQUIRE) != CAN_INTERACT_SHM_MAGIC
+		|| shm->header->version != CAN_INTERACT_SHM_VERSION
+		|| shm->len < sizeof(struct can_interact_shm_header) + sizeof(struct can_interact_shm_rx_slot) * shm->header->capacity) {
+		munmap(mapping, shm->len);
+		shm->header = NULL;
+		return EPROTO;
+	}
+
+	if (shm->header->tx_capacity != 0) {
+		strcpy(tx_name, name);
+		strcat(tx_name, ".tx");
+		res = _p_can_interact_shm_map(tx_name, 0, 0, 0, &shm->tx_len, &mapping);
+		if (res == 0 && shm->tx_len >= sizeof(struct can_interact_shm_tx_header) + sizeof(struct can_interact_shm_tx_slot) * shm->header->tx_capacity) {
+			shm->tx_header = (struct can_interact_shm_tx_header*)mapping;
+			shm->tx_slots = (struct can_interact_shm_tx_slot*)(shm->tx_header + 1);
+		} else if (res == 0) {
+			munmap(mapping, shm->tx_len);
+		} /* otherwise attach read-only (e.g. lacking permissions on the transmit queue) */
+	}
+
+	shm->next = __atomic_load_n(&shm->header->cursor, __ATOMIC_ACQUIRE);
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_shm_try - INTERNAL METHOD. attempts to read next frame without waiting, skipping frames lost to overruns
+ * @param struct can_interact_shm* - client handle
+ * @param struct can_interact_timed_frame* - frame to write to
+ * @return int - 1 if frame was read, 0 if none is available
+ */
+static int _p_can_interact_shm_try(struct can_interact_shm *shm, struct can_interact_timed_frame *frame)
+{
+	const struct can_interact_shm_rx_slot *slot;
+	const uint64_t capacity = shm->header->capacity;
+	uint64_t before, expected, cursor, oldest;
+
+	for (;;) {
+		slot = &shm->slots[shm->next & (capacity - 1)];
+		expected = shm->next + 1;
+		before = __atomic_load_n(&slot->tag, __ATOMIC_ACQUIRE);
+		if ((before & ~SHM_WRITING) < expected || before == (SHM_WRITING | expected)) {
+			return 0;
+		}
+		if (before == expected) {
+			*frame = slot->value;
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if (__atomic_load_n(&slot->tag, __ATOMIC_RELAXED) == before) {
+				++shm->next;
+				return 1;
+			}
+		}
+		/* overwritten by a later lap - skip to oldest frame still held */
+		cursor = __atomic_load_n(&shm->header->cursor, __ATOMIC_ACQUIRE);
+		oldest = cursor > capacity ? cursor - capacity : 0;
+		if (oldest > shm->next) {
+			shm->overruns += oldest - shm->next;
+			shm->next = oldest;
+		} else {
+			++shm->overruns;
+			++shm->next;
+		}
+	}
+}
+
+int can_interact_shm_get_frame(struct can_interact_shm *shm, struct can_interact_timed_frame *frame, const int timeout_ms)
+{
+	struct timespec now, deadline;
+	uint32_t word;
+	long left_ms;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += timeout_ms / 1000;
+	deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_nsec -= 1000000000;
+		++deadline.tv_sec;
+	}
+
+	for (;;) {
+		word = __atomic_load_n(&shm->header->futex, __ATOMIC_ACQUIRE);
+		if (_p_can_interact_shm_try(shm, frame)) {
+			return 0;
+		}
+		if (timeout_ms < 0) {
+			_p_can_interact_shm_futex_wait(&shm->header->futex, word, -1);
+			continue;
+		}
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		left_ms = (long)(deadline.tv_sec - now.tv_sec) * 1000 + (deadline.tv_nsec - now.tv_nsec) / 1000000;
+		if (left_ms <= 0) {
+			return ETIMEDOUT;
+		}
+		_p_can_interact_shm_futex_wait(&shm->header->futex, word, (int)left_ms);
+	}
+}
+
+int can_interact_shm_send_frame(struct can_interact_shm *shm, const struct can_frame *frame)
+{
+	struct can_interact_shm_tx_header *header = shm->tx_header;
+	struct can_interact_shm_tx_slot *slot;
+	uint64_t mask, pos, seq;
+
+	if (header == NULL) {
+		return ENOTSUP;
+	}
+	mask = shm->header->tx_capacity - 1;
+	pos = __atomic_load_n(&header->enqueue, __ATOMIC_RELAXED);
+	for (;;) {
+		slot = &shm->tx_slots[pos & mask];
+		seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+		if (seq == pos) { /* free for this lap - try to claim it */
+			if (__atomic_compare_exchange_n(&header->enqueue, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (seq < pos) { /* still holds request of previous lap */
+			return ENOBUFS;
+		} else {
+			pos = __atomic_load_n(&header->enqueue, __ATOMIC_RELAXED);
+		}
+	}
+	slot->frame = *frame;
+	__atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+	__atomic_fetch_add(&header->futex, 1, __ATOMIC_RELEASE);
+	return _p_can_interact_shm_futex_wake(&header->futex, 1);
+}
+
+int can_interact_shm_fini(struct can_interact_shm *shm)
+{
+	char tx_name[sizeof(shm->name) + 3];
+	int res;
+
+	res = 0;
+	if (shm->tx_header != NULL && munmap(shm->tx_header, shm->tx_len) == -1) {
+		res = (int)errno;
+	}
+	if (shm->header != NULL && munmap(shm->header, shm->len) == -1) {
+		res = (int)errno;
+	}
+	if (shm->server) {
+		strcpy(tx_name, shm->name);
+		strcat(tx_name, ".tx");
+		shm_unlink(tx_name);
+		if (shm_unlink(shm->name) == -1) {
+			res = (int)errno;
+		}
+	}
+	shm->header = NULL;
+	shm->tx_header = NULL;
+	return res;
+}
@@ -0,0 +1,198 @@
+#ifndef CAN_INTERACT_SHM_H
+#define CAN_INTERACT_SHM_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "can_interact.h"
+
+/**
+ * @brief C-style shared memory frame bus, letting many local processes share a single CAN socket
+ * A server process owns the socket (see can_interact_init) and publishes received, timestamped frames into a POSIX shared memory ring
+ * Clients map the ring read-only and sleep on a futex until frames arrive. Clients may optionally submit frames for transmission through a second, writable queue
+ * Each client tracks its own position - a client falling more than the ring's capacity behind is told how many frames it lost
+ * For the CXX API, see can_interact_shm.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CAN_INTERACT_SHM_MAGIC 0x43414E53u /* "CANS" */
+#define CAN_INTERACT_SHM_VERSION 1u
+
+#ifndef CAN_INTERACT_SHM_MODE
+#define CAN_INTERACT_SHM_MODE 0600 /* permissions of created segments, writers can send on the bus, so e.g. 0660 to share with a group */
+#endif /* CAN_INTERACT_SHM_MODE */
+
+struct can_interact_shm_rx_slot {
+	/**
+	 * @brief struct can_interact_shm_rx_slot - INTERNAL. published frame, tag is its sequence + 1 (top bit set while being overwritten)
+	 */
+	uint64_t tag;
+	struct can_interact_timed_frame value;
+};
+
+struct can_interact_shm_tx_slot {
+	/**
+	 * @brief struct can_interact_shm_tx_slot - INTERNAL. transmit request slot of bounded multi producer queue
+	 */
+	uint64_t seq;
+	struct can_frame frame;
+};
+
+struct can_interact_shm_header {
+	/**
+	 * @brief struct can_interact_shm_header - INTERNAL. head of shared memory object, each group of fields sits on its own cache line
+	 */
+	uint32_t magic;
+	uint32_t version;
+	uint32_t capacity; /* slots in ring, power of two */
+	uint32_t tx_capacity; /* slots in transmit queue (lives in separate object), 0 if transmitting is disabled */
+	uint8_t _pad0[48];
+	uint64_t cursor; /* next sequence to publish */
+	uint32_t futex; /* bumped once per published batch, clients wait on it */
+	uint32_t _pad1[13];
+};
+
+struct can_interact_shm_tx_header {
+	/**
+	 * @brief struct can_interact_shm_tx_header - INTERNAL. head of shared memory transmit queue object
+	 */
+	uint64_t enqueue; /* claimed by clients */
+	uint8_t _pad0[56];
+	uint64_t dequeue; /* consumed by server */
+	uint32_t futex; /* bumped on every submission, server waits on it */
+	uint32_t _pad1[13];
+};
+
+struct can_interact_shm {
+	/**
+	 * @brief struct can_interact_shm - process local handle of shared memory frame bus (either as server or client)
+	 */
+	struct can_interact_shm_header *header;
+	struct can_interact_shm_rx_slot *slots;
+	struct can_interact_shm_tx_header *tx_header; /* NULL if transmitting is disabled */
+	struct can_interact_shm_tx_slot *tx_slots;
+	size_t len; /* mapped length of ring object */
+	size_t tx_len; /* mapped length of transmit queue object */
+	uint64_t next; /* client: sequence of next frame to read */
+	uint64_t overruns; /* client: frames lost as they were overwritten before being read */
+	int server; /* non-zero if this handle created the objects */
+	char name[64];
+};
+
+/**
+ * @brief can_interact_shm_create - creates shared memory frame bus (server side), replacing stale objects of same name
+ *
+ * @param struct can_interact_shm* - handle to initialise
+ *
+ * @param const char* - POSIX shared memory name, e.g. "/can0" (at most 60 characters). The transmit queue uses name with ".tx" appended
+ *
+ * @param const uint32_t - capacity of ring in frames, must be a power of two
+ *
+ * @param const uint32_t - capacity of transmit queue in frames, must be a power of two, 0 to disable transmitting
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if a capacity or the name is invalid, for other non-zero values refer to errno codes
+ */
+int can_interact_shm_create(struct can_interact_shm *shm, const char *name, const uint32_t capacity, const uint32_t tx_capacity);
+
+/**
+ * @brief can_interact_shm_publish - publishes frames to all clients (server side, single thread only)
+ *
+ * @param struct can_interact_shm* - server handle
+ *
+ * @param const struct can_interact_timed_frame* - frames
+ *
+ * @param const size_t - number of frames
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes (from waking clients)
+ */
+int can_interact_shm_publish(struct can_interact_shm *shm, const struct can_interact_timed_frame *frames, const size_t len);
+
+/**
+ * @brief can_interact_shm_serve_rx - receives one batch from socket and publishes it (server side, run in a loop on one thread)
+ * Enable timestamps on the socket (can_interact_timestamps) beforehand for clients to receive kernel timestamps
+ *
+ * @param struct can_interact_shm* - server handle
+ *
+ * @param const int* - socket descriptor to receive from
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_shm_serve_rx(struct can_interact_shm *shm, const int *socket);
+
+/**
+ * @brief can_interact_shm_serve_tx - waits for transmit requests and sends all queued frames (server side, run in a loop on one thread)
+ *
+ * @param struct can_interact_shm* - server handle
+ *
+ * @param const int* - socket descriptor to send to
+ *
+ * @param const int - maximum time to wait for requests in milliseconds, -1 to wait indefinitely
+ *
+ * @param size_t* - pointer to write number of frames sent to, may be NULL
+ *
+ * @return int - error code
+ * Note: 0 on success (including timeouts), ENOTSUP if transmitting is disabled, for other non-zero values refer to errno codes (the failed frame is dropped)
+ */
+int can_interact_shm_serve_tx(struct can_interact_shm *shm, const int *socket, const int timeout_ms, size_t *sent);
+
+/**
+ * @brief can_interact_shm_attach - attaches to existing shared memory frame bus (client side)
+ * The ring is mapped read-only, the transmit queue (if any) read-write. Reading starts at the next published frame
+ *
+ * @param struct can_interact_shm* - handle to initialise
+ *
+ * @param const char* - POSIX shared memory name used by server
+ *
+ * @return int - error code
+ * Note: 0 on success, EPROTO if the object is not a compatible frame bus, for other non-zero values refer to errno codes
+ */
+int can_interact_shm_attach(struct can_interact_shm *shm, const char *name);
+
+/**
+ * @brief can_interact_shm_get_frame - reads next frame (client side, one thread per handle)
+ *
+ * @param struct can_interact_shm* - client handle
+ *
+ * @param struct can_interact_timed_frame* - pointer to frame to write to
+ *
+ * @param const int - maximum time to wait in milliseconds, -1 to wait indefinitely, 0 to poll
+ *
+ * @return int - error code
+ * Note: 0 on success, ETIMEDOUT if no frame arrived in time, for other non-zero values refer to errno codes
+ */
+int can_interact_shm_get_frame(struct can_interact_shm *shm, struct can_interact_timed_frame *frame, const int timeout_ms);
+
+/**
+ * @brief can_interact_shm_send_frame - submits frame for transmission by server (client side, any number of threads / processes)
+ *
+ * @param struct can_interact_shm* - client handle
+ *
+ * @param const struct can_frame* - frame to send
+ *
+ * @return int - error code
+ * Note: 0 on success, ENOTSUP if transmitting is disabled, ENOBUFS if the queue is full, for other non-zero values refer to errno codes
+ */
+int can_interact_shm_send_frame(struct can_interact_shm *shm, const struct can_frame *frame);
+
+/**
+ * @brief can_interact_shm_fini - unmaps frame bus, additionally removing its objects if handle is the server's
+ *
+ * @param struct can_interact_shm* - handle
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_shm_fini(struct can_interact_shm *shm);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_SHM_H */
@@ -0,0 +1,233 @@
+#ifndef CAN_INTERACT_SHM_HH
+#define CAN_INTERACT_SHM_HH
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <errno.h>
+
+#include "can_interact.hh"
+#include "can_interact_shm.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact shared memory frame bus
+ * ShmServer is run by the one process owning the CAN socket, ShmCAN mirrors can_interact::CAN for the processes sharing it
+ * For declarations for the native C library, see can_interact_shm.h
+ */
+
+namespace can_interact {
+
+	class ShmServer {
+		/**
+		  * @brief ShmServer (class) - creates frame bus and moves frames between it and a CAN connection
+		  * serve_rx and serve_tx are meant to be called in loops on two separate threads
+		  */
+		private:
+			can_interact_shm _shm ;
+
+		public:
+			/**
+			  * @brief ShmServer (constructor) - creates shared memory objects, replacing stale ones
+			  * @param const std::string& - POSIX shared memory name, e.g. "/can0"
+			  * @param const std::uint32_t - capacity of ring in frames (power of two)
+			  * @param const std::uint32_t - capacity of transmit queue in frames (power of two), 0 disables transmitting
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			ShmServer(const std::string&, const std::uint32_t, const std::uint32_t = 0) noexcept(false) ;
+
+			/**
+			  * @brief serve_rx - receives one batch from CAN connection and publishes it to clients
+			  * @param const CAN& - CAN connection (enable its timestamps for clients to receive kernel timestamps)
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void serve_rx(const CAN&) noexcept(false) ;
+
+			/**
+			  * @brief serve_tx - waits for transmit requests of clients and sends them
+			  * @param const CAN& - CAN connection
+			  * @param const std::chrono::milliseconds - maximum time to wait
+			  * @return std::size_t - number of frames sent
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			std::size_t serve_tx(const CAN&, const std::chrono::milliseconds) noexcept(false) ;
+
+			/**
+			  * @brief publish - publishes frames from another source to clients
+			  * @param const can_interact_timed_frame* - frames
+			  * @param const std::size_t - number of frames
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			void publish(const can_interact_timed_frame*, const std::size_t) noexcept(false) ;
+
+			/**
+			  * @brief ~ShmServer (destructor) - unmaps and removes shared memory objects
+			  */
+			~ShmServer() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			ShmServer() = delete ;
+			ShmServer(const ShmServer&) = delete ;
+			ShmServer& operator=(const ShmServer&) = delete ;
+	} ;
+
+	class ShmCAN {
+		/**
+		  * @brief ShmCAN (class) - client of frame bus, receiving & sending like can_interact::CAN without a socket of its own
+		  * Each object keeps its own read position, use one object per reading thread
+		  */
+		private:
+			can_interact_shm _shm ;
+
+		public:
+			/**
+			  * @brief ShmCAN (constructor) - attaches to frame bus
+			  * @param const std::string& - POSIX shared memory name used by server
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			ShmCAN(const std::string&) noexcept(false) ;
+
+			/**
+			  * @brief frame (overload) - returns next frame, blocking until one is published
+			  * @return can_frame - LINUX CAN frame struct
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			can_frame frame() noexcept(false) ;
+
+			/**
+			  * @brief frame (overload) - submits frame to server for transmission
+			  * @param const can_frame& - LINUX CAN frame struct
+			  * @throws std::runtime_error - if transmitting is disabled, the queue is full or other errors are reported by errno
+			  */
+			void frame(const can_frame&) noexcept(false) ;
+
+			/**
+			  * @brief timed_frame - returns next timestamped frame, waiting at most timeout
+			  * @param can_interact_timed_frame& - frame to write to
+			  * @param const std::chrono::milliseconds - maximum time to wait
+			  * @return bool - false on timeout
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			bool timed_frame(can_interact_timed_frame&, const std::chrono::milliseconds) noexcept(false) ;
+
+			/**
+			  * @brief overruns - getter for number of frames lost as this client fell behind by more than the ring's capacity
+			  * @return std::uint64_t - lost frames
+			  */
+			std::uint64_t overruns() const noexcept ;
+
+			/**
+			  * @brief ~ShmCAN (destructor) - detaches from frame bus
+			  */
+			~ShmCAN() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			ShmCAN() = delete ;
+			ShmCAN(const ShmCAN&) = delete ;
+			ShmCAN& operator=(const ShmCAN&) = delete ;
+	} ;
+
+}
+
+can_interact::ShmServer::ShmServer(const std::string& name, const std::uint32_t capacity, const std::uint32_t tx_capacity) noexcept(false)
+{
+	const int res = can_interact_shm_create(&this->_shm, name.c_str(), capacity, tx_capacity) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::ShmServer::serve_rx(const can_interact::CAN& can) noexcept(false)
+{
+	const int socket = can.socket() ;
+	const int res = can_interact_shm_serve_rx(&this->_shm, &socket) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+std::size_t can_interact::ShmServer::serve_tx(const can_interact::CAN& can, const std::chrono::milliseconds timeout) noexcept(false)
+{
+	const int socket = can.socket() ;
+	std::size_t sent ;
+	const int res = can_interact_shm_serve_tx(&this->_shm, &socket, static_cast<int>(timeout.count()), &sent) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return sent ;
+}
+
+void can_interact::ShmServer::publish(const can_interact_timed_frame* frames, const std::size_t len) noexcept(false)
+{
+	const int res = can_interact_shm_publish(&this->_shm, frames, len) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+can_interact::ShmServer::~ShmServer() noexcept
+{
+	can_interact_shm_fini(&this->_shm) ;
+}
+
+can_interact::ShmCAN::ShmCAN(const std::string& name) noexcept(false)
+{
+	const int res = can_interact_shm_attach(&this->_shm, name.c_str()) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+can_frame can_interact::ShmCAN::frame() noexcept(false)
+{
+	can_interact_timed_frame frame ;
+	const int res = can_interact_shm_get_frame(&this->_shm, &frame, -1) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return frame.frame ;
+}
+
+void can_interact::ShmCAN::frame(const can_frame& frame) noexcept(false)
+{
+	const int res = can_interact_shm_send_frame(&this->_shm, &frame) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+bool can_interact::ShmCAN::timed_frame(can_interact_timed_frame& frame, const std::chrono::milliseconds timeout) noexcept(false)
+{
+	const int res = can_interact_shm_get_frame(&this->_shm, &frame, static_cast<int>(timeout.count())) ;
+	if(res == ETIMEDOUT)
+	{
+		return false ;
+	}
+	else if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return true ;
+}
+
+std::uint64_t can_interact::ShmCAN::overruns() const noexcept
+{
+	return this->_shm.overruns ;
+}
+
+can_interact::ShmCAN::~ShmCAN() noexcept
+{
+	can_interact_shm_fini(&this->_shm) ;
+}
+
+#endif // CAN_INTERACT_SHM_HH
@@ -0,0 +1,527 @@
+#define _DEFAULT_SOURCE
+
+#include <unistd.h> /* syscalls */
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#include <endian.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <linux/can.h>
+#include <linux/can/error.h>
+
+#include "can_interact_text.h"
+
+/**
+ * @brief C-style definitions of the text log parser and formatter
+ * For definitions for the CXX API, see can_interact_text.hh
+ */
+
+/* b repeated in every byte of a 64-bit word (spelt without long long constants for C89) */
+#define TEXT_BYTES(b) ((((uint64_t)(0x01010101u * (uint32_t)(b))) << 32) | (uint64_t)(0x01010101u * (uint32_t)(b)))
+#define TEXT_LOW_BYTE_OF_16 ((((uint64_t)0x00FF00FFu) << 32) | (uint64_t)0x00FF00FFu)
+#define TEXT_LOW_HALF_OF_32 ((((uint64_t)0x0000FFFFu) << 32) | (uint64_t)0x0000FFFFu)
+
+static const char _p_can_interact_text_digits[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+
+/**
+ * @brief _p_can_interact_text_nibble - INTERNAL METHOD. decodes single hex digit
+ * @param const char - character
+ * @return int - value, -1 if not a hex digit
+ */
+static int _p_can_interact_text_nibble(const char c)
+{
+	const unsigned int u = (unsigned char)c;
+
+	if (u - '0' < 10u) {
+		return (int)(u - '0');
+	}
+	if ((u | 0x20u) - 'a' < 6u) {
+		return (int)((u | 0x20u) - 'a' + 10u);
+	}
+	return -1;
+}
+
+/**
+ * @brief _p_can_interact_text_ge - INTERNAL METHOD. compares all bytes of word (each below 0x80) with constant at once
+ * @param const uint64_t - 8 bytes
+ * @param const unsigned int - constant (at most 0x80)
+ * @return uint64_t - 0x80 in every byte which is greater than or equal to constant, 0 in others
+ */
+static uint64_t _p_can_interact_text_ge(const uint64_t v, const unsigned int k)
+{
+	return ((v | TEXT_BYTES(0x80)) - TEXT_BYTES(k)) & TEXT_BYTES(0x80); /* the set top bit of each byte absorbs its borrow */
+}
+
+/**
+ * @brief _p_can_interact_text_hex - INTERNAL METHOD. decodes run of hex digit pairs
+ * Eight characters are validated and decoded per step within a 64-bit register (SWAR), the remainder one pair at a time
+ * @param const char* - start of run
+ * @param const char* - end of text (never read beyond)
+ * @param uint8_t* - bytes to write to
+ * @param const size_t - maximum number of bytes
+ * @return size_t - number of characters consumed (always even)
+ */
+static size_t _p_can_interact_text_hex(const char *pos, const char *end, uint8_t *out, const size_t max)
+{
+	const char *p = pos;
+	uint64_t v, alpha, digit, nib;
+	size_t n = 0;
+	int hi, lo;
+
+	while (max - n >= 4 && end - p >= 8) {
+		memcpy(&v, p, 8);
+		v = le64toh(v); /* first character in lowest byte */
+		if (v & TEXT_BYTES(0x80)) {
+			break;
+		}
+		digit = _p_can_interact_text_ge(v, '0') & ~_p_can_interact_text_ge(v, '9' + 1);
+		alpha = _p_can_interact_text_ge(v | TEXT_BYTES(0x20), 'a') & ~_p_can_interact_text_ge(v | TEXT_BYTES(0x20), 'f' + 1);
+		if ((digit | alpha) != TEXT_BYTES(0x80)) {
+			break; /* run ends within these 8 characters */
+		}
+		nib = (v & TEXT_BYTES(0x0F)) + (alpha >> 7) * 9; /* 'A' & 0x0F == 1, hence + 9 */
+		nib = ((nib & TEXT_LOW_BYTE_OF_16) << 4) | ((nib >> 8) & TEXT_LOW_BYTE_OF_16); /* pair nibbles into bytes, one per 16 bits */
+		nib = (nib | (nib >> 8)) & TEXT_LOW_HALF_OF_32; /* gather bytes */
+		nib = nib | (nib >> 16);
+		out[n] = (uint8_t)nib;
+		out[n + 1] = (uint8_t)(nib >> 8);
+		out[n + 2] = (uint8_t)(nib >> 16);
+		out[n + 3] = (uint8_t)(nib >> 24);
+		n += 4;
+		p += 8;
+	}
+	while (n < max && end - p >= 2 && (hi = _p_can_interact_text_nibble(p[0])) >= 0 && (lo = _p_can_interact_text_nibble(p[1])) >= 0) {
+		out[n++] = (uint8_t)((hi << 4) | lo);
+		p += 2;
+	}
+	return (size_t)(p - pos);
+}
+
+/**
+ * @brief _p_can_interact_text_blank - INTERNAL METHOD. skips spaces and tabs
+ * @param const char* - position
+ * @param const char* - end of line
+ * @return const char* - first other character (or end of line)
+ */
+static const char* _p_can_interact_text_blank(const char *p, const char *end)
+{
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		++p;
+	}
+	return p;
+}
+
+/**
+ * @brief _p_can_interact_text_token - INTERNAL METHOD. finds end of whitespace delimited token
+ * @param const char* - start of token
+ * @param const char* - end of line
+ * @return const char* - first character after token
+ */
+static const char* _p_can_interact_text_token(const char *p, const char *end)
+{
+	while (p < end && *p != ' ' && *p != '\t' && *p != '\r') {
+		++p;
+	}
+	return p;
+}
+
+/**
+ * @brief _p_can_interact_text_device - INTERNAL METHOD. checks interface / channel token against parser's filter
+ * @param const struct can_interact_text_parser* - parser
+ * @param const char* - start of token
+ * @param const char* - end of token
+ * @return int - non-zero if frames of token are wanted
+ */
+static int _p_can_interact_text_device(const struct can_interact_text_parser *parser, const char *start, const char *end)
+{
+	return parser->device == NULL || (strlen(parser->device) == (size_t)(end - start) && memcmp(parser->device, start, (size_t)(end - start)) == 0);
+}
+
+/**
+ * @brief _p_can_interact_text_time - INTERNAL METHOD. parses seconds with up to nanosecond fraction
+ * @param const char* - position
+ * @param const char* - end of line
+ * @param uint64_t* - pointer to write nanoseconds to
+ * @return const char* - first character after number, NULL if there is no number
+ */
+static const char* _p_can_interact_text_time(const char *p, const char *end, uint64_t *ns)
+{
+	uint64_t secs = 0, frac = 0, scale = 1000000000u;
+	const char *start = p;
+
+	while (p < end && (unsigned int)(*p - '0') < 10u) {
+		secs = secs * 10u + (uint64_t)(*p++ - '0');
+	}
+	if (p == start) {
+		return NULL;
+	}
+	if (p < end && *p == '.') {
+		for (++p; p < end && (unsigned int)(*p - '0') < 10u; ++p) {
+			if (scale > 1u) { /* digits beyond nanoseconds are dropped */
+				scale /= 10u;
+				frac += (uint64_t)(*p - '0') * scale;
+			}
+		}
+	}
+	*ns = secs * 1000000000u + frac;
+	return p;
+}
+
+/**
+ * @brief _p_can_interact_text_candump - INTERNAL METHOD. parses candump log line, e.g. "(1436509052.249713) can0 123#DEADBEEF"
+ * @param const struct can_interact_text_parser* - parser
+ * @param const char* - start of line
+ * @param const char* - end of line
+ * @param struct can_interact_timed_frame* - frame to write to
+ * @return int - non-zero if line held a wanted frame
+ */
+static int _p_can_interact_text_candump(const struct can_interact_text_parser *parser, const char *p, const char *end, struct can_interact_timed_frame *frame)
+{
+	const char *token;
+	canid_t id = 0;
+	size_t digits = 0, consumed;
+	int nibble;
+
+	if (p >= end || *p != '(') {
+		return 0;
+	}
+	p = _p_can_interact_text_time(p + 1, end, &frame->timestamp_ns);
+	if (p == NULL || p >= end || *p != ')') {
+		return 0;
+	}
+	token = _p_can_interact_text_blank(p + 1, end);
+	p = _p_can_interact_text_token(token, end);
+	if (!_p_can_interact_text_device(parser, token, p)) {
+		return 0;
+	}
+
+	p = _p_can_interact_text_blank(p, end);
+	for (; p < end && (nibble = _p_can_interact_text_nibble(*p)) >= 0 && digits < 8; ++p, ++digits) {
+		id = (id << 4) | (canid_t)nibble;
+	}
+	if (p >= end || *p != '#' || (digits != 3 && digits != 8)) {
+		return 0;
+	}
+	if (digits == 8) {
+		id = (id & CAN_ERR_FLAG) ? (id & (CAN_ERR_FLAG | CAN_ERR_MASK)) : ((id & CAN_EFF_MASK) | CAN_EFF_FLAG);
+	}
+	++p;
+
+	memset(&frame->frame, 0, sizeof(struct can_frame));
+	if (p < end && *p == '#') { /* CAN FD */
+		return 0;
+	} else if (p < end && (*p == 'R' || *p == 'r')) {
+		id |= CAN_RTR_FLAG;
+		if (p + 1 < end && (unsigned int)(p[1] - '0') <= 8u) {
+			frame->frame.can_dlc = (uint8_t)(p[1] - '0');
+		}
+	} else {
+		consumed = _p_can_interact_text_hex(p, end, frame->frame.data, 8);
+		if (p + consumed < end && _p_can_interact_text_nibble(p[consumed]) >= 0) { /* odd number of digits or more than 8 bytes */
+			return 0;
+		}
+		frame->frame.can_dlc = (uint8_t)(consumed / 2);
+	}
+	frame->frame.can_id = id;
+	return 1;
+}
+
+/**
+ * @brief _p_can_interact_text_asc - INTERNAL METHOD. parses Vector ASC line, e.g. "   12.345678 1  123  Rx   d 4 DE AD BE EF"
+ * @param struct can_interact_text_parser* - parser (picks up "base dec" / "base hex" headers)
+ * @param const char* - start of line
+ * @param const char* - end of line
+ * @param struct can_interact_timed_frame* - frame to write to
+ * @return int - non-zero if line held a wanted frame
+ */
+static int _p_can_interact_text_asc(struct can_interact_text_parser *parser, const char *p, const char *end, struct can_interact_timed_frame *frame)
+{
+	const char *token;
+	canid_t id = 0;
+	uint64_t ts;
+	int nibble, hi, lo, ext, remote;
+	uint8_t dlc = 0, i;
+
+	p = _p_can_interact_text_blank(p, end);
+	if (end - p >= 8 && memcmp(p, "base ", 5) == 0) {
+		parser->decimal = memcmp(p + 5, "dec", 3) == 0;
+		return 0;
+	}
+	p = _p_can_interact_text_time(p, end, &ts);
+	if (p == NULL || p >= end || (*p != ' ' && *p != '\t')) {
+		return 0;
+	}
+
+	token = _p_can_interact_text_blank(p, end); /* channel, digits only (CANFD / event lines differ here) */
+	for (p = token; p < end && (unsigned int)(*p - '0') < 10u; ++p) {
+	}
+	if (p == token || p >= end || (*p != ' ' && *p != '\t') || !_p_can_interact_text_device(parser, token, p)) {
+		return 0;
+	}
+
+	token = _p_can_interact_text_blank(p, end);
+	p = _p_can_interact_text_token(token, end);
+	ext = p > token && (p[-1] == 'x' || p[-1] == 'X');
+	if (p - ext == token || p - ext - token > 8) {
+		return 0;
+	}
+	for (; token < p - ext; ++token) {
+		nibble = parser->decimal ? ((unsigned int)(*token - '0') < 10u ? *token - '0' : -1) : _p_can_interact_text_nibble(*token);
+		if (nibble < 0) {
+			return 0; /* e.g. ErrorFrame */
+		}
+		id = parser->decimal ? id * 10u + (canid_t)nibble : (id << 4) | (canid_t)nibble;
+	}
+	if (ext) {
+		id = (id & CAN_EFF_MASK) | CAN_EFF_FLAG;
+	} else if (id > CAN_SFF_MASK) {
+		return 0;
+	}
+
+	p = _p_can_interact_text_blank(p, end);
+	if (end - p < 2 || !((p[0] == 'R' || p[0] == 'T') && p[1] == 'x')) {
+		return 0;
+	}
+	p = _p_can_interact_text_blank(p + 2, end);
+	if (p >= end || (*p != 'd' && *p != 'r')) {
+		return 0;
+	}
+	remote = *p == 'r';
+	p = _p_can_interact_text_blank(p + 1, end);
+	if (p < end && (nibble = _p_can_interact_text_nibble(*p)) >= 0) {
+		if (nibble > 8) {
+			return 0;
+		}
+		dlc = (uint8_t)nibble;
+		++p;
+	} else if (!remote) {
+		return 0;
+	}
+
+	memset(&frame->frame, 0, sizeof(struct can_frame));
+	if (!remote) {
+		for (i = 0; i < dlc; ++i) {
+			p = _p_can_interact_text_blank(p, end);
+			if (end - p < 2 || (hi = _p_can_interact_text_nibble(p[0])) < 0 || (lo = _p_can_interact_text_nibble(p[1])) < 0) {
+				return 0;
+			}
+			frame->frame.data[i] = (uint8_t)((hi << 4) | lo);
+			p += 2;
+		}
+	}
+	frame->frame.can_id = remote ? id | CAN_RTR_FLAG : id;
+	frame->frame.can_dlc = dlc;
+	frame->timestamp_ns = parser->base_ns + ts;
+	return 1;
+}
+
+void can_interact_text_init(struct can_interact_text_parser *parser, const char *text, const size_t len, const enum can_interact_text_format format)
+{
+	memset(parser, 0, sizeof(struct can_interact_text_parser));
+	parser->pos = text;
+	parser->end = text + len;
+	parser->format = format;
+}
+
+int can_interact_text_open(struct can_interact_text_parser *parser, const char *path, const enum can_interact_text_format format)
+{
+	struct stat st;
+	void *map = NULL;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd == -1) {
+		return (int)errno;
+	}
+	if (fstat(fd, &st) != 0) {
+		close(fd);
+		return (int)errno;
+	}
+	if (st.st_size > 0) {
+		map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED) {
+			close(fd);
+			return (int)errno;
+		}
+		madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+	}
+	close(fd); /* the mapping keeps the file open */
+	can_interact_text_init(parser, (const char*)map, (size_t)st.st_size, format);
+	parser->map = map;
+	parser->map_len = (size_t)st.st_size;
+	return 0;
+}
+
+size_t can_interact_text_parse(struct can_interact_text_parser *parser, struct can_interact_timed_frame *frames, const size_t len)
+{
+	const char *line, *eol;
+	size_t n = 0;
+	int ok;
+
+	while (n < len && parser->pos < parser->end) {
+		line = parser->pos;
+		eol = (const char*)memchr(line, '\n', (size_t)(parser->end - line));
+		if (eol == NULL) {
+			eol = parser->end;
+			parser->pos = parser->end;
+		} else {
+			parser->pos = eol + 1;
+		}
+		++parser->lines;
+		ok = parser->format == TEXT_CANDUMP
+			? _p_can_interact_text_candump(parser, line, eol, &frames[n])
+			: _p_can_interact_text_asc(parser, line, eol, &frames[n]);
+		if (ok) {
+			++n;
+		} else {
+			++parser->skipped;
+		}
+	}
+	return n;
+}
+
+int can_interact_text_close(struct can_interact_text_parser *parser)
+{
+	int res = 0;
+
+	if (parser->map != NULL) {
+		res = munmap(parser->map, parser->map_len) == 0 ? 0 : (int)errno;
+		parser->map = NULL;
+	}
+	parser->pos = parser->end;
+	return res;
+}
+
+/**
+ * @brief _p_can_interact_text_decimal - INTERNAL METHOD. writes unsigned decimal number
+ * @param char* - destination
+ * @param uint64_t - number
+ * @param const size_t - minimum number of digits (zero padded)
+ * @return size_t - number of characters written
+ */
+static size_t _p_can_interact_text_decimal(char *out, uint64_t value, const size_t width)
+{
+	char tmp[20];
+	size_t n = 0, i;
+
+	do {
+		tmp[n++] = (char)('0' + (int)(value % 10u));
+		value /= 10u;
+	} while (value != 0);
+	while (n < width) {
+		tmp[n++] = '0';
+	}
+	for (i = 0; i < n; ++i) {
+		out[i] = tmp[n - 1 - i];
+	}
+	return n;
+}
+
+/**
+ * @brief _p_can_interact_text_hexid - INTERNAL METHOD. writes fixed width upper case hex number
+ * @param char* - destination
+ * @param const uint32_t - number
+ * @param const size_t - number of digits
+ * @return size_t - number of characters written
+ */
+static size_t _p_can_interact_text_hexid(char *out, const uint32_t value, const size_t digits)
+{
+	size_t i;
+
+	for (i = 0; i < digits; ++i) {
+		out[i] = _p_can_interact_text_digits[(value >> (4 * (digits - 1 - i))) & 0xFu];
+	}
+	return digits;
+}
+
+size_t can_interact_text_format_frames(const struct can_interact_timed_frame *frames, const size_t len, const enum can_interact_text_format format, const char *device, const uint64_t base_ns, char *out, const size_t out_len, size_t *written)
+{
+	const size_t device_len = strlen(device);
+	const struct can_frame *frame;
+	char *p = out;
+	uint64_t ts;
+	size_t n, i, pad;
+	uint8_t dlc;
+
+	for (n = 0; n < len && (size_t)(out + out_len - p) >= CAN_INTERACT_TEXT_LINE_LEN(device_len); ++n) {
+		frame = &frames[n].frame;
+		dlc = frame->can_dlc > 8 ? 8 : frame->can_dlc;
+		if (format == TEXT_CANDUMP) {
+			ts = frames[n].timestamp_ns;
+			*p++ = '(';
+			p += _p_can_interact_text_decimal(p, ts / 1000000000u, 10);
+			*p++ = '.';
+			p += _p_can_interact_text_decimal(p, (ts % 1000000000u) / 1000u, 6);
+			*p++ = ')';
+			*p++ = ' ';
+			memcpy(p, device, device_len);
+			p += device_len;
+			*p++ = ' ';
+			if (frame->can_id & CAN_ERR_FLAG) {
+				p += _p_can_interact_text_hexid(p, frame->can_id & (CAN_ERR_FLAG | CAN_ERR_MASK), 8);
+			} else if (frame->can_id & CAN_EFF_FLAG) {
+				p += _p_can_interact_text_hexid(p, frame->can_id & CAN_EFF_MASK, 8);
+			} else {
+				p += _p_can_interact_text_hexid(p, frame->can_id & CAN_SFF_MASK, 3);
+			}
+			*p++ = '#';
+			if (frame->can_id & CAN_RTR_FLAG) {
+				*p++ = 'R';
+				if (dlc > 0) {
+					*p++ = (char)('0' + dlc);
+				}
+			} else {
+				for (i = 0; i < dlc; ++i) {
+					*p++ = _p_can_interact_text_digits[frame->data[i] >> 4];
+					*p++ = _p_can_interact_text_digits[frame->data[i] & 0xFu];
+				}
+			}
+		} else {
+			ts = frames[n].timestamp_ns > base_ns ? frames[n].timestamp_ns - base_ns : 0;
+			pad = _p_can_interact_text_decimal(p, ts / 1000000000u, 0); /* seconds right aligned to 4 characters, like Vector tools */
+			if (pad < 4) {
+				memmove(p + (4 - pad), p, pad);
+				memset(p, ' ', 4 - pad);
+				pad = 4;
+			}
+			p += pad;
+			*p++ = '.';
+			p += _p_can_interact_text_decimal(p, (ts % 1000000000u) / 1000u, 6);
+			*p++ = ' ';
+			memcpy(p, device, device_len);
+			p += device_len;
+			*p++ = ' ';
+			*p++ = ' ';
+			if (frame->can_id & CAN_EFF_FLAG) {
+				p += _p_can_interact_text_hexid(p, frame->can_id & CAN_EFF_MASK, 8);
+				*p++ = 'x';
+				pad = 6;
+			} else {
+				p += _p_can_interact_text_hexid(p, frame->can_id & CAN_SFF_MASK, 3);
+				pad = 13;
+			}
+			memset(p, ' ', pad); /* identifier column is 16 characters wide */
+			p += pad;
+			memcpy(p, "Rx   ", 5);
+			p += 5;
+			*p++ = (frame->can_id & CAN_RTR_FLAG) ? 'r' : 'd';
+			*p++ = ' ';
+			*p++ = (char)('0' + dlc);
+			if (!(frame->can_id & CAN_RTR_FLAG)) {
+				for (i = 0; i < dlc; ++i) {
+					*p++ = ' ';
+					*p++ = _p_can_interact_text_digits[frame->data[i] >> 4];
+					*p++ = _p_can_interact_text_digits[frame->data[i] & 0xFu];
+				}
+			}
+		}
+		*p++ = '\n';
+	}
+	*written = (size_t)(p - out);
+	return n;
+}
@@ -0,0 +1,130 @@
+#ifndef CAN_INTERACT_TEXT_H
+#define CAN_INTERACT_TEXT_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+#include "can_interact.h"
+
+/**
+ * @brief C-style streaming parser and formatter of text logs, producing / consuming the timestamped frames of the receive path
+ * Supports candump log files ("(1436509052.249713) can0 123#DEADBEEF") and Vector ASC ("   12.345678 1  123  Rx   d 4 DE AD BE EF")
+ * Parsing works in place on a caller buffer or memory mapped file - nothing is allocated per line and no scanf / printf style functions are used
+ * Lines which are not classical CAN frames (headers, comments, CAN FD, error or event lines) are skipped and counted
+ * For the CXX API, see can_interact_text.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define CAN_INTERACT_TEXT_LINE_MAX 96 /* longest line written by can_interact_text_format_frames for interface names of up to 16 characters */
+#define CAN_INTERACT_TEXT_LINE_LEN(device_len) (CAN_INTERACT_TEXT_LINE_MAX - 16 + (device_len)) /* longest line for an interface name of device_len characters */
+#define CAN_INTERACT_TEXT_ASC_HEADER "base hex  timestamps absolute\nno internal events logged\n" /* minimal header for written ASC files */
+
+enum can_interact_text_format {
+	/**
+	 * @brief enum can_interact_text_format - text log formats
+	 * TEXT_CANDUMP is the log format of candump -l / -L (absolute timestamps), TEXT_ASC is Vector ASC (timestamps relative to measurement start)
+	 */
+    TEXT_CANDUMP,
+    TEXT_ASC
+};
+
+struct can_interact_text_parser {
+	/**
+	 * @brief struct can_interact_text_parser - position within a text log
+	 * Initialise with can_interact_text_init (buffer) or can_interact_text_open (file)
+	 */
+	const char *pos;
+	const char *end;
+	const char *device; /* only frames of this interface (candump) / channel (ASC) are returned, NULL for all */
+	uint64_t base_ns; /* added to ASC timestamps, e.g. measurement start as epoch nanoseconds */
+	unsigned long lines; /* lines read */
+	unsigned long skipped; /* lines which did not yield a frame */
+	enum can_interact_text_format format;
+	int decimal; /* ASC identifiers are decimal ("base dec" header) */
+	void *map; /* mapping if opened from file, NULL otherwise */
+	size_t map_len;
+};
+
+/**
+ * @brief can_interact_text_init - starts parsing text held in memory
+ *
+ * @param struct can_interact_text_parser* - parser to initialise
+ *
+ * @param const char* - text (must outlive parser, need not be NUL terminated)
+ *
+ * @param const size_t - length of text
+ *
+ * @param const enum can_interact_text_format - format of text
+ */
+void can_interact_text_init(struct can_interact_text_parser *parser, const char *text, const size_t len, const enum can_interact_text_format format);
+
+/**
+ * @brief can_interact_text_open - maps text log file and starts parsing it
+ *
+ * @param struct can_interact_text_parser* - parser to initialise
+ *
+ * @param const char* - path
+ *
+ * @param const enum can_interact_text_format - format of file
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_text_open(struct can_interact_text_parser *parser, const char *path, const enum can_interact_text_format format);
+
+/**
+ * @brief can_interact_text_parse - parses next frames
+ *
+ * @param struct can_interact_text_parser* - parser
+ *
+ * @param struct can_interact_timed_frame* - array to write frames to
+ *
+ * @param const size_t - capacity of array
+ *
+ * @return size_t - number of frames parsed, 0 once the end of text is reached
+ */
+size_t can_interact_text_parse(struct can_interact_text_parser *parser, struct can_interact_timed_frame *frames, const size_t len);
+
+/**
+ * @brief can_interact_text_close - unmaps file of parser opened with can_interact_text_open (no-op otherwise)
+ *
+ * @param struct can_interact_text_parser* - parser
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_text_close(struct can_interact_text_parser *parser);
+
+/**
+ * @brief can_interact_text_format_frames - formats frames as lines of text
+ *
+ * @param const struct can_interact_timed_frame* - frames
+ *
+ * @param const size_t - number of frames
+ *
+ * @param const enum can_interact_text_format - format to write
+ *
+ * @param const char* - interface name (candump) or channel number (ASC) written into each line
+ *
+ * @param const uint64_t - subtracted from timestamps for ASC (measurement start), ignored for candump
+ *
+ * @param char* - buffer to write text to (not NUL terminated)
+ *
+ * @param const size_t - capacity of buffer, lines are only written whole (each needs room for CAN_INTERACT_TEXT_LINE_LEN(strlen(device)) bytes)
+ *
+ * @param size_t* - pointer to write number of bytes written to
+ *
+ * @return size_t - number of frames formatted, 0 for frames if the buffer cannot take a single line
+ */
+size_t can_interact_text_format_frames(const struct can_interact_timed_frame *frames, const size_t len, const enum can_interact_text_format format, const char *device, const uint64_t base_ns, char *out, const size_t out_len, size_t *written);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_TEXT_H */
@@ -0,0 +1,189 @@
+#ifndef CAN_INTERACT_TEXT_HH
+#define CAN_INTERACT_TEXT_HH
+#pragma once
+
+#include <memory>
+#include <string>
+#include <array>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include "can_interact.hh"
+#include "can_interact_text.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact candump / ASC text log parser and formatter
+ * For declarations for the native C library, see can_interact_text.h
+ */
+
+namespace can_interact {
+
+	class TextParser {
+		/**
+		  * @brief TextParser (class) - streaming parser of candump / ASC text logs
+		  */
+		private:
+			std::unique_ptr<can_interact_text_parser> _state ;
+			std::string _device ;
+
+		public:
+			/**
+			  * @brief TextParser (constructor) - maps text log file
+			  * @param const std::string& - path
+			  * @param const can_interact_text_format - format of file
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			TextParser(const std::string&, const can_interact_text_format) noexcept(false) ;
+
+			/**
+			  * @brief TextParser (constructor) - parses text held in memory
+			  * @param const char* - text (must outlive parser)
+			  * @param const std::size_t - length of text
+			  * @param const can_interact_text_format - format of text
+			  */
+			TextParser(const char*, const std::size_t, const can_interact_text_format) noexcept(false) ;
+
+			TextParser(TextParser&&) noexcept = default ;
+			TextParser& operator=(TextParser&&) noexcept = default ;
+
+			/**
+			  * @brief device - restricts parsing to frames of one interface (candump) / channel (ASC)
+			  * @param const std::string& - interface name or channel number, empty for all
+			  */
+			void device(const std::string&) noexcept(false) ;
+
+			/**
+			  * @brief base - setter for time added to ASC timestamps (measurement start)
+			  * @param const std::uint64_t - nanoseconds
+			  */
+			void base(const std::uint64_t) noexcept ;
+
+			/**
+			  * @brief parse (overload) - parses next frames
+			  * @param can_interact_timed_frame* - array to write frames to
+			  * @param const std::size_t - capacity of array
+			  * @return std::size_t - number of frames parsed, 0 once the end of text is reached
+			  */
+			std::size_t parse(can_interact_timed_frame*, const std::size_t) noexcept ;
+
+			/**
+			  * @brief parse (overload) - parses next frames
+			  * @param std::array<can_interact_timed_frame, N>& - array to write frames to
+			  * @return std::size_t - number of frames parsed, 0 once the end of text is reached
+			  */
+			template<std::size_t N>
+			std::size_t parse(std::array<can_interact_timed_frame, N>&) noexcept ;
+
+			/**
+			  * @brief lines - getter for number of lines read so far
+			  * @return unsigned long - lines
+			  */
+			unsigned long lines() const noexcept ;
+
+			/**
+			  * @brief skipped - getter for number of lines read so far which did not yield a frame
+			  * @return unsigned long - lines
+			  */
+			unsigned long skipped() const noexcept ;
+
+			/**
+			  * @brief ~TextParser (destructor) - unmaps file
+			  */
+			~TextParser() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			TextParser() = delete ;
+			TextParser(const TextParser&) = delete ;
+			TextParser& operator=(const TextParser&) = delete ;
+	} ;
+
+	/**
+	  * @brief format_text - formats frames as lines of text
+	  * @param const can_interact_timed_frame* - frames
+	  * @param const std::size_t - number of frames
+	  * @param const can_interact_text_format - format to write
+	  * @param const std::string& - interface name (candump) or channel number (ASC)
+	  * @param const std::uint64_t - subtracted from timestamps for ASC (measurement start), ignored for candump
+	  * @return std::string - lines
+	  */
+	std::string format_text(const can_interact_timed_frame*, const std::size_t, const can_interact_text_format, const std::string&, const std::uint64_t = 0) noexcept(false) ;
+
+}
+
+can_interact::TextParser::TextParser(const std::string& path, const can_interact_text_format format) noexcept(false)
+	: _state{new can_interact_text_parser}, _device{}
+{
+	const int res = can_interact_text_open(this->_state.get(), path.c_str(), format) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+can_interact::TextParser::TextParser(const char* text, const std::size_t len, const can_interact_text_format format) noexcept(false)
+	: _state{new can_interact_text_parser}, _device{}
+{
+	can_interact_text_init(this->_state.get(), text, len, format) ;
+}
+
+void can_interact::TextParser::device(const std::string& device) noexcept(false)
+{
+	this->_device = device ;
+	this->_state->device = this->_device.empty() ? nullptr : this->_device.c_str() ;
+}
+
+void can_interact::TextParser::base(const std::uint64_t base_ns) noexcept
+{
+	this->_state->base_ns = base_ns ;
+}
+
+std::size_t can_interact::TextParser::parse(can_interact_timed_frame* frames, const std::size_t len) noexcept
+{
+	return can_interact_text_parse(this->_state.get(), frames, len) ;
+}
+
+template<std::size_t N>
+std::size_t can_interact::TextParser::parse(std::array<can_interact_timed_frame, N>& frames) noexcept
+{
+	return can_interact_text_parse(this->_state.get(), frames.data(), N) ;
+}
+
+unsigned long can_interact::TextParser::lines() const noexcept
+{
+	return this->_state->lines ;
+}
+
+unsigned long can_interact::TextParser::skipped() const noexcept
+{
+	return this->_state->skipped ;
+}
+
+can_interact::TextParser::~TextParser() noexcept
+{
+	if(this->_state)
+	{
+		can_interact_text_close(this->_state.get()) ;
+	}
+}
+
+std::string can_interact::format_text(const can_interact_timed_frame* frames, const std::size_t len, const can_interact_text_format format, const std::string& device, const std::uint64_t base_ns) noexcept(false)
+{
+	std::string text ;
+	std::size_t done = 0 ;
+	char buf[4096] ;
+	while(done < len)
+	{
+		std::size_t written ;
+		const std::size_t n = can_interact_text_format_frames(frames + done, len - done, format, device.c_str(), base_ns, buf, sizeof(buf), &written) ;
+		if(n == 0)
+		{
+			throw std::invalid_argument(std::string{"Device name too long: "} + device) ;
+		}
+		text.append(buf, written) ;
+		done += n ;
+	}
+	return text ;
+}
+
+#endif // CAN_INTERACT_TEXT_HH
@@ -0,0 +1,553 @@
+#define _DEFAULT_SOURCE
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <errno.h>
+#include <linux/can.h>
+
+#include "can_interact_trigger.h"
+
+/**
+ * @brief C-style definitions of the trigger engine
+ * For definitions for the CXX API, see can_interact_trigger.hh
+ */
+
+#define _P_CAN_INTERACT_TRIGGER_FALSE 0
+#define _P_CAN_INTERACT_TRIGGER_HOLDING 1
+#define _P_CAN_INTERACT_TRIGGER_FIRED 2
+
+struct _p_can_interact_trigger_parser {
+	/**
+	 * @brief struct _p_can_interact_trigger_parser - INTERNAL. recursive descent compiler state
+	 */
+	const struct can_interact_trigger *trigger;
+	struct can_interact_trigger_rule_entry *rule;
+	const char *p;
+	unsigned int depth; /* evaluation stack depth after instructions emitted so far */
+	unsigned int nesting; /* parentheses and unary operators, bounds recursion */
+	int error;
+};
+
+void can_interact_trigger_init(struct can_interact_trigger *trigger)
+{
+	memset(trigger, 0, sizeof(struct can_interact_trigger));
+}
+
+/**
+ * @brief _p_can_interact_trigger_find - INTERNAL METHOD. looks up (or inserts) slot of identifier in index
+ * @param struct can_interact_trigger* - trigger state
+ * @param const canid_t - identifier
+ * @param const int - non-zero to insert if missing
+ * @return struct can_interact_trigger_id_entry* - slot, NULL if not found (or index full)
+ */
+static struct can_interact_trigger_id_entry* _p_can_interact_trigger_find(struct can_interact_trigger *trigger, const canid_t id, const int insert)
+{
+	size_t i = (size_t)((id * 2654435761u) & (CAN_INTERACT_TRIGGER_MAX_IDS - 1)), probe;
+
+	for (probe = 0; probe < CAN_INTERACT_TRIGGER_MAX_IDS; ++probe, i = (i + 1) & (CAN_INTERACT_TRIGGER_MAX_IDS - 1)) {
+		if (!trigger->ids[i].used) {
+			if (!insert) {
+				return NULL;
+			}
+			trigger->ids[i].used = 1;
+			trigger->ids[i].id = id;
+			++trigger->id_count;
+			return &trigger->ids[i];
+		}
+		if (trigger->ids[i].id == id) {
+			return &trigger->ids[i];
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief _p_can_interact_trigger_name_char - INTERNAL METHOD. checks whether character may appear in signal name
+ * @param const char - character
+ * @param const int - non-zero for first character
+ * @return int - 1 if it may, else 0
+ */
+static int _p_can_interact_trigger_name_char(const char c, const int first)
+{
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (!first && ((c >= '0' && c <= '9') || c == '.'));
+}
+
+int can_interact_trigger_add_signal(struct can_interact_trigger *trigger, const char *name, const struct can_interact_compose_layout *layout, const size_t index)
+{
+	struct can_interact_trigger_id_entry *entry;
+	size_t len, i;
+
+	if (layout == NULL || index >= layout->count) {
+		return EINVAL;
+	}
+	for (len = 0; name[len] != '\0'; ++len) {
+		if (!_p_can_interact_trigger_name_char(name[len], len == 0)) {
+			return EINVAL;
+		}
+	}
+	if (len == 0 || len >= CAN_INTERACT_TRIGGER_NAME_LEN) {
+		return EINVAL;
+	}
+	for (i = 0; i < trigger->signal_count; ++i) {
+		if (strcmp(trigger->signals[i].name, name) == 0) {
+			return EEXIST;
+		}
+	}
+	if (trigger->signal_count == CAN_INTERACT_TRIGGER_MAX_SIGNALS) {
+		return ENOSPC;
+	}
+	entry = _p_can_interact_trigger_find(trigger, layout->id, 1);
+	if (entry == NULL) {
+		return ENOSPC;
+	}
+
+	i = trigger->signal_count++;
+	memcpy(trigger->signals[i].name, name, len + 1u);
+	trigger->signals[i].layout = layout;
+	trigger->signals[i].index = index;
+	trigger->signals[i].valid = 0;
+	entry->signals[i / 32u] |= (uint32_t)1 << (i % 32u);
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_trigger_skip - INTERNAL METHOD. skips whitespace
+ * @param struct _p_can_interact_trigger_parser* - parser
+ */
+static void _p_can_interact_trigger_skip(struct _p_can_interact_trigger_parser *parser)
+{
+	while (*parser->p == ' ' || *parser->p == '\t' || *parser->p == '\n' || *parser->p == '\r') {
+		++parser->p;
+	}
+}
+
+/**
+ * @brief _p_can_interact_trigger_accept - INTERNAL METHOD. consumes token if it comes next
+ * @param struct _p_can_interact_trigger_parser* - parser
+ * @param const char* - token
+ * @return int - 1 if consumed, else 0
+ */
+static int _p_can_interact_trigger_accept(struct _p_can_interact_trigger_parser *parser, const char *token)
+{
+	const size_t len = strlen(token);
+
+	_p_can_interact_trigger_skip(parser);
+	if (strncmp(parser->p, token, len) != 0) {
+		return 0;
+	}
+	parser->p += len;
+	return 1;
+}
+
+/**
+ * @brief _p_can_interact_trigger_emit - INTERNAL METHOD. appends instruction, tracking stack depth
+ * @param struct _p_can_interact_trigger_parser* - parser
+ * @param const enum can_interact_trigger_op - operation
+ * @param const double - constant (TRIGGER_OP_CONST)
+ * @param const size_t - signal (TRIGGER_OP_SIGNAL)
+ */
+static void _p_can_interact_trigger_emit(struct _p_can_interact_trigger_parser *parser, const enum can_interact_trigger_op op, const double value, const size_t signal)
+{
+	struct can_interact_trigger_insn *insn;
+
+	if (parser->error != 0) {
+		return;
+	}
+	if (parser->rule->len == CAN_INTERACT_TRIGGER_MAX_CODE) {
+		parser->error = E2BIG;
+		return;
+	}
+	if (op == TRIGGER_OP_CONST || op == TRIGGER_OP_SIGNAL) {
+		if (++parser->depth > CAN_INTERACT_TRIGGER_MAX_STACK) {
+			parser->error = E2BIG;
+			return;
+		}
+	} else if (op != TRIGGER_OP_NEG && op != TRIGGER_OP_NOT) {
+		--parser->depth;
+	}
+	insn = &parser->rule->code[parser->rule->len++];
+	insn->op = (uint8_t)op;
+	insn->value = value;
+	insn->signal = (uint16_t)signal;
+}
+
+static void _p_can_interact_trigger_or(struct _p_can_interact_trigger_parser *parser);
+
+/**
+ * @brief _p_can_interact_trigger_primary - INTERNAL METHOD. compiles number, signal name or parenthesised expression
+ * @param struct _p_can_interact_trigger_parser* - parser
+ */
+static void _p_can_interact_trigger_primary(struct _p_can_interact_trigger_parser *parser)
+{
+	const char *start;
+	char *end;
+	double value;
+	size_t len, i;
+
+	_p_can_interact_trigger_skip(parser);
+	start = parser->p;
+	if (_p_can_interact_trigger_accept(parser, "(")) {
+		_p_can_interact_trigger_or(parser);
+		if (!_p_can_interact_trigger_accept(parser, ")") && parser->error == 0) {
+			parser->error = EINVAL;
+		}
+	} else if ((*start >= '0' && *start <= '9') || *start == '.') {
+		value = strtod(start, &end);
+		if (end == start) {
+			parser->error = EINVAL;
+			return;
+		}
+		parser->p = end;
+		_p_can_interact_trigger_emit(parser, TRIGGER_OP_CONST, value, 0);
+	} else if (_p_can_interact_trigger_name_char(*start, 1)) {
+		for (len = 1; _p_can_interact_trigger_name_char(start[len], 0); ++len) {
+		}
+		parser->p = start + len;
+		for (i = 0; i < parser->trigger->signal_count; ++i) {
+			if (strncmp(parser->trigger->signals[i].name, start, len) == 0 && parser->trigger->signals[i].name[len] == '\0') {
+				_p_can_interact_trigger_emit(parser, TRIGGER_OP_SIGNAL, 0.0, i);
+				return;
+			}
+		}
+		parser->error = EINVAL;
+	} else {
+		parser->error = EINVAL;
+	}
+}
+
+/**
+ * @brief _p_can_interact_trigger_unary - INTERNAL METHOD. compiles negation or logical not
+ * @param struct _p_can_interact_trigger_parser* - parser
+ */
+static void _p_can_interact_trigger_unary(struct _p_can_interact_trigger_parser *parser)
+{
+	enum can_interact_trigger_op op;
+
+	if (parser->error != 0) {
+		return;
+	}
+	if (++parser->nesting > CAN_INTERACT_TRIGGER_MAX_CODE) {
+		parser->error = E2BIG;
+		return;
+	}
+	if (_p_can_interact_trigger_accept(parser, "-")) {
+		op = TRIGGER_OP_NEG;
+	} else if (parser->p[0] == '!' && parser->p[1] != '=') { /* accept skipped whitespace already */
+		++parser->p;
+		op = TRIGGER_OP_NOT;
+	} else {
+		_p_can_interact_trigger_primary(parser);
+		--parser->nesting;
+		return;
+	}
+	_p_can_interact_trigger_unary(parser);
+	_p_can_interact_trigger_emit(parser, op, 0.0, 0);
+	--parser->nesting;
+}
+
+/**
+ * @brief _p_can_interact_trigger_term - INTERNAL METHOD. compiles products and quotients
+ * @param struct _p_can_interact_trigger_parser* - parser
+ */
+static void _p_can_interact_trigger_term(struct _p_can_interact_trigger_parser *parser)
+{
+	enum can_interact_trigger_op op;
+
+	_p_can_interact_trigger_unary(parser);
+	while (parser->error == 0) {
+		if (_p_can_interact_trigger_accept(parser, "*")) {
+			op = TRIGGER_OP_MUL;
+		} else if (_p_can_interact_trigger_accept(parser, "/")) {
+			op = TRIGGER_OP_DIV;
+		} else {
+			return;
+		}
+		_p_can_interact_trigger_unary(parser);
+		_p_can_interact_trigger_emit(parser, op, 0.0, 0);
+	}
+}
+
+/**
+ * @brief _p_can_interact_trigger_sum - INTERNAL METHOD. compiles sums and differences
+ * @param struct _p_can_interact_trigger_parser* - parser
+ */
+static void _p_can_interact_trigger_sum(struct _p_can_interact_trigger_parser *parser)
+{
+	enum can_interact_trigger_op op;
+
+	_p_can_interact_trigger_term(parser);
+	while (parser->error == 0) {
+		if (_p_can_interact_trigger_accept(parser, "+")) {
+			op = TRIGGER_OP_ADD;
+		} else if (_p_can_interact_trigger_accept(parser, "-")) {
+			op = TRIGGER_OP_SUB;
+		} else {
+			return;
+		}
+		_p_can_interact_trigger_term(parser);
+		_p_can_interact_trigger_emit(parser, op, 0.0, 0);
+	}
+}
+
+/**
+ * @brief _p_can_interact_trigger_compare - INTERNAL METHOD. compiles at most one comparison
+ * @param struct _p_can_interact_trigger_parser* - parser
+ */
+static void _p_can_interact_trigger_compare(struct _p_can_interact_trigger_parser *parser)
+{
+	enum can_interact_trigger_op op;
+
+	_p_can_interact_trigger_sum(parser);
+	if (parser->error != 0) {
+		return;
+	}
+	if (_p_can_interact_trigger_accept(parser, "<=")) { /* two character tokens first */
+		op = TRIGGER_OP_LE;
+	} else if (_p_can_interact_trigger_accept(parser, ">=")) {
+		op = TRIGGER_OP_GE;
+	} else if (_p_can_interact_trigger_accept(parser, "==")) {
+		op = TRIGGER_OP_EQ;
+	} else if (_p_can_interact_trigger_accept(parser, "!=")) {
+		op = TRIGGER_OP_NE;
+	} else if (_p_can_interact_trigger_accept(parser, "<")) {
+		op = TRIGGER_OP_LT;
+	} else if (_p_can_interact_trigger_accept(parser, ">")) {
+		op = TRIGGER_OP_GT;
+	} else {
+		return;
+	}
+	_p_can_interact_trigger_sum(parser);
+	_p_can_interact_trigger_emit(parser, op, 0.0, 0);
+}
+
+/**
+ * @brief _p_can_interact_trigger_and - INTERNAL METHOD. compiles conjunctions
+ * @param struct _p_can_interact_trigger_parser* - parser
+ */
+static void _p_can_interact_trigger_and(struct _p_can_interact_trigger_parser *parser)
+{
+	_p_can_interact_trigger_compare(parser);
+	while (parser->error == 0 && _p_can_interact_trigger_accept(parser, "&&")) {
+		_p_can_interact_trigger_compare(parser);
+		_p_can_interact_trigger_emit(parser, TRIGGER_OP_AND, 0.0, 0);
+	}
+}
+
+/**
+ * @brief _p_can_interact_trigger_or - INTERNAL METHOD. compiles disjunctions, the whole grammar
+ * @param struct _p_can_interact_trigger_parser* - parser
+ */
+static void _p_can_interact_trigger_or(struct _p_can_interact_trigger_parser *parser)
+{
+	_p_can_interact_trigger_and(parser);
+	while (parser->error == 0 && _p_can_interact_trigger_accept(parser, "||")) {
+		_p_can_interact_trigger_and(parser);
+		_p_can_interact_trigger_emit(parser, TRIGGER_OP_OR, 0.0, 0);
+	}
+}
+
+int can_interact_trigger_add_rule(struct can_interact_trigger *trigger, const char *expression, const uint64_t hold_ns, const can_interact_trigger_handler handler, void *ctx, size_t *rule)
+{
+	struct _p_can_interact_trigger_parser parser;
+	struct can_interact_trigger_rule_entry *entry;
+	struct can_interact_trigger_id_entry *id;
+	const size_t index = trigger->rule_count;
+	uint8_t i;
+
+	if (handler == NULL) {
+		return EINVAL;
+	}
+	if (index == CAN_INTERACT_TRIGGER_MAX_RULES) {
+		return ENOSPC;
+	}
+	entry = &trigger->rules[index];
+	memset(entry, 0, sizeof(struct can_interact_trigger_rule_entry));
+	parser.trigger = trigger;
+	parser.rule = entry;
+	parser.p = expression;
+	parser.depth = 0;
+	parser.nesting = 0;
+	parser.error = 0;
+	_p_can_interact_trigger_or(&parser);
+	_p_can_interact_trigger_skip(&parser);
+	if (parser.error != 0) {
+		return parser.error;
+	}
+	if (*parser.p != '\0') {
+		return EINVAL;
+	}
+
+	entry->hold_ns = hold_ns;
+	entry->handler = handler;
+	entry->ctx = ctx;
+	for (i = 0; i < entry->len; ++i) {
+		if (entry->code[i].op == TRIGGER_OP_SIGNAL) {
+			id = _p_can_interact_trigger_find(trigger, trigger->signals[entry->code[i].signal].layout->id, 0);
+			id->rules[index / 32u] |= (uint32_t)1 << (index % 32u);
+		}
+	}
+	++trigger->rule_count;
+	if (rule != NULL) {
+		*rule = index;
+	}
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_trigger_eval - INTERNAL METHOD. runs bytecode of rule on current signal values
+ * @param const struct can_interact_trigger* - trigger state
+ * @param const struct can_interact_trigger_rule_entry* - rule
+ * @return int - 1 if condition holds, 0 if not or a signal has no value yet
+ */
+static int _p_can_interact_trigger_eval(const struct can_interact_trigger *trigger, const struct can_interact_trigger_rule_entry *rule)
+{
+	double stack[CAN_INTERACT_TRIGGER_MAX_STACK];
+	const struct can_interact_trigger_insn *insn;
+	size_t top = 0;
+	uint8_t i;
+
+	for (i = 0; i < rule->len; ++i) {
+		insn = &rule->code[i];
+		switch (insn->op) {
+		case TRIGGER_OP_CONST:
+			stack[top++] = insn->value;
+			break;
+		case TRIGGER_OP_SIGNAL:
+			if (!trigger->signals[insn->signal].valid) {
+				return 0;
+			}
+			stack[top++] = trigger->signals[insn->signal].value;
+			break;
+		case TRIGGER_OP_NEG:
+			stack[top - 1] = -stack[top - 1];
+			break;
+		case TRIGGER_OP_NOT:
+			stack[top - 1] = stack[top - 1] == 0.0 ? 1.0 : 0.0;
+			break;
+		default: /* binary operators */
+			--top;
+			switch (insn->op) {
+			case TRIGGER_OP_ADD: stack[top - 1] += stack[top]; break;
+			case TRIGGER_OP_SUB: stack[top - 1] -= stack[top]; break;
+			case TRIGGER_OP_MUL: stack[top - 1] *= stack[top]; break;
+			case TRIGGER_OP_DIV: stack[top - 1] /= stack[top]; break;
+			case TRIGGER_OP_LT: stack[top - 1] = stack[top - 1] < stack[top] ? 1.0 : 0.0; break;
+			case TRIGGER_OP_LE: stack[top - 1] = stack[top - 1] <= stack[top] ? 1.0 : 0.0; break;
+			case TRIGGER_OP_GT: stack[top - 1] = stack[top - 1] > stack[top] ? 1.0 : 0.0; break;
+			case TRIGGER_OP_GE: stack[top - 1] = stack[top - 1] >= stack[top] ? 1.0 : 0.0; break;
+			case TRIGGER_OP_EQ: stack[top - 1] = stack[top - 1] == stack[top] ? 1.0 : 0.0; break;
+			case TRIGGER_OP_NE: stack[top - 1] = stack[top - 1] != stack[top] ? 1.0 : 0.0; break;
+			case TRIGGER_OP_AND: stack[top - 1] = stack[top - 1] != 0.0 && stack[top] != 0.0 ? 1.0 : 0.0; break;
+			default: stack[top - 1] = stack[top - 1] != 0.0 || stack[top] != 0.0 ? 1.0 : 0.0; break;
+			}
+		}
+	}
+	return top > 0 && stack[0] != 0.0;
+}
+
+/**
+ * @brief _p_can_interact_trigger_update - INTERNAL METHOD. advances hold state of rule with fresh condition, firing its handler when due
+ * @param struct can_interact_trigger* - trigger state
+ * @param const size_t - rule
+ * @param const int - condition
+ * @param const uint64_t - timestamp of frame in nanoseconds
+ * @param const struct can_frame* - frame
+ */
+static void _p_can_interact_trigger_update(struct can_interact_trigger *trigger, const size_t index, const int condition, const uint64_t timestamp, const struct can_frame *frame)
+{
+	struct can_interact_trigger_rule_entry *rule = &trigger->rules[index];
+
+	if (!condition) {
+		if (rule->state == _P_CAN_INTERACT_TRIGGER_HOLDING) {
+			--trigger->holding;
+		}
+		rule->state = _P_CAN_INTERACT_TRIGGER_FALSE;
+		return;
+	}
+	if (rule->state == _P_CAN_INTERACT_TRIGGER_FALSE) {
+		rule->since_ns = timestamp;
+		if (rule->hold_ns != 0) {
+			rule->state = _P_CAN_INTERACT_TRIGGER_HOLDING;
+			++trigger->holding;
+			return;
+		}
+	} else if (rule->state != _P_CAN_INTERACT_TRIGGER_HOLDING || timestamp - rule->since_ns < rule->hold_ns) {
+		return;
+	} else {
+		--trigger->holding;
+	}
+	rule->state = _P_CAN_INTERACT_TRIGGER_FIRED;
+	rule->handler(index, timestamp, frame, rule->ctx);
+}
+
+void can_interact_trigger_frame(struct can_interact_trigger *trigger, const struct can_interact_timed_frame *frame)
+{
+	const struct can_interact_trigger_id_entry *id = _p_can_interact_trigger_find(trigger, frame->frame.can_id, 0);
+	struct can_interact_trigger_signal_entry *signal;
+	uint32_t bits;
+	size_t w, i;
+
+	if (id == NULL) {
+		return;
+	}
+	for (w = 0; w < (CAN_INTERACT_TRIGGER_MAX_SIGNALS + 31) / 32; ++w) {
+		for (bits = id->signals[w], i = w * 32u; bits != 0; bits >>= 1, ++i) {
+			if (!(bits & 1u)) {
+				continue;
+			}
+			signal = &trigger->signals[i];
+			if (signal->layout->len <= frame->frame.can_dlc) {
+				signal->value = can_interact_compose_get_value(signal->layout, signal->index, frame->frame.data);
+				signal->valid = 1;
+			}
+		}
+	}
+	for (w = 0; w < (CAN_INTERACT_TRIGGER_MAX_RULES + 31) / 32; ++w) {
+		for (bits = id->rules[w], i = w * 32u; bits != 0; bits >>= 1, ++i) {
+			if (bits & 1u) {
+				_p_can_interact_trigger_update(trigger, i, _p_can_interact_trigger_eval(trigger, &trigger->rules[i]), frame->timestamp_ns, &frame->frame);
+			}
+		}
+	}
+}
+
+void can_interact_trigger_frames(struct can_interact_trigger *trigger, const struct can_interact_timed_frame *frames, const size_t len)
+{
+	size_t i;
+
+	for (i = 0; i < len; ++i) {
+		can_interact_trigger_frame(trigger, &frames[i]);
+	}
+}
+
+void can_interact_trigger_poll(struct can_interact_trigger *trigger, const uint64_t now_ns)
+{
+	struct can_interact_trigger_rule_entry *rule;
+	size_t i;
+
+	for (i = 0; i < trigger->rule_count && trigger->holding > 0; ++i) {
+		rule = &trigger->rules[i];
+		if (rule->state == _P_CAN_INTERACT_TRIGGER_HOLDING && now_ns - rule->since_ns >= rule->hold_ns && now_ns >= rule->since_ns) {
+			rule->state = _P_CAN_INTERACT_TRIGGER_FIRED;
+			--trigger->holding;
+			rule->handler(i, rule->since_ns + rule->hold_ns, NULL, rule->ctx);
+		}
+	}
+}
+
+uint64_t can_interact_trigger_deadline(const struct can_interact_trigger *trigger)
+{
+	uint64_t deadline = 0;
+	size_t i;
+
+	for (i = 0; i < trigger->rule_count && trigger->holding > 0; ++i) {
+		if (trigger->rules[i].state == _P_CAN_INTERACT_TRIGGER_HOLDING
+				&& (deadline == 0 || trigger->rules[i].since_ns + trigger->rules[i].hold_ns < deadline)) {
+			deadline = trigger->rules[i].since_ns + trigger->rules[i].hold_ns;
+		}
+	}
+	return deadline;
+}
@@ -0,0 +1,217 @@
+#ifndef CAN_INTERACT_TRIGGER_H
+#define CAN_INTERACT_TRIGGER_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+#include "can_interact.h"
+#include "can_interact_compose.h"
+
+/**
+ * @brief C-style trigger engine evaluating compiled conditions over live signal values as frames arrive
+ * Signals are named fields of compiled message layouts (see can_interact_compose.h). Rules are infix expressions over signal names and numbers,
+ * e.g. "brake_pressure > 80 && speed > 5", compiled into flat stack bytecode. Operators by increasing precedence as in C: || && (== != < <= > >=) (+ -) (* /) unary - !
+ * Each identifier keeps bitmasks of the signals it carries and the rules depending on them, so a frame only decodes its own signals and
+ * re-evaluates the rules which read them. A rule fires its handler once when its condition has held for its hold time, and re-arms when the
+ * condition turns false; a rule reading a signal not received yet is false
+ * Hold times are measured on frame timestamps, so frames need kernel receive timestamps (see can_interact_timestamps) or timestamps from a log
+ * For the CXX API, see can_interact_trigger.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifndef CAN_INTERACT_TRIGGER_MAX_SIGNALS
+#define CAN_INTERACT_TRIGGER_MAX_SIGNALS 256
+#endif /* CAN_INTERACT_TRIGGER_MAX_SIGNALS */
+
+#ifndef CAN_INTERACT_TRIGGER_MAX_RULES
+#define CAN_INTERACT_TRIGGER_MAX_RULES 128
+#endif /* CAN_INTERACT_TRIGGER_MAX_RULES */
+
+#ifndef CAN_INTERACT_TRIGGER_MAX_IDS
+#define CAN_INTERACT_TRIGGER_MAX_IDS 64 /* identifiers carrying signals, power of two */
+#endif /* CAN_INTERACT_TRIGGER_MAX_IDS */
+
+#ifndef CAN_INTERACT_TRIGGER_MAX_CODE
+#define CAN_INTERACT_TRIGGER_MAX_CODE 48 /* instructions per rule */
+#endif /* CAN_INTERACT_TRIGGER_MAX_CODE */
+
+#define CAN_INTERACT_TRIGGER_MAX_STACK 16 /* evaluation stack depth per rule */
+#define CAN_INTERACT_TRIGGER_NAME_LEN 32 /* including terminator */
+
+/**
+ * @brief can_interact_trigger_handler - callback invoked when a rule fires
+ * @param const size_t - index of rule
+ * @param const uint64_t - timestamp in nanoseconds of the frame which completed the condition, or at which its hold time ran out
+ * @param const struct can_frame* - frame which completed the condition, NULL if the hold time ran out in can_interact_trigger_poll
+ * @param void* - user context provided upon registration
+ */
+typedef void (*can_interact_trigger_handler)(const size_t rule, const uint64_t timestamp_ns, const struct can_frame *frame, void *ctx);
+
+enum can_interact_trigger_op {
+    TRIGGER_OP_CONST = 0,
+    TRIGGER_OP_SIGNAL,
+    TRIGGER_OP_ADD,
+    TRIGGER_OP_SUB,
+    TRIGGER_OP_MUL,
+    TRIGGER_OP_DIV,
+    TRIGGER_OP_NEG,
+    TRIGGER_OP_LT,
+    TRIGGER_OP_LE,
+    TRIGGER_OP_GT,
+    TRIGGER_OP_GE,
+    TRIGGER_OP_EQ,
+    TRIGGER_OP_NE,
+    TRIGGER_OP_AND,
+    TRIGGER_OP_OR,
+    TRIGGER_OP_NOT
+};
+
+struct can_interact_trigger_insn {
+	/**
+	 * @brief struct can_interact_trigger_insn - INTERNAL. bytecode instruction
+	 */
+	double value; /* TRIGGER_OP_CONST */
+	uint16_t signal; /* TRIGGER_OP_SIGNAL */
+	uint8_t op;
+};
+
+struct can_interact_trigger_signal_entry {
+	/**
+	 * @brief struct can_interact_trigger_signal_entry - INTERNAL. named signal and its latest value
+	 */
+	char name[CAN_INTERACT_TRIGGER_NAME_LEN];
+	const struct can_interact_compose_layout *layout;
+	size_t index; /* within layout */
+	double value;
+	uint8_t valid;
+};
+
+struct can_interact_trigger_rule_entry {
+	/**
+	 * @brief struct can_interact_trigger_rule_entry - INTERNAL. compiled rule and its hold state
+	 */
+	struct can_interact_trigger_insn code[CAN_INTERACT_TRIGGER_MAX_CODE];
+	uint64_t hold_ns;
+	uint64_t since_ns; /* timestamp at which condition turned true */
+	can_interact_trigger_handler handler;
+	void *ctx;
+	uint8_t len;
+	uint8_t state; /* 0 false, 1 holding, 2 fired */
+};
+
+struct can_interact_trigger_id_entry {
+	/**
+	 * @brief struct can_interact_trigger_id_entry - INTERNAL. slot of the open addressed identifier index
+	 */
+	canid_t id;
+	uint8_t used;
+	uint32_t signals[(CAN_INTERACT_TRIGGER_MAX_SIGNALS + 31) / 32]; /* bitmask of signals carried */
+	uint32_t rules[(CAN_INTERACT_TRIGGER_MAX_RULES + 31) / 32]; /* bitmask of rules reading them */
+};
+
+struct can_interact_trigger {
+	/**
+	 * @brief struct can_interact_trigger - trigger engine state, see can_interact_trigger_init
+	 */
+	struct can_interact_trigger_signal_entry signals[CAN_INTERACT_TRIGGER_MAX_SIGNALS];
+	struct can_interact_trigger_rule_entry rules[CAN_INTERACT_TRIGGER_MAX_RULES];
+	struct can_interact_trigger_id_entry ids[CAN_INTERACT_TRIGGER_MAX_IDS];
+	size_t signal_count;
+	size_t rule_count;
+	size_t id_count;
+	size_t holding; /* rules in hold state, lets can_interact_trigger_poll return early */
+};
+
+/**
+ * @brief can_interact_trigger_init - clears signals and rules
+ *
+ * @param struct can_interact_trigger* - state to initialise
+ */
+void can_interact_trigger_init(struct can_interact_trigger *trigger);
+
+/**
+ * @brief can_interact_trigger_add_signal - names a signal of a message layout for use in rules
+ *
+ * @param struct can_interact_trigger* - trigger state
+ *
+ * @param const char* - name, letters, digits, '_' and '.', not starting with a digit
+ *
+ * @param const struct can_interact_compose_layout* - layout of message carrying signal (must outlive trigger state)
+ *
+ * @param const size_t - index of signal within layout
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if name or index is invalid, EEXIST if name is taken, ENOSPC if signal or identifier capacity is exhausted
+ */
+int can_interact_trigger_add_signal(struct can_interact_trigger *trigger, const char *name, const struct can_interact_compose_layout *layout, const size_t index);
+
+/**
+ * @brief can_interact_trigger_add_rule - compiles rule
+ *
+ * @param struct can_interact_trigger* - trigger state
+ *
+ * @param const char* - condition expression over signal names
+ *
+ * @param const uint64_t - nanoseconds the condition has to hold before the rule fires, 0 to fire at once
+ *
+ * @param const can_interact_trigger_handler - handler to invoke
+ *
+ * @param void* - user context passed to handler
+ *
+ * @param size_t* - pointer to write index of rule to, may be NULL
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL on syntax errors or unknown signal names, E2BIG if the expression needs more than
+ * CAN_INTERACT_TRIGGER_MAX_CODE instructions or CAN_INTERACT_TRIGGER_MAX_STACK stack slots, ENOSPC if rule capacity is exhausted
+ */
+int can_interact_trigger_add_rule(struct can_interact_trigger *trigger, const char *expression, const uint64_t hold_ns, const can_interact_trigger_handler handler, void *ctx, size_t *rule);
+
+/**
+ * @brief can_interact_trigger_frame - updates signals carried by frame and evaluates the rules reading them
+ *
+ * @param struct can_interact_trigger* - trigger state
+ *
+ * @param const struct can_interact_timed_frame* - received frame
+ */
+void can_interact_trigger_frame(struct can_interact_trigger *trigger, const struct can_interact_timed_frame *frame);
+
+/**
+ * @brief can_interact_trigger_frames - processes many frames in order, e.g. a batch received by can_interact_get_frames
+ *
+ * @param struct can_interact_trigger* - trigger state
+ *
+ * @param const struct can_interact_timed_frame* - frames
+ *
+ * @param const size_t - number of frames
+ */
+void can_interact_trigger_frames(struct can_interact_trigger *trigger, const struct can_interact_timed_frame *frames, const size_t len);
+
+/**
+ * @brief can_interact_trigger_poll - fires rules whose condition was last seen true and whose hold time ran out by now
+ * Needed for rules whose signals stop arriving while held, call it on a timer (see can_interact_trigger_deadline)
+ *
+ * @param struct can_interact_trigger* - trigger state
+ *
+ * @param const uint64_t - current time in nanoseconds, on the clock of the frame timestamps
+ */
+void can_interact_trigger_poll(struct can_interact_trigger *trigger, const uint64_t now_ns);
+
+/**
+ * @brief can_interact_trigger_deadline - earliest time at which a held rule is due
+ *
+ * @param const struct can_interact_trigger* - trigger state
+ *
+ * @return uint64_t - time in nanoseconds, 0 if no rule is held
+ */
+uint64_t can_interact_trigger_deadline(const struct can_interact_trigger *trigger);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_TRIGGER_H */
@@ -0,0 +1,176 @@
+#ifndef CAN_INTERACT_TRIGGER_HH
+#define CAN_INTERACT_TRIGGER_HH
+#pragma once
+
+#include <memory>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <errno.h>
+
+#include "can_interact.hh"
+#include "can_interact_compose.hh"
+#include "can_interact_trigger.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact trigger engine
+ * For declarations for the native C library, see can_interact_trigger.h
+ */
+
+namespace can_interact {
+
+	class Trigger {
+		/**
+		  * @brief Trigger (class) - compiled rules over named signals, evaluated per received frame
+		  */
+		public:
+			/**
+			  * @brief handler_t - receives index of fired rule, timestamp in nanoseconds and completing frame (nullptr if fired by poll)
+			  */
+			typedef std::function<void(std::size_t, std::uint64_t, const can_frame*)> handler_t ;
+
+		private:
+			std::unique_ptr<can_interact_trigger> _state ;
+			std::deque<handler_t> _handlers ; // addresses of elements are stable, for use as C context
+
+			/**
+			  * @brief _trampoline - INTERNAL METHOD. forwards C callbacks to std::function handlers
+			  * @param const std::size_t - rule
+			  * @param const std::uint64_t - timestamp in nanoseconds
+			  * @param const can_frame* - frame
+			  * @param void* - pointer to handler_t
+			  */
+			static void _trampoline(const std::size_t, const std::uint64_t, const can_frame*, void*) ;
+
+		public:
+			/**
+			  * @brief Trigger (constructor) - creates engine without signals and rules
+			  */
+			Trigger() noexcept(false) ;
+
+			Trigger(Trigger&&) noexcept = default ;
+			Trigger& operator=(Trigger&&) noexcept = default ;
+
+			/**
+			  * @brief signal - names a signal of a composer's message for use in rules
+			  * @param const std::string& - name, letters, digits, '_' and '.', not starting with a digit
+			  * @param const Composer& - composer of message carrying signal (must outlive trigger)
+			  * @param const std::size_t - index of signal within composer
+			  * @throws std::invalid_argument - if name or index is invalid or name is taken
+			  * @throws std::runtime_error - if signal or identifier capacity is exhausted
+			  */
+			void signal(const std::string&, const Composer&, const std::size_t) noexcept(false) ;
+
+			/**
+			  * @brief rule - compiles rule
+			  * @param const std::string& - condition expression over signal names, e.g. "brake > 80 && speed > 5"
+			  * @param const std::uint64_t - nanoseconds the condition has to hold before the rule fires, 0 to fire at once
+			  * @param handler_t - handler to invoke
+			  * @return std::size_t - index of rule
+			  * @throws std::invalid_argument - if the expression is invalid or too long
+			  * @throws std::runtime_error - if rule capacity is exhausted
+			  */
+			std::size_t rule(const std::string&, const std::uint64_t, handler_t) noexcept(false) ;
+
+			/**
+			  * @brief frame - updates signals carried by frame and evaluates the rules reading them
+			  * @param const can_interact_timed_frame& - received frame
+			  */
+			void frame(const can_interact_timed_frame&) ;
+
+			/**
+			  * @brief frames - processes batch received by CAN::frames in order
+			  * @param const can_interact_timed_frame* - frames
+			  * @param const std::size_t - number of frames
+			  */
+			void frames(const can_interact_timed_frame*, const std::size_t) ;
+
+			/**
+			  * @brief poll - fires held rules whose hold time ran out by now
+			  * @param const std::uint64_t - current time in nanoseconds, on the clock of the frame timestamps
+			  */
+			void poll(const std::uint64_t) ;
+
+			/**
+			  * @brief deadline - earliest time at which a held rule is due
+			  * @return std::uint64_t - time in nanoseconds, 0 if no rule is held
+			  */
+			std::uint64_t deadline() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			Trigger(const Trigger&) = delete ;
+			Trigger& operator=(const Trigger&) = delete ;
+	} ;
+
+}
+
+can_interact::Trigger::Trigger() noexcept(false) : _state{new can_interact_trigger}, _handlers{}
+{
+	can_interact_trigger_init(this->_state.get()) ;
+}
+
+void can_interact::Trigger::_trampoline(const std::size_t rule, const std::uint64_t timestamp, const can_frame* frame, void* ctx)
+{
+	(*static_cast<handler_t*>(ctx))(rule, timestamp, frame) ;
+}
+
+void can_interact::Trigger::signal(const std::string& name, const Composer& composer, const std::size_t index) noexcept(false)
+{
+	const int res = can_interact_trigger_add_signal(this->_state.get(), name.c_str(), &composer.layout(), index) ;
+	if(res == ENOSPC)
+	{
+		throw std::runtime_error(std::string{"No capacity left for signal "} + name) ;
+	}
+	else if(res != 0)
+	{
+		throw std::invalid_argument(std::string{"Invalid or duplicate signal "} + name) ;
+	}
+}
+
+std::size_t can_interact::Trigger::rule(const std::string& expression, const std::uint64_t hold_ns, handler_t handler) noexcept(false)
+{
+	if(!handler)
+	{
+		throw std::invalid_argument("Rule needs a handler") ;
+	}
+	this->_handlers.push_back(std::move(handler)) ;
+	std::size_t index ;
+	const int res = can_interact_trigger_add_rule(this->_state.get(), expression.c_str(), hold_ns, &can_interact::Trigger::_trampoline, &this->_handlers.back(), &index) ;
+	if(res != 0)
+	{
+		this->_handlers.pop_back() ;
+		if(res == ENOSPC)
+		{
+			throw std::runtime_error(std::string{"At most "} + std::to_string(CAN_INTERACT_TRIGGER_MAX_RULES) + " rules") ;
+		}
+		throw std::invalid_argument(std::string{"Invalid or too long expression: "} + expression) ;
+	}
+	return index ;
+}
+
+void can_interact::Trigger::frame(const can_interact_timed_frame& frame)
+{
+	can_interact_trigger_frame(this->_state.get(), &frame) ;
+}
+
+void can_interact::Trigger::frames(const can_interact_timed_frame* frames, const std::size_t len)
+{
+	can_interact_trigger_frames(this->_state.get(), frames, len) ;
+}
+
+void can_interact::Trigger::poll(const std::uint64_t now)
+{
+	can_interact_trigger_poll(this->_state.get(), now) ;
+}
+
+std::uint64_t can_interact::Trigger::deadline() const noexcept
+{
+	return can_interact_trigger_deadline(this->_state.get()) ;
+}
+
+#endif // CAN_INTERACT_TRIGGER_HH
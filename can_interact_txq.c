@@ -0,0 +1,292 @@
+#define _DEFAULT_SOURCE
+
+#include <unistd.h> /* syscalls */
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+
+#include "can_interact_txq.h"
+
+/**
+ * @brief C-style definitions of the priority aware transmit scheduler
+ * For definitions for the CXX API, see can_interact_txq.hh
+ */
+
+typedef int (*_p_can_interact_txq_before)(const struct can_interact_txq_entry *a, const struct can_interact_txq_entry *b);
+
+/**
+ * @brief _p_can_interact_txq_now - INTERNAL METHOD. reads monotonic clock
+ * @return uint64_t - time in nanoseconds
+ */
+static uint64_t _p_can_interact_txq_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief _p_can_interact_txq_key - INTERNAL METHOD. maps identifier onto the order in which the bus arbitrates
+ * Bits compared on the wire: 11 base id bits, RTR (standard) or SRR (extended, always recessive), IDE, 18 extension bits, RTR (extended)
+ * Hence a standard frame beats an extended frame sharing its base id, and a data frame beats a remote frame
+ * @param const canid_t - identifier including flags
+ * @return uint64_t - key, lower wins arbitration
+ */
+static uint64_t _p_can_interact_txq_key(const canid_t id)
+{
+	const uint64_t rtr = (id & CAN_RTR_FLAG) ? 1u : 0u;
+
+	if (id & CAN_EFF_FLAG) {
+		return ((uint64_t)((id & CAN_EFF_MASK) >> 18) << 21) | (1u << 20) | (1u << 19) | ((uint64_t)(id & 0x3FFFFu) << 1) | rtr;
+	}
+	return ((uint64_t)(id & CAN_SFF_MASK) << 21) | (rtr << 20);
+}
+
+/**
+ * @brief _p_can_interact_txq_by_priority - INTERNAL METHOD. ordering of ready heap
+ * @param const struct can_interact_txq_entry* - first entry
+ * @param const struct can_interact_txq_entry* - second entry
+ * @return int - non-zero if first entry is sent before second
+ */
+static int _p_can_interact_txq_by_priority(const struct can_interact_txq_entry *a, const struct can_interact_txq_entry *b)
+{
+	return a->key != b->key ? a->key < b->key : a->seq < b->seq;
+}
+
+/**
+ * @brief _p_can_interact_txq_by_release - INTERNAL METHOD. ordering of rate limited (held) heap
+ * @param const struct can_interact_txq_entry* - first entry
+ * @param const struct can_interact_txq_entry* - second entry
+ * @return int - non-zero if first entry is released before second
+ */
+static int _p_can_interact_txq_by_release(const struct can_interact_txq_entry *a, const struct can_interact_txq_entry *b)
+{
+	return a->release_ns != b->release_ns ? a->release_ns < b->release_ns : a->seq < b->seq;
+}
+
+/**
+ * @brief _p_can_interact_txq_heap_push - INTERNAL METHOD. inserts entry into binary heap
+ * @param struct can_interact_txq_entry* - heap
+ * @param size_t* - length of heap (incremented)
+ * @param const struct can_interact_txq_entry* - entry to insert (capacity must have been checked)
+ * @param _p_can_interact_txq_before - heap ordering
+ */
+static void _p_can_interact_txq_heap_push(struct can_interact_txq_entry *heap, size_t *len, const struct can_interact_txq_entry *entry, _p_can_interact_txq_before before)
+{
+	size_t i = (*len)++;
+
+	while (i > 0 && before(entry, &heap[(i - 1) / 2])) {
+		heap[i] = heap[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	heap[i] = *entry;
+}
+
+/**
+ * @brief _p_can_interact_txq_heap_pop - INTERNAL METHOD. removes top entry of non-empty binary heap
+ * @param struct can_interact_txq_entry* - heap
+ * @param size_t* - length of heap (decremented)
+ * @param _p_can_interact_txq_before - heap ordering
+ */
+static void _p_can_interact_txq_heap_pop(struct can_interact_txq_entry *heap, size_t *len, _p_can_interact_txq_before before)
+{
+	const struct can_interact_txq_entry last = heap[--*len];
+	const size_t n = *len;
+	size_t i = 0, child;
+
+	while ((child = 2 * i + 1) < n) {
+		if (child + 1 < n && before(&heap[child + 1], &heap[child])) {
+			++child;
+		}
+		if (!before(&heap[child], &last)) {
+			break;
+		}
+		heap[i] = heap[child];
+		i = child;
+	}
+	if (n > 0) {
+		heap[i] = last;
+	}
+}
+
+/**
+ * @brief _p_can_interact_txq_find - INTERNAL METHOD. looks up rate limit slot of identifier
+ * @param struct can_interact_txq* - scheduler
+ * @param const canid_t - identifier
+ * @param const int - non-zero to return a free slot if identifier has none
+ * @return struct can_interact_txq_limit* - slot, NULL if not found (or table full)
+ */
+static struct can_interact_txq_limit* _p_can_interact_txq_find(struct can_interact_txq *txq, const canid_t id, const int insert)
+{
+	size_t i, probe;
+	struct can_interact_txq_limit *free_slot = NULL;
+
+	i = (size_t)((id * 2654435761u) & (CAN_INTERACT_TXQ_MAX_LIMITS - 1));
+	for (probe = 0; probe < CAN_INTERACT_TXQ_MAX_LIMITS; ++probe, i = (i + 1) & (CAN_INTERACT_TXQ_MAX_LIMITS - 1)) {
+		if (txq->limits[i].interval_us != 0 && txq->limits[i].id == id) {
+			return &txq->limits[i];
+		}
+		if (txq->limits[i].interval_us == 0 && free_slot == NULL) {
+			free_slot = &txq->limits[i]; /* lifted limits leave holes, so keep probing for id */
+		}
+	}
+	return insert ? free_slot : NULL;
+}
+
+/**
+ * @brief _p_can_interact_txq_release - INTERNAL METHOD. moves rate limited frames which are due into ready heap
+ * @param struct can_interact_txq* - scheduler
+ * @param const uint64_t - current time in nanoseconds
+ */
+static void _p_can_interact_txq_release(struct can_interact_txq *txq, const uint64_t now)
+{
+	while (txq->held_len > 0 && txq->held[0].release_ns <= now) {
+		_p_can_interact_txq_heap_push(txq->ready, &txq->ready_len, &txq->held[0], _p_can_interact_txq_by_priority);
+		_p_can_interact_txq_heap_pop(txq->held, &txq->held_len, _p_can_interact_txq_by_release);
+	}
+}
+
+void can_interact_txq_init(struct can_interact_txq *txq)
+{
+	memset(txq, 0, sizeof(struct can_interact_txq));
+}
+
+int can_interact_txq_sndbuf(const int *socket, const int bytes)
+{
+	return setsockopt(*socket, SOL_SOCKET, SO_SNDBUF, &bytes, sizeof(bytes)) == 0 ? 0 : (int)errno;
+}
+
+int can_interact_txq_limit(struct can_interact_txq *txq, const canid_t id, const uint32_t interval_us)
+{
+	struct can_interact_txq_limit *limit = _p_can_interact_txq_find(txq, id, interval_us != 0);
+
+	if (limit == NULL) {
+		return interval_us != 0 ? ENOSPC : 0;
+	}
+	if (limit->interval_us == 0) {
+		limit->next_ns = 0;
+	}
+	limit->id = id;
+	limit->interval_us = interval_us;
+	return 0;
+}
+
+int can_interact_txq_push(struct can_interact_txq *txq, const struct can_frame *frame)
+{
+	struct can_interact_txq_entry entry;
+	struct can_interact_txq_limit *limit;
+
+	if (txq->ready_len + txq->held_len >= CAN_INTERACT_TXQ_MAX_FRAMES) {
+		++txq->stats.rejected;
+		return ENOBUFS;
+	}
+	entry.key = _p_can_interact_txq_key(frame->can_id);
+	entry.seq = txq->seq++;
+	entry.enqueued_ns = _p_can_interact_txq_now();
+	entry.release_ns = entry.enqueued_ns;
+	entry.frame = *frame;
+
+	limit = _p_can_interact_txq_find(txq, frame->can_id, 0);
+	if (limit != NULL) {
+		if (limit->next_ns > entry.release_ns) {
+			entry.release_ns = limit->next_ns;
+		}
+		limit->next_ns = entry.release_ns + (uint64_t)limit->interval_us * 1000u;
+	}
+	if (entry.release_ns > entry.enqueued_ns) {
+		_p_can_interact_txq_heap_push(txq->held, &txq->held_len, &entry, _p_can_interact_txq_by_release);
+	} else {
+		_p_can_interact_txq_heap_push(txq->ready, &txq->ready_len, &entry, _p_can_interact_txq_by_priority);
+	}
+	if (txq->ready_len + txq->held_len > txq->stats.max_depth) {
+		txq->stats.max_depth = txq->ready_len + txq->held_len;
+	}
+	return 0;
+}
+
+int can_interact_txq_dispatch(struct can_interact_txq *txq, const int *socket, const int timeout_ms, size_t *sent)
+{
+	const uint64_t start = _p_can_interact_txq_now();
+	const uint64_t deadline = start + (uint64_t)(timeout_ms < 0 ? 0 : timeout_ms) * 1000000u;
+	struct pollfd pfd;
+	uint64_t now = start, latency, wait_ns;
+	size_t n = 0;
+	int res = 0, wait_ms;
+
+	pfd.fd = *socket;
+	pfd.events = POLLOUT;
+	for (;;) {
+		_p_can_interact_txq_release(txq, now);
+		if (txq->ready_len == 0) {
+			if (txq->held_len == 0) {
+				break; /* queue is empty */
+			}
+			wait_ns = txq->held[0].release_ns - now;
+			pfd.events = 0;
+		} else if (send(*socket, &txq->ready[0].frame, sizeof(struct can_frame), MSG_DONTWAIT) == (ssize_t)sizeof(struct can_frame)) {
+			latency = _p_can_interact_txq_now() - txq->ready[0].enqueued_ns;
+			if (latency > txq->stats.latency_max_ns) {
+				txq->stats.latency_max_ns = latency;
+			}
+			txq->stats.latency_total_ns += latency;
+			++txq->stats.sent;
+			++n;
+			_p_can_interact_txq_heap_pop(txq->ready, &txq->ready_len, _p_can_interact_txq_by_priority);
+			now = _p_can_interact_txq_now();
+			continue;
+		} else if (errno == EAGAIN || errno == EWOULDBLOCK) { /* socket buffer full, poll reports when it drains */
+			++txq->stats.backpressure;
+			wait_ns = UINT64_MAX;
+			pfd.events = POLLOUT;
+		} else if (errno == ENOBUFS) { /* device queue full, not poll-able */
+			++txq->stats.backpressure;
+			wait_ns = (uint64_t)CAN_INTERACT_TXQ_BACKOFF_MS * 1000000u;
+			pfd.events = 0;
+		} else if (errno == EINTR) {
+			continue;
+		} else {
+			res = (int)errno;
+			++txq->stats.dropped;
+			_p_can_interact_txq_heap_pop(txq->ready, &txq->ready_len, _p_can_interact_txq_by_priority);
+			break;
+		}
+
+		if (timeout_ms >= 0) { /* bound wait by remaining time */
+			if (now >= deadline) {
+				break;
+			}
+			if (wait_ns > deadline - now) {
+				wait_ns = deadline - now;
+			}
+		}
+		wait_ms = wait_ns == UINT64_MAX ? -1 : (int)((wait_ns + 999999u) / 1000000u);
+		if (pfd.events != 0) {
+			poll(&pfd, 1, wait_ms);
+		} else {
+			poll(NULL, 0, wait_ms);
+		}
+		now = _p_can_interact_txq_now();
+	}
+
+	if (sent != NULL) {
+		*sent = n;
+	}
+	return res;
+}
+
+void can_interact_txq_get_stats(struct can_interact_txq *txq, struct can_interact_txq_stats *stats)
+{
+	const uint64_t now = _p_can_interact_txq_now();
+
+	_p_can_interact_txq_release(txq, now);
+	txq->stats.depth = txq->ready_len + txq->held_len;
+	txq->stats.head_wait_ns = txq->ready_len > 0 ? now - txq->ready[0].enqueued_ns : 0;
+	*stats = txq->stats;
+}
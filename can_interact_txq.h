@@ -0,0 +1,159 @@
+#ifndef CAN_INTERACT_TXQ_H
+#define CAN_INTERACT_TXQ_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+#include "can_interact.h"
+
+/**
+ * @brief C-style priority aware transmit scheduler, sitting in front of a CAN socket
+ * Queued frames leave in bus arbitration order (lowest identifier first, FIFO among equal identifiers) rather than in submission order
+ * Identifiers may be rate limited to a minimum interval - their frames wait in a separate queue until released
+ * When the kernel pushes back (socket buffer or device queue full) dispatching waits via poll instead of spinning on ENOBUFS
+ * Keep the kernel's backlog short (see can_interact_txq_sndbuf) so that urgent frames are not stuck behind frames already handed over
+ * All state lives in a single caller-provided struct and is not thread safe - submit and dispatch from one thread
+ * For the CXX API, see can_interact_txq.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifndef CAN_INTERACT_TXQ_MAX_FRAMES
+#define CAN_INTERACT_TXQ_MAX_FRAMES 256 /* capacity of queue in frames (ready and rate limited combined) */
+#endif /* CAN_INTERACT_TXQ_MAX_FRAMES */
+
+#ifndef CAN_INTERACT_TXQ_MAX_LIMITS
+#define CAN_INTERACT_TXQ_MAX_LIMITS 64 /* capacity of open addressed rate limit table, must be a power of two */
+#endif /* CAN_INTERACT_TXQ_MAX_LIMITS */
+
+#define CAN_INTERACT_TXQ_BACKOFF_MS 1 /* pause after ENOBUFS, as the device queue does not signal when it drains */
+
+struct can_interact_txq_entry {
+	/**
+	 * @brief struct can_interact_txq_entry - INTERNAL. queued frame
+	 */
+	uint64_t key; /* arbitration priority, lower wins */
+	uint64_t seq; /* submission order, breaks ties */
+	uint64_t enqueued_ns;
+	uint64_t release_ns; /* earliest time frame may be sent (rate limits) */
+	struct can_frame frame;
+};
+
+struct can_interact_txq_limit {
+	/**
+	 * @brief struct can_interact_txq_limit - INTERNAL. slot of the rate limit table
+	 */
+	canid_t id;
+	uint32_t interval_us; /* 0 if slot is empty */
+	uint64_t next_ns; /* release time of id's next frame */
+};
+
+struct can_interact_txq_stats {
+	/**
+	 * @brief struct can_interact_txq_stats - queue metrics
+	 * Latencies span from submission to being accepted by the kernel, including time held back by rate limits
+	 */
+	size_t depth; /* frames queued */
+	size_t max_depth; /* highest depth seen */
+	uint64_t head_wait_ns; /* time the next frame to be sent has been queued for, 0 if none is ready */
+	unsigned long sent; /* frames accepted by kernel */
+	unsigned long rejected; /* frames refused as the queue was full */
+	unsigned long dropped; /* frames discarded after failing to send with errors other than backpressure */
+	unsigned long backpressure; /* number of times the kernel pushed back (EAGAIN / ENOBUFS) */
+	uint64_t latency_max_ns;
+	uint64_t latency_total_ns; /* divide by sent for mean latency */
+};
+
+struct can_interact_txq {
+	/**
+	 * @brief struct can_interact_txq - transmit scheduler state (~25KB with default settings)
+	 * Initialise with can_interact_txq_init
+	 */
+	struct can_interact_txq_entry ready[CAN_INTERACT_TXQ_MAX_FRAMES]; /* binary heap by key, seq */
+	struct can_interact_txq_entry held[CAN_INTERACT_TXQ_MAX_FRAMES]; /* binary heap by release_ns, seq */
+	struct can_interact_txq_limit limits[CAN_INTERACT_TXQ_MAX_LIMITS];
+	size_t ready_len;
+	size_t held_len;
+	uint64_t seq;
+	struct can_interact_txq_stats stats; /* depth and head_wait_ns are filled in by can_interact_txq_get_stats */
+};
+
+/**
+ * @brief can_interact_txq_init - initialises empty transmit scheduler without rate limits
+ *
+ * @param struct can_interact_txq* - scheduler
+ */
+void can_interact_txq_init(struct can_interact_txq *txq);
+
+/**
+ * @brief can_interact_txq_sndbuf - shrinks socket's send buffer so that backpressure surfaces early (as poll-able EAGAIN) and few frames wait inside the kernel
+ *
+ * @param const int* - socket descriptor
+ *
+ * @param const int - send buffer size in bytes (the kernel enforces a minimum of a few frames)
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_txq_sndbuf(const int *socket, const int bytes);
+
+/**
+ * @brief can_interact_txq_limit - sets minimum interval between frames of identifier (applies to frames submitted afterwards)
+ *
+ * @param struct can_interact_txq* - scheduler
+ *
+ * @param const canid_t - identifier (including CAN_EFF_FLAG for extended identifiers)
+ *
+ * @param const uint32_t - minimum interval in microseconds, 0 lifts the limit
+ *
+ * @return int - error code
+ * Note: 0 on success, ENOSPC if the rate limit table is full
+ */
+int can_interact_txq_limit(struct can_interact_txq *txq, const canid_t id, const uint32_t interval_us);
+
+/**
+ * @brief can_interact_txq_push - submits frame
+ *
+ * @param struct can_interact_txq* - scheduler
+ *
+ * @param const struct can_frame* - frame to send
+ *
+ * @return int - error code
+ * Note: 0 on success, ENOBUFS if the queue is full
+ */
+int can_interact_txq_push(struct can_interact_txq *txq, const struct can_frame *frame);
+
+/**
+ * @brief can_interact_txq_dispatch - sends queued frames in priority order, waiting out backpressure and rate limits
+ *
+ * @param struct can_interact_txq* - scheduler
+ *
+ * @param const int* - socket descriptor to send to
+ *
+ * @param const int - maximum time to spend in milliseconds, 0 to only send what the kernel accepts right away, -1 to run until the queue is empty
+ *
+ * @param size_t* - pointer to write number of frames sent to, may be NULL
+ *
+ * @return int - error code
+ * Note: 0 on success (including running out of time with frames still queued), for non-zero values refer to errno codes (the failed frame is dropped)
+ */
+int can_interact_txq_dispatch(struct can_interact_txq *txq, const int *socket, const int timeout_ms, size_t *sent);
+
+/**
+ * @brief can_interact_txq_get_stats - reports queue metrics
+ *
+ * @param struct can_interact_txq* - scheduler
+ *
+ * @param struct can_interact_txq_stats* - pointer to write metrics to
+ */
+void can_interact_txq_get_stats(struct can_interact_txq *txq, struct can_interact_txq_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_TXQ_H */
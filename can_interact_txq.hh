@@ -0,0 +1,139 @@
+#ifndef CAN_INTERACT_TXQ_HH
+#define CAN_INTERACT_TXQ_HH
+#pragma once
+
+#include <memory>
+#include <chrono>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <errno.h>
+
+#include "can_interact.hh"
+#include "can_interact_txq.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact priority aware transmit scheduler
+ * For declarations for the native C library, see can_interact_txq.h
+ */
+
+namespace can_interact {
+
+	class TxQueue {
+		/**
+		  * @brief TxQueue (class) - orders frames by arbitration priority (with optional per-id rate limits) before handing them to a CAN connection
+		  * Not thread safe - submit and dispatch from one thread
+		  */
+		private:
+			std::unique_ptr<can_interact_txq> _state ;
+
+		public:
+			/**
+			  * @brief TxQueue (constructor) - initialises empty scheduler without rate limits
+			  */
+			TxQueue() noexcept(false) ;
+
+			TxQueue(TxQueue&&) noexcept = default ;
+			TxQueue& operator=(TxQueue&&) noexcept = default ;
+
+			/**
+			  * @brief sndbuf - shrinks CAN connection's send buffer, so that few frames wait inside the kernel (out of reach of prioritisation)
+			  * @param const CAN& - CAN connection
+			  * @param const int - send buffer size in bytes
+			  * @throws std::runtime_error - in case can_interact_* functionality returns non-zero error (and errors reported by errno)
+			  */
+			static void sndbuf(const CAN&, const int) noexcept(false) ;
+
+			/**
+			  * @brief limit - sets minimum interval between frames of identifier
+			  * @param const canid_t - identifier (including CAN_EFF_FLAG for extended identifiers)
+			  * @param const std::chrono::microseconds - minimum interval, zero lifts the limit
+			  * @throws std::invalid_argument - if interval is negative or above UINT32_MAX microseconds
+			  * @throws std::runtime_error - if rate limit table is full
+			  */
+			void limit(const canid_t, const std::chrono::microseconds) noexcept(false) ;
+
+			/**
+			  * @brief push - submits frame
+			  * @param const can_frame& - LINUX CAN frame struct
+			  * @return bool - false if the queue is full and the frame was refused
+			  */
+			bool push(const can_frame&) noexcept ;
+
+			/**
+			  * @brief dispatch - sends queued frames in priority order, waiting out backpressure and rate limits
+			  * @param const CAN& - CAN connection
+			  * @param const std::chrono::milliseconds - maximum time to spend, zero to only send what the kernel accepts right away
+			  * @return std::size_t - number of frames sent
+			  * @throws std::runtime_error - in case sending fails for other reasons than backpressure (the failed frame is dropped)
+			  */
+			std::size_t dispatch(const CAN&, const std::chrono::milliseconds) noexcept(false) ;
+
+			/**
+			  * @brief stats - getter for queue metrics
+			  * @return can_interact_txq_stats - depth, head-of-line wait, latencies and counters
+			  */
+			can_interact_txq_stats stats() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			TxQueue(const TxQueue&) = delete ;
+			TxQueue& operator=(const TxQueue&) = delete ;
+	} ;
+
+}
+
+can_interact::TxQueue::TxQueue() noexcept(false)
+	: _state{new can_interact_txq}
+{
+	can_interact_txq_init(this->_state.get()) ;
+}
+
+void can_interact::TxQueue::sndbuf(const CAN& can, const int bytes) noexcept(false)
+{
+	const int socket = can.socket() ;
+	const int res = can_interact_txq_sndbuf(&socket, bytes) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::TxQueue::limit(const canid_t id, const std::chrono::microseconds interval) noexcept(false)
+{
+	if(interval.count() < 0 || interval.count() > static_cast<std::chrono::microseconds::rep>(UINT32_MAX))
+	{
+		throw std::invalid_argument(std::string{"Rate limit interval of "} + std::to_string(interval.count()) + "us out of range 0-" + std::to_string(UINT32_MAX) + "us") ;
+	}
+	if(can_interact_txq_limit(this->_state.get(), id, static_cast<std::uint32_t>(interval.count())) != 0)
+	{
+		throw std::runtime_error(std::string{"Rate limit table full"}) ;
+	}
+}
+
+bool can_interact::TxQueue::push(const can_frame& frame) noexcept
+{
+	return can_interact_txq_push(this->_state.get(), &frame) == 0 ;
+}
+
+std::size_t can_interact::TxQueue::dispatch(const CAN& can, const std::chrono::milliseconds timeout) noexcept(false)
+{
+	const int socket = can.socket() ;
+	std::size_t sent ;
+	const int res = can_interact_txq_dispatch(this->_state.get(), &socket, static_cast<int>(timeout.count()), &sent) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return sent ;
+}
+
+can_interact_txq_stats can_interact::TxQueue::stats() const noexcept
+{
+	can_interact_txq_stats stats ;
+	can_interact_txq_get_stats(this->_state.get(), &stats) ;
+	return stats ;
+}
+
+#endif // CAN_INTERACT_TXQ_HH
@@ -0,0 +1,367 @@
+#define _DEFAULT_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/isotp.h>
+
+#include "can_interact_uds.h"
+
+/**
+ * @brief C-style definitions of the UDS flash download client
+ * For definitions for the CXX API, see can_interact_uds.hh
+ */
+
+#define CAN_INTERACT_UDS_NEGATIVE 0x7F
+#define CAN_INTERACT_UDS_POSITIVE 0x40 /* added to service identifier in positive responses */
+
+/**
+ * @brief _p_can_interact_uds_now - INTERNAL METHOD. current CLOCK_MONOTONIC time
+ * @return uint64_t - nanoseconds
+ */
+static uint64_t _p_can_interact_uds_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+int can_interact_uds_init(struct can_interact_uds *uds, const char *device_name, const struct can_interact_uds_config *config)
+{
+	struct can_isotp_options options;
+	struct can_isotp_fc_options fc;
+	struct can_isotp_ll_options ll;
+	struct sockaddr_can addr;
+	uint32_t stmin;
+	unsigned int ifindex;
+	int res;
+
+	uds->p2_ms = config->p2_ms != 0 ? config->p2_ms : 50;
+	uds->p2_star_ms = config->p2_star_ms != 0 ? config->p2_star_ms : 5000;
+	uds->pending = 0;
+	uds->nrc = 0;
+	uds->socket = -1;
+
+	ifindex = if_nametoindex(device_name);
+	if (ifindex == 0) {
+		return ENODEV;
+	}
+	uds->socket = socket(PF_CAN, SOCK_DGRAM, CAN_ISOTP);
+	if (uds->socket == -1) {
+		return (int)errno;
+	}
+
+	memset(&options, 0, sizeof(options));
+	options.flags = CAN_ISOTP_WAIT_TX_DONE; /* send returns once the request is on the bus, so P2 is measured from its end */
+	if (config->padding >= 0) {
+		options.flags |= CAN_ISOTP_TX_PADDING | CAN_ISOTP_RX_PADDING;
+		options.txpad_content = (uint8_t)config->padding;
+		options.rxpad_content = (uint8_t)config->padding;
+	}
+	if (config->tx_stmin_ns >= 0) {
+		options.flags |= CAN_ISOTP_FORCE_TXSTMIN;
+	}
+	options.frame_txtime = config->frame_txtime_ns != 0 ? config->frame_txtime_ns : CAN_ISOTP_FRAME_TXTIME_ZERO;
+	memset(&fc, 0, sizeof(fc));
+	fc.bs = config->block_size;
+	fc.stmin = config->stmin;
+	if (setsockopt(uds->socket, SOL_CAN_ISOTP, CAN_ISOTP_OPTS, &options, sizeof(options)) == -1
+			|| setsockopt(uds->socket, SOL_CAN_ISOTP, CAN_ISOTP_RECV_FC, &fc, sizeof(fc)) == -1) {
+		goto fail;
+	}
+	if (config->tx_stmin_ns >= 0) {
+		stmin = (uint32_t)config->tx_stmin_ns;
+		if (setsockopt(uds->socket, SOL_CAN_ISOTP, CAN_ISOTP_TX_STMIN, &stmin, sizeof(stmin)) == -1) {
+			goto fail;
+		}
+	}
+	if (config->fd) {
+		memset(&ll, 0, sizeof(ll));
+		ll.mtu = CANFD_MTU;
+		ll.tx_dl = config->tx_dl != 0 ? config->tx_dl : CANFD_MAX_DLEN;
+		ll.tx_flags = CANFD_BRS;
+		if (setsockopt(uds->socket, SOL_CAN_ISOTP, CAN_ISOTP_LL_OPTS, &ll, sizeof(ll)) == -1) {
+			goto fail;
+		}
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+	addr.can_ifindex = (int)ifindex;
+	addr.can_addr.tp.tx_id = config->tx_id;
+	addr.can_addr.tp.rx_id = config->rx_id;
+	if (bind(uds->socket, (struct sockaddr*)&addr, sizeof(addr)) == -1) {
+		goto fail;
+	}
+	return 0;
+
+fail:
+	res = (int)errno;
+	close(uds->socket);
+	uds->socket = -1;
+	return res;
+}
+
+/**
+ * @brief _p_can_interact_uds_send - INTERNAL METHOD. sends request, returning once it was transmitted
+ * @param struct can_interact_uds* - client
+ * @param const uint8_t* - request
+ * @param const size_t - request length
+ * @return int - 0 on success, else errno code of send
+ */
+static int _p_can_interact_uds_send(struct can_interact_uds *uds, const uint8_t *request, const size_t len)
+{
+	ssize_t res;
+
+	uds->nrc = 0;
+	do {
+		res = send(uds->socket, request, len, 0);
+	} while (res == -1 && errno == EINTR);
+	if (res == -1) {
+		return (int)errno;
+	}
+	return (size_t)res == len ? 0 : EIO;
+}
+
+/**
+ * @brief _p_can_interact_uds_wait - INTERNAL METHOD. waits for final response to service, skipping response pending and unrelated responses
+ * @param struct can_interact_uds* - client
+ * @param const uint8_t - service identifier of request
+ * @param const uint8_t** - pointer to write pointer to positive response to
+ * @param size_t* - pointer to write response length to
+ * @return int - error code, see can_interact_uds_request
+ */
+static int _p_can_interact_uds_wait(struct can_interact_uds *uds, const uint8_t sid, const uint8_t **response, size_t *response_len)
+{
+	struct pollfd pfd;
+	uint64_t deadline = _p_can_interact_uds_now() + (uint64_t)uds->p2_ms * 1000000u, now;
+	ssize_t len;
+	int res;
+
+	pfd.fd = uds->socket;
+	pfd.events = POLLIN;
+	for (;;) {
+		now = _p_can_interact_uds_now();
+		if (now >= deadline) {
+			return ETIMEDOUT;
+		}
+		res = poll(&pfd, 1, (int)((deadline - now + 999999u) / 1000000u));
+		if (res == -1 && errno != EINTR) {
+			return (int)errno;
+		}
+		if (res <= 0) {
+			continue;
+		}
+		len = recv(uds->socket, uds->response, CAN_INTERACT_UDS_MAX_RESPONSE, 0);
+		if (len == -1) {
+			return (int)errno;
+		}
+		if (len >= 3 && uds->response[0] == CAN_INTERACT_UDS_NEGATIVE && uds->response[1] == sid) {
+			if (uds->response[2] == CAN_INTERACT_UDS_NRC_PENDING) {
+				++uds->pending;
+				deadline = _p_can_interact_uds_now() + (uint64_t)uds->p2_star_ms * 1000000u;
+				continue;
+			}
+			uds->nrc = uds->response[2];
+			return EPROTO;
+		}
+		if (len >= 1 && uds->response[0] == (uint8_t)(sid + CAN_INTERACT_UDS_POSITIVE)) {
+			*response = uds->response;
+			*response_len = (size_t)len;
+			return 0;
+		}
+		/* late answer to an earlier request (e.g. one that timed out), keep waiting */
+	}
+}
+
+int can_interact_uds_request(struct can_interact_uds *uds, const uint8_t *request, const size_t len, const uint8_t **response, size_t *response_len)
+{
+	int res;
+
+	if (len == 0) {
+		return EINVAL;
+	}
+	res = _p_can_interact_uds_send(uds, request, len);
+	return res != 0 ? res : _p_can_interact_uds_wait(uds, request[0], response, response_len);
+}
+
+int can_interact_uds_session(struct can_interact_uds *uds, const uint8_t session)
+{
+	const uint8_t request[2] = {0x10, 0};
+	uint8_t message[2];
+	const uint8_t *response;
+	size_t len;
+	uint32_t p2, p2_star;
+	int res;
+
+	memcpy(message, request, sizeof(message));
+	message[1] = session;
+	res = can_interact_uds_request(uds, message, sizeof(message), &response, &len);
+	if (res != 0) {
+		return res;
+	}
+	if (len >= 6) { /* P2server_max in ms, P2*server_max in 10ms */
+		p2 = (uint32_t)response[2] << 8 | response[3];
+		p2_star = ((uint32_t)response[4] << 8 | response[5]) * 10u;
+		uds->p2_ms = p2 > uds->p2_ms ? p2 : uds->p2_ms;
+		uds->p2_star_ms = p2_star > uds->p2_star_ms ? p2_star : uds->p2_star_ms;
+	}
+	return 0;
+}
+
+int can_interact_uds_security(struct can_interact_uds *uds, const uint8_t level, const can_interact_uds_key key, void *ctx)
+{
+	uint8_t message[CAN_INTERACT_UDS_MAX_RESPONSE];
+	uint8_t seed[CAN_INTERACT_UDS_MAX_RESPONSE];
+	const uint8_t *response;
+	size_t len, seed_len, key_len, i;
+	int res, locked = 0;
+
+	if ((level & 1u) == 0) {
+		return EINVAL;
+	}
+	message[0] = 0x27;
+	message[1] = level;
+	res = can_interact_uds_request(uds, message, 2, &response, &len);
+	if (res != 0) {
+		return res;
+	}
+	seed_len = len > 2 ? len - 2 : 0;
+	memcpy(seed, response + 2, seed_len);
+	for (i = 0; i < seed_len; ++i) {
+		locked |= seed[i] != 0;
+	}
+	if (!locked) { /* zero seed, already unlocked */
+		return 0;
+	}
+	key_len = sizeof(message) - 2;
+	res = key(level, seed, seed_len, message + 2, &key_len, ctx);
+	if (res != 0) {
+		return res;
+	}
+	message[1] = (uint8_t)(level + 1u);
+	return can_interact_uds_request(uds, message, key_len + 2, &response, &len);
+}
+
+/**
+ * @brief _p_can_interact_uds_fill - INTERNAL METHOD. builds TransferData request in block buffer
+ * @param uint8_t* - block buffer
+ * @param const uint8_t - block sequence counter
+ * @param const size_t - payload length
+ * @param const uint64_t - offset of payload within download
+ * @param const can_interact_uds_source - data source
+ * @param void* - user context of source
+ * @return int - 0 on success, else error code of source
+ */
+static int _p_can_interact_uds_fill(uint8_t *block, const uint8_t seq, const size_t len, const uint64_t offset, const can_interact_uds_source source, void *ctx)
+{
+	block[0] = 0x36;
+	block[1] = seq;
+	return source(block + 2, len, offset, ctx);
+}
+
+int can_interact_uds_download(struct can_interact_uds *uds, const uint32_t address, const uint32_t size, const uint8_t format, const can_interact_uds_source source, void *ctx, struct can_interact_uds_stats *stats)
+{
+	uint8_t request[11];
+	const uint8_t *response;
+	const uint64_t start = _p_can_interact_uds_now(), pending = uds->pending;
+	uint64_t offset = 0, next, sent_at, block_len = 0;
+	size_t len, payload, chunk, i, cur = 0;
+	uint8_t seq = 1;
+	int res, filled = 0;
+
+	if (stats != NULL) {
+		memset(stats, 0, sizeof(struct can_interact_uds_stats));
+		can_interact_hist_init(&stats->latency);
+	}
+
+	/* RequestDownload, addressAndLengthFormatIdentifier 0x44: 4 byte size, 4 byte address */
+	request[0] = 0x34;
+	request[1] = format;
+	request[2] = 0x44;
+	for (i = 0; i < 4; ++i) {
+		request[3 + i] = (uint8_t)(address >> (24 - 8 * i));
+		request[7 + i] = (uint8_t)(size >> (24 - 8 * i));
+	}
+	res = can_interact_uds_request(uds, request, sizeof(request), &response, &len);
+	if (res != 0) {
+		return res;
+	}
+	if (len < 2 || (response[1] >> 4) == 0 || (response[1] >> 4) > 8 || len < 2u + (size_t)(response[1] >> 4)) {
+		return EPROTO;
+	}
+	for (i = 0; i < (size_t)(response[1] >> 4); ++i) { /* maxNumberOfBlockLength, counting SID and counter */
+		block_len = block_len << 8 | response[2 + i];
+	}
+	if (block_len > CAN_INTERACT_UDS_MAX_BLOCK) {
+		block_len = CAN_INTERACT_UDS_MAX_BLOCK;
+	}
+	if (block_len < 3) {
+		return EPROTO;
+	}
+	payload = (size_t)block_len - 2;
+
+	if (size > 0) {
+		res = _p_can_interact_uds_fill(uds->block[0], seq, payload < size ? payload : size, 0, source, ctx);
+		if (res != 0) {
+			return res;
+		}
+	}
+	while (offset < size) {
+		chunk = size - offset < payload ? (size_t)(size - offset) : payload;
+		sent_at = _p_can_interact_uds_now();
+		res = _p_can_interact_uds_send(uds, uds->block[cur], chunk + 2);
+		if (res != 0) {
+			return res;
+		}
+		next = offset + chunk;
+		filled = 0;
+		if (next < size) { /* the ECU programs this block meanwhile */
+			filled = _p_can_interact_uds_fill(uds->block[cur ^ 1u], (uint8_t)(seq + 1u), size - next < payload ? (size_t)(size - next) : payload, next, source, ctx);
+		}
+		res = _p_can_interact_uds_wait(uds, 0x36, &response, &len);
+		if (res != 0) {
+			return res;
+		}
+		if (len >= 2 && response[1] != seq) {
+			return EPROTO;
+		}
+		if (filled != 0) {
+			return filled;
+		}
+		if (stats != NULL) {
+			can_interact_hist_record(&stats->latency, _p_can_interact_uds_now() - sent_at);
+			stats->bytes += chunk;
+			++stats->blocks;
+		}
+		offset = next;
+		seq = (uint8_t)(seq + 1u); /* wraps from 0xFF to 0x00 */
+		cur ^= 1u;
+	}
+
+	request[0] = 0x37; /* RequestTransferExit */
+	res = can_interact_uds_request(uds, request, 1, &response, &len);
+	if (stats != NULL) {
+		stats->block_len = (size_t)block_len;
+		stats->pending = uds->pending - pending;
+		stats->elapsed_ns = _p_can_interact_uds_now() - start;
+	}
+	return res;
+}
+
+void can_interact_uds_fini(struct can_interact_uds *uds)
+{
+	if (uds->socket != -1) {
+		close(uds->socket);
+		uds->socket = -1;
+	}
+}
@@ -0,0 +1,197 @@
+#ifndef CAN_INTERACT_UDS_H
+#define CAN_INTERACT_UDS_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/can.h>
+
+#include "can_interact.h"
+#include "can_interact_hist.h"
+
+/**
+ * @brief C-style UDS (ISO 14229) client for ECU flash download over kernel CAN_ISOTP sockets (ISO 15765-2 segmentation in the kernel)
+ * The ISO-TP socket is opened next to (and independent from) can_interact_init sockets on the same device. can_interact_uds_request sends
+ * one request and waits P2 for its response, extending to P2* while the ECU answers response pending (0x78)
+ * can_interact_uds_download runs RequestDownload / TransferData / RequestTransferExit: it uses the largest block length the ECU accepts
+ * (maxNumberOfBlockLength of its RequestDownload response, capped at CAN_INTERACT_UDS_MAX_BLOCK), and double buffers blocks so the data
+ * source fills block n + 1 while the ECU programs block n. UDS allows one outstanding request, so this is as far as requests can be pipelined
+ * Throughput levers are in struct can_interact_uds_config: CAN FD link layer with 64 byte frames, no inter-frame gap of the kernel
+ * (frame_txtime), the block size / STmin announced to the ECU, and optionally overriding a conservative STmin requested by the ECU
+ * Session and security access are hooks for the caller, see can_interact_uds_session and can_interact_uds_security
+ * For the CXX API, see can_interact_uds.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifndef CAN_INTERACT_UDS_MAX_BLOCK
+#define CAN_INTERACT_UDS_MAX_BLOCK 4095 /* largest TransferData request (including SID and counter), the classical ISO-TP limit */
+#endif /* CAN_INTERACT_UDS_MAX_BLOCK */
+
+#define CAN_INTERACT_UDS_MAX_RESPONSE 512 /* responses to download services are short */
+
+#define CAN_INTERACT_UDS_NRC_PENDING 0x78 /* requestCorrectlyReceived-ResponsePending */
+
+struct can_interact_uds_config {
+	/**
+	 * @brief struct can_interact_uds_config - addressing, timing and transport settings
+	 */
+	canid_t tx_id; /* physical request identifier (including CAN_EFF_FLAG for extended identifiers) */
+	canid_t rx_id; /* response identifier */
+	uint32_t p2_ms; /* response timeout, 0 for 50ms */
+	uint32_t p2_star_ms; /* response timeout after response pending, 0 for 5000ms */
+	int32_t tx_stmin_ns; /* separation time forced on own consecutive frames regardless of the ECU's flow control, -1 to honour the ECU */
+	uint32_t frame_txtime_ns; /* gap the kernel inserts between own frames, 0 for none */
+	uint8_t block_size; /* block size announced in own flow control, 0 for no further flow control */
+	uint8_t stmin; /* separation time announced in own flow control (ISO-TP encoding) */
+	uint8_t fd; /* CAN FD link layer, with bit rate switch */
+	uint8_t tx_dl; /* CAN FD frame length 8, 12, 16, 20, 24, 32, 48 or 64, 0 for 64 */
+	int16_t padding; /* byte to pad frames with, -1 for no padding */
+};
+
+struct can_interact_uds_stats {
+	/**
+	 * @brief struct can_interact_uds_stats - results of a download
+	 */
+	struct can_interact_hist latency; /* per TransferData round trip in nanoseconds */
+	uint64_t bytes; /* payload transferred */
+	uint64_t blocks; /* TransferData requests */
+	uint64_t pending; /* response pending (0x78) answers */
+	uint64_t elapsed_ns; /* from RequestDownload until RequestTransferExit was answered */
+	size_t block_len; /* negotiated TransferData request length (payload is 2 bytes less) */
+};
+
+/**
+ * @brief can_interact_uds_source - callback filling the next part of a download
+ * @param uint8_t* - buffer to fill
+ * @param const size_t - bytes requested (less for the last block)
+ * @param const uint64_t - offset of the part within the download
+ * @param void* - user context
+ * @return int - 0 on success, a non-zero errno code aborts the download
+ */
+typedef int (*can_interact_uds_source)(uint8_t *buffer, const size_t len, const uint64_t offset, void *ctx);
+
+/**
+ * @brief can_interact_uds_key - security access hook computing the key for a seed
+ * @param const uint8_t - security level of the seed request (odd)
+ * @param const uint8_t* - seed
+ * @param const size_t - seed length
+ * @param uint8_t* - buffer to write key to
+ * @param size_t* - capacity of buffer on entry, key length to write
+ * @param void* - user context
+ * @return int - 0 on success, a non-zero errno code aborts security access
+ */
+typedef int (*can_interact_uds_key)(const uint8_t level, const uint8_t *seed, const size_t seed_len, uint8_t *key, size_t *key_len, void *ctx);
+
+struct can_interact_uds {
+	/**
+	 * @brief struct can_interact_uds - client state, see can_interact_uds_init
+	 */
+	uint8_t block[2][CAN_INTERACT_UDS_MAX_BLOCK]; /* TransferData requests, filled alternately */
+	uint8_t response[CAN_INTERACT_UDS_MAX_RESPONSE];
+	uint32_t p2_ms;
+	uint32_t p2_star_ms;
+	uint64_t pending; /* response pending answers seen */
+	int socket;
+	uint8_t nrc; /* negative response code of last failed request, 0 if none */
+};
+
+/**
+ * @brief can_interact_uds_init - opens and configures ISO-TP socket between tester and ECU
+ *
+ * @param struct can_interact_uds* - client state to initialise
+ *
+ * @param const char* - CAN device name
+ *
+ * @param const struct can_interact_uds_config* - configuration
+ *
+ * @return int - error code
+ * Note: 0 on success, ENODEV if there is no such device, for other non-zero values refer to errno codes of socket, setsockopt and bind
+ * (e.g. EPROTONOSUPPORT without the can-isotp module)
+ */
+int can_interact_uds_init(struct can_interact_uds *uds, const char *device_name, const struct can_interact_uds_config *config);
+
+/**
+ * @brief can_interact_uds_request - sends request and waits for its final response
+ *
+ * @param struct can_interact_uds* - client
+ *
+ * @param const uint8_t* - request starting with service identifier
+ *
+ * @param const size_t - request length
+ *
+ * @param const uint8_t** - pointer to write pointer to positive response to (valid until the next request)
+ *
+ * @param size_t* - pointer to write response length to
+ *
+ * @return int - error code
+ * Responses to other services (e.g. late answers to a request that timed out) are skipped
+ * Note: 0 on positive response, EPROTO on negative response (code in uds->nrc), ETIMEDOUT if P2 / P2* expired,
+ * for other non-zero values refer to errno codes of send, recv and poll
+ */
+int can_interact_uds_request(struct can_interact_uds *uds, const uint8_t *request, const size_t len, const uint8_t **response, size_t *response_len);
+
+/**
+ * @brief can_interact_uds_session - DiagnosticSessionControl, taking over P2 / P2* announced by the ECU
+ *
+ * @param struct can_interact_uds* - client
+ *
+ * @param const uint8_t - session, e.g. 0x02 programming or 0x03 extended
+ *
+ * @return int - error code
+ * Note: see can_interact_uds_request
+ */
+int can_interact_uds_session(struct can_interact_uds *uds, const uint8_t session);
+
+/**
+ * @brief can_interact_uds_security - SecurityAccess seed / key exchange
+ *
+ * @param struct can_interact_uds* - client
+ *
+ * @param const uint8_t - security level (odd requestSeed sub-function, the key is sent with level + 1)
+ *
+ * @param const can_interact_uds_key - hook computing the key (not called if the ECU is already unlocked, i.e. sends a zero seed)
+ *
+ * @param void* - user context passed to hook
+ *
+ * @return int - error code
+ * Note: see can_interact_uds_request, EINVAL for an even level, or the error code of the hook
+ */
+int can_interact_uds_security(struct can_interact_uds *uds, const uint8_t level, const can_interact_uds_key key, void *ctx);
+
+/**
+ * @brief can_interact_uds_download - transfers data into ECU memory (RequestDownload, TransferData, RequestTransferExit)
+ *
+ * @param struct can_interact_uds* - client
+ *
+ * @param const uint32_t - memory address
+ *
+ * @param const uint32_t - size in bytes
+ *
+ * @param const uint8_t - dataFormatIdentifier (compression / encryption method, 0x00 for plain data)
+ *
+ * @param const can_interact_uds_source - callback providing the data
+ *
+ * @param void* - user context passed to callback
+ *
+ * @param struct can_interact_uds_stats* - results to write to, may be NULL
+ *
+ * @return int - error code
+ * Note: see can_interact_uds_request, EPROTO also for an unusable block length, or the error code of the callback
+ */
+int can_interact_uds_download(struct can_interact_uds *uds, const uint32_t address, const uint32_t size, const uint8_t format, const can_interact_uds_source source, void *ctx, struct can_interact_uds_stats *stats);
+
+/**
+ * @brief can_interact_uds_fini - closes ISO-TP socket
+ *
+ * @param struct can_interact_uds* - client
+ */
+void can_interact_uds_fini(struct can_interact_uds *uds);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_UDS_H */
@@ -0,0 +1,253 @@
+#ifndef CAN_INTERACT_UDS_HH
+#define CAN_INTERACT_UDS_HH
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+#include <utility>
+#include <exception>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+#include "can_interact.hh"
+#include "can_interact_uds.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact UDS flash download client
+ * For declarations for the native C library, see can_interact_uds.h
+ */
+
+namespace can_interact {
+
+	class UdsClient {
+		/**
+		  * @brief UdsClient (class) - UDS tester on a kernel ISO-TP socket, downloading into ECU memory
+		  */
+		public:
+			typedef can_interact_uds_config config_t ;
+			typedef can_interact_uds_stats stats_t ;
+			typedef std::function<std::vector<std::uint8_t>(const std::uint8_t, const std::vector<std::uint8_t>&)> key_t ;
+
+		private:
+			std::unique_ptr<can_interact_uds> _uds ;
+			std::exception_ptr _exception ;
+
+			/**
+			  * @brief check - INTERNAL METHOD. throws for error code of C API, rethrowing exceptions of hooks first
+			  */
+			void check(const int, const char*) noexcept(false) ;
+
+			/**
+			  * @brief source - INTERNAL METHOD. copies download data from the buffer passed to download
+			  */
+			static int source(std::uint8_t*, const std::size_t, const std::uint64_t, void*) noexcept ;
+
+			/**
+			  * @brief key - INTERNAL METHOD. calls key hook passed to security
+			  */
+			static int key(const std::uint8_t, const std::uint8_t*, const std::size_t, std::uint8_t*, std::size_t*, void*) noexcept ;
+
+		public:
+			/**
+			  * @brief UdsClient (constructor) - opens ISO-TP socket between tester and ECU
+			  * @param const std::string& - CAN device name
+			  * @param const config_t& - identifiers, P2 / P2* and transport settings (see can_interact_uds.h)
+			  * @throws std::invalid_argument - if there is no such device
+			  * @throws std::runtime_error - on errors reported by errno (e.g. without the can-isotp module)
+			  */
+			UdsClient(const std::string&, const config_t&) noexcept(false) ;
+
+			UdsClient(UdsClient&&) noexcept = default ;
+			UdsClient& operator=(UdsClient&&) noexcept = default ;
+
+			/**
+			  * @brief request - sends request and waits for its final response, waiting P2* while the ECU answers response pending
+			  * @param const std::vector<std::uint8_t>& - request starting with service identifier
+			  * @return std::vector<std::uint8_t> - positive response
+			  * @throws std::invalid_argument - if request is empty
+			  * @throws std::runtime_error - on negative response (including the code), timeout or errors reported by errno
+			  */
+			std::vector<std::uint8_t> request(const std::vector<std::uint8_t>&) noexcept(false) ;
+
+			/**
+			  * @brief session - DiagnosticSessionControl, taking over P2 / P2* announced by the ECU
+			  * @param const std::uint8_t - session, e.g. 0x02 programming or 0x03 extended
+			  * @throws std::runtime_error - see request
+			  */
+			void session(const std::uint8_t) noexcept(false) ;
+
+			/**
+			  * @brief security - SecurityAccess seed / key exchange
+			  * @param const std::uint8_t - security level (odd requestSeed sub-function)
+			  * @param const key_t& - hook computing the key from level and seed (not called if the ECU sends a zero seed)
+			  * @throws std::invalid_argument - if level is even
+			  * @throws std::runtime_error - see request, exceptions of the hook are rethrown
+			  */
+			void security(const std::uint8_t, const key_t&) noexcept(false) ;
+
+			/**
+			  * @brief download - transfers data into ECU memory (RequestDownload, TransferData, RequestTransferExit)
+			  * @param const std::uint32_t - memory address
+			  * @param const std::uint8_t* - data
+			  * @param const std::uint32_t - size in bytes
+			  * @param const std::uint8_t - dataFormatIdentifier, 0x00 for plain data
+			  * @return stats_t - per block latency, negotiated block length, bytes and elapsed time (see throughput)
+			  * @throws std::runtime_error - see request, also if the ECU offers an unusable block length
+			  */
+			stats_t download(const std::uint32_t, const std::uint8_t*, const std::uint32_t, const std::uint8_t = 0) noexcept(false) ;
+
+			/**
+			  * @brief download - transfers data into ECU memory, see above
+			  * @param const std::uint32_t - memory address
+			  * @param const std::vector<std::uint8_t>& - data
+			  * @param const std::uint8_t - dataFormatIdentifier, 0x00 for plain data
+			  * @return stats_t - see above
+			  * @throws std::invalid_argument - if data exceeds 4 GiB
+			  * @throws std::runtime_error - see above
+			  */
+			stats_t download(const std::uint32_t, const std::vector<std::uint8_t>&, const std::uint8_t = 0) noexcept(false) ;
+
+			/**
+			  * @brief throughput - payload rate of a download
+			  * @param const stats_t& - results of download
+			  * @return double - bytes per second, 0 if nothing was transferred
+			  */
+			static double throughput(const stats_t&) noexcept ;
+
+			~UdsClient() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			UdsClient(const UdsClient&) = delete ;
+			UdsClient& operator=(const UdsClient&) = delete ;
+			UdsClient() = delete ;
+	} ;
+
+}
+
+can_interact::UdsClient::UdsClient(const std::string& device_name, const config_t& config) noexcept(false) : _uds{new can_interact_uds}
+{
+	const int res = can_interact_uds_init(this->_uds.get(), device_name.c_str(), &config) ;
+	if(res == ENODEV)
+	{
+		throw std::invalid_argument(std::string{"No CAN device "} + device_name) ;
+	}
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+void can_interact::UdsClient::check(const int res, const char* service) noexcept(false)
+{
+	char nrc[8] ;
+
+	if(this->_exception)
+	{
+		std::exception_ptr exception = this->_exception ;
+		this->_exception = nullptr ;
+		std::rethrow_exception(exception) ;
+	}
+	if(res == EPROTO && this->_uds->nrc != 0)
+	{
+		std::snprintf(nrc, sizeof(nrc), "0x%02X", this->_uds->nrc) ;
+		throw std::runtime_error(std::string{service} + " failed with negative response " + nrc) ;
+	}
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{service} + ": Errno " + std::to_string(res)) ;
+	}
+}
+
+int can_interact::UdsClient::source(std::uint8_t* buffer, const std::size_t len, const std::uint64_t offset, void* ctx) noexcept
+{
+	std::memcpy(buffer, static_cast<const std::uint8_t*>(ctx) + offset, len) ;
+	return 0 ;
+}
+
+int can_interact::UdsClient::key(const std::uint8_t level, const std::uint8_t* seed, const std::size_t seed_len, std::uint8_t* key, std::size_t* key_len, void* ctx) noexcept
+{
+	std::pair<UdsClient*, const key_t*>& hook = *static_cast<std::pair<UdsClient*, const key_t*>*>(ctx) ;
+	try
+	{
+		const std::vector<std::uint8_t> computed = (*hook.second)(level, std::vector<std::uint8_t>(seed, seed + seed_len)) ;
+		if(computed.size() > *key_len)
+		{
+			throw std::length_error("Security access key is too long") ;
+		}
+		std::memcpy(key, computed.data(), computed.size()) ;
+		*key_len = computed.size() ;
+		return 0 ;
+	}
+	catch(...) // must not unwind through C
+	{
+		hook.first->_exception = std::current_exception() ;
+		return ECANCELED ;
+	}
+}
+
+std::vector<std::uint8_t> can_interact::UdsClient::request(const std::vector<std::uint8_t>& request) noexcept(false)
+{
+	const std::uint8_t* response ;
+	std::size_t len ;
+
+	if(request.empty())
+	{
+		throw std::invalid_argument("UDS request must contain a service identifier") ;
+	}
+	this->check(can_interact_uds_request(this->_uds.get(), request.data(), request.size(), &response, &len), "UDS request") ;
+	return std::vector<std::uint8_t>(response, response + len) ;
+}
+
+void can_interact::UdsClient::session(const std::uint8_t session) noexcept(false)
+{
+	this->check(can_interact_uds_session(this->_uds.get(), session), "DiagnosticSessionControl") ;
+}
+
+void can_interact::UdsClient::security(const std::uint8_t level, const key_t& hook) noexcept(false)
+{
+	std::pair<UdsClient*, const key_t*> ctx{this, &hook} ;
+
+	if((level & 1u) == 0)
+	{
+		throw std::invalid_argument("Security access level must be odd (requestSeed)") ;
+	}
+	this->check(can_interact_uds_security(this->_uds.get(), level, &UdsClient::key, &ctx), "SecurityAccess") ;
+}
+
+can_interact::UdsClient::stats_t can_interact::UdsClient::download(const std::uint32_t address, const std::uint8_t* data, const std::uint32_t size, const std::uint8_t format) noexcept(false)
+{
+	stats_t stats ;
+
+	this->check(can_interact_uds_download(this->_uds.get(), address, size, format, &UdsClient::source, const_cast<std::uint8_t*>(data), &stats), "Download") ;
+	return stats ;
+}
+
+can_interact::UdsClient::stats_t can_interact::UdsClient::download(const std::uint32_t address, const std::vector<std::uint8_t>& data, const std::uint8_t format) noexcept(false)
+{
+	if(data.size() > UINT32_MAX)
+	{
+		throw std::invalid_argument("UDS download is limited to 4 GiB") ;
+	}
+	return this->download(address, data.data(), static_cast<std::uint32_t>(data.size()), format) ;
+}
+
+double can_interact::UdsClient::throughput(const stats_t& stats) noexcept
+{
+	return stats.elapsed_ns == 0 ? 0.0 : static_cast<double>(stats.bytes) * 1e9 / static_cast<double>(stats.elapsed_ns) ;
+}
+
+can_interact::UdsClient::~UdsClient() noexcept
+{
+	if(this->_uds)
+	{
+		can_interact_uds_fini(this->_uds.get()) ;
+	}
+}
+
+#endif // CAN_INTERACT_UDS_HH
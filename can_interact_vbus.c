@@ -0,0 +1,529 @@
+#define _DEFAULT_SOURCE
+
+#include <stddef.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/error.h>
+
+#include "can_interact_vbus.h"
+
+/**
+ * @brief C-style definitions of the virtual CAN bus
+ * For definitions for the CXX API, see can_interact_vbus.hh
+ */
+
+/**
+ * @brief _p_can_interact_vbus_monotonic - INTERNAL METHOD. current CLOCK_MONOTONIC time
+ * @return uint64_t - nanoseconds
+ */
+static uint64_t _p_can_interact_vbus_monotonic(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief _p_can_interact_vbus_sleep_until - INTERNAL METHOD. sleeps until CLOCK_MONOTONIC time
+ * @param const uint64_t - nanoseconds
+ */
+static void _p_can_interact_vbus_sleep_until(const uint64_t deadline)
+{
+	struct timespec ts;
+
+	ts.tv_sec = (time_t)(deadline / 1000000000u);
+	ts.tv_nsec = (long)(deadline % 1000000000u);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+	}
+}
+
+/**
+ * @brief _p_can_interact_vbus_chance - INTERNAL METHOD. draws from fault generator (xorshift64*)
+ * @param struct can_interact_vbus* - bus
+ * @param const uint32_t - probability in parts per million
+ * @return int - 1 with given probability, else 0
+ */
+static int _p_can_interact_vbus_chance(struct can_interact_vbus *bus, const uint32_t ppm)
+{
+	uint64_t x = bus->random;
+
+	if (ppm == 0) {
+		return 0;
+	}
+	x ^= x >> 12;
+	x ^= x << 25;
+	x ^= x >> 27;
+	bus->random = x;
+	x *= (uint64_t)0x2545F491u << 32 | 0x4F6CDD1Du;
+	return (uint32_t)((x >> 32) % 1000000u) < ppm;
+}
+
+/**
+ * @brief _p_can_interact_vbus_push - INTERNAL METHOD. appends bits of field, most significant first
+ * @param uint8_t* - bit array
+ * @param unsigned int* - number of bits in array
+ * @param const uint32_t - field
+ * @param const unsigned int - width of field
+ */
+static void _p_can_interact_vbus_push(uint8_t *bits, unsigned int *len, const uint32_t field, const unsigned int width)
+{
+	unsigned int i;
+
+	for (i = width; i > 0; --i) {
+		bits[(*len)++] = (uint8_t)((field >> (i - 1u)) & 1u);
+	}
+}
+
+/**
+ * @brief _p_can_interact_vbus_bits - INTERNAL METHOD. length of frame on the wire, from start of frame through interframe space
+ * Builds the stuffed part (start of frame up to CRC) bit by bit to count its stuff bits exactly
+ * @param const struct can_frame* - frame
+ * @return unsigned int - bits
+ */
+static unsigned int _p_can_interact_vbus_bits(const struct can_frame *frame)
+{
+	uint8_t bits[128];
+	const uint32_t rtr = frame->can_id & CAN_RTR_FLAG ? 1u : 0u;
+	const unsigned int bytes = rtr || frame->can_dlc > 8 ? 0u : frame->can_dlc;
+	unsigned int len = 0, i, run, stuffed = 0;
+	uint16_t crc = 0;
+	uint8_t prev;
+
+	_p_can_interact_vbus_push(bits, &len, 0, 1); /* start of frame */
+	if (frame->can_id & CAN_EFF_FLAG) {
+		_p_can_interact_vbus_push(bits, &len, (frame->can_id & CAN_EFF_MASK) >> 18, 11);
+		_p_can_interact_vbus_push(bits, &len, 3, 2); /* SRR, IDE */
+		_p_can_interact_vbus_push(bits, &len, frame->can_id & 0x3FFFFu, 18);
+		_p_can_interact_vbus_push(bits, &len, rtr, 1);
+		_p_can_interact_vbus_push(bits, &len, 0, 2); /* r1, r0 */
+	} else {
+		_p_can_interact_vbus_push(bits, &len, frame->can_id & CAN_SFF_MASK, 11);
+		_p_can_interact_vbus_push(bits, &len, rtr, 1);
+		_p_can_interact_vbus_push(bits, &len, 0, 2); /* IDE, r0 */
+	}
+	_p_can_interact_vbus_push(bits, &len, frame->can_dlc & 0xFu, 4);
+	for (i = 0; i < bytes; ++i) {
+		_p_can_interact_vbus_push(bits, &len, frame->data[i], 8);
+	}
+	for (i = 0; i < len; ++i) { /* CRC-15, polynomial 0x4599 */
+		crc = (uint16_t)(((crc << 1) & 0x7FFFu) ^ ((bits[i] ^ (crc >> 14)) & 1u ? 0x4599u : 0u));
+	}
+	_p_can_interact_vbus_push(bits, &len, crc, 15);
+
+	prev = bits[0];
+	run = 1;
+	for (i = 1; i < len; ++i) {
+		if (bits[i] == prev) {
+			++run;
+		} else {
+			prev = bits[i];
+			run = 1;
+		}
+		if (run == 5) { /* stuff bit of opposite value starts the next run */
+			++stuffed;
+			prev = (uint8_t)!prev;
+			run = 1;
+		}
+	}
+	return len + stuffed + 13u; /* CRC delimiter, ACK slot and delimiter, end of frame, interframe space */
+}
+
+/**
+ * @brief _p_can_interact_vbus_arbitration - INTERNAL METHOD. arbitration field as a number, lower values win
+ * Standard and extended frames line up on the 11 bit base identifier, followed by RTR / SRR, IDE, identifier extension and RTR
+ * @param const canid_t - identifier with flags
+ * @return uint32_t - arbitration value
+ */
+static uint32_t _p_can_interact_vbus_arbitration(const canid_t id)
+{
+	const uint32_t rtr = id & CAN_RTR_FLAG ? 1u : 0u;
+
+	if (id & CAN_EFF_FLAG) {
+		return ((id & CAN_EFF_MASK) >> 18) << 21 | 3u << 19 | (id & 0x3FFFFu) << 1 | rtr;
+	}
+	return (id & CAN_SFF_MASK) << 21 | rtr << 20;
+}
+
+int can_interact_vbus_init(struct can_interact_vbus *bus, const enum can_interact_vbus_mode mode, const uint32_t bitrate)
+{
+	if (bitrate == 0) {
+		return EINVAL;
+	}
+	memset(bus, 0, sizeof(struct can_interact_vbus));
+	bus->mode = mode;
+	bus->bitrate = bitrate;
+	bus->random = 1;
+	bus->now_ns = mode == VBUS_REAL_TIME ? _p_can_interact_vbus_monotonic() : 0;
+	return 0;
+}
+
+int can_interact_vbus_attach(struct can_interact_vbus *bus, int *socket, size_t *node)
+{
+	int pair[2];
+
+	if (bus->count == CAN_INTERACT_VBUS_MAX_NODES) {
+		return ENOSPC;
+	}
+	if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, pair) == -1) {
+		return (int)errno;
+	}
+	if (fcntl(pair[1], F_SETFL, fcntl(pair[1], F_GETFL) | O_NONBLOCK) == -1) {
+		close(pair[0]);
+		close(pair[1]);
+		return (int)errno;
+	}
+	memset(&bus->nodes[bus->count], 0, sizeof(struct can_interact_vbus_node));
+	bus->nodes[bus->count].socket = pair[1];
+	*socket = pair[0];
+	if (node != NULL) {
+		*node = bus->count;
+	}
+	++bus->count;
+	return 0;
+}
+
+int can_interact_vbus_filter(struct can_interact_vbus *bus, const size_t node, const canid_t *ids, const size_t len)
+{
+	if (node >= bus->count) {
+		return EINVAL;
+	}
+	if (len > CAN_INTERACT_VBUS_MAX_FILTERS) {
+		return E2BIG;
+	}
+	memcpy(bus->nodes[node].filters, ids, len * sizeof(canid_t));
+	bus->nodes[node].filter_len = len;
+	return 0;
+}
+
+int can_interact_vbus_error_reports(struct can_interact_vbus *bus, const size_t node, const int enable)
+{
+	if (node >= bus->count) {
+		return EINVAL;
+	}
+	bus->nodes[node].error_reports = (uint8_t)(enable != 0);
+	return 0;
+}
+
+void can_interact_vbus_inject(struct can_interact_vbus *bus, const struct can_interact_vbus_faults *faults)
+{
+	bus->faults = *faults;
+	bus->random = faults->seed != 0 ? faults->seed : 1; /* xorshift never leaves 0 */
+}
+
+/**
+ * @brief _p_can_interact_vbus_report - INTERNAL METHOD. delivers error frame to node if it asked for them
+ * @param struct can_interact_vbus_node* - node
+ * @param const canid_t - error class (CAN_ERR_*)
+ * @param const uint8_t - byte 1 (controller status)
+ * @param const uint8_t - byte 2 (protocol violation type)
+ */
+static void _p_can_interact_vbus_report(struct can_interact_vbus_node *node, const canid_t error, const uint8_t controller, const uint8_t protocol)
+{
+	struct can_frame frame;
+
+	if (!node->error_reports || node->socket == -1) {
+		return;
+	}
+	memset(&frame, 0, sizeof(frame));
+	frame.can_id = CAN_ERR_FLAG | error;
+	frame.can_dlc = CAN_ERR_DLC;
+	frame.data[1] = controller;
+	frame.data[2] = protocol;
+	send(node->socket, &frame, sizeof(frame), MSG_DONTWAIT);
+}
+
+int can_interact_vbus_bus_off(struct can_interact_vbus *bus, const size_t node)
+{
+	if (node >= bus->count) {
+		return EINVAL;
+	}
+
+	bus->nodes[node].bus_off = 1;
+	bus->nodes[node].full = 0;
+	_p_can_interact_vbus_report(&bus->nodes[node], CAN_ERR_BUSOFF, 0, 0);
+	return 0;
+}
+
+int can_interact_vbus_restart(struct can_interact_vbus *bus, const size_t node)
+{
+	if (node >= bus->count) {
+		return EINVAL;
+	}
+
+	bus->nodes[node].bus_off = 0;
+	bus->nodes[node].tec = 0;
+	bus->nodes[node].rec = 0;
+	_p_can_interact_vbus_report(&bus->nodes[node], CAN_ERR_RESTARTED, 0, 0);
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_vbus_fill - INTERNAL METHOD. takes next sent frame of node into its empty mailbox, discarding frames while bus-off
+ * @param struct can_interact_vbus* - bus
+ * @param struct can_interact_vbus_node* - node
+ * @return int - 0 on success, else errno code of recv
+ */
+static int _p_can_interact_vbus_fill(struct can_interact_vbus *bus, struct can_interact_vbus_node *node)
+{
+	struct canfd_frame frame; /* larger than struct can_frame, so CAN FD frames show up by their size and are skipped */
+	ssize_t res;
+
+	while (!node->full && node->socket != -1) {
+		res = recv(node->socket, &frame, sizeof(frame), MSG_DONTWAIT);
+		if (res == -1) {
+			return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : (int)errno;
+		}
+		if (res == 0) { /* application closed its socket, stop polling it (it would stay readable) */
+			close(node->socket);
+			node->socket = -1;
+			return 0;
+		}
+		if (res != (ssize_t)sizeof(struct can_frame)) {
+			continue;
+		}
+		if (node->bus_off) {
+			++node->stats.tx_discarded;
+			continue;
+		}
+		memcpy(&node->mailbox, &frame, sizeof(struct can_frame));
+		node->queued_ns = bus->now_ns;
+		node->full = 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_vbus_accepts - INTERNAL METHOD. checks filter of node
+ * @param const struct can_interact_vbus_node* - node
+ * @param const canid_t - identifier of frame
+ * @return int - 1 if node receives frame, else 0
+ */
+static int _p_can_interact_vbus_accepts(const struct can_interact_vbus_node *node, const canid_t id)
+{
+	size_t i;
+
+	if (node->filter_len == 0) {
+		return 1;
+	}
+	for (i = 0; i < node->filter_len; ++i) {
+		if (node->filters[i] == id) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief _p_can_interact_vbus_error - INTERNAL METHOD. applies destroyed transmission to error counters, frame stays in mailbox for retransmission
+ * @param struct can_interact_vbus* - bus
+ * @param const size_t - transmitting node
+ */
+static void _p_can_interact_vbus_error(struct can_interact_vbus *bus, const size_t sender)
+{
+	struct can_interact_vbus_node *node = &bus->nodes[sender];
+	size_t i;
+
+	++node->stats.tx_errors;
+	for (i = 0; i < bus->count; ++i) {
+		if (i != sender && !bus->nodes[i].bus_off && bus->nodes[i].rec < 255) {
+			++bus->nodes[i].rec;
+		}
+		if (!bus->nodes[i].bus_off) {
+			_p_can_interact_vbus_report(&bus->nodes[i], CAN_ERR_PROT, 0, CAN_ERR_PROT_FORM);
+		}
+	}
+	node->tec = (uint16_t)(node->tec + 8u);
+	if (node->tec > 255) {
+		can_interact_vbus_bus_off(bus, sender);
+	} else if (node->tec >= 128 && node->tec - 8u < 128) {
+		_p_can_interact_vbus_report(node, CAN_ERR_CRTL, CAN_ERR_CRTL_TX_PASSIVE, 0);
+	}
+}
+
+/**
+ * @brief _p_can_interact_vbus_deliver - INTERNAL METHOD. hands transmitted frame to every other node
+ * @param struct can_interact_vbus* - bus
+ * @param const size_t - transmitting node
+ */
+static void _p_can_interact_vbus_deliver(struct can_interact_vbus *bus, const size_t sender)
+{
+	const struct can_frame *frame = &bus->nodes[sender].mailbox;
+	struct can_interact_vbus_node *node;
+	size_t i;
+
+	for (i = 0; i < bus->count; ++i) {
+		node = &bus->nodes[i];
+		if (i == sender || node->bus_off || node->socket == -1 || !_p_can_interact_vbus_accepts(node, frame->can_id)) {
+			continue;
+		}
+		if (_p_can_interact_vbus_chance(bus, bus->faults.drop_ppm)
+				|| send(node->socket, frame, sizeof(struct can_frame), MSG_DONTWAIT) != (ssize_t)sizeof(struct can_frame)) {
+			++node->stats.rx_dropped;
+			continue;
+		}
+		++node->stats.rx_frames;
+		if (node->rec > 0) {
+			--node->rec;
+		}
+	}
+}
+
+int can_interact_vbus_step(struct can_interact_vbus *bus, int *transmitted)
+{
+	struct can_interact_vbus_node *node;
+	uint64_t now, duration, latency;
+	uint32_t key, best_key = 0;
+	size_t i, winner = bus->count;
+	unsigned int bits;
+	int res, error;
+
+	*transmitted = 0;
+	if (bus->mode == VBUS_REAL_TIME) {
+		now = _p_can_interact_vbus_monotonic();
+		if (now > bus->now_ns) { /* bus was idle meanwhile */
+			bus->now_ns = now;
+		}
+	}
+	for (i = 0; i < bus->count; ++i) {
+		res = _p_can_interact_vbus_fill(bus, &bus->nodes[i]);
+		if (res != 0) {
+			return res;
+		}
+		if (bus->nodes[i].full) { /* lowest arbitration field wins, lowest node on identical fields */
+			key = _p_can_interact_vbus_arbitration(bus->nodes[i].mailbox.can_id);
+			if (winner == bus->count || key < best_key) {
+				winner = i;
+				best_key = key;
+			}
+		}
+	}
+	if (winner == bus->count) {
+		return 0;
+	}
+
+	node = &bus->nodes[winner];
+	bits = _p_can_interact_vbus_bits(&node->mailbox);
+	error = _p_can_interact_vbus_chance(bus, bus->faults.error_ppm);
+	if (error) {
+		bits = bits / 2u + 17u; /* detected mid frame on average, then error flag, delimiter and interframe space */
+	}
+	duration = (uint64_t)bits * 1000000000u / bus->bitrate;
+	bus->now_ns += duration;
+	if (bus->mode == VBUS_REAL_TIME) {
+		_p_can_interact_vbus_sleep_until(bus->now_ns);
+	}
+	node->stats.busy_ns += duration;
+	*transmitted = 1;
+
+	if (error) {
+		_p_can_interact_vbus_error(bus, winner);
+		return 0;
+	}
+	if (node->tec > 0) {
+		--node->tec;
+	}
+	++node->stats.tx_frames;
+	latency = bus->now_ns - node->queued_ns;
+	node->stats.latency_total_ns += latency;
+	if (latency > node->stats.latency_max_ns) {
+		node->stats.latency_max_ns = latency;
+	}
+	_p_can_interact_vbus_deliver(bus, winner);
+	node->full = 0;
+	return 0;
+}
+
+int can_interact_vbus_wait(const struct can_interact_vbus *bus, const int timeout_ms)
+{
+	struct pollfd fds[CAN_INTERACT_VBUS_MAX_NODES];
+	size_t i;
+	int res;
+
+	for (i = 0; i < bus->count; ++i) {
+		if (bus->nodes[i].full) {
+			return 0;
+		}
+		fds[i].fd = bus->nodes[i].socket; /* poll skips detached nodes (-1) */
+		fds[i].events = POLLIN;
+		fds[i].revents = 0;
+	}
+	res = poll(fds, (nfds_t)bus->count, timeout_ms);
+	if (res == -1) {
+		return errno == EINTR ? ETIMEDOUT : (int)errno;
+	}
+	return res == 0 ? ETIMEDOUT : 0;
+}
+
+int can_interact_vbus_run(struct can_interact_vbus *bus, const volatile sig_atomic_t *stop)
+{
+	int transmitted, res;
+
+	while (stop == NULL || !*stop) {
+		res = can_interact_vbus_step(bus, &transmitted);
+		if (res != 0) {
+			return res;
+		}
+		if (transmitted) {
+			continue;
+		}
+		if (bus->mode == VBUS_VIRTUAL_TIME) {
+			return 0;
+		}
+		res = can_interact_vbus_wait(bus, 100);
+		if (res != 0 && res != ETIMEDOUT) {
+			return res;
+		}
+	}
+	return 0;
+}
+
+int can_interact_vbus_get_stats(const struct can_interact_vbus *bus, const size_t node, struct can_interact_vbus_stats *stats)
+{
+	const struct can_interact_vbus_stats *source;
+	size_t i;
+
+	if (node < bus->count) {
+		*stats = bus->nodes[node].stats;
+		return 0;
+	}
+	if (node > bus->count) {
+		return EINVAL;
+	}
+	memset(stats, 0, sizeof(struct can_interact_vbus_stats));
+	for (i = 0; i < bus->count; ++i) {
+		source = &bus->nodes[i].stats;
+		stats->tx_frames += source->tx_frames;
+		stats->tx_errors += source->tx_errors;
+		stats->tx_discarded += source->tx_discarded;
+		stats->rx_frames += source->rx_frames;
+		stats->rx_dropped += source->rx_dropped;
+		stats->latency_total_ns += source->latency_total_ns;
+		stats->busy_ns += source->busy_ns;
+		if (source->latency_max_ns > stats->latency_max_ns) {
+			stats->latency_max_ns = source->latency_max_ns;
+		}
+	}
+	return 0;
+}
+
+void can_interact_vbus_fini(struct can_interact_vbus *bus)
+{
+	size_t i;
+
+	for (i = 0; i < bus->count; ++i) {
+		if (bus->nodes[i].socket != -1) {
+			close(bus->nodes[i].socket);
+		}
+	}
+	bus->count = 0;
+}
@@ -0,0 +1,248 @@
+#ifndef CAN_INTERACT_VBUS_H
+#define CAN_INTERACT_VBUS_H
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <signal.h>
+#include <linux/can.h>
+
+#include "can_interact.h"
+
+/**
+ * @brief C-style in-process virtual CAN bus, for tests and benchmarks on machines without SocketCAN (or the vcan module)
+ * Every attached node is the application end of an AF_UNIX SOCK_SEQPACKET socket pair carrying struct can_frame records, so it works in
+ * place of a real socket with can_interact_get_frame(s), can_interact_send_frame(s) and can_interact_fini (but not can_interact_filter,
+ * see can_interact_vbus_filter). The bus keeps the other ends: each step it takes the next frame of every node into that node's single
+ * transmit mailbox, lets the lowest arbitration field win as on a real bus, occupies the bus for the frame's exact length in bits (including
+ * stuff bits) at the configured bitrate and then hands the frame to every other node
+ * In VBUS_VIRTUAL_TIME mode bus time jumps from frame to frame, so runs are fast and reproducible. In VBUS_REAL_TIME mode each frame ends
+ * after its real duration on CLOCK_MONOTONIC, so throughput and latency match a real bus of that bitrate
+ * Faults are drawn from a seeded generator: dropped receptions (e.g. receive overflow), transmission errors (error frame, retransmission,
+ * error counters with error passive and bus-off) and forced bus-off
+ * For the CXX API, see can_interact_vbus.hh
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#ifndef CAN_INTERACT_VBUS_MAX_NODES
+#define CAN_INTERACT_VBUS_MAX_NODES 16
+#endif /* CAN_INTERACT_VBUS_MAX_NODES */
+
+#ifndef CAN_INTERACT_VBUS_MAX_FILTERS
+#define CAN_INTERACT_VBUS_MAX_FILTERS 32 /* identifiers per node filter */
+#endif /* CAN_INTERACT_VBUS_MAX_FILTERS */
+
+enum can_interact_vbus_mode {
+    VBUS_VIRTUAL_TIME = 0,
+    VBUS_REAL_TIME
+};
+
+struct can_interact_vbus_faults {
+	/**
+	 * @brief struct can_interact_vbus_faults - fault injection rates
+	 */
+	uint32_t drop_ppm; /* per receiving node and frame, parts per million */
+	uint32_t error_ppm; /* per transmission attempt, parts per million */
+	uint64_t seed; /* of the fault generator, same seed gives same faults */
+};
+
+struct can_interact_vbus_stats {
+	/**
+	 * @brief struct can_interact_vbus_stats - counters of a node, or summed over the bus
+	 */
+	uint64_t tx_frames; /* frames won arbitration and transmitted */
+	uint64_t tx_errors; /* transmission attempts destroyed by injected errors */
+	uint64_t tx_discarded; /* frames discarded while bus-off */
+	uint64_t rx_frames;
+	uint64_t rx_dropped; /* by injected drops or full receive queues */
+	uint64_t latency_total_ns; /* from taking frame into mailbox until its transmission ended, over tx_frames */
+	uint64_t latency_max_ns;
+	uint64_t busy_ns; /* bus time spent on this node's transmissions (including errors) */
+};
+
+struct can_interact_vbus_node {
+	/**
+	 * @brief struct can_interact_vbus_node - INTERNAL. bus side of an attached node
+	 */
+	struct can_frame mailbox;
+	struct can_interact_vbus_stats stats;
+	uint64_t queued_ns; /* bus time at which mailbox was filled */
+	canid_t filters[CAN_INTERACT_VBUS_MAX_FILTERS];
+	size_t filter_len; /* 0 accepts all identifiers */
+	int socket; /* -1 once the application closed its end, the node is then detached */
+	uint16_t tec; /* transmit error counter */
+	uint16_t rec; /* receive error counter */
+	uint8_t full; /* mailbox holds a frame */
+	uint8_t bus_off;
+	uint8_t error_reports; /* deliver error frames (CAN_ERR_FLAG) to node */
+};
+
+struct can_interact_vbus {
+	/**
+	 * @brief struct can_interact_vbus - virtual bus state, see can_interact_vbus_init
+	 */
+	struct can_interact_vbus_node nodes[CAN_INTERACT_VBUS_MAX_NODES];
+	struct can_interact_vbus_faults faults;
+	enum can_interact_vbus_mode mode;
+	uint64_t now_ns; /* bus time at which the bus is free again (CLOCK_MONOTONIC in VBUS_REAL_TIME mode) */
+	uint64_t random;
+	uint32_t bitrate;
+	size_t count;
+};
+
+/**
+ * @brief can_interact_vbus_init - initialises bus without nodes and faults
+ *
+ * @param struct can_interact_vbus* - bus to initialise
+ *
+ * @param const enum can_interact_vbus_mode - VBUS_VIRTUAL_TIME or VBUS_REAL_TIME
+ *
+ * @param const uint32_t - bitrate in bit/s
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if bitrate is 0
+ */
+int can_interact_vbus_init(struct can_interact_vbus *bus, const enum can_interact_vbus_mode mode, const uint32_t bitrate);
+
+/**
+ * @brief can_interact_vbus_attach - connects new node to bus
+ *
+ * @param struct can_interact_vbus* - bus
+ *
+ * @param int* - pointer to write application side socket to, close it with can_interact_fini (which detaches the node)
+ *
+ * @param size_t* - pointer to write index of node to, may be NULL
+ *
+ * @return int - error code
+ * Note: 0 on success, ENOSPC if CAN_INTERACT_VBUS_MAX_NODES are attached, for other non-zero values refer to errno codes of socketpair
+ */
+int can_interact_vbus_attach(struct can_interact_vbus *bus, int *socket, size_t *node);
+
+/**
+ * @brief can_interact_vbus_filter - restricts identifiers delivered to node, as can_interact_filter does on a real socket
+ *
+ * @param struct can_interact_vbus* - bus
+ *
+ * @param const size_t - node
+ *
+ * @param const canid_t* - identifiers to receive
+ *
+ * @param const size_t - number of identifiers, 0 to receive all
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if there is no such node, E2BIG if there are more than CAN_INTERACT_VBUS_MAX_FILTERS identifiers
+ */
+int can_interact_vbus_filter(struct can_interact_vbus *bus, const size_t node, const canid_t *ids, const size_t len);
+
+/**
+ * @brief can_interact_vbus_error_reports - enables delivery of error frames (CAN_ERR_FLAG, see linux/can/error.h) to node
+ *
+ * @param struct can_interact_vbus* - bus
+ *
+ * @param const size_t - node
+ *
+ * @param const int - non-zero to enable
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if there is no such node
+ */
+int can_interact_vbus_error_reports(struct can_interact_vbus *bus, const size_t node, const int enable);
+
+/**
+ * @brief can_interact_vbus_inject - sets fault injection rates and reseeds fault generator
+ *
+ * @param struct can_interact_vbus* - bus
+ *
+ * @param const struct can_interact_vbus_faults* - rates, all 0 for a fault free bus
+ */
+void can_interact_vbus_inject(struct can_interact_vbus *bus, const struct can_interact_vbus_faults *faults);
+
+/**
+ * @brief can_interact_vbus_bus_off - forces node into bus-off, discarding its mailbox and frames it sends until restarted
+ *
+ * @param struct can_interact_vbus* - bus
+ *
+ * @param const size_t - node
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if there is no such node
+ */
+int can_interact_vbus_bus_off(struct can_interact_vbus *bus, const size_t node);
+
+/**
+ * @brief can_interact_vbus_restart - recovers node from bus-off, clearing its error counters
+ *
+ * @param struct can_interact_vbus* - bus
+ *
+ * @param const size_t - node
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if there is no such node
+ */
+int can_interact_vbus_restart(struct can_interact_vbus *bus, const size_t node);
+
+/**
+ * @brief can_interact_vbus_step - fills empty mailboxes from sent frames and carries out one transmission (waiting for its end in VBUS_REAL_TIME mode)
+ *
+ * @param struct can_interact_vbus* - bus
+ *
+ * @param int* - pointer to write 1 to if a transmission took place, 0 if the bus is idle
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes of recv
+ */
+int can_interact_vbus_step(struct can_interact_vbus *bus, int *transmitted);
+
+/**
+ * @brief can_interact_vbus_wait - waits until a node sends a frame
+ *
+ * @param const struct can_interact_vbus* - bus
+ *
+ * @param const int - timeout in milliseconds, -1 to wait indefinitely
+ *
+ * @return int - error code
+ * Note: 0 if a frame is waiting, ETIMEDOUT on timeout, for other non-zero values refer to errno codes of poll
+ */
+int can_interact_vbus_wait(const struct can_interact_vbus *bus, const int timeout_ms);
+
+/**
+ * @brief can_interact_vbus_run - steps bus until it is idle (VBUS_VIRTUAL_TIME) or until stop flag is set (VBUS_REAL_TIME)
+ *
+ * @param struct can_interact_vbus* - bus
+ *
+ * @param const volatile sig_atomic_t* - stop flag, checked at least every 100ms, may be NULL in VBUS_VIRTUAL_TIME mode
+ *
+ * @return int - error code
+ * Note: 0 on success, for non-zero values refer to errno codes
+ */
+int can_interact_vbus_run(struct can_interact_vbus *bus, const volatile sig_atomic_t *stop);
+
+/**
+ * @brief can_interact_vbus_get_stats - getter for counters of one node or the whole bus
+ *
+ * @param const struct can_interact_vbus* - bus
+ *
+ * @param const size_t - node, bus->count for the sum over all nodes
+ *
+ * @param struct can_interact_vbus_stats* - counters to write to (latency_max_ns is the maximum over nodes for the sum)
+ *
+ * @return int - error code
+ * Note: 0 on success, EINVAL if there is no such node
+ */
+int can_interact_vbus_get_stats(const struct can_interact_vbus *bus, const size_t node, struct can_interact_vbus_stats *stats);
+
+/**
+ * @brief can_interact_vbus_fini - closes bus side of all nodes, application sockets then read end of file
+ *
+ * @param struct can_interact_vbus* - bus
+ */
+void can_interact_vbus_fini(struct can_interact_vbus *bus);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CAN_INTERACT_VBUS_H */
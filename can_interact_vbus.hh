@@ -0,0 +1,356 @@
+#ifndef CAN_INTERACT_VBUS_HH
+#define CAN_INTERACT_VBUS_HH
+#pragma once
+
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include <errno.h>
+
+#include "can_interact.hh"
+#include "can_interact_vbus.h"
+
+/**
+ * @brief CXX API (C++11) of can_interact virtual CAN bus
+ * For declarations for the native C library, see can_interact_vbus.h
+ * Requires linking with -pthread (for start / stop)
+ */
+
+namespace can_interact {
+
+	class VirtualBus {
+		/**
+		  * @brief VirtualBus (class) - in-process bus connecting CAN objects with arbitration, bit timing and fault injection
+		  */
+		public:
+			typedef can_interact_vbus_stats stats_t ;
+			typedef can_interact_vbus_faults faults_t ;
+
+		private:
+			std::unique_ptr<can_interact_vbus> _state ;
+			mutable std::mutex _mutex ; // guards _state against the thread of start()
+			std::atomic<bool> _running ;
+			std::atomic<int> _error ; // first error of the thread of start(), reported by stop()
+			std::thread _thread ;
+
+			/**
+			  * @brief _run - INTERNAL METHOD. steps bus until stop() or an error in VBUS_REAL_TIME mode
+			  */
+			void _run() ;
+
+			/**
+			  * @brief _join - INTERNAL METHOD. signals thread of start() to finish and joins it
+			  */
+			void _join() noexcept ;
+
+			/**
+			  * @brief _check - INTERNAL METHOD. validates node index
+			  * @param const std::size_t - node
+			  * @throws std::out_of_range - if there is no such node
+			  */
+			void _check(const std::size_t) const noexcept(false) ;
+
+		public:
+			/**
+			  * @brief VirtualBus (constructor) - creates bus without nodes
+			  * @param const can_interact_vbus_mode - VBUS_VIRTUAL_TIME (stepped by run) or VBUS_REAL_TIME (stepped by start)
+			  * @param const std::uint32_t - bitrate in bit/s
+			  * @throws std::invalid_argument - if bitrate is 0
+			  */
+			explicit VirtualBus(const can_interact_vbus_mode, const std::uint32_t = 500000) noexcept(false) ;
+
+			/**
+			  * @brief attach - connects new node, to be used like a connection to a real interface (except CAN::filter, see filter)
+			  * @return CAN - connection of node, its index is nodes() - 1 afterwards
+			  * @throws std::runtime_error - if the bus is running or no node can be attached (errors reported by errno)
+			  */
+			CAN attach() noexcept(false) ;
+
+			/**
+			  * @brief nodes - number of attached nodes
+			  * @return std::size_t - count
+			  */
+			std::size_t nodes() const noexcept ;
+
+			/**
+			  * @brief filter - restricts identifiers delivered to node
+			  * @param const std::size_t - node
+			  * @param const std::vector<canid_t>& - identifiers to receive, empty to receive all
+			  * @throws std::out_of_range - if there is no such node
+			  * @throws std::invalid_argument - if there are more than CAN_INTERACT_VBUS_MAX_FILTERS identifiers
+			  */
+			void filter(const std::size_t, const std::vector<canid_t>&) noexcept(false) ;
+
+			/**
+			  * @brief error_reports - enables delivery of error frames (CAN_ERR_FLAG) to node
+			  * @param const std::size_t - node
+			  * @param const bool - enable
+			  * @throws std::out_of_range - if there is no such node
+			  */
+			void error_reports(const std::size_t, const bool) noexcept(false) ;
+
+			/**
+			  * @brief inject - sets fault injection rates and reseeds fault generator
+			  * @param const faults_t& - rates
+			  */
+			void inject(const faults_t&) ;
+
+			/**
+			  * @brief bus_off - forces node into bus-off
+			  * @param const std::size_t - node
+			  * @throws std::out_of_range - if there is no such node
+			  */
+			void bus_off(const std::size_t) noexcept(false) ;
+
+			/**
+			  * @brief restart - recovers node from bus-off
+			  * @param const std::size_t - node
+			  * @throws std::out_of_range - if there is no such node
+			  */
+			void restart(const std::size_t) noexcept(false) ;
+
+			/**
+			  * @brief step - carries out one transmission
+			  * @return bool - false if the bus is idle
+			  * @throws std::runtime_error - on errors reported by errno
+			  */
+			bool step() noexcept(false) ;
+
+			/**
+			  * @brief run - steps bus until it is idle, for VBUS_VIRTUAL_TIME mode
+			  * @return std::size_t - number of transmissions
+			  * @throws std::runtime_error - on errors reported by errno
+			  */
+			std::size_t run() noexcept(false) ;
+
+			/**
+			  * @brief now - bus time at which the bus is free again
+			  * @return std::uint64_t - nanoseconds (CLOCK_MONOTONIC in VBUS_REAL_TIME mode)
+			  */
+			std::uint64_t now() const noexcept ;
+
+			/**
+			  * @brief start - spawns thread stepping bus in real time
+			  * @throws std::runtime_error - if already running or the bus is in VBUS_VIRTUAL_TIME mode
+			  */
+			void start() noexcept(false) ;
+
+			/**
+			  * @brief stop - joins thread of start (takes up to 100ms)
+			  * @throws std::runtime_error - if the thread ended early because stepping the bus failed (errors reported by errno)
+			  */
+			void stop() noexcept(false) ;
+
+			/**
+			  * @brief stats - getter for counters
+			  * @param const std::size_t - node, nodes() for the sum over all nodes
+			  * @return stats_t - counters
+			  * @throws std::out_of_range - if there is no such node
+			  */
+			stats_t stats(const std::size_t) const noexcept(false) ;
+
+			/**
+			  * @brief ~VirtualBus (destructor) - stops thread, closes bus side of all nodes
+			  */
+			~VirtualBus() noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			VirtualBus(const VirtualBus&) = delete ;
+			VirtualBus(VirtualBus&&) = delete ;
+			VirtualBus& operator=(const VirtualBus&) = delete ;
+			VirtualBus& operator=(VirtualBus&&) = delete ;
+			VirtualBus() = delete ;
+	} ;
+
+}
+
+can_interact::VirtualBus::VirtualBus(const can_interact_vbus_mode mode, const std::uint32_t bitrate) noexcept(false) : _state{new can_interact_vbus}, _mutex{}, _running{false}, _error{0}, _thread{}
+{
+	if(can_interact_vbus_init(this->_state.get(), mode, bitrate) != 0)
+	{
+		throw std::invalid_argument("Bitrate of virtual bus must not be 0") ;
+	}
+}
+
+void can_interact::VirtualBus::_check(const std::size_t node) const noexcept(false)
+{
+	if(node >= this->_state->count)
+	{
+		throw std::out_of_range(std::string{"No node "} + std::to_string(node) + " on virtual bus") ;
+	}
+}
+
+can_interact::CAN can_interact::VirtualBus::attach() noexcept(false)
+{
+	if(this->_running.load())
+	{
+		throw std::runtime_error("Cannot attach to running virtual bus") ;
+	}
+	int socket ;
+	std::lock_guard<std::mutex> lock(this->_mutex) ;
+	const int res = can_interact_vbus_attach(this->_state.get(), &socket, nullptr) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return can_interact::CAN(socket) ;
+}
+
+std::size_t can_interact::VirtualBus::nodes() const noexcept
+{
+	std::lock_guard<std::mutex> lock(this->_mutex) ;
+	return this->_state->count ;
+}
+
+void can_interact::VirtualBus::filter(const std::size_t node, const std::vector<canid_t>& ids) noexcept(false)
+{
+	std::lock_guard<std::mutex> lock(this->_mutex) ;
+	this->_check(node) ;
+	if(can_interact_vbus_filter(this->_state.get(), node, ids.data(), ids.size()) != 0)
+	{
+		throw std::invalid_argument(std::string{"At most "} + std::to_string(CAN_INTERACT_VBUS_MAX_FILTERS) + " identifiers per node") ;
+	}
+}
+
+void can_interact::VirtualBus::error_reports(const std::size_t node, const bool enable) noexcept(false)
+{
+	std::lock_guard<std::mutex> lock(this->_mutex) ;
+	if(can_interact_vbus_error_reports(this->_state.get(), node, enable) != 0)
+	{
+		throw std::out_of_range(std::string{"No node "} + std::to_string(node) + " on virtual bus") ;
+	}
+}
+
+void can_interact::VirtualBus::inject(const faults_t& faults)
+{
+	std::lock_guard<std::mutex> lock(this->_mutex) ;
+	can_interact_vbus_inject(this->_state.get(), &faults) ;
+}
+
+void can_interact::VirtualBus::bus_off(const std::size_t node) noexcept(false)
+{
+	std::lock_guard<std::mutex> lock(this->_mutex) ;
+	if(can_interact_vbus_bus_off(this->_state.get(), node) != 0)
+	{
+		throw std::out_of_range(std::string{"No node "} + std::to_string(node) + " on virtual bus") ;
+	}
+}
+
+void can_interact::VirtualBus::restart(const std::size_t node) noexcept(false)
+{
+	std::lock_guard<std::mutex> lock(this->_mutex) ;
+	if(can_interact_vbus_restart(this->_state.get(), node) != 0)
+	{
+		throw std::out_of_range(std::string{"No node "} + std::to_string(node) + " on virtual bus") ;
+	}
+}
+
+bool can_interact::VirtualBus::step() noexcept(false)
+{
+	int transmitted ;
+	std::lock_guard<std::mutex> lock(this->_mutex) ;
+	const int res = can_interact_vbus_step(this->_state.get(), &transmitted) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+	return transmitted != 0 ;
+}
+
+std::size_t can_interact::VirtualBus::run() noexcept(false)
+{
+	std::size_t count = 0 ;
+	while(this->step())
+	{
+		++count ;
+	}
+	return count ;
+}
+
+std::uint64_t can_interact::VirtualBus::now() const noexcept
+{
+	std::lock_guard<std::mutex> lock(this->_mutex) ;
+	return this->_state->now_ns ;
+}
+
+void can_interact::VirtualBus::_run()
+{
+	while(this->_running.load())
+	{
+		int transmitted = 0 ;
+		int res ;
+		{
+			std::lock_guard<std::mutex> lock(this->_mutex) ;
+			res = can_interact_vbus_step(this->_state.get(), &transmitted) ;
+		}
+		if(res == 0 && !transmitted)
+		{
+			res = can_interact_vbus_wait(this->_state.get(), 100) ; // node count is fixed while running, closed nodes are detached by step
+			res = res == ETIMEDOUT ? 0 : res ;
+		}
+		if(res != 0)
+		{
+			this->_error.store(res) ;
+			return ;
+		}
+	}
+}
+
+void can_interact::VirtualBus::start() noexcept(false)
+{
+	if(this->_state->mode != VBUS_REAL_TIME)
+	{
+		throw std::runtime_error("Only virtual buses in VBUS_REAL_TIME mode run on a thread") ;
+	}
+	if(this->_running.exchange(true))
+	{
+		throw std::runtime_error("Virtual bus is already running") ;
+	}
+	this->_error.store(0) ;
+	this->_thread = std::thread(&can_interact::VirtualBus::_run, this) ;
+}
+
+void can_interact::VirtualBus::_join() noexcept
+{
+	this->_running.store(false) ;
+	if(this->_thread.joinable())
+	{
+		this->_thread.join() ;
+	}
+}
+
+void can_interact::VirtualBus::stop() noexcept(false)
+{
+	this->_join() ;
+	const int res = this->_error.exchange(0) ;
+	if(res != 0)
+	{
+		throw std::runtime_error(std::string{"Errno "} + std::to_string(res)) ;
+	}
+}
+
+can_interact::VirtualBus::stats_t can_interact::VirtualBus::stats(const std::size_t node) const noexcept(false)
+{
+	stats_t stats ;
+	std::lock_guard<std::mutex> lock(this->_mutex) ;
+	if(can_interact_vbus_get_stats(this->_state.get(), node, &stats) != 0)
+	{
+		throw std::out_of_range(std::string{"No node "} + std::to_string(node) + " on virtual bus") ;
+	}
+	return stats ;
+}
+
+can_interact::VirtualBus::~VirtualBus() noexcept
+{
+	this->_join() ;
+	can_interact_vbus_fini(this->_state.get()) ;
+}
+
+#endif // CAN_INTERACT_VBUS_HH
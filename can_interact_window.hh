@@ -0,0 +1,328 @@
+#ifndef CAN_INTERACT_WINDOW_HH
+#define CAN_INTERACT_WINDOW_HH
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <utility>
+#include <string>
+#include <stdexcept>
+#include <cstddef>
+#include <cstdint>
+
+#include "can_interact.hh"
+
+/**
+ * @brief CXX API (C++11) streaming windowed aggregation of decoded signal samples into min / max / mean / last summaries
+ * Windows are aligned to multiples of the hop on the timestamp axis and shared by all signals. Tumbling windows (hop equal to window) only keep
+ * running values per signal. Sliding windows keep the samples of the current window in a per-signal ring, with monotonic deques of ring
+ * positions for min and max, so each sample costs O(1) amortised to add and to expire
+ * All per-signal state lives in contiguous arrays indexed by signal. A window is closed (and its summary handed to the handler) by the first
+ * sample of that signal at or after the window's end, or by advance for signals which went quiet
+ */
+
+namespace can_interact {
+
+	class WindowAggregator {
+		/**
+		  * @brief WindowAggregator (class) - tumbling or sliding window summaries of many signals
+		  */
+		public:
+			struct summary_t {
+				/**
+				  * @brief summary_t - aggregate of one signal over one closed window [start_ns, end_ns)
+				  */
+				std::size_t signal ;
+				std::uint64_t start_ns ;
+				std::uint64_t end_ns ;
+				std::uint64_t count ;
+				double min ;
+				double max ;
+				double mean ;
+				double last ;
+			} ;
+
+			struct stats_t {
+				/**
+				  * @brief stats_t - ingestion counters
+				  */
+				std::uint64_t samples ; // accepted samples
+				std::uint64_t summaries ; // windows closed with at least one sample
+				std::uint64_t late ; // samples older than the previous sample of their signal, dropped
+				std::uint64_t overflows ; // samples pushed out of a full sliding window ring before expiring
+			} ;
+
+			/**
+			  * @brief handler_t - receives summary of each closed window, called on the thread adding samples
+			  */
+			typedef std::function<void(const summary_t&)> handler_t ;
+
+		private:
+			struct _state {
+				/**
+				  * @brief _state - INTERNAL. per-signal window state, ring positions count up and are taken modulo capacity
+				  */
+				std::uint64_t close_ns ; // end of current window, 0 before first sample
+				std::uint64_t last_ns ;
+				std::uint64_t head ; // oldest sample in ring
+				std::uint64_t tail ; // next sample in ring
+				std::uint64_t min_head ;
+				std::uint64_t min_tail ;
+				std::uint64_t max_head ;
+				std::uint64_t max_tail ;
+				std::uint64_t count ; // tumbling only
+				double min ; // tumbling only
+				double max ; // tumbling only
+				double sum ;
+				double last ;
+			} ;
+
+			std::uint64_t _window ;
+			std::uint64_t _hop ;
+			std::size_t _capacity ; // samples per sliding ring, 0 for tumbling windows
+			handler_t _handler ;
+			std::vector<_state> _states ;
+			std::vector<std::uint64_t> _times ; // rings of _capacity entries per signal
+			std::vector<double> _values ;
+			std::vector<std::uint64_t> _min_queue ; // ring positions of samples with increasing values
+			std::vector<std::uint64_t> _max_queue ; // ring positions of samples with decreasing values
+			stats_t _stats ;
+
+			/**
+			  * @brief _expire - INTERNAL METHOD. drops oldest sample of sliding ring
+			  * @param _state& - state of signal
+			  * @param const std::size_t - first array index of signal's ring
+			  */
+			void _expire(_state&, const std::size_t) noexcept ;
+
+			/**
+			  * @brief _close - INTERNAL METHOD. closes windows of signal ending at or before time
+			  * @param const std::size_t - signal
+			  * @param const std::uint64_t - time in nanoseconds
+			  */
+			void _close(const std::size_t, const std::uint64_t) noexcept(false) ;
+
+		public:
+			/**
+			  * @brief WindowAggregator (constructor) - allocates state of all signals
+			  * @param const std::size_t - number of signals, indexed from 0
+			  * @param const std::uint64_t - window length in nanoseconds
+			  * @param const std::uint64_t - hop between window ends in nanoseconds, 0 or window length for tumbling windows
+			  * @param handler_t - receives summaries
+			  * @param const std::size_t - samples kept per signal and sliding window (older ones are pushed out early), unused for tumbling windows
+			  * @throws std::invalid_argument - if window is 0, hop exceeds window, or sliding windows have no capacity
+			  */
+			WindowAggregator(const std::size_t, const std::uint64_t, const std::uint64_t, handler_t, const std::size_t = 1024) noexcept(false) ;
+
+			WindowAggregator(WindowAggregator&&) = default ;
+			WindowAggregator& operator=(WindowAggregator&&) = default ;
+
+			/**
+			  * @brief add (overload) - feeds sample of signal, closing its windows which end at or before the sample
+			  * @param const std::size_t - signal
+			  * @param const std::uint64_t - timestamp in nanoseconds, non-decreasing per signal
+			  * @param const double - decoded value
+			  * @throws std::out_of_range - if there is no such signal
+			  */
+			void add(const std::size_t, const std::uint64_t, const double) noexcept(false) ;
+
+			/**
+			  * @brief add (overload) - feeds many samples of one signal
+			  * @param const std::size_t - signal
+			  * @param const std::uint64_t* - timestamps in nanoseconds, non-decreasing
+			  * @param const double* - decoded values
+			  * @param const std::size_t - number of samples
+			  * @throws std::out_of_range - if there is no such signal
+			  */
+			void add(const std::size_t, const std::uint64_t*, const double*, const std::size_t) noexcept(false) ;
+
+			/**
+			  * @brief advance - closes windows of all signals ending at or before given time, e.g. driven by a timer so quiet signals report too
+			  * @param const std::uint64_t - time in nanoseconds
+			  */
+			void advance(const std::uint64_t) noexcept(false) ;
+
+			/**
+			  * @brief stats - getter for ingestion counters
+			  * @return stats_t - counters
+			  */
+			stats_t stats() const noexcept ;
+
+			/* Below are defaulted and deleted methods */
+			WindowAggregator() = delete ;
+			WindowAggregator(const WindowAggregator&) = delete ;
+			WindowAggregator& operator=(const WindowAggregator&) = delete ;
+	} ;
+
+}
+
+can_interact::WindowAggregator::WindowAggregator(const std::size_t signals, const std::uint64_t window, const std::uint64_t hop, handler_t handler, const std::size_t capacity) noexcept(false)
+	: _window{window}, _hop{hop == 0 ? window : hop}, _capacity{0}, _handler{std::move(handler)}, _states(signals), _times{}, _values{}, _min_queue{}, _max_queue{}, _stats{0, 0, 0, 0}
+{
+	if(window == 0 || this->_hop > window)
+	{
+		throw std::invalid_argument("Window must be non-zero and at least as long as the hop") ;
+	}
+	if(this->_hop != window)
+	{
+		if(capacity == 0)
+		{
+			throw std::invalid_argument("Sliding windows need a non-zero capacity") ;
+		}
+		this->_capacity = capacity ;
+		this->_times.resize(signals * capacity) ;
+		this->_values.resize(signals * capacity) ;
+		this->_min_queue.resize(signals * capacity) ;
+		this->_max_queue.resize(signals * capacity) ;
+	}
+	for(_state& state : this->_states)
+	{
+		state = _state{0, 0, 0, 0, 0, 0, 0, 0, 0, 0.0, 0.0, 0.0, 0.0} ;
+	}
+}
+
+void can_interact::WindowAggregator::_expire(_state& state, const std::size_t base) noexcept
+{
+	const std::uint64_t pos = state.head ;
+	state.sum -= this->_values[base + pos % this->_capacity] ;
+	if(this->_min_queue[base + state.min_head % this->_capacity] == pos)
+	{
+		++state.min_head ;
+	}
+	if(this->_max_queue[base + state.max_head % this->_capacity] == pos)
+	{
+		++state.max_head ;
+	}
+	++state.head ;
+	if(state.head == state.tail)
+	{
+		state.sum = 0.0 ; // drop accumulated rounding error whenever the window runs empty
+	}
+}
+
+void can_interact::WindowAggregator::_close(const std::size_t signal, const std::uint64_t now) noexcept(false)
+{
+	_state& state = this->_states[signal] ;
+	const std::size_t base = signal * this->_capacity ;
+
+	while(state.close_ns != 0 && state.close_ns <= now)
+	{
+		const std::uint64_t end = state.close_ns ;
+		const std::uint64_t start = end > this->_window ? end - this->_window : 0 ;
+		if(this->_capacity == 0)
+		{
+			if(state.count > 0)
+			{
+				++this->_stats.summaries ;
+				this->_handler(summary_t{signal, start, end, state.count, state.min, state.max, state.sum / static_cast<double>(state.count), state.last}) ;
+			}
+			state.count = 0 ;
+			state.sum = 0.0 ;
+		}
+		else
+		{
+			while(state.head != state.tail && this->_times[base + state.head % this->_capacity] < start)
+			{
+				this->_expire(state, base) ;
+			}
+			if(state.head != state.tail)
+			{
+				const std::uint64_t count = state.tail - state.head ;
+				++this->_stats.summaries ;
+				this->_handler(summary_t{signal, start, end, count,
+					this->_values[base + this->_min_queue[base + state.min_head % this->_capacity] % this->_capacity],
+					this->_values[base + this->_max_queue[base + state.max_head % this->_capacity] % this->_capacity],
+					state.sum / static_cast<double>(count), state.last}) ;
+			}
+		}
+		state.close_ns += this->_hop ;
+
+		// skip windows which cannot hold a sample instead of stepping through a long silence hop by hop
+		const bool empty = this->_capacity == 0 || state.head == state.tail ;
+		if(empty && state.close_ns <= now)
+		{
+			state.close_ns = (now / this->_hop) * this->_hop + this->_hop ;
+		}
+	}
+}
+
+void can_interact::WindowAggregator::add(const std::size_t signal, const std::uint64_t timestamp, const double value) noexcept(false)
+{
+	if(signal >= this->_states.size())
+	{
+		throw std::out_of_range(std::string{"No signal "} + std::to_string(signal)) ;
+	}
+	_state& state = this->_states[signal] ;
+	if(state.close_ns == 0)
+	{
+		state.close_ns = (timestamp / this->_hop) * this->_hop + this->_hop ;
+	}
+	else if(timestamp < state.last_ns)
+	{
+		++this->_stats.late ;
+		return ;
+	}
+	this->_close(signal, timestamp) ;
+	state.last_ns = timestamp ;
+	state.last = value ;
+	++this->_stats.samples ;
+
+	if(this->_capacity == 0)
+	{
+		if(state.count == 0 || value < state.min)
+		{
+			state.min = value ;
+		}
+		if(state.count == 0 || value > state.max)
+		{
+			state.max = value ;
+		}
+		state.sum += value ;
+		++state.count ;
+		return ;
+	}
+
+	const std::size_t base = signal * this->_capacity ;
+	if(state.tail - state.head == this->_capacity)
+	{
+		++this->_stats.overflows ;
+		this->_expire(state, base) ;
+	}
+	while(state.min_tail != state.min_head && this->_values[base + this->_min_queue[base + (state.min_tail - 1) % this->_capacity] % this->_capacity] >= value)
+	{
+		--state.min_tail ;
+	}
+	while(state.max_tail != state.max_head && this->_values[base + this->_max_queue[base + (state.max_tail - 1) % this->_capacity] % this->_capacity] <= value)
+	{
+		--state.max_tail ;
+	}
+	this->_min_queue[base + state.min_tail++ % this->_capacity] = state.tail ;
+	this->_max_queue[base + state.max_tail++ % this->_capacity] = state.tail ;
+	this->_times[base + state.tail % this->_capacity] = timestamp ;
+	this->_values[base + state.tail % this->_capacity] = value ;
+	state.sum += value ;
+	++state.tail ;
+}
+
+void can_interact::WindowAggregator::add(const std::size_t signal, const std::uint64_t* timestamps, const double* values, const std::size_t len) noexcept(false)
+{
+	for(std::size_t i = 0 ; i < len ; ++i)
+	{
+		this->add(signal, timestamps[i], values[i]) ;
+	}
+}
+
+void can_interact::WindowAggregator::advance(const std::uint64_t now) noexcept(false)
+{
+	for(std::size_t signal = 0 ; signal < this->_states.size() ; ++signal)
+	{
+		this->_close(signal, now) ;
+	}
+}
+
+can_interact::WindowAggregator::stats_t can_interact::WindowAggregator::stats() const noexcept
+{
+	return this->_stats ;
+}
+
+#endif // CAN_INTERACT_WINDOW_HH
@@ -0,0 +1,486 @@
+#define _DEFAULT_SOURCE
+
+#include <stdio.h> /* io */
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h> /* syscalls */
+#include <sys/wait.h>
+
+#include <linux/can.h>
+
+#include <argp.h>
+
+#include "can_interact.h" /* functionality containing both code to read and write from socket */
+#include "can_interact_hist.h"
+#include "can_interact_vbus.h"
+
+/**
+ * @brief Load generator and latency measurement using C-style can_interact functionality
+ * Sends frames at a target rate (or bus load) and receives them on a second socket, which on the same host sees them through the
+ * interface's local loopback (e.g. vcan). Each frame carries a 16 bit sequence number and the low 32 bits of its CLOCK_REALTIME send time
+ * in nanoseconds (bytes 0-1 and 2-5, little endian), the receive side compares them to kernel receive timestamps and reports loss,
+ * reordering and latency percentiles. With --reply the frames are expected back from a reflector (--echo) with a shifted identifier,
+ * giving round trip latency through a remote node or gateway. With --vbus no interface is needed: sender, receiver (and reflector) are
+ * attached to an in-process virtual bus of the given bitrate, run by a child process
+ * One-way latency between hosts needs synchronised clocks, latencies above about 4 s wrap around
+ */
+
+#pragma GCC diagnostic ignored "-Wmissing-field-initializers" /* Below is some argp stuff. I'm ignoring some of the 'errors' */
+#pragma GCC diagnostic push
+
+static char args_doc[] = "[NET_DEVICE_NAME [RX_DEVICE_NAME]]"; /* description of non-option specified command line arguments */
+static char doc[] = "can_load -- generates CAN load and measures loss, reordering and latency"; /* general program documentation */
+const char* argp_program_bug_address = "salih.msa@outlook.com";
+static struct argp_option options[] = {
+	{"rate", 'r', "FPS", 0, "Frames per second (default 1000)", 0},
+	{"load", 'l', "PERCENT", 0, "Target bus load instead of a rate, from nominal frame lengths", 0},
+	{"bitrate", 'b', "BPS", 0, "Bitrate for --load and --vbus (default 500000)", 0},
+	{"count", 'c', "N", 0, "Frames to send (default 10000)", 0},
+	{"id", 'i', "ID", 0, "First identifier (default 0x100)", 0},
+	{"ids", 'n', "N", 0, "Number of consecutive identifiers used (default 1)", 0},
+	{"random-ids", 'R', 0, 0, "Pick identifiers at random instead of cycling through them", 0},
+	{"extended", 'x', 0, 0, "Send extended (29 bit) identifiers", 0},
+	{"dlc", 'd', "LEN", 0, "Payload length 0-8 (default 8), frames shorter than 6 bytes are counted but not timed", 0},
+	{"pattern", 'p', "PATTERN", 0, "Fill of remaining payload bytes: zero, ones, alt or random (default zero)", 0},
+	{"reply", 'e', "OFFSET", 0, "Measure round trip, expecting frames echoed with identifier + OFFSET", 0},
+	{"echo", 'E', "OFFSET", 0, "Run as reflector, resending received frames with identifier + OFFSET until interrupted", 0},
+	{"vbus", 'v', 0, 0, "Use an in-process virtual bus instead of network devices", 0},
+	{0}
+};
+
+enum pattern {
+    PATTERN_ZERO = 0,
+    PATTERN_ONES,
+    PATTERN_ALT,
+    PATTERN_RANDOM
+};
+
+struct arguments {
+/**
+ * @brief struct arguments - this structure is used to communicate with parse_opt (for it to store the values it parses within it)
+ */
+	char *args[2]; /* args for (string) params */
+	unsigned int arg_count;
+	double rate;
+	double load;
+	unsigned long bitrate;
+	unsigned long count;
+	unsigned long id;
+	unsigned long ids;
+	long offset;
+	int random_ids;
+	int extended;
+	int dlc;
+	enum pattern pattern;
+	int reply;
+	int echo;
+	int vbus;
+};
+
+/**
+ * @brief parse_opt - deals with given arguments based on given argumentsK
+ * @param int - int correlating to char storing argument key
+ * @param char* - argument string associated with argument key
+ * @param struct argp_state* - pointer to argp_state struct storing information about the state of the option parsing
+ * @return error_t - number storing 0 upon successfully parsed values, non-zero exit code otherwise
+ */
+static error_t parse_opt(int key, char *arg, struct argp_state *state)
+{
+	struct arguments *arguments = (struct arguments*)state->input;
+
+	switch (key) {
+	case 'r':
+		arguments->rate = atof(arg);
+		break;
+	case 'l':
+		arguments->load = atof(arg);
+		break;
+	case 'b':
+		arguments->bitrate = strtoul(arg, NULL, 0);
+		break;
+	case 'c':
+		arguments->count = strtoul(arg, NULL, 0);
+		break;
+	case 'i':
+		arguments->id = strtoul(arg, NULL, 0);
+		break;
+	case 'n':
+		arguments->ids = strtoul(arg, NULL, 0);
+		break;
+	case 'R':
+		arguments->random_ids = 1;
+		break;
+	case 'x':
+		arguments->extended = 1;
+		break;
+	case 'd':
+		arguments->dlc = atoi(arg);
+		break;
+	case 'p':
+		if (strcmp(arg, "zero") == 0) {
+			arguments->pattern = PATTERN_ZERO;
+		} else if (strcmp(arg, "ones") == 0) {
+			arguments->pattern = PATTERN_ONES;
+		} else if (strcmp(arg, "alt") == 0) {
+			arguments->pattern = PATTERN_ALT;
+		} else if (strcmp(arg, "random") == 0) {
+			arguments->pattern = PATTERN_RANDOM;
+		} else {
+			argp_error(state, "unknown pattern %s", arg);
+		}
+		break;
+	case 'e':
+		arguments->reply = 1;
+		arguments->offset = strtol(arg, NULL, 0);
+		break;
+	case 'E':
+		arguments->echo = 1;
+		arguments->offset = strtol(arg, NULL, 0);
+		break;
+	case 'v':
+		arguments->vbus = 1;
+		break;
+	case ARGP_KEY_ARG:
+		if (state->arg_num >= 2) {
+			argp_usage(state);
+		}
+		arguments->args[state->arg_num] = arg;
+		arguments->arg_count = state->arg_num + 1;
+		break;
+	case ARGP_KEY_END:
+		if ((arguments->arg_count == 0 && !arguments->vbus) || arguments->rate <= 0 || arguments->dlc < 0 || arguments->dlc > 8
+				|| arguments->ids == 0 || arguments->bitrate == 0 || (arguments->echo && (arguments->reply || arguments->vbus))) {
+			argp_usage(state);
+		}
+		break;
+	default:
+		return ARGP_ERR_UNKNOWN;
+	}
+	return 0;
+}
+
+#pragma GCC diagnostic pop /* end of argp, so end of repressing weird messages */
+
+static volatile sig_atomic_t stop = 0;
+
+/**
+ * @brief on_signal - sets stop flag
+ * @param int - signal number
+ */
+static void on_signal(int signum)
+{
+	(void)signum;
+	stop = 1;
+}
+
+/**
+ * @brief now_ns - current time
+ * @param const clockid_t - clock
+ * @return uint64_t - nanoseconds
+ */
+static uint64_t now_ns(const clockid_t clock)
+{
+	struct timespec ts;
+
+	clock_gettime(clock, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief echo - resends every received frame with shifted identifier until stopped
+ * @param const int - socket
+ * @param const long - identifier offset
+ * @return int - exit code
+ */
+static int echo(const int s, const long offset)
+{
+	struct can_interact_timed_frame received[CAN_INTERACT_MAX_BATCH];
+	struct can_frame frames[CAN_INTERACT_MAX_BATCH];
+	size_t len, sent, i;
+	canid_t mask;
+	int res;
+
+	while (!stop) {
+		res = can_interact_get_frames(received, CAN_INTERACT_MAX_BATCH, &len, &s);
+		if (res == EINTR || res == EAGAIN) {
+			continue;
+		}
+		if (res != 0) {
+			fprintf(stderr, "Error reading from CAN bus: %s\n", strerror(res));
+			return 1;
+		}
+		for (i = 0; i < len; ++i) {
+			frames[i] = received[i].frame;
+			mask = frames[i].can_id & CAN_EFF_FLAG ? CAN_EFF_MASK : CAN_SFF_MASK;
+			frames[i].can_id = (frames[i].can_id & ~mask) | ((canid_t)((long)(frames[i].can_id & mask) + offset) & mask);
+		}
+		can_interact_send_frames(frames, len, &sent, &s);
+	}
+	return 0;
+}
+
+struct receiver {
+/**
+ * @brief struct receiver - receive side counters
+ */
+	struct can_interact_hist latency;
+	uint64_t received;
+	uint64_t reordered;
+	canid_t first; /* expected identifiers */
+	canid_t last;
+	uint16_t expected; /* next sequence number */
+	int timed;
+};
+
+/**
+ * @brief drain - takes all queued frames from non-blocking socket
+ * @param struct receiver* - counters
+ * @param const int - socket
+ */
+static void drain(struct receiver *rx, const int s)
+{
+	struct can_interact_timed_frame frames[CAN_INTERACT_MAX_BATCH];
+	size_t len, i;
+	uint64_t when;
+	uint32_t sent_at;
+	uint16_t seq;
+	canid_t id;
+
+	while (can_interact_get_frames(frames, CAN_INTERACT_MAX_BATCH, &len, &s) == 0) {
+		when = 0;
+		for (i = 0; i < len; ++i) {
+			id = frames[i].frame.can_id & (CAN_EFF_FLAG | CAN_EFF_MASK);
+			if (id < rx->first || id > rx->last) {
+				continue;
+			}
+			++rx->received;
+			if (!rx->timed || frames[i].frame.can_dlc < 6) {
+				continue;
+			}
+			seq = (uint16_t)(frames[i].frame.data[0] | frames[i].frame.data[1] << 8);
+			sent_at = (uint32_t)frames[i].frame.data[2] | (uint32_t)frames[i].frame.data[3] << 8
+				| (uint32_t)frames[i].frame.data[4] << 16 | (uint32_t)frames[i].frame.data[5] << 24;
+			if (frames[i].timestamp_ns == 0 && when == 0) { /* no kernel timestamps on this socket */
+				when = now_ns(CLOCK_REALTIME);
+			}
+			can_interact_hist_record(&rx->latency, (uint32_t)((uint32_t)(frames[i].timestamp_ns != 0 ? frames[i].timestamp_ns : when) - sent_at));
+			if ((int16_t)(seq - rx->expected) >= 0) {
+				rx->expected = (uint16_t)(seq + 1);
+			} else {
+				++rx->reordered;
+			}
+		}
+	}
+}
+
+/**
+ * @brief frame_bits - nominal length of frame without stuff bits
+ * @param const int - extended identifier
+ * @param const int - payload length
+ * @return double - bits
+ */
+static double frame_bits(const int extended, const int dlc)
+{
+	return (extended ? 67.0 : 47.0) + 8.0 * dlc;
+}
+
+/**
+ * @brief measure - sends frames at target rate, receives them and reports
+ * @param const struct arguments* - configuration
+ * @param const int - sending socket
+ * @param const int - receiving socket
+ * @return int - exit code
+ */
+static int measure(const struct arguments *arguments, const int tx, const int rx)
+{
+	static struct receiver receiver;
+	const canid_t flags = arguments->extended ? CAN_EFF_FLAG : 0;
+	const canid_t mask = arguments->extended ? CAN_EFF_MASK : CAN_SFF_MASK;
+	const double rate = arguments->load > 0 ? arguments->load / 100.0 * (double)arguments->bitrate / frame_bits(arguments->extended, arguments->dlc) : arguments->rate;
+	const uint64_t period = (uint64_t)(1e9 / rate);
+	struct can_frame frame;
+	struct pollfd pfd;
+	struct timespec ts;
+	uint64_t start, next, elapsed, sent = 0, failed = 0, stamp;
+	unsigned long seq;
+	int i;
+
+	can_interact_hist_init(&receiver.latency);
+	receiver.first = flags | (((canid_t)arguments->id + (canid_t)arguments->offset) & mask);
+	receiver.last = receiver.first + (canid_t)arguments->ids - 1;
+	receiver.timed = arguments->dlc >= 6;
+	can_interact_timestamps(&rx);
+	fcntl(rx, F_SETFL, fcntl(rx, F_GETFL) | O_NONBLOCK);
+
+	memset(&frame, 0, sizeof(frame));
+	frame.can_dlc = (uint8_t)arguments->dlc;
+	for (i = 0; i < 8; ++i) {
+		frame.data[i] = arguments->pattern == PATTERN_ONES ? 0xFF : arguments->pattern == PATTERN_ALT ? 0x55 : 0x00;
+	}
+
+	start = now_ns(CLOCK_MONOTONIC);
+	next = start;
+	for (seq = 0; seq < arguments->count && !stop; ++seq) {
+		frame.can_id = flags | (((canid_t)arguments->id
+			+ (canid_t)(arguments->random_ids ? (unsigned long)rand() % arguments->ids : seq % arguments->ids)) & mask);
+		if (arguments->pattern == PATTERN_RANDOM) {
+			for (i = 0; i < 8; ++i) {
+				frame.data[i] = (uint8_t)rand();
+			}
+		}
+		if (arguments->dlc >= 6) {
+			stamp = now_ns(CLOCK_REALTIME);
+			frame.data[0] = (uint8_t)seq;
+			frame.data[1] = (uint8_t)(seq >> 8);
+			frame.data[2] = (uint8_t)stamp;
+			frame.data[3] = (uint8_t)(stamp >> 8);
+			frame.data[4] = (uint8_t)(stamp >> 16);
+			frame.data[5] = (uint8_t)(stamp >> 24);
+		}
+		if (can_interact_send_frame(&frame, &tx) == 0) {
+			++sent;
+		} else {
+			++failed;
+		}
+		drain(&receiver, rx);
+		next += period;
+		if (next > now_ns(CLOCK_MONOTONIC)) {
+			ts.tv_sec = (time_t)(next / 1000000000u);
+			ts.tv_nsec = (long)(next % 1000000000u);
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+		}
+	}
+	elapsed = now_ns(CLOCK_MONOTONIC) - start;
+
+	pfd.fd = rx; /* collect stragglers until 200ms pass without frames */
+	pfd.events = POLLIN;
+	while (receiver.received < sent && poll(&pfd, 1, 200) > 0) {
+		drain(&receiver, rx);
+	}
+
+	fprintf(stdout, "sent %lu frames (%lu failed) in %.3f s, %.0f frames/s, offered bus load %.1f%% at %lu bit/s\n",
+		(unsigned long)sent, (unsigned long)failed, (double)elapsed / 1e9, (double)sent * 1e9 / (double)elapsed,
+		(double)sent * 1e11 * frame_bits(arguments->extended, arguments->dlc) / (double)elapsed / (double)arguments->bitrate, arguments->bitrate);
+	fprintf(stdout, "received %lu, lost %lu (%.3f%%), reordered %lu\n", (unsigned long)receiver.received,
+		(unsigned long)(sent > receiver.received ? sent - receiver.received : 0),
+		sent > receiver.received ? (double)(sent - receiver.received) * 100.0 / (double)sent : 0.0, (unsigned long)receiver.reordered);
+	if (receiver.latency.total > 0) {
+		fprintf(stdout, "%s latency (us): min %.1f p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f max %.1f mean %.1f\n",
+			arguments->reply ? "round trip" : "one-way",
+			(double)receiver.latency.min / 1e3,
+			(double)can_interact_hist_percentile(&receiver.latency, 50.0) / 1e3,
+			(double)can_interact_hist_percentile(&receiver.latency, 90.0) / 1e3,
+			(double)can_interact_hist_percentile(&receiver.latency, 99.0) / 1e3,
+			(double)can_interact_hist_percentile(&receiver.latency, 99.9) / 1e3,
+			(double)receiver.latency.max / 1e3, can_interact_hist_mean(&receiver.latency) / 1e3);
+	}
+	return 0;
+}
+
+/**
+ * @brief spawn_bus - attaches nodes to a virtual bus and runs it in a child process
+ * @param const struct arguments* - configuration
+ * @param int* - sending socket to write to
+ * @param int* - receiving socket to write to
+ * @param pid_t* - child processes to write to (bus and, for --reply, reflector)
+ * @return int - 0 on success
+ */
+static int spawn_bus(const struct arguments *arguments, int *tx, int *rx, pid_t *children)
+{
+	static struct can_interact_vbus bus;
+	struct can_interact_vbus_stats stats;
+	uint64_t start;
+	int reflector = -1;
+
+	if (can_interact_vbus_init(&bus, VBUS_REAL_TIME, (uint32_t)arguments->bitrate) != 0
+			|| can_interact_vbus_attach(&bus, tx, NULL) != 0 || can_interact_vbus_attach(&bus, rx, NULL) != 0
+			|| (arguments->reply && can_interact_vbus_attach(&bus, &reflector, NULL) != 0)) {
+		return 1;
+	}
+	children[0] = fork();
+	if (children[0] == 0) {
+		start = now_ns(CLOCK_MONOTONIC);
+		can_interact_vbus_run(&bus, &stop);
+		can_interact_vbus_get_stats(&bus, bus.count, &stats);
+		fprintf(stderr, "virtual bus: %lu frames, %lu dropped receptions, %.1f%% busy\n", (unsigned long)stats.tx_frames,
+			(unsigned long)stats.rx_dropped, (double)stats.busy_ns * 100.0 / (double)(now_ns(CLOCK_MONOTONIC) - start));
+		_exit(0);
+	}
+	if (reflector != -1) {
+		children[1] = fork();
+		if (children[1] == 0) {
+			_exit(echo(reflector, arguments->offset));
+		}
+	}
+	return children[0] == -1;
+}
+
+int main(int argc, char **argv)
+{
+	/* Initialisation */
+	struct arguments arguments; /* stores argp args */
+	struct argp argp = { /* argp - The ARGP structure itself */
+		options, /* options */
+		parse_opt, /* callback function to process args */
+		args_doc, /* names of parameters */
+		doc /* documentation containing general program description */
+	};
+	struct sigaction action;
+	pid_t children[2] = {-1, -1};
+	int tx, rx, res, i;
+
+	memset(&arguments, 0, sizeof(arguments));
+	arguments.rate = 1000;
+	arguments.bitrate = 500000;
+	arguments.count = 10000;
+	arguments.id = 0x100;
+	arguments.ids = 1;
+	arguments.dlc = 8;
+	argp_parse(&argp, argc, argv, 0, 0, &arguments);
+
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = on_signal; /* no SA_RESTART, so blocking reads return on interruption */
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+
+	/* Main functionality */
+	if (arguments.vbus) {
+		if (spawn_bus(&arguments, &tx, &rx, children) != 0) {
+			fprintf(stderr, "Error creating virtual bus\n");
+			return 1;
+		}
+	} else {
+		if (can_interact_init(&tx, arguments.args[0]) != 0) {
+			fprintf(stderr, "Error opening CAN device %s\n", arguments.args[0]);
+			return 1;
+		}
+		if (arguments.echo) {
+			res = echo(tx, arguments.offset);
+			can_interact_fini(&tx);
+			return res;
+		}
+		if (can_interact_init(&rx, arguments.arg_count > 1 ? arguments.args[1] : arguments.args[0]) != 0) {
+			fprintf(stderr, "Error opening CAN device %s\n", arguments.arg_count > 1 ? arguments.args[1] : arguments.args[0]);
+			return 1;
+		}
+	}
+
+	res = measure(&arguments, tx, rx);
+
+	/* E(nd)O(f)P(rogram) */
+	for (i = 1; i >= 0; --i) {
+		if (children[i] > 0) {
+			kill(children[i], SIGTERM);
+			waitpid(children[i], NULL, 0);
+		}
+	}
+	can_interact_fini(&tx);
+	can_interact_fini(&rx);
+	return res;
+}